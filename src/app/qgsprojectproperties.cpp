@@ -701,6 +701,10 @@ QgsProjectProperties::QgsProjectProperties( QgsMapCanvas *mapCanvas, QWidget *pa
   }
   mWMSImageQualitySpinBox->setClearValue( 90 );
 
+  // WMS PNG compression
+  mWMSPngCompressionSpinBox->setValue( QgsProject::instance()->readNumEntry( QStringLiteral( "WMSPngCompression" ), QStringLiteral( "/" ), -1 ) );
+  mWMSPngCompressionSpinBox->setClearValue( -1 );
+
   // WMS tileBuffer
   mWMSTileBufferSpinBox->setValue( QgsProject::instance()->readNumEntry( QStringLiteral( "WMSTileBuffer" ), QStringLiteral( "/" ), 0 ) );
 
@@ -1432,6 +1436,17 @@ void QgsProjectProperties::apply()
     QgsProject::instance()->writeEntry( QStringLiteral( "WMSImageQuality" ), QStringLiteral( "/" ), imageQualityValue );
   }
 
+  // WMS PNG compression
+  int pngCompressionValue = mWMSPngCompressionSpinBox->value();
+  if ( pngCompressionValue < 0 )
+  {
+    QgsProject::instance()->removeEntry( QStringLiteral( "WMSPngCompression" ), QStringLiteral( "/" ) );
+  }
+  else
+  {
+    QgsProject::instance()->writeEntry( QStringLiteral( "WMSPngCompression" ), QStringLiteral( "/" ), pngCompressionValue );
+  }
+
   // WMS TileBuffer
   QgsProject::instance()->writeEntry( QStringLiteral( "WMSTileBuffer" ), QStringLiteral( "/" ), mWMSTileBufferSpinBox->value() );
 
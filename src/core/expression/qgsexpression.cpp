@@ -55,6 +55,7 @@ void QgsExpression::setExpression( const QString &expression )
   d->mEvalErrorString = QString();
   d->mExp = expression;
   d->mIsPrepared = false;
+  d->mProgram.reset();
 }
 
 QString QgsExpression::expression() const
@@ -343,7 +344,25 @@ bool QgsExpression::prepare( const QgsExpressionContext *context )
 
   initGeomCalculator( context );
   d->mIsPrepared = true;
-  return d->mRootNode->prepare( this, context );
+  const bool prepared = d->mRootNode->prepare( this, context );
+
+  // lower the prepared tree to a register program, nodes which cannot be compiled are still interpreted
+  if ( d->mCompilationEnabled )
+    d->mProgram = QgsExpressionProgram::compile( d->mRootNode, context );
+  else
+    d->mProgram.reset();
+  return prepared;
+}
+
+void QgsExpression::setCompilationEnabled( bool enabled )
+{
+  detach();
+  d->mCompilationEnabled = enabled;
+}
+
+bool QgsExpression::isCompilationEnabled() const
+{
+  return d->mCompilationEnabled;
 }
 
 QVariant QgsExpression::evaluate()
@@ -371,9 +390,47 @@ QVariant QgsExpression::evaluate( const QgsExpressionContext *context )
   {
     prepare( context );
   }
+  if ( d->mProgram )
+    return d->mProgram->evaluate( this, context );
   return d->mRootNode->eval( this, context );
 }
 
+QVariantList QgsExpression::evaluateFeatures( const QList< QgsFeature > &features, QgsExpressionContext *context )
+{
+  d->mEvalErrorString = QString();
+  if ( !d->mRootNode )
+  {
+    d->mEvalErrorString = tr( "No root node! Parsing failed?" );
+    QVariantList results;
+    results.reserve( features.size() );
+    for ( int i = 0; i < features.size(); ++i )
+      results << QVariant();
+    return results;
+  }
+
+  if ( ! d->mIsPrepared )
+  {
+    prepare( context );
+  }
+  if ( d->mProgram && context )
+    return d->mProgram->evaluateFeatures( this, context, features );
+
+  QVariantList results;
+  results.reserve( features.size() );
+  QString lastError;
+  for ( const QgsFeature &feature : features )
+  {
+    if ( context )
+      context->setFeature( feature );
+    d->mEvalErrorString = QString();
+    results << d->mRootNode->eval( this, context );
+    if ( !d->mEvalErrorString.isNull() )
+      lastError = d->mEvalErrorString;
+  }
+  d->mEvalErrorString = lastError;
+  return results;
+}
+
 bool QgsExpression::hasEvalError() const
 {
   return !d->mEvalErrorString.isNull();
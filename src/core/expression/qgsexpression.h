@@ -231,6 +231,29 @@ class CORE_EXPORT QgsExpression
      */
     bool prepare( const QgsExpressionContext *context );
 
+    /**
+     * Sets whether prepare() compiles the expression to a register program, which is then
+     * run by evaluate() and evaluateFeatures() instead of the node interpreter.
+     *
+     * Compiling gives the same results and errors as the interpreter, and is faster for
+     * expressions evaluated against many features. It adds some cost to prepare(), so it is
+     * disabled by default.
+     *
+     * \note The expression must be prepared again for the change to take effect.
+     *
+     * \see isCompilationEnabled()
+     * \since QGIS 3.22
+     */
+    void setCompilationEnabled( bool enabled );
+
+    /**
+     * Returns TRUE if prepare() compiles the expression to a register program.
+     *
+     * \see setCompilationEnabled()
+     * \since QGIS 3.22
+     */
+    bool isCompilationEnabled() const;
+
     /**
      * Gets list of columns referenced by the expression.
      *
@@ -340,6 +363,22 @@ class CORE_EXPORT QgsExpression
      */
     QVariant evaluate( const QgsExpressionContext *context );
 
+    /**
+     * Evaluates the expression for each of the specified \a features and returns the results, in the
+     * same order as the features.
+     *
+     * Each feature is set in turn on the \a context, which is left with the last feature set. Evaluating
+     * a block of features at once is faster than calling evaluate() for each of them, as the prepared
+     * expression is run over the whole block one operation at a time.
+     *
+     * A feature for which the evaluation fails gets a NULL result, hasEvalError() and evalErrorString()
+     * report the last error encountered in the block.
+     *
+     * \note prepare() should be called before calling this method.
+     * \since QGIS 3.22
+     */
+    QVariantList evaluateFeatures( const QList< QgsFeature > &features, QgsExpressionContext *context );
+
     //! Returns TRUE if an error occurred when evaluating last input
     bool hasEvalError() const;
     //! Returns evaluation error
@@ -530,7 +530,7 @@ QgsExpressionContextScope *QgsExpressionContextUtils::updateSymbolScope( const Q
   if ( !symbolScope )
     return nullptr;
 
-  symbolScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_SYMBOL_COLOR, symbol ? symbol->color() : QColor(), true ) );
+  symbolScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolColor, symbol ? symbol->color() : QColor() );
 
   double angle = 0.0;
   const QgsMarkerSymbol *markerSymbol = dynamic_cast< const QgsMarkerSymbol * >( symbol );
@@ -538,7 +538,7 @@ QgsExpressionContextScope *QgsExpressionContextUtils::updateSymbolScope( const Q
   {
     angle = markerSymbol->angle();
   }
-  symbolScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_SYMBOL_ANGLE, angle, true ) );
+  symbolScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolAngle, angle );
 
   return symbolScope;
 }
@@ -23,6 +23,7 @@
 #include "qgsexpressionnodeimpl.h"
 #include "qgsexiftools.h"
 #include "qgsfeaturerequest.h"
+#include "qgsfeedback.h"
 #include "qgsstringutils.h"
 #include "qgsmultipoint.h"
 #include "qgsgeometryutils.h"
@@ -52,6 +53,7 @@
 #include "qgsfieldformatterregistry.h"
 #include "qgsfieldformatter.h"
 #include "qgsvectorlayerfeatureiterator.h"
+#include "qgsvectorlayeraggregatecache_p.h"
 #include "qgsproviderregistry.h"
 #include "sqlite3.h"
 #include "qgstransaction.h"
@@ -669,12 +671,12 @@ static QVariant fcnAggregate( const QVariantList &values, const QgsExpressionCon
 
     if ( !isStatic )
     {
-      cacheKey = QStringLiteral( "aggfcn:%1:%2:%3:%4:%5%6:%7" ).arg( vl->id(), QString::number( aggregate ), subExpression, parameters.filter,
-                 QString::number( context->feature().id() ), QString::number( qHash( context->feature() ) ), orderBy );
+      cacheKey = QStringLiteral( "aggfcn:%1:%2:%3:%4:%5%6:%7:%8" ).arg( vl->id(), QString::number( aggregate ), subExpression, parameters.filter,
+                 QString::number( context->feature().id() ), QString::number( qHash( context->feature() ) ), orderBy, parameters.delimiter );
     }
     else
     {
-      cacheKey = QStringLiteral( "aggfcn:%1:%2:%3:%4:%5" ).arg( vl->id(), QString::number( aggregate ), subExpression, parameters.filter, orderBy );
+      cacheKey = QStringLiteral( "aggfcn:%1:%2:%3:%4:%5:%6" ).arg( vl->id(), QString::number( aggregate ), subExpression, parameters.filter, orderBy, parameters.delimiter );
     }
 
     if ( context->hasCachedValue( cacheKey ) )
@@ -682,6 +684,29 @@ static QVariant fcnAggregate( const QVariantList &values, const QgsExpressionCon
       return context->cachedValue( cacheKey );
     }
 
+    // static aggregates are also shared with other contexts through the layer
+    QString layerCacheKey;
+    QgsVectorLayerAggregateCache *layerCache = vl->aggregateCache();
+    int layerCacheGeneration = 0;
+    if ( isStatic )
+    {
+      QgsExpression orderByExp( orderBy );
+      if ( QgsVectorLayerAggregateCache::canCache( vl, { &subExp, &filterExp, &orderByExp } ) )
+      {
+        const QString variablesKey = QgsVectorLayerAggregateCache::variablesKey( filterExp.referencedVariables() + subExp.referencedVariables() + orderByExp.referencedVariables(), context );
+        if ( !variablesKey.isNull() )
+        {
+          layerCacheKey = cacheKey + ':' + variablesKey;
+          layerCacheGeneration = layerCache->generation();
+          if ( layerCache->value( layerCacheKey, result ) )
+          {
+            context->setCachedValue( cacheKey, result );
+            return result;
+          }
+        }
+      }
+    }
+
     QgsExpressionContext subContext( *context );
     QgsExpressionContextScope *subScope = new QgsExpressionContextScope();
     subScope->setVariable( QStringLiteral( "parent" ), context->feature() );
@@ -689,6 +714,8 @@ static QVariant fcnAggregate( const QVariantList &values, const QgsExpressionCon
     result = vl->aggregate( aggregate, subExpression, parameters, &subContext, &ok, nullptr, context->feedback() );
 
     context->setCachedValue( cacheKey, result );
+    if ( ok && !layerCacheKey.isEmpty() && !( context->feedback() && context->feedback()->isCanceled() ) )
+      layerCache->insert( layerCacheKey, result, layerCacheGeneration );
   }
   else
   {
@@ -703,6 +730,111 @@ static QVariant fcnAggregate( const QVariantList &values, const QgsExpressionCon
   return result;
 }
 
+//! Number of parent features aggregated one by one in a context before all the groups of children are aggregated at once
+constexpr int RELATION_AGGREGATE_GROUPING_THRESHOLD = 2;
+
+/**
+ * Retrieves the aggregate of the children of the \a parentFeature from the aggregates of all the groups of
+ * children of \a relation, which are calculated in a single pass over the child layer and shared through its
+ * aggregate cache.
+ *
+ * Returns FALSE if the relation or the aggregate cannot be grouped, or while too few parents were aggregated
+ * in the \a context for a pass over all the children to pay off.
+ */
+static bool relationAggregateFromGroups( const QgsRelation &relation, QgsAggregateCalculator::Aggregate aggregate, const QString &subExpression,
+    const QgsAggregateCalculator::AggregateParameters &parameters, const QString &orderBy, const QgsFeature &parentFeature,
+    const QgsExpressionContext *context, QVariant &result )
+{
+  if ( !relation.polymorphicRelationId().isEmpty() )
+    return false;
+
+  QgsVectorLayer *childLayer = relation.referencingLayer();
+  const QgsVectorLayer *parentLayer = relation.referencedLayer();
+  if ( !childLayer || !parentLayer )
+    return false;
+
+  // groups are matched on values, which must compare as the related features filter does
+  QStringList groupByFields;
+  QVariantList parentValues;
+  const QgsFields parentFields = parentLayer->fields();
+  const QgsFields childFields = childLayer->fields();
+  const QList< QgsRelation::FieldPair > fieldPairs = relation.fieldPairs();
+  for ( const QgsRelation::FieldPair &pair : fieldPairs )
+  {
+    const int parentIndex = parentFields.lookupField( pair.referencedField() );
+    const int childIndex = childFields.lookupField( pair.referencingField() );
+    if ( parentIndex < 0 || childIndex < 0 || parentFields.at( parentIndex ).type() != childFields.at( childIndex ).type() )
+      return false;
+
+    // groups are keyed by the string representation of the values, which only identifies these types
+    switch ( childFields.at( childIndex ).type() )
+    {
+      case QVariant::Int:
+      case QVariant::UInt:
+      case QVariant::LongLong:
+      case QVariant::ULongLong:
+      case QVariant::String:
+      case QVariant::Date:
+        break;
+      default:
+        return false;
+    }
+
+    groupByFields << pair.referencingField();
+    parentValues << parentFeature.attribute( pair.referencedField() );
+  }
+  if ( groupByFields.isEmpty() )
+    return false;
+
+  QgsExpression subExp( subExpression );
+  QgsExpression orderByExp( orderBy );
+  const QSet< QString > variables = subExp.referencedVariables() + orderByExp.referencedVariables();
+  if ( variables.contains( QString() ) || !QgsVectorLayerAggregateCache::canCache( childLayer, { &subExp, &orderByExp } ) )
+    return false;
+
+  const QString variablesKey = QgsVectorLayerAggregateCache::variablesKey( variables, context );
+  if ( variablesKey.isNull() )
+    return false;
+
+  const QString groupsKey = QStringLiteral( "relagg-grouped:%1:%2:%3:%4:%5:%6" ).arg( relation.id(),
+                            QString::number( static_cast< int >( aggregate ) ),
+                            subExpression,
+                            parameters.delimiter,
+                            orderBy,
+                            variablesKey );
+
+  QgsVectorLayerAggregateCache *cache = childLayer->aggregateCache();
+  QVariant groups;
+  if ( !cache->value( groupsKey, groups ) )
+  {
+    // only read all the children once several parents were aggregated in this context
+    const QString countKey = QStringLiteral( "relagg-count:" ) + groupsKey;
+    const int count = context->cachedValue( countKey ).toInt() + 1;
+    context->setCachedValue( countKey, count );
+    if ( count < RELATION_AGGREGATE_GROUPING_THRESHOLD )
+      return false;
+
+    const int generation = cache->generation();
+    QgsAggregateCalculator calculator( childLayer );
+    QgsAggregateCalculator::AggregateParameters groupParameters = parameters;
+    groupParameters.filter.clear();
+    calculator.setParameters( groupParameters );
+
+    QgsExpressionContext subContext( *context );
+    bool ok = false;
+    groups = QVariantHash( calculator.calculateGrouped( aggregate, subExpression, groupByFields, &subContext, &ok, context->feedback() ) );
+    if ( !ok || ( context->feedback() && context->feedback()->isCanceled() ) )
+      return false;
+
+    cache->insert( groupsKey, groups, generation );
+  }
+
+  const QVariantHash groupValues = groups.toHash();
+  const auto it = groupValues.constFind( QgsAggregateCalculator::groupKey( parentValues ) );
+  result = it != groupValues.constEnd() ? it.value() : groupValues.value( QString() );
+  return true;
+}
+
 static QVariant fcnAggregateRelation( const QVariantList &values, const QgsExpressionContext *context, QgsExpression *parent, const QgsExpressionNodeFunction * )
 {
   if ( !context )
@@ -806,6 +938,11 @@ static QVariant fcnAggregateRelation( const QVariantList &values, const QgsExpre
   QVariant result;
   ok = false;
 
+  if ( relationAggregateFromGroups( relation, aggregate, subExpression, parameters, orderBy, f, context, result ) )
+  {
+    context->setCachedValue( cacheKey, result );
+    return result;
+  }
 
   QgsExpressionContext subContext( *context );
   result = childLayer->aggregate( aggregate, subExpression, parameters, &subContext, &ok, nullptr, context->feedback() );
@@ -1080,7 +1217,7 @@ static QVariant fcnMapScale( const QVariantList &, const QgsExpressionContext *c
   if ( !context )
     return QVariant();
 
-  QVariant scale = context->variable( QStringLiteral( "map_scale" ) );
+  QVariant scale = context->knownVariable( QgsExpressionContextScope::KnownVariable::MapScale );
   bool ok = false;
   if ( !scale.isValid() || scale.isNull() )
     return QVariant();
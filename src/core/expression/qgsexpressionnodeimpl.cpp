@@ -16,10 +16,10 @@
 #include "qgsexpressionnodeimpl.h"
 #include "qgsexpressionutils.h"
 #include "qgsexpression.h"
+#include "qgsexpressioncontext.h"
 
 #include "qgsgeometry.h"
 #include "qgsfeaturerequest.h"
-#include "qgsstringutils.h"
 
 #include <QRegularExpression>
 
@@ -110,6 +110,11 @@ QVariant QgsExpressionNodeUnaryOperator::evalNode( QgsExpression *parent, const
   QVariant val = mOperand->eval( parent, context );
   ENSURE_NO_EVAL_ERROR
 
+  return evaluateOperand( val, parent );
+}
+
+QVariant QgsExpressionNodeUnaryOperator::evaluateOperand( const QVariant &val, QgsExpression *parent )
+{
   switch ( mOp )
   {
     case uoNot:
@@ -216,6 +221,11 @@ QVariant QgsExpressionNodeBinaryOperator::evalNode( QgsExpression *parent, const
   QVariant vR = mOpRight->eval( parent, context );
   ENSURE_NO_EVAL_ERROR
 
+  return evaluateOperands( vL, vR, parent, context );
+}
+
+QVariant QgsExpressionNodeBinaryOperator::evaluateOperands( const QVariant &vL, const QVariant &vR, QgsExpression *parent, const QgsExpressionContext *context )
+{
   switch ( mOp )
   {
     case boPlus:
@@ -532,39 +542,10 @@ QVariant QgsExpressionNodeBinaryOperator::evalNode( QgsExpression *parent, const
         ENSURE_NO_EVAL_ERROR
         QString regexp = QgsExpressionUtils::getStringValue( vR, parent );
         ENSURE_NO_EVAL_ERROR
-        // TODO: cache QRegularExpression in case that regexp is a literal string (i.e. it will stay constant)
         bool matches;
         if ( mOp == boLike || mOp == boILike || mOp == boNotLike || mOp == boNotILike ) // change from LIKE syntax to regexp
         {
-          QString esc_regexp = QgsStringUtils::qRegExpEscape( regexp );
-          // manage escape % and _
-          if ( esc_regexp.startsWith( '%' ) )
-          {
-            esc_regexp.replace( 0, 1, QStringLiteral( ".*" ) );
-          }
-          const thread_local QRegularExpression rx1( QStringLiteral( "[^\\\\](%)" ) );
-          int pos = 0;
-          while ( ( pos = esc_regexp.indexOf( rx1, pos ) ) != -1 )
-          {
-            esc_regexp.replace( pos + 1, 1, QStringLiteral( ".*" ) );
-            pos += 1;
-          }
-          const thread_local QRegularExpression rx2( QStringLiteral( "\\\\%" ) );
-          esc_regexp.replace( rx2, QStringLiteral( "%" ) );
-          if ( esc_regexp.startsWith( '_' ) )
-          {
-            esc_regexp.replace( 0, 1, QStringLiteral( "." ) );
-          }
-          const thread_local QRegularExpression rx3( QStringLiteral( "[^\\\\](_)" ) );
-          pos = 0;
-          while ( ( pos = esc_regexp.indexOf( rx3, pos ) ) != -1 )
-          {
-            esc_regexp.replace( pos + 1, 1, '.' );
-            pos += 1;
-          }
-          esc_regexp.replace( QLatin1String( "\\\\_" ), QLatin1String( "_" ) );
-
-          matches = QRegularExpression( QRegularExpression::anchoredPattern( esc_regexp ), mOp == boLike || mOp == boNotLike ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption ).match( str ).hasMatch();
+          matches = QgsExpressionUtils::likePatternToRegularExpression( regexp, mOp == boLike || mOp == boNotLike ).match( str ).hasMatch();
         }
         else
         {
@@ -1053,6 +1034,9 @@ bool QgsExpressionNodeInOperator::isStatic( QgsExpression *parent, const QgsExpr
 
 QVariant QgsExpressionNodeFunction::evalNode( QgsExpression *parent, const QgsExpressionContext *context )
 {
+  if ( mKnownVariable >= 0 )
+    return context ? context->knownVariable( static_cast< QgsExpressionContextScope::KnownVariable >( mKnownVariable ) ) : QVariant();
+
   QString name = QgsExpression::QgsExpression::Functions()[mFnIndex]->name();
   QgsExpressionFunction *fd = context && context->hasFunction( name ) ? context->function( name ) : QgsExpression::QgsExpression::Functions()[mFnIndex];
 
@@ -1117,6 +1101,16 @@ bool QgsExpressionNodeFunction::prepareNode( QgsExpression *parent, const QgsExp
 {
   QgsExpressionFunction *fd = QgsExpression::QgsExpression::Functions()[mFnIndex];
 
+  // well known variables referenced by name (e.g. @geometry_part_num) are read from the fixed slots of the scopes
+  mKnownVariable = -1;
+  if ( fd->name() == QLatin1String( "var" ) && mArgs && mArgs->count() == 1 && mArgs->at( 0 )->nodeType() == ntLiteral )
+  {
+    const QVariant name = static_cast< const QgsExpressionNodeLiteral * >( mArgs->at( 0 ) )->value();
+    QgsExpressionContextScope::KnownVariable knownVariable;
+    if ( name.type() == QVariant::String && !name.isNull() && QgsExpressionContextScope::isKnownVariable( name.toString(), knownVariable ) )
+      mKnownVariable = static_cast< int >( knownVariable );
+  }
+
   bool res = fd->prepare( this, parent, context );
   if ( mArgs && !fd->lazyEval() )
   {
@@ -1241,6 +1235,7 @@ bool QgsExpressionNodeFunction::needsGeometry() const
 QgsExpressionNode *QgsExpressionNodeFunction::clone() const
 {
   QgsExpressionNodeFunction *copy = new QgsExpressionNodeFunction( mFnIndex, mArgs ? mArgs->clone() : nullptr );
+  copy->mKnownVariable = mKnownVariable;
   cloneTo( copy );
   return copy;
 }
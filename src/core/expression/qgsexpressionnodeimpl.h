@@ -86,10 +86,18 @@ class CORE_EXPORT QgsExpressionNodeUnaryOperator : public QgsExpressionNode
     QString text() const;
 
   private:
+
+    /**
+     * Computes the result of the operator for an already evaluated operand \a value.
+     */
+    QVariant evaluateOperand( const QVariant &value, QgsExpression *parent );
+
     UnaryOperator mOp;
     QgsExpressionNode *mOperand = nullptr;
 
     static const char *UNARY_OPERATOR_TEXT[];
+
+    friend class QgsExpressionProgram;
 };
 
 /**
@@ -204,6 +212,12 @@ class CORE_EXPORT QgsExpressionNodeBinaryOperator : public QgsExpressionNode
     QString text() const;
 
   private:
+
+    /**
+     * Computes the result of the operator for already evaluated left and right operand values.
+     */
+    QVariant evaluateOperands( const QVariant &vL, const QVariant &vR, QgsExpression *parent, const QgsExpressionContext *context );
+
     bool compare( double diff );
     qlonglong computeInt( qlonglong x, qlonglong y );
     double computeDouble( double x, double y );
@@ -220,6 +234,8 @@ class CORE_EXPORT QgsExpressionNodeBinaryOperator : public QgsExpressionNode
     QgsExpressionNode *mOpRight = nullptr;
 
     static const char *BINARY_OPERATOR_TEXT[];
+
+    friend class QgsExpressionProgram;
 };
 
 /**
@@ -389,6 +405,8 @@ class CORE_EXPORT QgsExpressionNodeFunction : public QgsExpressionNode
   private:
     int mFnIndex;
     NodeList *mArgs = nullptr;
+    //! Well known variable referenced by a var() call, resolved at prepare time, or -1
+    int mKnownVariable = -1;
 };
 
 /**
@@ -488,6 +506,8 @@ class CORE_EXPORT QgsExpressionNodeColumnRef : public QgsExpressionNode
   private:
     QString mName;
     int mIndex;
+
+    friend class QgsExpressionProgram;
 };
 
 /**
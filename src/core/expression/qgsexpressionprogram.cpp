@@ -0,0 +1,1209 @@
+/***************************************************************************
+                         qgsexpressionprogram.cpp
+                         ------------------------
+    begin                : October 2021
+    copyright            : (C) 2021 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsexpressionprogram_p.h"
+#include "qgsexpression.h"
+#include "qgsexpressioncontext.h"
+#include "qgsexpressionfunction.h"
+#include "qgsexpressionutils.h"
+#include "qgsfeature.h"
+
+#include <QVarLengthArray>
+
+#include <cmath>
+#include <vector>
+
+///@cond PRIVATE
+
+/**
+ * A register of a program. Numbers and strings are kept unboxed, and values read from features,
+ * variables or interpreted nodes keep their original variant so that they are returned unchanged.
+ */
+class QgsExpressionProgram::Value
+{
+  public:
+
+    enum Kind
+    {
+      Null,
+      Boolean,
+      Integer,
+      Double,
+      String,
+      Variant,
+    };
+
+    Kind kind = Null;
+    qlonglong integer = 0;
+    double number = 0;
+    QString string;
+    QVariant variant;
+    bool boxed = false;
+
+    void setNull()
+    {
+      kind = Null;
+      boxed = false;
+    }
+
+    void setBoolean( bool value )
+    {
+      kind = Boolean;
+      integer = value ? 1 : 0;
+      boxed = false;
+    }
+
+    void setTvl( QgsExpressionUtils::TVL value )
+    {
+      if ( value == QgsExpressionUtils::Unknown )
+        setNull();
+      else
+        setBoolean( value == QgsExpressionUtils::True );
+    }
+
+    void setInteger( qlonglong value )
+    {
+      kind = Integer;
+      integer = value;
+      boxed = false;
+    }
+
+    void setDouble( double value )
+    {
+      if ( std::isfinite( value ) )
+      {
+        kind = Double;
+        number = value;
+        boxed = false;
+      }
+      else
+      {
+        // not a valid number for any further calculation, leave it to the interpreter
+        setVariant( QVariant( value ) );
+      }
+    }
+
+    void setString( const QString &value )
+    {
+      kind = String;
+      string = value;
+      boxed = false;
+    }
+
+    void setVariant( const QVariant &value )
+    {
+      variant = value;
+      boxed = true;
+      if ( value.isNull() )
+      {
+        kind = Null;
+        return;
+      }
+
+      switch ( value.type() )
+      {
+        case QVariant::Int:
+        case QVariant::LongLong:
+          kind = Integer;
+          integer = value.toLongLong();
+          break;
+
+        case QVariant::Double:
+          number = value.toDouble();
+          kind = std::isfinite( number ) ? Double : Variant;
+          break;
+
+        case QVariant::String:
+          kind = String;
+          string = value.toString();
+          break;
+
+        default:
+          kind = Variant;
+          break;
+      }
+    }
+
+    bool isNumeric() const { return kind == Boolean || kind == Integer || kind == Double; }
+
+    bool isIntegral() const { return kind == Boolean || kind == Integer; }
+
+    double toDouble() const { return kind == Double ? number : static_cast< double >( integer ); }
+
+    QVariant toVariant() const
+    {
+      if ( boxed )
+        return variant;
+
+      switch ( kind )
+      {
+        case Boolean:
+          return integer ? TVL_True : TVL_False;
+        case Integer:
+          return QVariant( integer );
+        case Double:
+          return QVariant( number );
+        case String:
+          return QVariant( string );
+        case Null:
+        case Variant:
+          break;
+      }
+      return QVariant();
+    }
+
+    QgsExpressionUtils::TVL toTvl( QgsExpression *parent ) const
+    {
+      switch ( kind )
+      {
+        case Null:
+          return QgsExpressionUtils::Unknown;
+        case Boolean:
+        case Integer:
+          return integer != 0 ? QgsExpressionUtils::True : QgsExpressionUtils::False;
+        case Double:
+          return !qgsDoubleNear( number, 0.0 ) ? QgsExpressionUtils::True : QgsExpressionUtils::False;
+        case String:
+        case Variant:
+          break;
+      }
+      return QgsExpressionUtils::getTVLValue( toVariant(), parent );
+    }
+};
+
+static QgsExpressionProgram::ValueType typeForVariantType( QVariant::Type type )
+{
+  switch ( type )
+  {
+    case QVariant::Int:
+    case QVariant::LongLong:
+      return QgsExpressionProgram::ValueType::Integer;
+    case QVariant::Double:
+      return QgsExpressionProgram::ValueType::Double;
+    case QVariant::String:
+      return QgsExpressionProgram::ValueType::String;
+    default:
+      return QgsExpressionProgram::ValueType::Unknown;
+  }
+}
+
+static bool isNumericType( QgsExpressionProgram::ValueType type )
+{
+  return type == QgsExpressionProgram::ValueType::Boolean
+         || type == QgsExpressionProgram::ValueType::Integer
+         || type == QgsExpressionProgram::ValueType::Double;
+}
+
+static bool isIntegralType( QgsExpressionProgram::ValueType type )
+{
+  return type == QgsExpressionProgram::ValueType::Boolean
+         || type == QgsExpressionProgram::ValueType::Integer;
+}
+
+static QgsExpressionProgram::ValueType binaryResultType( QgsExpressionNodeBinaryOperator::BinaryOperator op, QgsExpressionProgram::ValueType left, QgsExpressionProgram::ValueType right )
+{
+  using ValueType = QgsExpressionProgram::ValueType;
+  switch ( op )
+  {
+    case QgsExpressionNodeBinaryOperator::boOr:
+    case QgsExpressionNodeBinaryOperator::boAnd:
+    case QgsExpressionNodeBinaryOperator::boEQ:
+    case QgsExpressionNodeBinaryOperator::boNE:
+    case QgsExpressionNodeBinaryOperator::boLE:
+    case QgsExpressionNodeBinaryOperator::boGE:
+    case QgsExpressionNodeBinaryOperator::boLT:
+    case QgsExpressionNodeBinaryOperator::boGT:
+    case QgsExpressionNodeBinaryOperator::boRegexp:
+    case QgsExpressionNodeBinaryOperator::boLike:
+    case QgsExpressionNodeBinaryOperator::boNotLike:
+    case QgsExpressionNodeBinaryOperator::boILike:
+    case QgsExpressionNodeBinaryOperator::boNotILike:
+    case QgsExpressionNodeBinaryOperator::boIs:
+    case QgsExpressionNodeBinaryOperator::boIsNot:
+      return ValueType::Boolean;
+
+    case QgsExpressionNodeBinaryOperator::boPlus:
+      if ( left == ValueType::String && right == ValueType::String )
+        return ValueType::String;
+      FALLTHROUGH
+    case QgsExpressionNodeBinaryOperator::boMinus:
+    case QgsExpressionNodeBinaryOperator::boMul:
+    case QgsExpressionNodeBinaryOperator::boMod:
+      if ( isIntegralType( left ) && isIntegralType( right ) )
+        return ValueType::Integer;
+      FALLTHROUGH
+    case QgsExpressionNodeBinaryOperator::boDiv:
+    case QgsExpressionNodeBinaryOperator::boPow:
+      return isNumericType( left ) && isNumericType( right ) ? ValueType::Double : ValueType::Unknown;
+
+    case QgsExpressionNodeBinaryOperator::boIntDiv:
+      return isNumericType( left ) && isNumericType( right ) ? ValueType::Integer : ValueType::Unknown;
+
+    case QgsExpressionNodeBinaryOperator::boConcat:
+      return ValueType::String;
+  }
+  return ValueType::Unknown;
+}
+
+static bool compareDifference( QgsExpressionNodeBinaryOperator::BinaryOperator op, double diff )
+{
+  switch ( op )
+  {
+    case QgsExpressionNodeBinaryOperator::boEQ:
+      return qgsDoubleNear( diff, 0.0 );
+    case QgsExpressionNodeBinaryOperator::boNE:
+      return !qgsDoubleNear( diff, 0.0 );
+    case QgsExpressionNodeBinaryOperator::boLT:
+      return diff < 0;
+    case QgsExpressionNodeBinaryOperator::boGT:
+      return diff > 0;
+    case QgsExpressionNodeBinaryOperator::boLE:
+      return diff <= 0;
+    case QgsExpressionNodeBinaryOperator::boGE:
+      return diff >= 0;
+    default:
+      Q_ASSERT( false );
+      return false;
+  }
+}
+
+/**
+ * Evaluates \a op for two numeric values, following QgsExpressionNodeBinaryOperator::evaluateOperands().
+ * Returns FALSE if the operator has no numeric fast path.
+ */
+static bool evaluateNumeric( QgsExpressionNodeBinaryOperator::BinaryOperator op, const QgsExpressionProgram::Value &left, const QgsExpressionProgram::Value &right, QgsExpressionProgram::Value &result )
+{
+  switch ( op )
+  {
+    case QgsExpressionNodeBinaryOperator::boPlus:
+    case QgsExpressionNodeBinaryOperator::boMinus:
+    case QgsExpressionNodeBinaryOperator::boMul:
+    case QgsExpressionNodeBinaryOperator::boMod:
+      if ( left.isIntegral() && right.isIntegral() )
+      {
+        const qlonglong iL = left.integer;
+        const qlonglong iR = right.integer;
+        switch ( op )
+        {
+          case QgsExpressionNodeBinaryOperator::boPlus:
+            result.setInteger( iL + iR );
+            break;
+          case QgsExpressionNodeBinaryOperator::boMinus:
+            result.setInteger( iL - iR );
+            break;
+          case QgsExpressionNodeBinaryOperator::boMul:
+            result.setInteger( iL * iR );
+            break;
+          default:
+            if ( iR == 0 )
+              result.setNull();
+            else
+              result.setInteger( iL % iR );
+            break;
+        }
+        return true;
+      }
+      FALLTHROUGH
+    case QgsExpressionNodeBinaryOperator::boDiv:
+    {
+      const double fL = left.toDouble();
+      const double fR = right.toDouble();
+      switch ( op )
+      {
+        case QgsExpressionNodeBinaryOperator::boPlus:
+          result.setDouble( fL + fR );
+          break;
+        case QgsExpressionNodeBinaryOperator::boMinus:
+          result.setDouble( fL - fR );
+          break;
+        case QgsExpressionNodeBinaryOperator::boMul:
+          result.setDouble( fL * fR );
+          break;
+        case QgsExpressionNodeBinaryOperator::boDiv:
+          if ( fR == 0. )
+            result.setNull(); // silently handle division by zero and return NULL
+          else
+            result.setDouble( fL / fR );
+          break;
+        default:
+          if ( fR == 0. )
+            result.setNull();
+          else
+            result.setDouble( std::fmod( fL, fR ) );
+          break;
+      }
+      return true;
+    }
+
+    case QgsExpressionNodeBinaryOperator::boIntDiv:
+    {
+      const double fR = right.toDouble();
+      if ( fR == 0. )
+        result.setNull();
+      else
+        result.setInteger( qlonglong( std::floor( left.toDouble() / fR ) ) );
+      return true;
+    }
+
+    case QgsExpressionNodeBinaryOperator::boPow:
+      result.setDouble( std::pow( left.toDouble(), right.toDouble() ) );
+      return true;
+
+    case QgsExpressionNodeBinaryOperator::boEQ:
+    case QgsExpressionNodeBinaryOperator::boNE:
+    case QgsExpressionNodeBinaryOperator::boLT:
+    case QgsExpressionNodeBinaryOperator::boGT:
+    case QgsExpressionNodeBinaryOperator::boLE:
+    case QgsExpressionNodeBinaryOperator::boGE:
+      result.setBoolean( compareDifference( op, left.toDouble() - right.toDouble() ) );
+      return true;
+
+    case QgsExpressionNodeBinaryOperator::boIs:
+    case QgsExpressionNodeBinaryOperator::boIsNot:
+    {
+      const bool equal = qgsDoubleNear( left.toDouble(), right.toDouble() );
+      result.setBoolean( op == QgsExpressionNodeBinaryOperator::boIs ? equal : !equal );
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+/**
+ * Evaluates \a op when at least one of the values is NULL.
+ * Returns FALSE if the result depends on the type of the NULL value.
+ */
+static bool evaluateNull( QgsExpressionNodeBinaryOperator::BinaryOperator op, const QgsExpressionProgram::Value &left, const QgsExpressionProgram::Value &right, QgsExpressionProgram::Value &result )
+{
+  switch ( op )
+  {
+    case QgsExpressionNodeBinaryOperator::boIs:
+    case QgsExpressionNodeBinaryOperator::boIsNot:
+    {
+      const bool bothNull = left.kind == QgsExpressionProgram::Value::Null && right.kind == QgsExpressionProgram::Value::Null;
+      result.setBoolean( op == QgsExpressionNodeBinaryOperator::boIs ? bothNull : !bothNull );
+      return true;
+    }
+
+    case QgsExpressionNodeBinaryOperator::boPlus:
+    case QgsExpressionNodeBinaryOperator::boIntDiv:
+    case QgsExpressionNodeBinaryOperator::boOr:
+    case QgsExpressionNodeBinaryOperator::boAnd:
+      // string concatenation of typed NULL strings and conversion errors
+      return false;
+
+    default:
+      result.setNull();
+      return true;
+  }
+}
+
+/**
+ * Evaluates \a op for two non NULL strings.
+ * Returns FALSE if the operator has no string fast path.
+ */
+static bool evaluateString( QgsExpressionNodeBinaryOperator::BinaryOperator op, const QgsExpressionProgram::Value &left, const QgsExpressionProgram::Value &right, const QRegularExpression *regularExpression, QgsExpressionProgram::Value &result )
+{
+  switch ( op )
+  {
+    case QgsExpressionNodeBinaryOperator::boPlus:
+    case QgsExpressionNodeBinaryOperator::boConcat:
+      result.setString( left.string + right.string );
+      return true;
+
+    case QgsExpressionNodeBinaryOperator::boEQ:
+    case QgsExpressionNodeBinaryOperator::boNE:
+    case QgsExpressionNodeBinaryOperator::boLT:
+    case QgsExpressionNodeBinaryOperator::boGT:
+    case QgsExpressionNodeBinaryOperator::boLE:
+    case QgsExpressionNodeBinaryOperator::boGE:
+    {
+      // strings are only compared as strings if they do not convert to intervals
+      static const bool sStringsAreIntervals = QVariant( QString() ).canConvert< QgsInterval >();
+      if ( sStringsAreIntervals )
+        return false;
+      result.setBoolean( compareDifference( op, QString::compare( left.string, right.string ) ) );
+      return true;
+    }
+
+    case QgsExpressionNodeBinaryOperator::boIs:
+    case QgsExpressionNodeBinaryOperator::boIsNot:
+    {
+      const bool equal = QString::compare( left.string, right.string ) == 0;
+      result.setBoolean( op == QgsExpressionNodeBinaryOperator::boIs ? equal : !equal );
+      return true;
+    }
+
+    case QgsExpressionNodeBinaryOperator::boRegexp:
+    case QgsExpressionNodeBinaryOperator::boLike:
+    case QgsExpressionNodeBinaryOperator::boNotLike:
+    case QgsExpressionNodeBinaryOperator::boILike:
+    case QgsExpressionNodeBinaryOperator::boNotILike:
+    {
+      if ( !regularExpression )
+        return false;
+      bool matches = regularExpression->match( left.string ).hasMatch();
+      if ( op == QgsExpressionNodeBinaryOperator::boNotLike || op == QgsExpressionNodeBinaryOperator::boNotILike )
+        matches = !matches;
+      result.setBoolean( matches );
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+std::unique_ptr< QgsExpressionProgram > QgsExpressionProgram::compile( QgsExpressionNode *rootNode, const QgsExpressionContext *context )
+{
+  if ( !rootNode )
+    return nullptr;
+
+  std::unique_ptr< QgsExpressionProgram > program( new QgsExpressionProgram() );
+  program->mRootNode = rootNode;
+  if ( context && context->hasVariable( QgsExpressionContext::EXPR_FIELDS ) )
+    program->mFields = qvariant_cast<QgsFields>( context->variable( QgsExpressionContext::EXPR_FIELDS ) );
+  program->mResultRegister = program->compileNode( rootNode, context );
+  program->mResultType = program->mRegisterTypes.at( program->mResultRegister );
+
+  // nothing to gain over the node interpreter
+  if ( program->mInstructions.size() == 1
+       && ( program->mInstructions.at( 0 ).opCode == OpCode::Fallback || program->mInstructions.at( 0 ).opCode == OpCode::LoadConstant ) )
+    return nullptr;
+
+  return program;
+}
+
+int QgsExpressionProgram::addRegister( ValueType type )
+{
+  mRegisterTypes.append( type );
+  return mRegisterTypes.size() - 1;
+}
+
+int QgsExpressionProgram::appendInstruction( const Instruction &instruction )
+{
+  mInstructions.append( instruction );
+  return mInstructions.size() - 1;
+}
+
+int QgsExpressionProgram::compileConstant( const QVariant &value )
+{
+  Instruction instruction;
+  instruction.opCode = OpCode::LoadConstant;
+  instruction.destination = addRegister( value.isNull() ? ValueType::Null : typeForVariantType( value.type() ) );
+  instruction.index = mConstants.size();
+  mConstants.append( value );
+  appendInstruction( instruction );
+  return instruction.destination;
+}
+
+int QgsExpressionProgram::compileFallback( QgsExpressionNode *node )
+{
+  Instruction instruction;
+  instruction.opCode = OpCode::Fallback;
+  instruction.destination = addRegister( ValueType::Unknown );
+  instruction.node = node;
+  appendInstruction( instruction );
+  mFallbackCount++;
+  return instruction.destination;
+}
+
+int QgsExpressionProgram::compileNode( QgsExpressionNode *node, const QgsExpressionContext *context )
+{
+  if ( node->hasCachedStaticValue() )
+    return compileConstant( node->cachedStaticValue() );
+
+  // nodes simplified during preparation are evaluated through their simplified version
+  if ( node->effectiveNode() != node )
+    return compileNode( const_cast< QgsExpressionNode * >( node->effectiveNode() ), context );
+
+  switch ( node->nodeType() )
+  {
+    case QgsExpressionNode::ntLiteral:
+      return compileConstant( static_cast< QgsExpressionNodeLiteral * >( node )->value() );
+
+    case QgsExpressionNode::ntColumnRef:
+    {
+      QgsExpressionNodeColumnRef *columnRef = static_cast< QgsExpressionNodeColumnRef * >( node );
+      if ( columnRef->mIndex < 0 )
+        return compileFallback( node );
+
+      const ValueType type = columnRef->mIndex < mFields.count() ? typeForVariantType( mFields.at( columnRef->mIndex ).type() ) : ValueType::Unknown;
+
+      Instruction instruction;
+      instruction.opCode = OpCode::LoadField;
+      instruction.destination = addRegister( type );
+      instruction.index = columnRef->mIndex;
+      instruction.node = node;
+      appendInstruction( instruction );
+      return instruction.destination;
+    }
+
+    case QgsExpressionNode::ntUnaryOperator:
+    {
+      QgsExpressionNodeUnaryOperator *unary = static_cast< QgsExpressionNodeUnaryOperator * >( node );
+      Instruction instruction;
+      instruction.left = compileNode( unary->operand(), context );
+      instruction.node = node;
+      if ( unary->op() == QgsExpressionNodeUnaryOperator::uoNot )
+      {
+        instruction.opCode = OpCode::Not;
+        instruction.destination = addRegister( ValueType::Boolean );
+      }
+      else
+      {
+        const ValueType operandType = mRegisterTypes.at( instruction.left );
+        instruction.opCode = OpCode::Negate;
+        instruction.destination = addRegister( operandType == ValueType::Boolean ? ValueType::Integer
+                                               : isNumericType( operandType ) ? operandType : ValueType::Unknown );
+      }
+      appendInstruction( instruction );
+      return instruction.destination;
+    }
+
+    case QgsExpressionNode::ntBinaryOperator:
+      return compileBinary( static_cast< QgsExpressionNodeBinaryOperator * >( node ), context );
+
+    case QgsExpressionNode::ntCondition:
+      return compileCondition( static_cast< QgsExpressionNodeCondition * >( node ), context );
+
+    case QgsExpressionNode::ntFunction:
+      return compileFunction( static_cast< QgsExpressionNodeFunction * >( node ), context );
+
+    case QgsExpressionNode::ntInOperator:
+    case QgsExpressionNode::ntIndexOperator:
+      break;
+  }
+
+  return compileFallback( node );
+}
+
+int QgsExpressionProgram::compileBinary( QgsExpressionNodeBinaryOperator *node, const QgsExpressionContext *context )
+{
+  const QgsExpressionNodeBinaryOperator::BinaryOperator op = node->op();
+
+  if ( op == QgsExpressionNodeBinaryOperator::boAnd || op == QgsExpressionNodeBinaryOperator::boOr )
+  {
+    // the right hand side is skipped when the left hand side decides the result
+    Instruction left;
+    left.opCode = OpCode::LogicalLeft;
+    left.left = compileNode( node->opLeft(), context );
+    left.destination = addRegister( ValueType::Boolean );
+    left.node = node;
+    const int leftIndex = appendInstruction( left );
+
+    Instruction right;
+    right.opCode = OpCode::LogicalRight;
+    right.right = compileNode( node->opRight(), context );
+    right.destination = left.destination;
+    right.node = node;
+    appendInstruction( right );
+
+    mInstructions[ leftIndex ].index = mInstructions.size();
+    return left.destination;
+  }
+
+  Instruction instruction;
+  instruction.opCode = OpCode::Binary;
+  instruction.left = compileNode( node->opLeft(), context );
+  instruction.right = compileNode( node->opRight(), context );
+  instruction.node = node;
+  instruction.destination = addRegister( binaryResultType( op, mRegisterTypes.at( instruction.left ), mRegisterTypes.at( instruction.right ) ) );
+
+  // patterns given as a string literal are only converted to a regular expression once
+  const Instruction &patternInstruction = mInstructions.constLast();
+  if ( patternInstruction.opCode == OpCode::LoadConstant && patternInstruction.destination == instruction.right
+       && mRegisterTypes.at( instruction.right ) == ValueType::String )
+  {
+    const QString pattern = mConstants.at( patternInstruction.index ).toString();
+    switch ( op )
+    {
+      case QgsExpressionNodeBinaryOperator::boLike:
+      case QgsExpressionNodeBinaryOperator::boNotLike:
+      case QgsExpressionNodeBinaryOperator::boILike:
+      case QgsExpressionNodeBinaryOperator::boNotILike:
+        instruction.index = mRegularExpressions.size();
+        mRegularExpressions.append( QgsExpressionUtils::likePatternToRegularExpression( pattern, op == QgsExpressionNodeBinaryOperator::boLike || op == QgsExpressionNodeBinaryOperator::boNotLike ) );
+        break;
+      case QgsExpressionNodeBinaryOperator::boRegexp:
+        instruction.index = mRegularExpressions.size();
+        mRegularExpressions.append( QRegularExpression( pattern ) );
+        break;
+      default:
+        break;
+    }
+    if ( instruction.index >= 0 )
+      mRegularExpressions.last().optimize();
+  }
+
+  appendInstruction( instruction );
+  return instruction.destination;
+}
+
+int QgsExpressionProgram::compileCondition( QgsExpressionNodeCondition *node, const QgsExpressionContext *context )
+{
+  const int destination = addRegister( ValueType::Unknown );
+  QVector< int > jumpsToEnd;
+  ValueType type = ValueType::Null;
+  bool firstBranch = true;
+  auto mergeType = [&type, &firstBranch]( ValueType branchType )
+  {
+    if ( branchType == ValueType::Null )
+      return;
+    if ( firstBranch || type == ValueType::Null )
+      type = branchType;
+    else if ( type != branchType )
+      type = ValueType::Unknown;
+    firstBranch = false;
+  };
+
+  const QgsExpressionNodeCondition::WhenThenList conditions = node->conditions();
+  for ( QgsExpressionNodeCondition::WhenThen *condition : conditions )
+  {
+    Instruction test;
+    test.opCode = OpCode::JumpIfNotTrue;
+    test.left = compileNode( condition->whenExp(), context );
+    test.node = node;
+    const int testIndex = appendInstruction( test );
+
+    Instruction move;
+    move.opCode = OpCode::Move;
+    move.left = compileNode( condition->thenExp(), context );
+    move.destination = destination;
+    appendInstruction( move );
+    mergeType( mRegisterTypes.at( move.left ) );
+
+    Instruction jump;
+    jump.opCode = OpCode::Jump;
+    jumpsToEnd << appendInstruction( jump );
+
+    mInstructions[ testIndex ].index = mInstructions.size();
+  }
+
+  if ( node->elseExp() )
+  {
+    Instruction move;
+    move.opCode = OpCode::Move;
+    move.left = compileNode( node->elseExp(), context );
+    move.destination = destination;
+    appendInstruction( move );
+    mergeType( mRegisterTypes.at( move.left ) );
+  }
+  else
+  {
+    // return NULL if no condition is matching
+    Instruction move;
+    move.opCode = OpCode::Move;
+    move.left = compileConstant( QVariant() );
+    move.destination = destination;
+    appendInstruction( move );
+  }
+
+  for ( int jump : std::as_const( jumpsToEnd ) )
+    mInstructions[ jump ].index = mInstructions.size();
+
+  mRegisterTypes[ destination ] = type;
+  return destination;
+}
+
+int QgsExpressionProgram::compileFunction( QgsExpressionNodeFunction *node, const QgsExpressionContext *context )
+{
+  QgsExpressionFunction *function = QgsExpression::Functions()[ node->fnIndex() ];
+  QgsStaticExpressionFunction *staticFunction = dynamic_cast< QgsStaticExpressionFunction * >( function );
+  if ( !staticFunction || staticFunction->lazyEval() )
+    return compileFallback( node );
+
+  const QList< QgsExpressionNode * > arguments = node->args() ? node->args()->list() : QList< QgsExpressionNode * >();
+
+  if ( function->name() == QLatin1String( "var" ) && arguments.size() == 1 )
+  {
+    // @variable references are resolved by name without going through the function
+    const QgsExpressionNode *nameNode = arguments.at( 0 );
+    if ( nameNode->nodeType() == QgsExpressionNode::ntLiteral
+         && static_cast< const QgsExpressionNodeLiteral * >( nameNode )->value().type() == QVariant::String
+         && !static_cast< const QgsExpressionNodeLiteral * >( nameNode )->value().isNull() )
+    {
+      const QString name = static_cast< const QgsExpressionNodeLiteral * >( nameNode )->value().toString();
+      Instruction instruction;
+      instruction.destination = addRegister( ValueType::Unknown );
+      instruction.node = node;
+      QgsExpressionContextScope::KnownVariable knownVariable;
+      if ( QgsExpressionContextScope::isKnownVariable( name, knownVariable ) )
+      {
+        // well known variables are read from the fixed slots of the scopes
+        instruction.opCode = OpCode::LoadKnownVariable;
+        instruction.index = static_cast< int >( knownVariable );
+      }
+      else
+      {
+        instruction.opCode = OpCode::LoadVariable;
+        instruction.index = mVariableNames.size();
+        mVariableNames << name;
+      }
+      if ( !mFunctionNames.contains( function->name() ) )
+        mFunctionNames << function->name();
+      appendInstruction( instruction );
+      return instruction.destination;
+    }
+  }
+
+  const int destination = addRegister( ValueType::Unknown );
+  const QgsExpressionFunction::ParameterList &parameters = function->parameters();
+  QVector< int > nullChecks;
+  Instruction call;
+  call.opCode = OpCode::CallFunction;
+  call.destination = destination;
+  call.node = node;
+  for ( int i = 0; i < arguments.size(); ++i )
+  {
+    const int argument = compileNode( arguments.at( i ), context );
+    call.arguments << argument;
+
+    // all "normal" functions return NULL when any parameter is NULL
+    const bool defaultParamIsNull = parameters.count() > i && parameters.at( i ).optional() && !parameters.at( i ).defaultValue().isValid();
+    if ( !defaultParamIsNull && !function->handlesNull() )
+    {
+      Instruction check;
+      check.opCode = OpCode::CheckNullArgument;
+      check.left = argument;
+      check.destination = destination;
+      nullChecks << appendInstruction( check );
+    }
+  }
+  appendInstruction( call );
+
+  for ( int check : std::as_const( nullChecks ) )
+    mInstructions[ check ].index = mInstructions.size();
+
+  if ( !mFunctionNames.contains( function->name() ) )
+    mFunctionNames << function->name();
+  return destination;
+}
+
+bool QgsExpressionProgram::isOverriddenBy( const QgsExpressionContext *context ) const
+{
+  if ( !context )
+    return false;
+
+  for ( const QString &name : mFunctionNames )
+  {
+    // functions overridden by the context are only handled by the node interpreter
+    if ( context->hasFunction( name ) )
+      return true;
+  }
+  return false;
+}
+
+bool QgsExpressionProgram::loadField( const Instruction &instruction, Value &destination, const QgsFeature &feature, QgsExpression *parent, const QgsExpressionContext *context ) const
+{
+  if ( feature.isValid() )
+  {
+    destination.setVariant( feature.attribute( instruction.index ) );
+    return true;
+  }
+
+  // let the node report the missing feature
+  destination.setVariant( instruction.node->eval( parent, context ) );
+  return !parent->hasEvalError();
+}
+
+bool QgsExpressionProgram::evaluateBinary( const Instruction &instruction, Value *registers, QgsExpression *parent, const QgsExpressionContext *context ) const
+{
+  QgsExpressionNodeBinaryOperator *node = static_cast< QgsExpressionNodeBinaryOperator * >( instruction.node );
+  const QgsExpressionNodeBinaryOperator::BinaryOperator op = node->op();
+  const Value &left = registers[ instruction.left ];
+  const Value &right = registers[ instruction.right ];
+  Value &destination = registers[ instruction.destination ];
+
+  bool evaluated = false;
+  if ( left.isNumeric() && right.isNumeric() )
+    evaluated = evaluateNumeric( op, left, right, destination );
+  else if ( left.kind == Value::Null || right.kind == Value::Null )
+    evaluated = evaluateNull( op, left, right, destination );
+  else if ( left.kind == Value::String && right.kind == Value::String )
+    evaluated = evaluateString( op, left, right, instruction.index >= 0 ? &mRegularExpressions.at( instruction.index ) : nullptr, destination );
+
+  if ( !evaluated )
+  {
+    destination.setVariant( node->evaluateOperands( left.toVariant(), right.toVariant(), parent, context ) );
+    return !parent->hasEvalError();
+  }
+  return true;
+}
+
+bool QgsExpressionProgram::execute( const Instruction &instruction, Value *registers, QgsExpression *parent, const QgsExpressionContext *context, int &next ) const
+{
+  switch ( instruction.opCode )
+  {
+    case OpCode::LoadConstant:
+      registers[ instruction.destination ].setVariant( mConstants.at( instruction.index ) );
+      return true;
+
+    case OpCode::LoadField:
+      return loadField( instruction, registers[ instruction.destination ], context ? context->feature() : QgsFeature(), parent, context );
+
+    case OpCode::LoadVariable:
+      registers[ instruction.destination ].setVariant( context ? context->variable( mVariableNames.at( instruction.index ) ) : QVariant() );
+      return true;
+
+    case OpCode::LoadKnownVariable:
+      registers[ instruction.destination ].setVariant( context ? context->knownVariable( static_cast< QgsExpressionContextScope::KnownVariable >( instruction.index ) ) : QVariant() );
+      return true;
+
+    case OpCode::Fallback:
+      registers[ instruction.destination ].setVariant( instruction.node->eval( parent, context ) );
+      return !parent->hasEvalError();
+
+    case OpCode::Move:
+      registers[ instruction.destination ] = registers[ instruction.left ];
+      return true;
+
+    case OpCode::Jump:
+      next = instruction.index;
+      return true;
+
+    case OpCode::JumpIfNotTrue:
+    {
+      const QgsExpressionUtils::TVL tvl = registers[ instruction.left ].toTvl( parent );
+      if ( parent->hasEvalError() )
+        return false;
+      if ( tvl != QgsExpressionUtils::True )
+        next = instruction.index;
+      return true;
+    }
+
+    case OpCode::Not:
+    {
+      const QgsExpressionUtils::TVL tvl = registers[ instruction.left ].toTvl( parent );
+      if ( parent->hasEvalError() )
+        return false;
+      registers[ instruction.destination ].setTvl( QgsExpressionUtils::NOT[tvl] );
+      return true;
+    }
+
+    case OpCode::Negate:
+    {
+      const Value &operand = registers[ instruction.left ];
+      Value &destination = registers[ instruction.destination ];
+      if ( operand.isIntegral() )
+      {
+        destination.setInteger( -operand.integer );
+      }
+      else if ( operand.kind == Value::Double )
+      {
+        destination.setDouble( -operand.number );
+      }
+      else
+      {
+        destination.setVariant( static_cast< QgsExpressionNodeUnaryOperator * >( instruction.node )->evaluateOperand( operand.toVariant(), parent ) );
+        return !parent->hasEvalError();
+      }
+      return true;
+    }
+
+    case OpCode::Binary:
+      return evaluateBinary( instruction, registers, parent, context );
+
+    case OpCode::LogicalLeft:
+    {
+      const bool isAnd = static_cast< QgsExpressionNodeBinaryOperator * >( instruction.node )->op() == QgsExpressionNodeBinaryOperator::boAnd;
+      const QgsExpressionUtils::TVL tvl = registers[ instruction.left ].toTvl( parent );
+      if ( parent->hasEvalError() )
+        return false;
+      registers[ instruction.destination ].setTvl( tvl );
+      // shortcut -- no need to evaluate right-hand side
+      if ( ( isAnd && tvl == QgsExpressionUtils::False ) || ( !isAnd && tvl == QgsExpressionUtils::True ) )
+        next = instruction.index;
+      return true;
+    }
+
+    case OpCode::LogicalRight:
+    {
+      const bool isAnd = static_cast< QgsExpressionNodeBinaryOperator * >( instruction.node )->op() == QgsExpressionNodeBinaryOperator::boAnd;
+      Value &destination = registers[ instruction.destination ];
+      const QgsExpressionUtils::TVL tvlL = destination.toTvl( parent );
+      const QgsExpressionUtils::TVL tvlR = registers[ instruction.right ].toTvl( parent );
+      if ( parent->hasEvalError() )
+        return false;
+      destination.setTvl( isAnd ? QgsExpressionUtils::AND[tvlL][tvlR] : QgsExpressionUtils::OR[tvlL][tvlR] );
+      return true;
+    }
+
+    case OpCode::CheckNullArgument:
+      if ( registers[ instruction.left ].kind == Value::Null )
+      {
+        registers[ instruction.destination ].setNull();
+        next = instruction.index;
+      }
+      return true;
+
+    case OpCode::CallFunction:
+    {
+      QgsExpressionNodeFunction *node = static_cast< QgsExpressionNodeFunction * >( instruction.node );
+      QVariantList arguments;
+      arguments.reserve( instruction.arguments.size() );
+      for ( int argument : instruction.arguments )
+        arguments.append( registers[ argument ].toVariant() );
+
+      registers[ instruction.destination ].setVariant( QgsExpression::Functions()[ node->fnIndex() ]->func( arguments, context, parent, node ) );
+      return !parent->hasEvalError();
+    }
+  }
+  return true;
+}
+
+QVariant QgsExpressionProgram::evaluate( QgsExpression *parent, const QgsExpressionContext *context ) const
+{
+  if ( isOverriddenBy( context ) )
+    return mRootNode->eval( parent, context );
+
+  QVarLengthArray< Value, 32 > registers( mRegisterTypes.size() );
+  QgsFeature feature;
+  bool featureFetched = false;
+
+  const int instructionCount = mInstructions.size();
+  int pc = 0;
+  while ( pc < instructionCount )
+  {
+    const Instruction &instruction = mInstructions.at( pc );
+    int next = pc + 1;
+
+    bool ok = true;
+    if ( instruction.opCode == OpCode::LoadField )
+    {
+      if ( !context )
+      {
+        registers[ instruction.destination ].setNull();
+      }
+      else
+      {
+        if ( !featureFetched )
+        {
+          feature = context->feature();
+          featureFetched = true;
+        }
+        ok = loadField( instruction, registers[ instruction.destination ], feature, parent, context );
+      }
+    }
+    else
+    {
+      ok = execute( instruction, registers.data(), parent, context, next );
+    }
+
+    if ( !ok )
+      return QVariant();
+
+    pc = next;
+  }
+
+  return registers[ mResultRegister ].toVariant();
+}
+
+QVariantList QgsExpressionProgram::evaluateFeatures( QgsExpression *parent, QgsExpressionContext *context, const QgsFeatureList &features ) const
+{
+  QVariantList results;
+  results.reserve( features.size() );
+
+  if ( isOverriddenBy( context ) )
+  {
+    QString lastError;
+    for ( const QgsFeature &feature : features )
+    {
+      context->setFeature( feature );
+      parent->setEvalErrorString( QString() );
+      results << mRootNode->eval( parent, context );
+      if ( parent->hasEvalError() )
+        lastError = parent->evalErrorString();
+    }
+    parent->setEvalErrorString( lastError );
+    return results;
+  }
+
+  const int rowCount = features.size();
+  const int registerCount = mRegisterTypes.size();
+  const int instructionCount = mInstructions.size();
+
+  // one frame of registers per feature, a row only takes part in the instructions
+  // it reaches: all jumps go forward, so instructions are run in order over the whole block
+  std::vector< Value > frames( static_cast< std::size_t >( rowCount ) * registerCount );
+  std::vector< int > rowPc( static_cast< std::size_t >( rowCount ), 0 );
+  const auto frame = [&frames, registerCount]( int row ) { return frames.data() + static_cast< std::size_t >( row ) * registerCount; };
+
+  int contextRow = -1;
+  const auto setContextRow = [&]( int row )
+  {
+    if ( contextRow != row )
+    {
+      context->setFeature( features.at( row ) );
+      contextRow = row;
+    }
+  };
+
+  // report the error of the last failing feature, as evaluating the features one at a time would
+  QString lastError;
+  int lastErrorRow = -1;
+  const auto failRow = [&]( int row )
+  {
+    // the row ends with a NULL result, the other rows keep going
+    if ( row > lastErrorRow )
+    {
+      lastError = parent->evalErrorString();
+      lastErrorRow = row;
+    }
+    parent->setEvalErrorString( QString() );
+    rowPc[ row ] = -1;
+  };
+
+  parent->setEvalErrorString( QString() );
+  for ( int pc = 0; pc < instructionCount; ++pc )
+  {
+    const Instruction &instruction = mInstructions.at( pc );
+    switch ( instruction.opCode )
+    {
+      case OpCode::LoadConstant:
+      {
+        const QVariant &constant = mConstants.at( instruction.index );
+        for ( int row = 0; row < rowCount; ++row )
+        {
+          if ( rowPc[ row ] != pc )
+            continue;
+          frame( row )[ instruction.destination ].setVariant( constant );
+          rowPc[ row ] = pc + 1;
+        }
+        break;
+      }
+
+      case OpCode::LoadField:
+      {
+        for ( int row = 0; row < rowCount; ++row )
+        {
+          if ( rowPc[ row ] != pc )
+            continue;
+          const QgsFeature &feature = features.at( row );
+          if ( !feature.isValid() )
+            setContextRow( row );
+          if ( loadField( instruction, frame( row )[ instruction.destination ], feature, parent, context ) )
+            rowPc[ row ] = pc + 1;
+          else
+            failRow( row );
+        }
+        break;
+      }
+
+      case OpCode::Move:
+      {
+        for ( int row = 0; row < rowCount; ++row )
+        {
+          if ( rowPc[ row ] != pc )
+            continue;
+          Value *registers = frame( row );
+          registers[ instruction.destination ] = registers[ instruction.left ];
+          rowPc[ row ] = pc + 1;
+        }
+        break;
+      }
+
+      case OpCode::Jump:
+      {
+        for ( int row = 0; row < rowCount; ++row )
+        {
+          if ( rowPc[ row ] == pc )
+            rowPc[ row ] = instruction.index;
+        }
+        break;
+      }
+
+      case OpCode::Binary:
+      {
+        for ( int row = 0; row < rowCount; ++row )
+        {
+          if ( rowPc[ row ] != pc )
+            continue;
+          Value *registers = frame( row );
+          const Value &left = registers[ instruction.left ];
+          const Value &right = registers[ instruction.right ];
+          // numeric operands are handled without touching the context
+          if ( !( left.isNumeric() && right.isNumeric() ) )
+            setContextRow( row );
+          if ( evaluateBinary( instruction, registers, parent, context ) )
+            rowPc[ row ] = pc + 1;
+          else
+            failRow( row );
+        }
+        break;
+      }
+
+      case OpCode::LoadVariable:
+      case OpCode::LoadKnownVariable:
+      {
+        // variables do not depend on the feature, they are read once for the whole block
+        QVariant value;
+        bool valueFetched = false;
+        for ( int row = 0; row < rowCount; ++row )
+        {
+          if ( rowPc[ row ] != pc )
+            continue;
+          if ( !valueFetched )
+          {
+            value = instruction.opCode == OpCode::LoadKnownVariable
+                    ? context->knownVariable( static_cast< QgsExpressionContextScope::KnownVariable >( instruction.index ) )
+                    : context->variable( mVariableNames.at( instruction.index ) );
+            valueFetched = true;
+          }
+          frame( row )[ instruction.destination ].setVariant( value );
+          rowPc[ row ] = pc + 1;
+        }
+        break;
+      }
+
+      case OpCode::Fallback:
+      case OpCode::JumpIfNotTrue:
+      case OpCode::Not:
+      case OpCode::Negate:
+      case OpCode::LogicalLeft:
+      case OpCode::LogicalRight:
+      case OpCode::CheckNullArgument:
+      case OpCode::CallFunction:
+      {
+        for ( int row = 0; row < rowCount; ++row )
+        {
+          if ( rowPc[ row ] != pc )
+            continue;
+          setContextRow( row );
+          int next = pc + 1;
+          if ( execute( instruction, frame( row ), parent, context, next ) )
+            rowPc[ row ] = next;
+          else
+            failRow( row );
+        }
+        break;
+      }
+    }
+  }
+
+  for ( int row = 0; row < rowCount; ++row )
+  {
+    results << ( rowPc[ row ] < 0 ? QVariant() : frame( row )[ mResultRegister ].toVariant() );
+  }
+
+  if ( lastErrorRow >= 0 )
+    parent->setEvalErrorString( lastError );
+  return results;
+}
+
+///@endcond
@@ -0,0 +1,176 @@
+/***************************************************************************
+                         qgsexpressionprogram_p.h
+                         ------------------------
+    begin                : October 2021
+    copyright            : (C) 2021 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSEXPRESSIONPROGRAM_PRIVATE_H
+#define QGSEXPRESSIONPROGRAM_PRIVATE_H
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#define SIP_NO_FILE
+
+#include "qgis_core.h"
+#include "qgsexpressionnodeimpl.h"
+#include "qgsfeature.h"
+#include "qgsfields.h"
+
+#include <QRegularExpression>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+#include <memory>
+
+class QgsExpression;
+class QgsExpressionContext;
+
+/**
+ * A prepared expression tree lowered to a flat register program.
+ *
+ * Literals, static nodes, field references, variables, operators, CASE conditions and
+ * eagerly evaluated built-in functions are compiled to instructions working on unboxed
+ * numeric and string registers. All other nodes are evaluated through the node interpreter,
+ * so evaluating a program always gives the same result and error as QgsExpressionNode::eval().
+ *
+ * A program keeps pointers to the nodes it was compiled from and must be discarded together
+ * with the expression tree.
+ */
+class CORE_EXPORT QgsExpressionProgram
+{
+  public:
+
+    //! Static types inferred for compiled values, values of any type may also be NULL at evaluation time
+    enum class ValueType
+    {
+      Unknown, //!< Type is only known at evaluation time
+      Null, //!< Always NULL
+      Boolean, //!< Three valued logic result
+      Integer, //!< 64 bit integer
+      Double, //!< Double precision number
+      String, //!< String
+    };
+
+    //! A register holding an unboxed or boxed value during evaluation
+    class Value;
+
+    /**
+     * Compiles the prepared expression tree starting at \a rootNode, with field indices and
+     * types resolved from \a context.
+     *
+     * Returns NULLPTR if the tree has no node which benefits from being compiled.
+     */
+    static std::unique_ptr< QgsExpressionProgram > compile( QgsExpressionNode *rootNode, const QgsExpressionContext *context );
+
+    /**
+     * Evaluates the program against a \a context, reporting errors to the \a parent expression.
+     */
+    QVariant evaluate( QgsExpression *parent, const QgsExpressionContext *context ) const;
+
+    /**
+     * Evaluates the program for each of the \a features, which are set in turn on the \a context.
+     *
+     * Each instruction is run over the whole block of features before moving to the next one, so
+     * that loads and operators are dispatched once per block rather than once per feature. A feature
+     * for which the evaluation fails gets a NULL result and the last error is reported to the \a parent
+     * expression.
+     */
+    QVariantList evaluateFeatures( QgsExpression *parent, QgsExpressionContext *context, const QgsFeatureList &features ) const;
+
+    //! Returns the static type inferred for the result of the program
+    ValueType resultType() const { return mResultType; }
+
+    //! Returns the number of instructions in the program
+    int instructionCount() const { return mInstructions.size(); }
+
+    //! Returns the number of nodes evaluated through the node interpreter
+    int fallbackCount() const { return mFallbackCount; }
+
+  private:
+
+    enum class OpCode
+    {
+      LoadConstant,
+      LoadField,
+      LoadVariable,
+      LoadKnownVariable,
+      Fallback,
+      Move,
+      Jump,
+      JumpIfNotTrue,
+      Not,
+      Negate,
+      Binary,
+      LogicalLeft,
+      LogicalRight,
+      CheckNullArgument,
+      CallFunction,
+    };
+
+    struct Instruction
+    {
+      OpCode opCode = OpCode::Fallback;
+      int destination = -1;
+      int left = -1;
+      int right = -1;
+      //! Field, constant, variable name, well known variable, regular expression index or jump target, depending on the op code
+      int index = -1;
+      QgsExpressionNode *node = nullptr;
+      QVector< int > arguments;
+    };
+
+    QgsExpressionProgram() = default;
+
+    int compileNode( QgsExpressionNode *node, const QgsExpressionContext *context );
+    int compileFallback( QgsExpressionNode *node );
+    int compileConstant( const QVariant &value );
+    int compileBinary( QgsExpressionNodeBinaryOperator *node, const QgsExpressionContext *context );
+    int compileCondition( QgsExpressionNodeCondition *node, const QgsExpressionContext *context );
+    int compileFunction( QgsExpressionNodeFunction *node, const QgsExpressionContext *context );
+    int addRegister( ValueType type );
+    int appendInstruction( const Instruction &instruction );
+
+    bool isOverriddenBy( const QgsExpressionContext *context ) const;
+    bool loadField( const Instruction &instruction, Value &destination, const QgsFeature &feature, QgsExpression *parent, const QgsExpressionContext *context ) const;
+    bool evaluateBinary( const Instruction &instruction, Value *registers, QgsExpression *parent, const QgsExpressionContext *context ) const;
+    //! Runs a single \a instruction over a frame of \a registers, returns FALSE on evaluation errors
+    bool execute( const Instruction &instruction, Value *registers, QgsExpression *parent, const QgsExpressionContext *context, int &next ) const;
+
+    QgsExpressionNode *mRootNode = nullptr;
+    //! Fields used to infer the type of field references
+    QgsFields mFields;
+    QVector< Instruction > mInstructions;
+    QVector< ValueType > mRegisterTypes;
+    QVector< QVariant > mConstants;
+    QStringList mVariableNames;
+    QVector< QRegularExpression > mRegularExpressions;
+    //! Names of functions evaluated by the program, which may be overridden by the evaluation context
+    QStringList mFunctionNames;
+    int mResultRegister = -1;
+    ValueType mResultType = ValueType::Unknown;
+    int mFallbackCount = 0;
+};
+
+/// @endcond
+
+#endif // QGSEXPRESSIONPROGRAM_PRIVATE_H
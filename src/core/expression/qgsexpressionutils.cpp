@@ -16,6 +16,9 @@
 #include "qgsexpressionutils.h"
 #include "qgsexpressionnode.h"
 #include "qgsvectorlayer.h"
+#include "qgsstringutils.h"
+
+#include <QRegularExpression>
 
 ///@cond PRIVATE
 
@@ -35,6 +38,39 @@ QgsExpressionUtils::TVL QgsExpressionUtils::OR[3][3] =
 
 QgsExpressionUtils::TVL QgsExpressionUtils::NOT[3] = { True, False, Unknown };
 
+QRegularExpression QgsExpressionUtils::likePatternToRegularExpression( const QString &pattern, bool caseSensitive )
+{
+  QString esc_regexp = QgsStringUtils::qRegExpEscape( pattern );
+  // manage escape % and _
+  if ( esc_regexp.startsWith( '%' ) )
+  {
+    esc_regexp.replace( 0, 1, QStringLiteral( ".*" ) );
+  }
+  const thread_local QRegularExpression rx1( QStringLiteral( "[^\\\\](%)" ) );
+  int pos = 0;
+  while ( ( pos = esc_regexp.indexOf( rx1, pos ) ) != -1 )
+  {
+    esc_regexp.replace( pos + 1, 1, QStringLiteral( ".*" ) );
+    pos += 1;
+  }
+  const thread_local QRegularExpression rx2( QStringLiteral( "\\\\%" ) );
+  esc_regexp.replace( rx2, QStringLiteral( "%" ) );
+  if ( esc_regexp.startsWith( '_' ) )
+  {
+    esc_regexp.replace( 0, 1, QStringLiteral( "." ) );
+  }
+  const thread_local QRegularExpression rx3( QStringLiteral( "[^\\\\](_)" ) );
+  pos = 0;
+  while ( ( pos = esc_regexp.indexOf( rx3, pos ) ) != -1 )
+  {
+    esc_regexp.replace( pos + 1, 1, '.' );
+    pos += 1;
+  }
+  esc_regexp.replace( QLatin1String( "\\\\_" ), QLatin1String( "_" ) );
+
+  return QRegularExpression( QRegularExpression::anchoredPattern( esc_regexp ), caseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption );
+}
+
 ///@endcond
 
 
@@ -30,6 +30,7 @@
 
 #include <QThread>
 #include <QLocale>
+#include <QRegularExpression>
 
 #define ENSURE_NO_EVAL_ERROR   {  if ( parent->hasEvalError() ) return QVariant(); }
 #define SET_EVAL_ERROR(x)   { parent->setEvalErrorString( x ); return QVariant(); }
@@ -175,6 +176,12 @@ class QgsExpressionUtils
       return false;
     }
 
+    /**
+     * Converts a LIKE/ILIKE \a pattern to an anchored regular expression, with \a caseSensitive
+     * set to FALSE for ILIKE patterns.
+     */
+    static QRegularExpression likePatternToRegularExpression( const QString &pattern, bool caseSensitive );
+
     static inline bool isNull( const QVariant &v )
     {
       return v.isNull();
@@ -54,13 +54,86 @@ email                : morb at ozemail dot com dot au
 #include "qgscircle.h"
 #include "qgscurve.h"
 
+#include <QMutex>
+
+#include <atomic>
+
 struct QgsGeometryPrivate
 {
   QgsGeometryPrivate(): ref( 1 ) {}
   QAtomicInt ref;
   std::unique_ptr< QgsAbstractGeometry > geometry;
+
+  //! Guards the cached GEOS engine
+  QMutex geosEngineMutex;
+  //! GEOS engine for the geometry, reused by predicates evaluated in the thread identified by geosEngineThreadId
+  std::shared_ptr< QgsGeos > geosEngine;
+  quint64 geosEngineThreadId = 0;
+  //! TRUE once the cached GEOS engine has been prepared
+  bool geosEnginePrepared = false;
+  //! FALSE once the geometry has been handed out for modification through QgsGeometry::get()
+  bool geosEngineCacheable = true;
+
+  //! Clears the cached GEOS engine, must be called whenever the geometry changes
+  void clearGeosEngine()
+  {
+    QMutexLocker locker( &geosEngineMutex );
+    geosEngine.reset();
+    geosEngineThreadId = 0;
+    geosEnginePrepared = false;
+  }
 };
 
+///@cond PRIVATE
+
+/**
+ * Returns an identifier of the calling thread. Unlike QThread addresses, identifiers
+ * are never reused by threads started after a thread finished.
+ */
+static quint64 currentGeosEngineThreadId()
+{
+  static std::atomic< quint64 > sNextThreadId( 1 );
+  static thread_local const quint64 sThreadId = sNextThreadId++;
+  return sThreadId;
+}
+
+/**
+ * Returns a GEOS engine for the geometry of \a d, which is the receiving side of a predicate.
+ *
+ * GEOS geometries are not safe to share between threads, so the cached engine is only reused
+ * by the thread which created it. Other threads get their own engine, which replaces the cached one.
+ * The engine is prepared once it is reused, so that geometries tested a single time do not pay for it.
+ */
+static std::shared_ptr< QgsGeos > cachedGeosEngine( QgsGeometryPrivate *d )
+{
+  const quint64 threadId = currentGeosEngineThreadId();
+  {
+    QMutexLocker locker( &d->geosEngineMutex );
+    if ( d->geosEngine && d->geosEngineThreadId == threadId )
+    {
+      if ( !d->geosEnginePrepared )
+      {
+        d->geosEngine->prepareGeometry();
+        d->geosEnginePrepared = true;
+      }
+      return d->geosEngine;
+    }
+  }
+
+  std::shared_ptr< QgsGeos > engine = std::make_shared< QgsGeos >( d->geometry.get() );
+
+  QMutexLocker locker( &d->geosEngineMutex );
+  if ( d->geosEngineCacheable )
+  {
+    d->geosEngine = engine;
+    d->geosEngineThreadId = threadId;
+    d->geosEnginePrepared = false;
+  }
+  return engine;
+}
+
+///@endcond
+
 QgsGeometry::QgsGeometry()
   : d( new QgsGeometryPrivate() )
 {
@@ -112,7 +185,11 @@ QgsGeometry &QgsGeometry::operator=( QgsGeometry const &other )
 void QgsGeometry::detach()
 {
   if ( d->ref <= 1 )
+  {
+    // the geometry is about to be modified in place
+    d->clearGeosEngine();
     return;
+  }
 
   std::unique_ptr< QgsAbstractGeometry > cGeom;
   if ( d->geometry )
@@ -128,6 +205,11 @@ void QgsGeometry::reset( std::unique_ptr<QgsAbstractGeometry> newGeometry )
     ( void )d->ref.deref();
     d = new QgsGeometryPrivate();
   }
+  else
+  {
+    d->clearGeosEngine();
+    d->geosEngineCacheable = true;
+  }
   d->geometry = std::move( newGeometry );
 }
 
@@ -139,6 +221,8 @@ const QgsAbstractGeometry *QgsGeometry::constGet() const
 QgsAbstractGeometry *QgsGeometry::get()
 {
   detach();
+  // the geometry may be modified at any time from now on, without the cached GEOS engine knowing
+  d->geosEngineCacheable = false;
   return d->geometry.get();
 }
 
@@ -1238,9 +1322,8 @@ bool QgsGeometry::intersects( const QgsGeometry &geometry ) const
     return false;
   }
 
-  QgsGeos geos( d->geometry.get() );
   mLastError.clear();
-  return geos.intersects( geometry.d->geometry.get(), &mLastError );
+  return cachedGeosEngine( d )->intersects( geometry.d->geometry.get(), &mLastError );
 }
 
 bool QgsGeometry::boundingBoxIntersects( const QgsRectangle &rectangle ) const
@@ -1283,9 +1366,8 @@ bool QgsGeometry::contains( const QgsGeometry &geometry ) const
     return false;
   }
 
-  QgsGeos geos( d->geometry.get() );
   mLastError.clear();
-  return geos.contains( geometry.d->geometry.get(), &mLastError );
+  return cachedGeosEngine( d )->contains( geometry.d->geometry.get(), &mLastError );
 }
 
 bool QgsGeometry::disjoint( const QgsGeometry &geometry ) const
@@ -1295,9 +1377,8 @@ bool QgsGeometry::disjoint( const QgsGeometry &geometry ) const
     return false;
   }
 
-  QgsGeos geos( d->geometry.get() );
   mLastError.clear();
-  return geos.disjoint( geometry.d->geometry.get(), &mLastError );
+  return cachedGeosEngine( d )->disjoint( geometry.d->geometry.get(), &mLastError );
 }
 
 bool QgsGeometry::equals( const QgsGeometry &geometry ) const
@@ -1326,9 +1407,8 @@ bool QgsGeometry::touches( const QgsGeometry &geometry ) const
     return false;
   }
 
-  QgsGeos geos( d->geometry.get() );
   mLastError.clear();
-  return geos.touches( geometry.d->geometry.get(), &mLastError );
+  return cachedGeosEngine( d )->touches( geometry.d->geometry.get(), &mLastError );
 }
 
 bool QgsGeometry::overlaps( const QgsGeometry &geometry ) const
@@ -1338,9 +1418,8 @@ bool QgsGeometry::overlaps( const QgsGeometry &geometry ) const
     return false;
   }
 
-  QgsGeos geos( d->geometry.get() );
   mLastError.clear();
-  return geos.overlaps( geometry.d->geometry.get(), &mLastError );
+  return cachedGeosEngine( d )->overlaps( geometry.d->geometry.get(), &mLastError );
 }
 
 bool QgsGeometry::within( const QgsGeometry &geometry ) const
@@ -1350,9 +1429,8 @@ bool QgsGeometry::within( const QgsGeometry &geometry ) const
     return false;
   }
 
-  QgsGeos geos( d->geometry.get() );
   mLastError.clear();
-  return geos.within( geometry.d->geometry.get(), &mLastError );
+  return cachedGeosEngine( d )->within( geometry.d->geometry.get(), &mLastError );
 }
 
 bool QgsGeometry::crosses( const QgsGeometry &geometry ) const
@@ -1362,9 +1440,8 @@ bool QgsGeometry::crosses( const QgsGeometry &geometry ) const
     return false;
   }
 
-  QgsGeos geos( d->geometry.get() );
   mLastError.clear();
-  return geos.crosses( geometry.d->geometry.get(), &mLastError );
+  return cachedGeosEngine( d )->crosses( geometry.d->geometry.get(), &mLastError );
 }
 
 QString QgsGeometry::asWkt( int precision ) const
@@ -1975,6 +2052,8 @@ QgsAbstractGeometry::part_iterator QgsGeometry::parts_begin()
     return QgsAbstractGeometry::part_iterator();
 
   detach();
+  // parts may be modified through the iterator, without the cached GEOS engine knowing
+  d->geosEngineCacheable = false;
   return d->geometry->parts_begin();
 }
 
@@ -2005,6 +2084,8 @@ QgsGeometryPartIterator QgsGeometry::parts()
     return QgsGeometryPartIterator();
 
   detach();
+  // parts may be modified through the iterator, without the cached GEOS engine knowing
+  d->geosEngineCacheable = false;
   return QgsGeometryPartIterator( d->geometry.get() );
 }
 
@@ -1321,6 +1321,10 @@ std::unique_ptr<QgsLineString> QgsGeos::sequenceToLinestring( const GEOSGeometry
   QVector< double > mOut;
   if ( hasM )
     mOut.resize( nPoints );
+#if GEOS_VERSION_MAJOR>3 || ( GEOS_VERSION_MAJOR == 3 && GEOS_VERSION_MINOR>=10 )
+  // copy the whole sequence straight into the contiguous coordinate arrays
+  GEOSCoordSeq_copyToArrays_r( geosinit()->ctxt, cs, xOut.data(), yOut.data(), hasZ ? zOut.data() : nullptr, hasM ? mOut.data() : nullptr );
+#else
   double *x = xOut.data();
   double *y = yOut.data();
   double *z = zOut.data();
@@ -1345,6 +1349,7 @@ std::unique_ptr<QgsLineString> QgsGeos::sequenceToLinestring( const GEOSGeometry
       GEOSCoordSeq_getOrdinate_r( geosinit()->ctxt, cs, i, 3, m++ );
     }
   }
+#endif
   std::unique_ptr< QgsLineString > line( new QgsLineString( xOut, yOut, zOut, mOut ) );
   return line;
 }
@@ -1555,6 +1560,16 @@ bool QgsGeos::relation( const QgsAbstractGeometry *geom, Relation r, QString *er
     return false;
   }
 
+  return relation( geosGeom.get(), r, errorMsg );
+}
+
+bool QgsGeos::relation( const GEOSGeometry *geosGeom, Relation r, QString *errorMsg ) const
+{
+  if ( !mGeos || !geosGeom )
+  {
+    return false;
+  }
+
   bool result = false;
   try
   {
@@ -1563,25 +1578,25 @@ bool QgsGeos::relation( const QgsAbstractGeometry *geom, Relation r, QString *er
       switch ( r )
       {
         case RelationIntersects:
-          result = ( GEOSPreparedIntersects_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom.get() ) == 1 );
+          result = ( GEOSPreparedIntersects_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom ) == 1 );
           break;
         case RelationTouches:
-          result = ( GEOSPreparedTouches_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom.get() ) == 1 );
+          result = ( GEOSPreparedTouches_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom ) == 1 );
           break;
         case RelationCrosses:
-          result = ( GEOSPreparedCrosses_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom.get() ) == 1 );
+          result = ( GEOSPreparedCrosses_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom ) == 1 );
           break;
         case RelationWithin:
-          result = ( GEOSPreparedWithin_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom.get() ) == 1 );
+          result = ( GEOSPreparedWithin_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom ) == 1 );
           break;
         case RelationContains:
-          result = ( GEOSPreparedContains_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom.get() ) == 1 );
+          result = ( GEOSPreparedContains_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom ) == 1 );
           break;
         case RelationDisjoint:
-          result = ( GEOSPreparedDisjoint_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom.get() ) == 1 );
+          result = ( GEOSPreparedDisjoint_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom ) == 1 );
           break;
         case RelationOverlaps:
-          result = ( GEOSPreparedOverlaps_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom.get() ) == 1 );
+          result = ( GEOSPreparedOverlaps_r( geosinit()->ctxt, mGeosPrepared.get(), geosGeom ) == 1 );
           break;
       }
       return result;
@@ -1590,25 +1605,25 @@ bool QgsGeos::relation( const QgsAbstractGeometry *geom, Relation r, QString *er
     switch ( r )
     {
       case RelationIntersects:
-        result = ( GEOSIntersects_r( geosinit()->ctxt, mGeos.get(), geosGeom.get() ) == 1 );
+        result = ( GEOSIntersects_r( geosinit()->ctxt, mGeos.get(), geosGeom ) == 1 );
         break;
       case RelationTouches:
-        result = ( GEOSTouches_r( geosinit()->ctxt, mGeos.get(), geosGeom.get() ) == 1 );
+        result = ( GEOSTouches_r( geosinit()->ctxt, mGeos.get(), geosGeom ) == 1 );
         break;
       case RelationCrosses:
-        result = ( GEOSCrosses_r( geosinit()->ctxt, mGeos.get(), geosGeom.get() ) == 1 );
+        result = ( GEOSCrosses_r( geosinit()->ctxt, mGeos.get(), geosGeom ) == 1 );
         break;
       case RelationWithin:
-        result = ( GEOSWithin_r( geosinit()->ctxt, mGeos.get(), geosGeom.get() ) == 1 );
+        result = ( GEOSWithin_r( geosinit()->ctxt, mGeos.get(), geosGeom ) == 1 );
         break;
       case RelationContains:
-        result = ( GEOSContains_r( geosinit()->ctxt, mGeos.get(), geosGeom.get() ) == 1 );
+        result = ( GEOSContains_r( geosinit()->ctxt, mGeos.get(), geosGeom ) == 1 );
         break;
       case RelationDisjoint:
-        result = ( GEOSDisjoint_r( geosinit()->ctxt, mGeos.get(), geosGeom.get() ) == 1 );
+        result = ( GEOSDisjoint_r( geosinit()->ctxt, mGeos.get(), geosGeom ) == 1 );
         break;
       case RelationOverlaps:
-        result = ( GEOSOverlaps_r( geosinit()->ctxt, mGeos.get(), geosGeom.get() ) == 1 );
+        result = ( GEOSOverlaps_r( geosinit()->ctxt, mGeos.get(), geosGeom ) == 1 );
         break;
     }
   }
@@ -1915,6 +1930,26 @@ GEOSCoordSequence *QgsGeos::createCoordinateSequence( const QgsCurve *curve, dou
   }
 
   GEOSCoordSequence *coordSeq = nullptr;
+#if GEOS_VERSION_MAJOR>3 || ( GEOS_VERSION_MAJOR == 3 && GEOS_VERSION_MINOR>=10 )
+  if ( precision <= 0. && numOutPoints == numPoints )
+  {
+    // no snapping and no closing point required: build the sequence straight from the contiguous coordinate arrays
+    try
+    {
+      coordSeq = GEOSCoordSeq_copyFromArrays_r( geosinit()->ctxt, line->xData(), line->yData(),
+                 hasZ ? line->zData() : nullptr, hasM ? line->mData() : nullptr, static_cast< unsigned int >( numPoints ) );
+      if ( !coordSeq )
+      {
+        QgsDebugMsg( QStringLiteral( "GEOS Exception: Could not create coordinate sequence for %1 points in %2 dimensions" ).arg( numPoints ).arg( coordDims ) );
+        return nullptr;
+      }
+    }
+    CATCH_GEOS( nullptr )
+
+    return coordSeq;
+  }
+#endif
+
   try
   {
     coordSeq = GEOSCoordSeq_create_r( geosinit()->ctxt, numOutPoints, coordDims );
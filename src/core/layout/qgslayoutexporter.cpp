@@ -29,12 +29,20 @@
 #include "qgslinestring.h"
 #include "qgsmessagelog.h"
 #include "qgslabelingresults.h"
+#include "qgsprojectmetadata.h"
 #include <QImageWriter>
 #include <QSize>
 #include <QSvgGenerator>
 #include <QBuffer>
 #include <QTimeZone>
 #include <QTextStream>
+#include <QMutex>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+
+#include <array>
+#include <atomic>
 
 #include "gdal.h"
 #include "cpl_conv.h"
@@ -437,21 +445,22 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToImage( const QString
       return MemoryError;
     }
 
-    if ( !saveImage( image, outputFilePath, pageDetails.extension, settings.exportMetadata ? mLayout->project() : nullptr ) )
-    {
-      mErrorFileName = outputFilePath;
-      return FileError;
-    }
+    // everything needed from the layout is collected first, the files may be written by another thread
+    const QString imageFormat = pageDetails.extension;
+    const bool exportMetadata = settings.exportMetadata;
+    const QgsProjectMetadata metadata = exportMetadata ? mLayout->project()->metadata() : QgsProjectMetadata();
 
     const bool shouldGeoreference = ( page == worldFilePageNo );
+    std::function< void() > georeference;
+    QString worldFileName;
+    double a = 0, b = 0, c = 0, d = 0, e = 0, f = 0;
     if ( shouldGeoreference )
     {
-      georeferenceOutputPrivate( outputFilePath, nullptr, bounds, settings.dpi, shouldGeoreference );
+      georeference = georeferenceOutputWriter( outputFilePath, nullptr, bounds, settings.dpi, shouldGeoreference );
 
       if ( settings.generateWorldFile )
       {
         // should generate world file for this page
-        double a, b, c, d, e, f;
         if ( bounds.isValid() )
           computeWorldFileParameters( bounds, a, b, c, d, e, f, settings.dpi );
         else
@@ -460,22 +469,120 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToImage( const QString
         QFileInfo fi( outputFilePath );
         // build the world file name
         QString outputSuffix = fi.suffix();
-        QString worldFileName = fi.absolutePath() + '/' + fi.completeBaseName() + '.'
-                                + outputSuffix.at( 0 ) + outputSuffix.at( fi.suffix().size() - 1 ) + 'w';
-
-        writeWorldFile( worldFileName, a, b, c, d, e, f );
+        worldFileName = fi.absolutePath() + '/' + fi.completeBaseName() + '.'
+                        + outputSuffix.at( 0 ) + outputSuffix.at( fi.suffix().size() - 1 ) + 'w';
       }
     }
 
+    const auto write = [ = ]
+    {
+      if ( !saveImage( image, outputFilePath, imageFormat, exportMetadata ? &metadata : nullptr ) )
+        return false;
+
+      if ( georeference )
+        georeference();
+      if ( !worldFileName.isEmpty() )
+        writeWorldFile( worldFileName, a, b, c, d, e, f );
+      return true;
+    };
+
+    if ( mWriteHandler )
+    {
+      mWriteHandler( outputFilePath, write );
+    }
+    else if ( !write() )
+    {
+      mErrorFileName = outputFilePath;
+      return FileError;
+    }
   }
   captureLabelingResults();
   return Success;
 }
 
+///@cond PRIVATE
+
+/**
+ * Writes the files of the pages exported from an iterator on a dedicated thread pool, while the
+ * pages are rendered one after another by the thread of the layout.
+ */
+class LayoutIteratorFileWriters
+{
+  public:
+
+    explicit LayoutIteratorFileWriters( int workerCount )
+      : mPendingSlots( 2 * workerCount )
+    {
+      mThreadPool.setMaxThreadCount( workerCount );
+    }
+
+    ~LayoutIteratorFileWriters()
+    {
+      mThreadPool.waitForDone();
+    }
+
+    LayoutIteratorFileWriters( const LayoutIteratorFileWriters &other ) = delete;
+    LayoutIteratorFileWriters &operator=( const LayoutIteratorFileWriters &other ) = delete;
+
+    /**
+     * Sets the exporter of the current page to hand its file writes over to the pool. Rendering
+     * blocks while too many rendered pages wait for their files to be written.
+     */
+    void attach( QgsLayoutExporter &exporter )
+    {
+      exporter.mWriteHandler = [this]( const QString & filePath, const std::function< bool() > &write )
+      {
+        mPendingSlots.acquire();
+        QtConcurrent::run( &mThreadPool, [this, filePath, write]
+        {
+          if ( !mFailed && !write() )
+          {
+            QMutexLocker locker( &mMutex );
+            if ( !mFailed )
+            {
+              mFailedFilePath = filePath;
+              mFailed = true;
+            }
+          }
+          mPendingSlots.release();
+        } );
+      };
+    }
+
+    //! Returns TRUE if a file could not be written
+    bool hasFailed() const { return mFailed; }
+
+    /**
+     * Waits for all the files to be written. Returns FALSE and sets \a failedFilePath if a file
+     * could not be written.
+     */
+    bool waitForDone( QString &failedFilePath )
+    {
+      mThreadPool.waitForDone();
+      failedFilePath = mFailedFilePath;
+      return !mFailed;
+    }
+
+  private:
+
+    QThreadPool mThreadPool;
+    QSemaphore mPendingSlots;
+    QMutex mMutex;
+    QString mFailedFilePath;
+    std::atomic< bool > mFailed{ false };
+};
+
+///@endcond PRIVATE
+
 QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToImage( QgsAbstractLayoutIterator *iterator, const QString &baseFilePath, const QString &extension, const QgsLayoutExporter::ImageExportSettings &settings, QString &error, QgsFeedback *feedback )
 {
   error.clear();
 
+  // layouts are not thread safe, the pages are rendered by this thread and only the files are written by other threads
+  std::unique_ptr< LayoutIteratorFileWriters > writers;
+  if ( settings.workerCount != 1 )
+    writers = std::make_unique< LayoutIteratorFileWriters >( settings.workerCount > 0 ? settings.workerCount : QThreadPool::globalInstance()->maxThreadCount() );
+
   if ( !iterator->beginRender() )
     return IteratorError;
 
@@ -499,8 +606,15 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToImage( QgsAbstractLay
     }
 
     QgsLayoutExporter exporter( iterator->layout() );
+    if ( writers )
+      writers->attach( exporter );
     QString filePath = iterator->filePath( baseFilePath, extension );
     ExportResult result = exporter.exportToImage( filePath, settings );
+    if ( result == Success && writers && writers->hasFailed() )
+    {
+      result = FileError;
+      writers->waitForDone( filePath );
+    }
     if ( result != Success )
     {
       if ( result == FileError )
@@ -511,6 +625,14 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToImage( QgsAbstractLay
     i++;
   }
 
+  QString failedFilePath;
+  if ( writers && !writers->waitForDone( failedFilePath ) )
+  {
+    error = QObject::tr( "Cannot write to %1. This file may be open in another application or may be an invalid path." ).arg( QDir::toNativeSeparators( failedFilePath ) );
+    iterator->endRender();
+    return FileError;
+  }
+
   if ( feedback )
   {
     feedback->setProgress( 100 );
@@ -703,7 +825,19 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToPdf( const QString &f
     bool shouldAppendGeoreference = settings.appendGeoreference && mLayout && mLayout->referenceMap() && mLayout->referenceMap()->page() == 0;
     if ( settings.appendGeoreference || settings.exportMetadata )
     {
-      georeferenceOutputPrivate( filePath, nullptr, QRectF(), settings.dpi, shouldAppendGeoreference, settings.exportMetadata );
+      const std::function< void() > georeference = georeferenceOutputWriter( filePath, nullptr, QRectF(), settings.dpi, shouldAppendGeoreference, settings.exportMetadata );
+      if ( mWriteHandler )
+      {
+        mWriteHandler( filePath, [georeference]
+        {
+          georeference();
+          return true;
+        } );
+      }
+      else
+      {
+        georeference();
+      }
     }
   }
   captureLabelingResults();
@@ -807,6 +941,11 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToPdfs( QgsAbstractLayo
 {
   error.clear();
 
+  // layouts are not thread safe, the pages are rendered by this thread and only the files are written by other threads
+  std::unique_ptr< LayoutIteratorFileWriters > writers;
+  if ( settings.workerCount != 1 )
+    writers = std::make_unique< LayoutIteratorFileWriters >( settings.workerCount > 0 ? settings.workerCount : QThreadPool::globalInstance()->maxThreadCount() );
+
   if ( !iterator->beginRender() )
     return IteratorError;
 
@@ -832,7 +971,14 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToPdfs( QgsAbstractLayo
     QString filePath = iterator->filePath( baseFilePath, QStringLiteral( "pdf" ) );
 
     QgsLayoutExporter exporter( iterator->layout() );
+    if ( writers )
+      writers->attach( exporter );
     ExportResult result = exporter.exportToPdf( filePath, settings );
+    if ( result == Success && writers && writers->hasFailed() )
+    {
+      result = FileError;
+      writers->waitForDone( filePath );
+    }
     if ( result != Success )
     {
       if ( result == FileError )
@@ -843,6 +989,14 @@ QgsLayoutExporter::ExportResult QgsLayoutExporter::exportToPdfs( QgsAbstractLayo
     i++;
   }
 
+  QString failedFilePath;
+  if ( writers && !writers->waitForDone( failedFilePath ) )
+  {
+    error = QObject::tr( "Cannot write to %1. This file may be open in another application or may be an invalid path." ).arg( QDir::toNativeSeparators( failedFilePath ) );
+    iterator->endRender();
+    return FileError;
+  }
+
   if ( feedback )
   {
     feedback->setProgress( 100 );
@@ -1555,7 +1709,7 @@ std::unique_ptr<double[]> QgsLayoutExporter::computeGeoTransform( const QgsLayou
   return t;
 }
 
-void QgsLayoutExporter::writeWorldFile( const QString &worldFileName, double a, double b, double c, double d, double e, double f ) const
+void QgsLayoutExporter::writeWorldFile( const QString &worldFileName, double a, double b, double c, double d, double e, double f )
 {
   QFile worldFile( worldFileName );
   if ( !worldFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
@@ -1584,70 +1738,93 @@ bool QgsLayoutExporter::georeferenceOutputPrivate( const QString &file, QgsLayou
   if ( !mLayout )
     return false;
 
+  georeferenceOutputWriter( file, map, exportRegion, dpi, includeGeoreference, includeMetadata )();
+  return true;
+}
+
+std::function< void() > QgsLayoutExporter::georeferenceOutputWriter( const QString &file, QgsLayoutItemMap *map, const QRectF &exportRegion, double dpi, bool includeGeoreference, bool includeMetadata ) const
+{
+  if ( !mLayout )
+    return [] {};
+
   if ( !map && includeGeoreference )
     map = mLayout->referenceMap();
 
-  std::unique_ptr<double[]> t;
+  bool hasGeoTransform = false;
+  std::array< double, 6 > geoTransform;
+  QByteArray projection;
 
   if ( map && includeGeoreference )
   {
     if ( dpi < 0 )
       dpi = mLayout->renderContext().dpi();
 
-    t = computeGeoTransform( map, exportRegion, dpi );
+    if ( const std::unique_ptr<double[]> t = computeGeoTransform( map, exportRegion, dpi ) )
+    {
+      std::copy( t.get(), t.get() + 6, geoTransform.begin() );
+      hasGeoTransform = true;
+      projection = map->crs().toWkt( QgsCoordinateReferenceSystem::WKT_PREFERRED_GDAL ).toLocal8Bit();
+    }
   }
 
-  // important - we need to manually specify the DPI in advance, as GDAL will otherwise
-  // assume a DPI of 150
-  CPLSetConfigOption( "GDAL_PDF_DPI", QString::number( dpi ).toLocal8Bit().constData() );
-  gdal::dataset_unique_ptr outputDS( GDALOpen( file.toLocal8Bit().constData(), GA_Update ) );
-  if ( outputDS )
+  QList< QPair< QByteArray, QByteArray > > metadataItems;
+  if ( includeMetadata )
   {
-    if ( t )
-      GDALSetGeoTransform( outputDS.get(), t.get() );
-
-    if ( includeMetadata )
+    QString creationDateString;
+    const QDateTime creationDateTime = mLayout->project()->metadata().creationDateTime();
+    if ( creationDateTime.isValid() )
     {
-      QString creationDateString;
-      const QDateTime creationDateTime = mLayout->project()->metadata().creationDateTime();
-      if ( creationDateTime.isValid() )
-      {
-        creationDateString = QStringLiteral( "D:%1" ).arg( mLayout->project()->metadata().creationDateTime().toString( QStringLiteral( "yyyyMMddHHmmss" ) ) );
-        if ( creationDateTime.timeZone().isValid() )
-        {
-          int offsetFromUtc = creationDateTime.timeZone().offsetFromUtc( creationDateTime );
-          creationDateString += ( offsetFromUtc >= 0 ) ? '+' : '-';
-          offsetFromUtc = std::abs( offsetFromUtc );
-          int offsetHours = offsetFromUtc / 3600;
-          int offsetMins = ( offsetFromUtc % 3600 ) / 60;
-          creationDateString += QStringLiteral( "%1'%2'" ).arg( offsetHours ).arg( offsetMins );
-        }
-      }
-      GDALSetMetadataItem( outputDS.get(), "CREATION_DATE", creationDateString.toUtf8().constData(), nullptr );
-
-      GDALSetMetadataItem( outputDS.get(), "AUTHOR", mLayout->project()->metadata().author().toUtf8().constData(), nullptr );
-      const QString creator = QStringLiteral( "QGIS %1" ).arg( Qgis::version() );
-      GDALSetMetadataItem( outputDS.get(), "CREATOR", creator.toUtf8().constData(), nullptr );
-      GDALSetMetadataItem( outputDS.get(), "PRODUCER", creator.toUtf8().constData(), nullptr );
-      GDALSetMetadataItem( outputDS.get(), "SUBJECT", mLayout->project()->metadata().abstract().toUtf8().constData(), nullptr );
-      GDALSetMetadataItem( outputDS.get(), "TITLE", mLayout->project()->metadata().title().toUtf8().constData(), nullptr );
-
-      const QgsAbstractMetadataBase::KeywordMap keywords = mLayout->project()->metadata().keywords();
-      QStringList allKeywords;
-      for ( auto it = keywords.constBegin(); it != keywords.constEnd(); ++it )
+      creationDateString = QStringLiteral( "D:%1" ).arg( mLayout->project()->metadata().creationDateTime().toString( QStringLiteral( "yyyyMMddHHmmss" ) ) );
+      if ( creationDateTime.timeZone().isValid() )
       {
-        allKeywords.append( QStringLiteral( "%1: %2" ).arg( it.key(), it.value().join( ',' ) ) );
+        int offsetFromUtc = creationDateTime.timeZone().offsetFromUtc( creationDateTime );
+        creationDateString += ( offsetFromUtc >= 0 ) ? '+' : '-';
+        offsetFromUtc = std::abs( offsetFromUtc );
+        int offsetHours = offsetFromUtc / 3600;
+        int offsetMins = ( offsetFromUtc % 3600 ) / 60;
+        creationDateString += QStringLiteral( "%1'%2'" ).arg( offsetHours ).arg( offsetMins );
       }
-      const QString keywordString = allKeywords.join( ';' );
-      GDALSetMetadataItem( outputDS.get(), "KEYWORDS", keywordString.toUtf8().constData(), nullptr );
     }
+    metadataItems << qMakePair( QByteArray( "CREATION_DATE" ), creationDateString.toUtf8() );
 
-    if ( t )
-      GDALSetProjection( outputDS.get(), map->crs().toWkt( QgsCoordinateReferenceSystem::WKT_PREFERRED_GDAL ).toLocal8Bit().constData() );
+    metadataItems << qMakePair( QByteArray( "AUTHOR" ), mLayout->project()->metadata().author().toUtf8() );
+    const QString creator = QStringLiteral( "QGIS %1" ).arg( Qgis::version() );
+    metadataItems << qMakePair( QByteArray( "CREATOR" ), creator.toUtf8() );
+    metadataItems << qMakePair( QByteArray( "PRODUCER" ), creator.toUtf8() );
+    metadataItems << qMakePair( QByteArray( "SUBJECT" ), mLayout->project()->metadata().abstract().toUtf8() );
+    metadataItems << qMakePair( QByteArray( "TITLE" ), mLayout->project()->metadata().title().toUtf8() );
+
+    const QgsAbstractMetadataBase::KeywordMap keywords = mLayout->project()->metadata().keywords();
+    QStringList allKeywords;
+    for ( auto it = keywords.constBegin(); it != keywords.constEnd(); ++it )
+    {
+      allKeywords.append( QStringLiteral( "%1: %2" ).arg( it.key(), it.value().join( ',' ) ) );
+    }
+    const QString keywordString = allKeywords.join( ';' );
+    metadataItems << qMakePair( QByteArray( "KEYWORDS" ), keywordString.toUtf8() );
   }
-  CPLSetConfigOption( "GDAL_PDF_DPI", nullptr );
 
-  return true;
+  const QByteArray dpiString = QString::number( dpi ).toLocal8Bit();
+  return [file, hasGeoTransform, geoTransform, projection, metadataItems, dpiString]
+  {
+    // important - we need to manually specify the DPI in advance, as GDAL will otherwise
+    // assume a DPI of 150. The option is only set for this thread, as files may be written concurrently
+    CPLSetThreadLocalConfigOption( "GDAL_PDF_DPI", dpiString.constData() );
+    gdal::dataset_unique_ptr outputDS( GDALOpen( file.toLocal8Bit().constData(), GA_Update ) );
+    if ( outputDS )
+    {
+      std::array< double, 6 > transform = geoTransform;
+      if ( hasGeoTransform )
+        GDALSetGeoTransform( outputDS.get(), transform.data() );
+
+      for ( const QPair< QByteArray, QByteArray > &item : metadataItems )
+        GDALSetMetadataItem( outputDS.get(), item.first.constData(), item.second.constData(), nullptr );
+
+      if ( hasGeoTransform )
+        GDALSetProjection( outputDS.get(), projection.constData() );
+    }
+    CPLSetThreadLocalConfigOption( "GDAL_PDF_DPI", nullptr );
+  };
 }
 
 QString nameForLayerWithItems( const QList< QGraphicsItem * > &items, unsigned int layerId )
@@ -2049,24 +2226,24 @@ void QgsLayoutExporter::captureLabelingResults()
   }
 }
 
-bool QgsLayoutExporter::saveImage( const QImage &image, const QString &imageFilename, const QString &imageFormat, QgsProject *projectForMetadata )
+bool QgsLayoutExporter::saveImage( const QImage &image, const QString &imageFilename, const QString &imageFormat, const QgsProjectMetadata *metadata )
 {
   QImageWriter w( imageFilename, imageFormat.toLocal8Bit().constData() );
   if ( imageFormat.compare( QLatin1String( "tiff" ), Qt::CaseInsensitive ) == 0 || imageFormat.compare( QLatin1String( "tif" ), Qt::CaseInsensitive ) == 0 )
   {
     w.setCompression( 1 ); //use LZW compression
   }
-  if ( projectForMetadata )
+  if ( metadata )
   {
-    w.setText( QStringLiteral( "Author" ), projectForMetadata->metadata().author() );
+    w.setText( QStringLiteral( "Author" ), metadata->author() );
     const QString creator = QStringLiteral( "QGIS %1" ).arg( Qgis::version() );
     w.setText( QStringLiteral( "Creator" ), creator );
     w.setText( QStringLiteral( "Producer" ), creator );
-    w.setText( QStringLiteral( "Subject" ), projectForMetadata->metadata().abstract() );
-    w.setText( QStringLiteral( "Created" ), projectForMetadata->metadata().creationDateTime().toString( Qt::ISODate ) );
-    w.setText( QStringLiteral( "Title" ), projectForMetadata->metadata().title() );
+    w.setText( QStringLiteral( "Subject" ), metadata->abstract() );
+    w.setText( QStringLiteral( "Created" ), metadata->creationDateTime().toString( Qt::ISODate ) );
+    w.setText( QStringLiteral( "Title" ), metadata->title() );
 
-    const QgsAbstractMetadataBase::KeywordMap keywords = projectForMetadata->metadata().keywords();
+    const QgsAbstractMetadataBase::KeywordMap keywords = metadata->keywords();
     QStringList allKeywords;
     for ( auto it = keywords.constBegin(); it != keywords.constEnd(); ++it )
     {
@@ -35,6 +35,7 @@ class QgsLayoutItemMap;
 class QgsAbstractLayoutIterator;
 class QgsFeedback;
 class QgsLabelingResults;
+class QgsProjectMetadata;
 
 /**
  * \ingroup core
@@ -218,6 +219,18 @@ class CORE_EXPORT QgsLayoutExporter
        */
       QVector<qreal> predefinedMapScales;
 
+      /**
+       * Number of threads for concurrent file writing in the iterator export methods.
+       * Only the encoding and writing of the image files is concurrent: layouts are not
+       * thread safe, so the pages are still rendered one after another by the thread of
+       * the layout, while the previous pages are written. A value of 1 renders and writes
+       * each page before the next one, 0 uses the maximum thread count of the global
+       * thread pool.
+       *
+       * \since QGIS 3.22
+       */
+      int workerCount = 1;
+
     };
 
     /**
@@ -384,6 +397,18 @@ class CORE_EXPORT QgsLayoutExporter
        */
       QVector<qreal> predefinedMapScales;
 
+      /**
+       * Number of threads for concurrent file writing in exportToPdfs(). Only the writing
+       * of the georeferencing and metadata of the PDF files is concurrent: layouts are not
+       * thread safe, so the pages are still rendered and encoded one after another by the
+       * thread of the layout. A value of 1 completes each file before the next one, 0 uses
+       * the maximum thread count of the global thread pool. Exports to a single PDF file
+       * are always sequential.
+       *
+       * \since QGIS 3.22
+       */
+      int workerCount = 1;
+
     };
 
     /**
@@ -694,10 +719,16 @@ class CORE_EXPORT QgsLayoutExporter
      */
     static int firstPageToBeExported( QgsLayout *layout );
 
+    /**
+     * Called with the file writes of the exported pages instead of running them, when set.
+     * The writes do not access the layout and may run in other threads.
+     */
+    std::function< void( const QString &filePath, const std::function< bool() > &write ) > mWriteHandler;
+
     /**
      * Saves an image to a file, possibly using format specific options (e.g. LZW compression for tiff)
     */
-    static bool saveImage( const QImage &image, const QString &imageFilename, const QString &imageFormat, QgsProject *projectForMetadata );
+    static bool saveImage( const QImage &image, const QString &imageFilename, const QString &imageFormat, const QgsProjectMetadata *metadata );
 
     /**
      * Computes a GDAL style geotransform for georeferencing a layout.
@@ -715,7 +746,7 @@ class CORE_EXPORT QgsLayoutExporter
     std::unique_ptr<double[]> computeGeoTransform( const QgsLayoutItemMap *referenceMap = nullptr, const QRectF &exportRegion = QRectF(), double dpi = -1 ) const;
 
     //! Write a world file
-    void writeWorldFile( const QString &fileName, double a, double b, double c, double d, double e, double f ) const;
+    static void writeWorldFile( const QString &fileName, double a, double b, double c, double d, double e, double f );
 
     /**
      * Prepare a \a printer for printing a layout as a PDF, to the destination \a filePath.
@@ -750,11 +781,19 @@ class CORE_EXPORT QgsLayoutExporter
     bool georeferenceOutputPrivate( const QString &file, QgsLayoutItemMap *referenceMap = nullptr,
                                     const QRectF &exportRegion = QRectF(), double dpi = -1, bool includeGeoreference = true, bool includeMetadata = false ) const;
 
+    /**
+     * Returns a function which writes the georeferencing and metadata of georeferenceOutputPrivate() to \a file.
+     * The function does not access the layout, so it may run in another thread.
+     */
+    std::function< void() > georeferenceOutputWriter( const QString &file, QgsLayoutItemMap *referenceMap = nullptr,
+        const QRectF &exportRegion = QRectF(), double dpi = -1, bool includeGeoreference = true, bool includeMetadata = false ) const;
+
     ExportResult handleLayeredExport( const QList<QGraphicsItem *> &items, const std::function<QgsLayoutExporter::ExportResult( unsigned int layerId, const QgsLayoutItem::ExportLayerDetail &layerDetails )> &exportFunc );
 
     static QgsVectorSimplifyMethod createExportSimplifyMethod();
     friend class TestQgsLayout;
     friend class TestQgsLayoutExporter;
+    friend class LayoutIteratorFileWriters;
 
 };
 
@@ -301,12 +301,13 @@ void QgsMapRendererCustomPainterJob::doRender()
       mPainter->setCompositionMode( job.blendMode );
     }
 
-    if ( !job.cached )
+    // cached jobs only run their renderer when they must register features for labeling
+    if ( !job.cached || job.renderer )
     {
       QElapsedTimer layerTime;
       layerTime.start();
 
-      if ( job.img )
+      if ( job.img && !job.cached )
       {
         job.img->fill( 0 );
         job.imageInitialized = true;
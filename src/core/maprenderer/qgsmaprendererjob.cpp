@@ -113,7 +113,7 @@ bool LayerRenderJob::imageCanBeComposed() const
 {
   if ( imageInitialized )
   {
-    if ( renderer )
+    if ( renderer && !cached )
     {
       return renderer->isReadyToCompose();
     }
@@ -400,6 +400,26 @@ std::vector<LayerRenderJob> QgsMapRendererJob::prepareJobs( QPainter *painter, Q
 
   bool requiresLabelRedraw = !( mCache && mCache->hasCacheImage( LABEL_CACHE_ID ) );
 
+  // when labels must be redrawn, layers with an up to date cached image only need to register
+  // their features with the labeling engine. This is not possible when selective masking is used,
+  // since masked layers are redrawn in a second pass from their first pass image.
+  bool canRegisterLabelsFromCachedLayers = mCache && labelingEngine2 && requiresLabelRedraw;
+  if ( canRegisterLabelsFromCachedLayers )
+  {
+    const QList<QgsMapLayer *> layers = mSettings.layers();
+    for ( QgsMapLayer *ml : layers )
+    {
+      if ( QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( ml ) )
+      {
+        if ( !QgsVectorLayerUtils::labelMasks( vl ).isEmpty() || !QgsVectorLayerUtils::symbolLayerMasks( vl ).isEmpty() )
+        {
+          canRegisterLabelsFromCachedLayers = false;
+          break;
+        }
+      }
+    }
+  }
+
   while ( li.hasPrevious() )
   {
     QgsMapLayer *ml = li.previous();
@@ -458,13 +478,22 @@ std::vector<LayerRenderJob> QgsMapRendererJob::prepareJobs( QPainter *painter, Q
 
     // Force render of layers that are being edited
     // or if there's a labeling engine that needs the layer to register features
+    bool registerLabelsOnly = false;
     if ( mCache )
     {
       const bool requiresLabeling = ( labelingEngine2 && QgsPalLabeling::staticWillUseLayer( ml ) ) && requiresLabelRedraw;
-      if ( ( vl && vl->isEditable() ) || requiresLabeling )
+      if ( vl && vl->isEditable() )
       {
         mCache->clearCacheImage( ml->id() );
       }
+      else if ( requiresLabeling )
+      {
+        // the layer itself has not changed, so keep its cached image and only register its labels
+        if ( vl && canRegisterLabelsFromCachedLayers && mCache->hasCacheImage( ml->id() ) )
+          registerLabelsOnly = true;
+        else
+          mCache->clearCacheImage( ml->id() );
+      }
     }
 
     layerJobs.emplace_back( LayerRenderJob() );
@@ -504,6 +533,13 @@ std::vector<LayerRenderJob> QgsMapRendererJob::prepareJobs( QPainter *painter, Q
       job.img->setDevicePixelRatio( static_cast<qreal>( mSettings.devicePixelRatio() ) );
       job.renderer = nullptr;
       job.context()->setPainter( nullptr );
+      if ( registerLabelsOnly )
+      {
+        // the renderer will not paint any symbol, but still needs a valid painter
+        job.context()->setFlag( QgsRenderContext::SkipSymbolRendering, true );
+        job.context()->setPainter( new QPainter( job.img ) );
+        job.renderer = ml->createMapRenderer( *( job.context() ) );
+      }
       continue;
     }
 
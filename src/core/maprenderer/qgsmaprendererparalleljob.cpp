@@ -346,10 +346,11 @@ void QgsMapRendererParallelJob::renderLayerStatic( LayerRenderJob &job )
   if ( job.context()->renderingStopped() )
     return;
 
-  if ( job.cached )
+  // cached jobs only run their renderer when they must register features for labeling
+  if ( job.cached && !job.renderer )
     return;
 
-  if ( job.img )
+  if ( job.img && !job.cached )
   {
     job.img->fill( 0 );
     job.imageInitialized = true;
@@ -34,6 +34,9 @@
 #include "qgscoordinatetransform.h"
 #include "qgsmeshdataprovider.h"
 
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
 QgsMeshLayerInterpolator::QgsMeshLayerInterpolator(
   const QgsTriangularMesh &m,
   const QVector<double> &datasetValues,
@@ -68,6 +71,50 @@ int QgsMeshLayerInterpolator::bandCount() const
   return 1;
 }
 
+namespace
+{
+  //! Number of output rows processed by a single interpolation task
+  constexpr int BAND_HEIGHT = 64;
+
+  //! Minimum number of output pixels for which the interpolation is split across threads
+  constexpr qgssize PARALLEL_PIXEL_THRESHOLD = 256 * 256;
+
+  //! Tolerance on barycentric coordinates used to detect points on triangle borders
+  constexpr double BARYCENTRIC_TOLERANCE = 1e-6;
+
+  /**
+   * Triangle prepared for rasterization: barycentric coordinates of the first two vertices
+   * are expressed as affine functions of the pixel column and row, so that the covered span of
+   * each row can be computed from the edge functions without testing every pixel of the bounding box.
+   */
+  struct RasterTriangle
+  {
+    int topLim = 0;
+    int bottomLim = 0;
+    int leftLim = 0;
+    int rightLim = 0;
+
+    // lamN( column, row ) = lamNOrigin + column * lamNColumn + row * lamNRow
+    double lam1Origin = 0;
+    double lam1Column = 0;
+    double lam1Row = 0;
+    double lam2Origin = 0;
+    double lam2Column = 0;
+    double lam2Row = 0;
+
+    double value1 = 0;
+    double value2 = 0;
+    double value3 = 0;
+  };
+
+  struct RasterBand
+  {
+    int top = 0;
+    int bottom = 0;
+    QVector<int> triangles;
+  };
+}
+
 QgsRasterBlock *QgsMeshLayerInterpolator::block( int, const QgsRectangle &extent, int width, int height, QgsRasterBlockFeedback *feedback )
 {
   std::unique_ptr<QgsRasterBlock> outputBlock( new QgsRasterBlock( Qgis::DataType::Float64, width, height ) );
@@ -76,6 +123,11 @@ QgsRasterBlock *QgsMeshLayerInterpolator::block( int, const QgsRectangle &extent
   outputBlock->setIsNoData();  // assume initially that all values are unset
   double *data = reinterpret_cast<double *>( outputBlock->bits() );
 
+  if ( mTriangularMesh.contains( QgsMesh::ElementType::Edge ) )
+  {
+    return outputBlock.release();
+  }
+
   QList<int> spatialIndexTriangles;
   int indexCount;
   if ( mSpatialIndexActive )
@@ -88,32 +140,40 @@ QgsRasterBlock *QgsMeshLayerInterpolator::block( int, const QgsRectangle &extent
     indexCount = mTriangularMesh.triangles().count();
   }
 
-  if ( mTriangularMesh.contains( QgsMesh::ElementType::Edge ) )
-  {
-    return outputBlock.release();
-  }
-
   const QVector<QgsMeshVertex> &vertices = mTriangularMesh.vertices();
+  const QVector<QgsMeshFace> &triangles = mTriangularMesh.triangles();
+  const QVector<int> &trianglesToNativeFaces = mTriangularMesh.trianglesToNativeFaces();
+  const bool dataOnVertices = mDataType == QgsMeshDatasetGroupMetadata::DataType::DataOnVertices;
 
   // currently expecting that triangulation does not add any new extra vertices on the way
-  if ( mDataType == QgsMeshDatasetGroupMetadata::DataType::DataOnVertices )
+  if ( dataOnVertices )
     Q_ASSERT( mDatasetValues.count() == mTriangularMesh.vertices().count() );
 
+  // the map to pixel transform is affine, so map coordinates of pixel (column, row) are
+  // origin + column * columnStep + row * rowStep
+  const QgsMapToPixel &mapToPixel = mContext.mapToPixel();
+  const QgsPointXY origin = mapToPixel.toMapCoordinates( 0.0, 0.0 );
+  const QgsVector columnStep = mapToPixel.toMapCoordinates( 1.0, 0.0 ) - origin;
+  const QgsVector rowStep = mapToPixel.toMapCoordinates( 0.0, 1.0 ) - origin;
+
+  const int rowCount = std::min( height, mOutputSize.height() );
+  const int columnCount = std::min( width, mOutputSize.width() );
+  if ( rowCount <= 0 || columnCount <= 0 )
+    return outputBlock.release();
+
+  // first pass: select the triangles to rasterize and precompute their edge functions
+  std::vector<RasterTriangle> rasterTriangles;
+  rasterTriangles.reserve( static_cast<size_t>( indexCount ) );
   for ( int i = 0; i < indexCount; ++i )
   {
     if ( feedback && feedback->isCanceled() )
-      break;
+      return outputBlock.release();
 
     if ( mContext.renderingStopped() )
-      break;
+      return outputBlock.release();
 
-    int triangleIndex;
-    if ( mSpatialIndexActive )
-      triangleIndex = spatialIndexTriangles[i];
-    else
-      triangleIndex = i;
-
-    const QgsMeshFace &face = mTriangularMesh.triangles()[triangleIndex];
+    const int triangleIndex = mSpatialIndexActive ? spatialIndexTriangles[i] : i;
+    const QgsMeshFace &face = triangles[triangleIndex];
 
     if ( face.isEmpty() )
       continue;
@@ -121,66 +181,144 @@ QgsRasterBlock *QgsMeshLayerInterpolator::block( int, const QgsRectangle &extent
     const int v1 = face[0], v2 = face[1], v3 = face[2];
     const QgsPointXY &p1 = vertices[v1], &p2 = vertices[v2], &p3 = vertices[v3];
 
-    const int nativeFaceIndex = mTriangularMesh.trianglesToNativeFaces()[triangleIndex];
-    const bool isActive = mActiveFaceFlagValues.active( nativeFaceIndex );
-    if ( !isActive )
+    const int nativeFaceIndex = trianglesToNativeFaces[triangleIndex];
+    if ( !mActiveFaceFlagValues.active( nativeFaceIndex ) )
       continue;
 
-    QgsRectangle bbox = QgsMeshLayerUtils::triangleBoundingBox( p1, p2, p3 );
+    const QgsRectangle bbox = QgsMeshLayerUtils::triangleBoundingBox( p1, p2, p3 );
     if ( !extent.intersects( bbox ) )
       continue;
 
-    // Get the BBox of the element in pixels
-    int topLim, bottomLim, leftLim, rightLim;
-    QgsMeshLayerUtils::boundingBoxToScreenRectangle( mContext.mapToPixel(), mOutputSize, bbox, leftLim, rightLim, topLim, bottomLim );
+    const double det = ( p2.y() - p3.y() ) * ( p1.x() - p3.x() ) + ( p3.x() - p2.x() ) * ( p1.y() - p3.y() );
+    if ( det == 0 )
+      continue; // degenerated triangle
 
-    double value( 0 ), value1( 0 ), value2( 0 ), value3( 0 );
-    const int faceIdx = mTriangularMesh.trianglesToNativeFaces()[triangleIndex];
+    RasterTriangle triangle;
+
+    // Get the BBox of the element in pixels
+    QgsMeshLayerUtils::boundingBoxToScreenRectangle( mapToPixel, mOutputSize, bbox, triangle.leftLim, triangle.rightLim, triangle.topLim, triangle.bottomLim );
+    triangle.rightLim = std::min( triangle.rightLim, columnCount - 1 );
+    triangle.bottomLim = std::min( triangle.bottomLim, rowCount - 1 );
+    if ( triangle.leftLim > triangle.rightLim || triangle.topLim > triangle.bottomLim )
+      continue;
 
-    if ( mDataType == QgsMeshDatasetGroupMetadata::DataType::DataOnVertices )
+    const double ox = origin.x() - p3.x();
+    const double oy = origin.y() - p3.y();
+    const double a1x = ( p2.y() - p3.y() ) / det;
+    const double a1y = ( p3.x() - p2.x() ) / det;
+    const double a2x = ( p3.y() - p1.y() ) / det;
+    const double a2y = ( p1.x() - p3.x() ) / det;
+
+    triangle.lam1Origin = a1x * ox + a1y * oy;
+    triangle.lam1Column = a1x * columnStep.x() + a1y * columnStep.y();
+    triangle.lam1Row = a1x * rowStep.x() + a1y * rowStep.y();
+    triangle.lam2Origin = a2x * ox + a2y * oy;
+    triangle.lam2Column = a2x * columnStep.x() + a2y * columnStep.y();
+    triangle.lam2Row = a2x * rowStep.x() + a2y * rowStep.y();
+
+    if ( dataOnVertices )
     {
-      value1 = mDatasetValues[v1];
-      value2 = mDatasetValues[v2];
-      value3 = mDatasetValues[v3];
+      triangle.value1 = mDatasetValues[v1];
+      triangle.value2 = mDatasetValues[v2];
+      triangle.value3 = mDatasetValues[v3];
     }
     else
-      value = mDatasetValues[faceIdx];
+    {
+      triangle.value1 = mDatasetValues[nativeFaceIndex];
+    }
+
+    rasterTriangles.push_back( triangle );
+  }
+
+  // second pass: bin triangles into horizontal bands. Triangles keep their original
+  // order inside each band, so overlapping triangles resolve exactly as a sequential pass would
+  QVector<RasterBand> bands( ( rowCount + BAND_HEIGHT - 1 ) / BAND_HEIGHT );
+  for ( int b = 0; b < bands.size(); ++b )
+  {
+    bands[b].top = b * BAND_HEIGHT;
+    bands[b].bottom = std::min( rowCount, ( b + 1 ) * BAND_HEIGHT ) - 1;
+  }
+  for ( size_t t = 0; t < rasterTriangles.size(); ++t )
+  {
+    const RasterTriangle &triangle = rasterTriangles[t];
+    for ( int b = triangle.topLim / BAND_HEIGHT; b <= triangle.bottomLim / BAND_HEIGHT; ++b )
+      bands[b].triangles.append( static_cast<int>( t ) );
+  }
+
+  // third pass: rasterize each band, row by row. Every band writes to its own rows only
+  QgsRasterBlock *output = outputBlock.get();
+  auto rasterizeBand = [ =, &rasterTriangles]( const RasterBand & band )
+  {
+    if ( ( feedback && feedback->isCanceled() ) || mContext.renderingStopped() )
+      return;
 
-    // interpolate in the bounding box of the face
-    for ( int j = topLim; j <= bottomLim; j++ )
+    for ( int triangleIndex : band.triangles )
     {
-      double *line = data + ( j * width );
-      for ( int k = leftLim; k <= rightLim; k++ )
+      const RasterTriangle &triangle = rasterTriangles[static_cast<size_t>( triangleIndex )];
+      const double lam1Column = triangle.lam1Column;
+      const double lam2Column = triangle.lam2Column;
+      const double lam3Column = -lam1Column - lam2Column;
+
+      const int firstRow = std::max( triangle.topLim, band.top );
+      const int lastRow = std::min( triangle.bottomLim, band.bottom );
+      for ( int j = firstRow; j <= lastRow; j++ )
       {
-        double val;
-        const QgsPointXY p = mContext.mapToPixel().toMapCoordinates( k, j );
-        if ( mDataType == QgsMeshDatasetGroupMetadata::DataType::DataOnVertices )
-          val = QgsMeshLayerUtils::interpolateFromVerticesData(
-                  p1,
-                  p2,
-                  p3,
-                  value1,
-                  value2,
-                  value3,
-                  p );
-        else
+        const double lam1Start = triangle.lam1Origin + j * triangle.lam1Row;
+        const double lam2Start = triangle.lam2Origin + j * triangle.lam2Row;
+        const double lam3Start = 1.0 - lam1Start - lam2Start;
+
+        // clip the row span against the three edge functions, widened by one pixel
+        // to stay robust to rounding; each pixel is still tested below
+        double spanLeft = triangle.leftLim;
+        double spanRight = triangle.rightLim;
+        bool emptySpan = false;
+        const auto clipSpan = [&spanLeft, &spanRight, &emptySpan]( double start, double step )
         {
-          val = QgsMeshLayerUtils::interpolateFromFacesData(
-                  p1,
-                  p2,
-                  p3,
-                  value,
-                  p
-                );
-        }
-        if ( !std::isnan( val ) )
+          const double limit = -BARYCENTRIC_TOLERANCE - start;
+          if ( step > 0 )
+            spanLeft = std::max( spanLeft, std::floor( limit / step ) - 1 );
+          else if ( step < 0 )
+            spanRight = std::min( spanRight, std::ceil( limit / step ) + 1 );
+          else if ( start <= -BARYCENTRIC_TOLERANCE )
+            emptySpan = true;
+        };
+        clipSpan( lam1Start, lam1Column );
+        clipSpan( lam2Start, lam2Column );
+        clipSpan( lam3Start, lam3Column );
+        if ( emptySpan || spanLeft > spanRight )
+          continue;
+
+        double *line = data + ( static_cast<qgssize>( j ) * width );
+        const int kStart = static_cast<int>( spanLeft );
+        const int kEnd = static_cast<int>( spanRight );
+        for ( int k = kStart; k <= kEnd; k++ )
         {
-          line[k] = val;
-          outputBlock->setIsData( j, k );
+          const double lam1 = lam1Start + k * lam1Column;
+          const double lam2 = lam2Start + k * lam2Column;
+          const double lam3 = lam3Start + k * lam3Column;
+          if ( lam1 <= -BARYCENTRIC_TOLERANCE || lam2 <= -BARYCENTRIC_TOLERANCE || lam3 <= -BARYCENTRIC_TOLERANCE )
+            continue;
+
+          const double val = dataOnVertices ? lam1 * triangle.value1 + lam2 * triangle.value2 + lam3 * triangle.value3
+                             : triangle.value1;
+          if ( !std::isnan( val ) )
+          {
+            line[k] = val;
+            output->setIsData( j, k );
+          }
         }
       }
     }
+  };
 
+  if ( bands.size() > 1 && static_cast<qgssize>( rowCount ) * columnCount >= PARALLEL_PIXEL_THRESHOLD && QThreadPool::globalInstance()->maxThreadCount() > 1 )
+  {
+    QtConcurrent::blockingMap( bands, rasterizeBand );
+  }
+  else
+  {
+    for ( const RasterBand &band : std::as_const( bands ) )
+      rasterizeBand( band );
   }
 
   return outputBlock.release();
@@ -48,6 +48,8 @@ class QgsRenderContext;
  * \ingroup core
  * \brief Interpolate mesh scalar dataset to raster block
  *
+ * Large blocks are split in horizontal bands which are rasterized concurrently.
+ *
  * \note not available in Python bindings
  * \since QGIS 3.2
  */
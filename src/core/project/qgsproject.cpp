@@ -65,6 +65,8 @@
 #include "qgsannotationlayer.h"
 #include "qgspointcloudlayer.h"
 #include "qgsattributeeditorcontainer.h"
+#include "qgsproviderregistry.h"
+#include "qgsprovidermetadata.h"
 
 
 #include <algorithm>
@@ -79,6 +81,9 @@
 #include <QStandardPaths>
 #include <QUuid>
 #include <QRegularExpression>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 
 #ifdef _MSC_VER
 #include <sys/utime.h>
@@ -89,6 +94,9 @@
 // canonical project instance
 QgsProject *QgsProject::sProject = nullptr;
 
+// project instance of the calling thread, overriding the canonical one
+static thread_local QgsProject *sThreadProject = nullptr;
+
 /**
  * Takes the given scope and key and convert them to a string list of key
  * tokens that will be used to navigate through a Property hierarchy
@@ -456,6 +464,10 @@ QgsProject::~QgsProject()
   {
     sProject = nullptr;
   }
+  if ( this == sThreadProject )
+  {
+    sThreadProject = nullptr;
+  }
 }
 
 void QgsProject::setInstance( QgsProject *project )
@@ -464,8 +476,21 @@ void QgsProject::setInstance( QgsProject *project )
 }
 
 
+void QgsProject::setThreadInstance( QgsProject *project )
+{
+  sThreadProject = project;
+}
+
+QgsProject *QgsProject::threadInstance()
+{
+  return sThreadProject;
+}
+
 QgsProject *QgsProject::instance()
 {
+  if ( sThreadProject )
+    return sThreadProject;
+
   if ( !sProject )
   {
     sProject = new QgsProject;
@@ -1074,6 +1099,108 @@ void QgsProject::setAvoidIntersectionsMode( const AvoidIntersectionsMode mode )
   emit avoidIntersectionsModeChanged();
 }
 
+struct QgsProject::PreloadedProvider
+{
+  QString layerId;
+  QString providerKey;
+  QString dataSource;
+  QgsDataProvider::ProviderOptions options;
+  QgsDataProvider::ReadFlags flags;
+  std::unique_ptr< QgsDataProvider > provider;
+};
+
+std::vector< QgsProject::PreloadedProvider > QgsProject::preloadProviders( const QVector<QDomNode> &layerNodes, QgsProject::ReadFlags flags ) const
+{
+  std::vector< PreloadedProvider > preloadedProviders;
+  if ( QThreadPool::globalInstance()->maxThreadCount() < 2 )
+    return preloadedProviders;
+
+  const bool trustLayerMetadata = mTrustLayerMetadata || ( flags & QgsProject::ReadFlag::FlagTrustLayerMetadata );
+
+  QgsReadWriteContext context;
+  context.setPathResolver( pathResolver() );
+  context.setTransformContext( transformContext() );
+
+  // layers are only used to decode the data sources, exactly as QgsMapLayer::readLayerXml() does
+  std::unique_ptr< QgsMapLayer > vectorLayer;
+  std::unique_ptr< QgsMapLayer > rasterLayer;
+
+  const thread_local QRegularExpression authCfgRx( QStringLiteral( "authcfg=([a-z]|[A-Z]|[0-9]){7}" ) );
+
+  for ( const QDomNode &node : layerNodes )
+  {
+    const QDomElement element = node.toElement();
+    if ( element.attribute( QStringLiteral( "embedded" ) ) == QLatin1String( "1" ) )
+      continue;
+
+    bool ok = false;
+    const QgsMapLayerType layerType = QgsMapLayerFactory::typeFromString( element.attribute( QStringLiteral( "type" ) ), ok );
+    if ( !ok || ( layerType != QgsMapLayerType::VectorLayer && layerType != QgsMapLayerType::RasterLayer ) )
+      continue;
+
+    const QString providerKey = element.namedItem( QStringLiteral( "provider" ) ).toElement().text();
+    const QgsProviderMetadata *metadata = providerKey.isEmpty() ? nullptr : QgsProviderRegistry::instance()->providerMetadata( providerKey );
+    if ( !metadata || !( metadata->providerCapabilities() & QgsProviderMetadata::ParallelCreateProvider ) )
+      continue;
+
+    QString dataSource = context.pathResolver().readPath( element.namedItem( QStringLiteral( "datasource" ) ).toElement().text() );
+    // the master password may have to be asked to the user, leave these layers to readLayerXml()
+    if ( authCfgRx.match( dataSource ).hasMatch() )
+      continue;
+
+    PreloadedProvider preloaded;
+    preloaded.layerId = element.namedItem( QStringLiteral( "id" ) ).toElement().text();
+    preloaded.providerKey = providerKey;
+    preloaded.options = QgsDataProvider::ProviderOptions { transformContext() };
+    if ( trustLayerMetadata )
+      preloaded.flags |= QgsDataProvider::FlagTrustDataSource;
+
+    if ( layerType == QgsMapLayerType::VectorLayer )
+    {
+      if ( !vectorLayer )
+        vectorLayer = std::make_unique< QgsVectorLayer >();
+      dataSource = vectorLayer->decodedSource( dataSource, providerKey, context );
+
+      // same as QgsVectorLayer::setDataProvider()
+      if ( providerKey == QLatin1String( "postgres" ) )
+      {
+        const QString checkUnicityKey { QStringLiteral( "checkPrimaryKeyUnicity" ) };
+        QgsDataSourceUri uri( dataSource );
+        if ( ! uri.hasParam( checkUnicityKey ) )
+        {
+          uri.setParam( checkUnicityKey, trustLayerMetadata ? "0" : "1" );
+          dataSource = uri.uri( false );
+        }
+      }
+    }
+    else
+    {
+      if ( !rasterLayer )
+        rasterLayer = std::make_unique< QgsRasterLayer >();
+      dataSource = rasterLayer->decodedSource( dataSource, providerKey, context );
+    }
+
+    preloaded.dataSource = dataSource;
+    preloadedProviders.emplace_back( std::move( preloaded ) );
+  }
+
+  if ( preloadedProviders.size() < 2 )
+  {
+    preloadedProviders.clear();
+    return preloadedProviders;
+  }
+
+  QThread *projectThread = thread();
+  QtConcurrent::blockingMap( preloadedProviders.begin(), preloadedProviders.end(), [projectThread]( PreloadedProvider & preloaded )
+  {
+    preloaded.provider.reset( QgsProviderRegistry::instance()->createProvider( preloaded.providerKey, preloaded.dataSource, preloaded.options, preloaded.flags ) );
+    if ( preloaded.provider )
+      preloaded.provider->moveToThread( projectThread );
+  } );
+
+  return preloadedProviders;
+}
+
 bool QgsProject::_getMapLayers( const QDomDocument &doc, QList<QDomNode> &brokenNodes, QgsProject::ReadFlags flags )
 {
   // Layer order is set by the restoring the legend settings from project file.
@@ -1117,6 +1244,17 @@ bool QgsProject::_getMapLayers( const QDomDocument &doc, QList<QDomNode> &broken
   const QVector<QDomNode> sortedLayerNodes = depSorter.sortedLayerNodes();
   const int totalLayerCount = sortedLayerNodes.count();
 
+  // create the data providers concurrently, layers are then read and added in order on this thread
+  std::vector< PreloadedProvider > preloadedProviders;
+  QHash< QString, PreloadedProvider * > preloadedProvidersById;
+  if ( ( flags & QgsProject::ReadFlag::FlagLoadLayersInParallel ) && !( flags & QgsProject::ReadFlag::FlagDontResolveLayers ) )
+  {
+    profile.switchTask( tr( "Create data providers" ) );
+    preloadedProviders = preloadProviders( sortedLayerNodes, flags );
+    for ( PreloadedProvider &preloaded : preloadedProviders )
+      preloadedProvidersById.insert( preloaded.layerId, &preloaded );
+  }
+
   int i = 0;
   for ( const QDomNode &node : sortedLayerNodes )
   {
@@ -1139,7 +1277,7 @@ bool QgsProject::_getMapLayers( const QDomDocument &doc, QList<QDomNode> &broken
       context.setProjectTranslator( this );
       context.setTransformContext( transformContext() );
 
-      if ( !addLayer( element, brokenNodes, context, flags ) )
+      if ( !addLayer( element, brokenNodes, context, flags, preloadedProvidersById.value( element.namedItem( QStringLiteral( "id" ) ).toElement().text() ) ) )
       {
         returnStatus = false;
       }
@@ -1156,7 +1294,7 @@ bool QgsProject::_getMapLayers( const QDomDocument &doc, QList<QDomNode> &broken
   return returnStatus;
 }
 
-bool QgsProject::addLayer( const QDomElement &layerElem, QList<QDomNode> &brokenNodes, QgsReadWriteContext &context, QgsProject::ReadFlags flags )
+bool QgsProject::addLayer( const QDomElement &layerElem, QList<QDomNode> &brokenNodes, QgsReadWriteContext &context, QgsProject::ReadFlags flags, PreloadedProvider *preloadedProvider )
 {
   QString type = layerElem.attribute( QStringLiteral( "type" ) );
   QgsDebugMsgLevel( "Layer type is " + type, 4 );
@@ -1238,8 +1376,18 @@ bool QgsProject::addLayer( const QDomElement &layerElem, QList<QDomNode> &broken
   if ( mTrustLayerMetadata || ( flags & QgsProject::ReadFlag::FlagTrustLayerMetadata ) )
     layerFlags |= QgsMapLayer::FlagTrustLayerMetadata;
 
+  if ( preloadedProvider && preloadedProvider->provider )
+  {
+    mapLayer->mPreloadedProvider = std::move( preloadedProvider->provider );
+    mapLayer->mPreloadedProviderKey = preloadedProvider->providerKey;
+    mapLayer->mPreloadedProviderSource = preloadedProvider->dataSource;
+    mapLayer->mPreloadedProviderFlags = preloadedProvider->flags;
+  }
+
   profile.switchTask( tr( "Load layer source" ) );
   bool layerIsValid = mapLayer->readLayerXml( layerElem, context, layerFlags ) && mapLayer->isValid();
+  // discard the preloaded provider if the layer did not use it
+  mapLayer->mPreloadedProvider.reset();
 
   profile.switchTask( tr( "Add layer to project" ) );
   QList<QgsMapLayer *> newLayers;
@@ -26,6 +26,7 @@
 #include "qgis.h"
 
 #include <memory>
+#include <vector>
 #include <QHash>
 #include <QList>
 #include <QObject>
@@ -128,6 +129,7 @@ class CORE_EXPORT QgsProject : public QObject, public QgsExpressionContextGenera
       FlagDontLoadLayouts = 1 << 1, //!< Don't load print layouts. Improves project read time if layouts are not required, and allows projects to be safely read in background threads (since print layouts are not thread safe).
       FlagTrustLayerMetadata = 1 << 2, //!< Trust layer metadata. Improves project read time. Do not use it if layers' extent is not fixed during the project's use by QGIS and QGIS Server.
       FlagDontStoreOriginalStyles = 1 << 3, //!< Skip the initial XML style storage for layers. Useful for minimising project load times in non-interactive contexts.
+      FlagLoadLayersInParallel = 1 << 4, //!< Create the data providers of vector and raster layers concurrently before the layers are added to the project, for providers which support it. Improves project read time for projects with many database or file based layers (since QGIS 3.22)
     };
     Q_DECLARE_FLAGS( ReadFlags, ReadFlag )
 
@@ -169,7 +171,16 @@ class CORE_EXPORT QgsProject : public QObject, public QgsExpressionContextGenera
       WMSOnlineResource = 2, //!< Alias
     };
 
-    //! Returns the QgsProject singleton instance
+    /**
+     * Returns the QgsProject singleton instance, or the project set for the calling
+     * thread with setThreadInstance().
+     *
+     * A project set with setThreadInstance() takes precedence over the singleton in the
+     * thread which set it only, other threads are not affected and setInstance() does not
+     * change the project returned in that thread.
+     *
+     * \see setThreadInstance()
+     */
     static QgsProject *instance();
 
     /**
@@ -182,6 +193,31 @@ class CORE_EXPORT QgsProject : public QObject, public QgsExpressionContextGenera
      */
     static void setInstance( QgsProject *project ) ;
 
+    /**
+     * Sets the project returned by instance() in the calling thread to \a project. If \a project
+     * is NULLPTR, the calling thread uses the singleton instance again.
+     *
+     * The project is not owned by the thread. Deleting it from the calling thread resets the
+     * thread instance, when it is deleted from another thread the calling thread must reset
+     * its instance with a NULLPTR \a project first.
+     *
+     * \note this method is provided for the server, which may handle requests concurrently from several threads, each with its own current project.
+     * \note not available in Python bindings
+     * \see threadInstance()
+     * \since QGIS 3.22
+     */
+    static void setThreadInstance( QgsProject *project ) SIP_SKIP;
+
+    /**
+     * Returns the project set for the calling thread with setThreadInstance(), or NULLPTR if the
+     * calling thread uses the singleton instance.
+     *
+     * \note not available in Python bindings
+     * \see setThreadInstance()
+     * \since QGIS 3.22
+     */
+    static QgsProject *threadInstance() SIP_SKIP;
+
 
     /**
      * Create a new QgsProject.
@@ -1957,6 +1993,8 @@ class CORE_EXPORT QgsProject : public QObject, public QgsExpressionContextGenera
 
     static QgsProject *sProject;
 
+    //! Data provider created ahead of its layer while reading a project
+    struct PreloadedProvider;
 
     /**
      * Read map layers from project file.
@@ -1987,7 +2025,15 @@ class CORE_EXPORT QgsProject : public QObject, public QgsExpressionContextGenera
      *
      * \note not available in Python bindings
      */
-    bool addLayer( const QDomElement &layerElem, QList<QDomNode> &brokenNodes, QgsReadWriteContext &context, QgsProject::ReadFlags flags = QgsProject::ReadFlags() ) SIP_SKIP;
+    bool addLayer( const QDomElement &layerElem, QList<QDomNode> &brokenNodes, QgsReadWriteContext &context, QgsProject::ReadFlags flags = QgsProject::ReadFlags(), PreloadedProvider *preloadedProvider = nullptr ) SIP_SKIP;
+
+    /**
+     * Creates concurrently the data providers of the vector and raster layers in \a layerNodes
+     * whose provider supports it, see QgsProject::ReadFlag::FlagLoadLayersInParallel.
+     *
+     * \note not available in Python bindings
+     */
+    std::vector< PreloadedProvider > preloadProviders( const QVector<QDomNode> &layerNodes, QgsProject::ReadFlags flags ) const SIP_SKIP;
 
     /**
      * The optional \a flags argument can be used to control layer reading behavior.
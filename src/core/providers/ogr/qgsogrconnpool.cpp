@@ -18,6 +18,21 @@
 
 #include "qgslogger.h"
 
+#include <QFileInfo>
+#include <QThreadPool>
+
+// static public
+int QgsOgrConnPoolGroup::maxConcurrentConnections( const QString &connInfo )
+{
+  const int defaultCount = QgsApplication::instance()->maxConcurrentConnectionsPerPool();
+  const QVariantMap parts = QgsOgrProviderMetadata().decodeUri( connInfo );
+  if ( !parts.value( QStringLiteral( "vsiPrefix" ) ).toString().isEmpty() ||
+       !QFileInfo( parts.value( QStringLiteral( "path" ) ).toString() ).isFile() )
+    return defaultCount;
+
+  return std::max( defaultCount, QThreadPool::globalInstance()->maxThreadCount() );
+}
+
 QgsOgrConnPool *QgsOgrConnPool::sInstance = nullptr;
 
 // static public
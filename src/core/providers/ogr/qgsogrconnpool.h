@@ -16,6 +16,7 @@
 #ifndef QGSOGRCONNPOOL_H
 #define QGSOGRCONNPOOL_H
 
+#include "qgis_core.h"
 #include "qgsconnectionpool.h"
 #include "qgsogrprovidermetadata.h"
 #include "qgsogrproviderutils.h"
@@ -75,17 +76,25 @@ inline bool qgsConnectionPool_ConnectionIsValid( QgsOgrConn *c )
   return c->valid;
 }
 
-class QgsOgrConnPoolGroup : public QObject, public QgsConnectionPoolGroup<QgsOgrConn *>
+class CORE_EXPORT QgsOgrConnPoolGroup : public QObject, public QgsConnectionPoolGroup<QgsOgrConn *>
 {
     Q_OBJECT
 
   public:
     explicit QgsOgrConnPoolGroup( const QString &name )
-      : QgsConnectionPoolGroup<QgsOgrConn*>( name )
+      : QgsConnectionPoolGroup<QgsOgrConn*>( name, maxConcurrentConnections( name ) )
     {
       initTimer( this );
     }
 
+    /**
+     * Returns the maximum number of connections which may be acquired at the same time for \a connInfo.
+     *
+     * Local files can be opened several times at a low cost, so each thread of the global thread pool
+     * may read from its own handle, e.g. when the layers of a GeoPackage are rendered in parallel.
+     */
+    static int maxConcurrentConnections( const QString &connInfo );
+
     //! QgsOgrConnPoolGroup cannot be copied
     QgsOgrConnPoolGroup( const QgsOgrConnPoolGroup &other ) = delete;
 
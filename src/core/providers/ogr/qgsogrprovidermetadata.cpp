@@ -1324,7 +1324,7 @@ void QgsOgrProviderMetadata::saveConnection( const QgsAbstractProviderConnection
 
 QgsProviderMetadata::ProviderCapabilities QgsOgrProviderMetadata::providerCapabilities() const
 {
-  return FileBasedUris | SaveLayerMetadata;
+  return FileBasedUris | SaveLayerMetadata | ParallelCreateProvider;
 }
 
 ///@endcond
@@ -192,6 +192,7 @@ class CORE_EXPORT QgsProviderMetadata : public QObject
     {
       FileBasedUris = 1 << 0, //!< Indicates that the provider can utilize URIs which are based on paths to files (as opposed to database or internet paths)
       SaveLayerMetadata = 1 << 1, //!< Indicates that the provider supports saving native layer metadata (since QGIS 3.20)
+      ParallelCreateProvider = 1 << 2, //!< Indicates that providers can be safely created from a thread other than the main thread, see QgsProject::ReadFlag::FlagLoadLayersInParallel (since QGIS 3.22)
     };
     Q_DECLARE_FLAGS( ProviderCapabilities, ProviderCapability )
 
@@ -19,10 +19,187 @@
 #include "qgsfeature.h"
 #include "qgsfeaturerequest.h"
 #include "qgsfeatureiterator.h"
+#include "qgsfeedback.h"
 #include "qgsgeometry.h"
 #include "qgsvectorlayer.h"
 
+#include <map>
+#include <memory>
 
+///@cond PRIVATE
+
+/**
+ * Accumulates the values of one group of features for QgsAggregateCalculator::calculateGrouped(),
+ * so that the groups are aggregated while the features are read instead of keeping the features.
+ */
+class QgsAggregateGroupAccumulator
+{
+  public:
+
+    //! Statistics matching the aggregate for each type of values, as used by QgsAggregateCalculator::calculate()
+    struct Statistics
+    {
+      QgsAggregateCalculator::Aggregate aggregate = QgsAggregateCalculator::Count;
+      QString delimiter;
+      bool numericOk = false;
+      QgsStatisticalSummary::Statistic numeric = QgsStatisticalSummary::Count;
+      bool dateTimeOk = false;
+      QgsDateTimeStatisticalSummary::Statistic dateTime = QgsDateTimeStatisticalSummary::Count;
+      bool stringOk = false;
+      QgsStringStatisticalSummary::Statistic string = QgsStringStatisticalSummary::Count;
+    };
+
+    QgsAggregateGroupAccumulator( const Statistics &statistics, QVariant::Type resultType )
+      : mStatistics( statistics )
+    {
+      if ( statistics.aggregate == QgsAggregateCalculator::ArrayAggregate )
+      {
+        mKind = Array;
+        return;
+      }
+
+      switch ( resultType )
+      {
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+        case QVariant::Double:
+          if ( statistics.numericOk )
+          {
+            mKind = Numeric;
+            mNumeric.reset( new QgsStatisticalSummary( statistics.numeric ) );
+          }
+          break;
+
+        case QVariant::Date:
+        case QVariant::DateTime:
+          if ( statistics.dateTimeOk )
+          {
+            mKind = DateTime;
+            mDateTime.reset( new QgsDateTimeStatisticalSummary( statistics.dateTime ) );
+          }
+          break;
+
+        case QVariant::UserType:
+          if ( statistics.aggregate == QgsAggregateCalculator::GeometryCollect )
+            mKind = Geometry;
+          break;
+
+        default:
+          if ( statistics.aggregate == QgsAggregateCalculator::StringConcatenate )
+          {
+            mKind = Concatenate;
+          }
+          else if ( statistics.aggregate == QgsAggregateCalculator::StringConcatenateUnique )
+          {
+            mKind = ConcatenateUnique;
+          }
+          else if ( statistics.stringOk )
+          {
+            mKind = String;
+            mString.reset( new QgsStringStatisticalSummary( statistics.string ) );
+          }
+          break;
+      }
+    }
+
+    //! Returns FALSE if the aggregate cannot be calculated for the type of values of the group
+    bool isValid() const { return mKind != Invalid; }
+
+    void addValue( const QVariant &value )
+    {
+      switch ( mKind )
+      {
+        case Invalid:
+          break;
+        case Array:
+          mArray.append( value );
+          break;
+        case Numeric:
+          mNumeric->addVariant( value );
+          break;
+        case DateTime:
+          mDateTime->addValue( value );
+          break;
+        case Geometry:
+          if ( value.canConvert<QgsGeometry>() )
+            mGeometries << value.value<QgsGeometry>();
+          break;
+        case Concatenate:
+          mStrings << value.toString();
+          break;
+        case ConcatenateUnique:
+        {
+          const QString string = value.toString();
+          if ( !mUniqueStrings.contains( string ) )
+          {
+            mUniqueStrings.insert( string );
+            mStrings << string;
+          }
+          break;
+        }
+        case String:
+          mString->addValue( value );
+          break;
+      }
+    }
+
+    QVariant result()
+    {
+      switch ( mKind )
+      {
+        case Invalid:
+          break;
+        case Array:
+          return mArray;
+        case Numeric:
+        {
+          mNumeric->finalize();
+          const double value = mNumeric->statistic( mStatistics.numeric );
+          return std::isnan( value ) ? QVariant() : value;
+        }
+        case DateTime:
+          mDateTime->finalize();
+          return mDateTime->statistic( mStatistics.dateTime );
+        case Geometry:
+          return QVariant::fromValue( QgsGeometry::collectGeometry( mGeometries ) );
+        case Concatenate:
+        case ConcatenateUnique:
+          return mStrings.join( mStatistics.delimiter );
+        case String:
+          mString->finalize();
+          return mString->statistic( mStatistics.string );
+      }
+      return QVariant();
+    }
+
+  private:
+
+    enum Kind
+    {
+      Invalid,
+      Array,
+      Numeric,
+      DateTime,
+      Geometry,
+      Concatenate,
+      ConcatenateUnique,
+      String,
+    };
+
+    Statistics mStatistics;
+    Kind mKind = Invalid;
+    std::unique_ptr< QgsStatisticalSummary > mNumeric;
+    std::unique_ptr< QgsDateTimeStatisticalSummary > mDateTime;
+    std::unique_ptr< QgsStringStatisticalSummary > mString;
+    QVariantList mArray;
+    QVector< QgsGeometry > mGeometries;
+    QStringList mStrings;
+    QSet< QString > mUniqueStrings;
+};
+
+///@endcond
 
 QgsAggregateCalculator::QgsAggregateCalculator( const QgsVectorLayer *layer )
   : mLayer( layer )
@@ -138,6 +315,154 @@ QVariant QgsAggregateCalculator::calculate( QgsAggregateCalculator::Aggregate ag
   return calculate( aggregate, fit, resultType, attrNum, expression.get(), mDelimiter, context, ok );
 }
 
+QHash<QString, QVariant> QgsAggregateCalculator::calculateGrouped( QgsAggregateCalculator::Aggregate aggregate, const QString &fieldOrExpression,
+    const QStringList &groupByFields, QgsExpressionContext *context, bool *ok, QgsFeedback *feedback ) const
+{
+  if ( ok )
+    *ok = false;
+
+  QHash< QString, QVariant > results;
+  if ( !mLayer || groupByFields.isEmpty() )
+    return results;
+
+  const QgsFields fields = mLayer->fields();
+  QVector< int > groupByIndices;
+  groupByIndices.reserve( groupByFields.size() );
+  for ( const QString &field : groupByFields )
+  {
+    const int index = fields.lookupField( field );
+    if ( index < 0 )
+      return results;
+    groupByIndices << index;
+  }
+
+  QgsExpressionContext defaultContext = mLayer->createExpressionContext();
+  context = context ? context : &defaultContext;
+
+  std::unique_ptr<QgsExpression> expression;
+  const int attrNum = fields.lookupField( fieldOrExpression );
+  if ( attrNum == -1 )
+  {
+    context->setFields( fields );
+    expression.reset( new QgsExpression( fieldOrExpression ) );
+
+    if ( expression->hasParserError() || !expression->prepare( context ) )
+      return results;
+  }
+
+  QSet<QString> attributes;
+  if ( !expression )
+    attributes.insert( fieldOrExpression );
+  else
+    attributes = expression->referencedColumns();
+  for ( const QString &field : groupByFields )
+    attributes.insert( field );
+
+  QgsFeatureRequest request;
+  request.setFlags( ( expression && expression->needsGeometry() ) ?
+                    QgsFeatureRequest::NoFlags :
+                    QgsFeatureRequest::NoGeometry )
+  .setSubsetOfAttributes( attributes, fields );
+
+  if ( mFidsSet )
+    request.setFilterFids( mFidsFilter );
+
+  if ( !mOrderBy.empty() )
+    request.setOrderBy( mOrderBy );
+
+  if ( !mFilterExpression.isEmpty() )
+    request.setFilterExpression( mFilterExpression );
+  request.setExpressionContext( *context );
+
+  QgsFeedback *requestFeedback = feedback ? feedback : context->feedback();
+  request.setFeedback( requestFeedback );
+
+  QgsAggregateGroupAccumulator::Statistics statistics;
+  statistics.aggregate = aggregate;
+  statistics.delimiter = mDelimiter;
+  statistics.numeric = numericStatFromAggregate( aggregate, &statistics.numericOk );
+  statistics.dateTime = dateTimeStatFromAggregate( aggregate, &statistics.dateTimeOk );
+  statistics.string = stringStatFromAggregate( aggregate, &statistics.stringOk );
+
+  // value type of the field, or of the first value of each group as calculate() does for the first matching feature
+  QVariant::Type fixedType = QVariant::Invalid;
+  if ( attrNum >= 0 )
+    fixedType = fields.at( attrNum ).type();
+  else if ( aggregate == GeometryCollect )
+    fixedType = QVariant::UserType;
+
+  // aggregate the groups while reading the features, keeping the requested order within groups
+  std::map< QString, std::unique_ptr< QgsAggregateGroupAccumulator > > groups;
+  QVariantList groupValues;
+  groupValues.reserve( groupByIndices.size() );
+  QgsFeatureIterator fit = mLayer->getFeatures( request );
+  QgsFeature f;
+  while ( fit.nextFeature( f ) )
+  {
+    groupValues.clear();
+    for ( int index : std::as_const( groupByIndices ) )
+      groupValues << f.attribute( index );
+
+    QVariant value;
+    if ( expression )
+    {
+      context->setFeature( f );
+      value = expression->evaluate( context );
+    }
+    else
+    {
+      value = f.attribute( attrNum );
+    }
+
+    std::unique_ptr< QgsAggregateGroupAccumulator > &group = groups[ groupKey( groupValues ) ];
+    if ( !group )
+    {
+      group.reset( new QgsAggregateGroupAccumulator( statistics, fixedType != QVariant::Invalid ? fixedType : value.type() ) );
+      if ( !group->isValid() )
+        return results;
+    }
+    group->addValue( value );
+  }
+
+  if ( requestFeedback && requestFeedback->isCanceled() )
+    return results;
+
+  results.reserve( static_cast< int >( groups.size() ) + 1 );
+  for ( auto it = groups.begin(); it != groups.end(); ++it )
+    results.insert( it->first, it->second->result() );
+
+  // value for groups without features, matching calculate() for an empty request
+  if ( attrNum >= 0 )
+  {
+    QgsAggregateGroupAccumulator empty( statistics, fixedType );
+    if ( !empty.isValid() )
+      return QHash< QString, QVariant >();
+    results.insert( QString(), empty.result() );
+  }
+  else
+  {
+    results.insert( QString(), defaultValue( aggregate ) );
+  }
+
+  if ( ok )
+    *ok = true;
+  return results;
+}
+
+QString QgsAggregateCalculator::groupKey( const QVariantList &values )
+{
+  QString key;
+  for ( const QVariant &value : values )
+  {
+    if ( value.isNull() )
+      key += QStringLiteral( "n" );
+    else
+      key += QStringLiteral( "v%1" ).arg( value.toString().replace( '\\', QLatin1String( "\\\\" ) ).replace( '|', QLatin1String( "\\|" ) ) );
+    key += '|';
+  }
+  return key;
+}
+
 QgsAggregateCalculator::Aggregate QgsAggregateCalculator::stringToAggregate( const QString &string, bool *ok )
 {
   QString normalized = string.trimmed().toLower();
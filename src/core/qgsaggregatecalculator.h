@@ -181,6 +181,41 @@ class CORE_EXPORT QgsAggregateCalculator
     QVariant calculate( Aggregate aggregate, const QString &fieldOrExpression,
                         QgsExpressionContext *context = nullptr, bool *ok = nullptr, QgsFeedback *feedback = nullptr ) const;
 
+    /**
+     * Calculates the value of an aggregate for each group of features sharing the same values
+     * for the \a groupByFields, reading the layer features only once.
+     *
+     * The features of each group are aggregated exactly as calculate() would if the filter
+     * was restricted to the features of the group. Results are keyed by groupKey() of the
+     * values of the \a groupByFields, and the value of an aggregate over no feature is
+     * stored with a null key. At least one group by field must be specified.
+     *
+     * Groups are aggregated while the features are read, so only the aggregate state of each
+     * group is kept in memory. As groups are identified by the string representation of the
+     * values, the group by fields should hold integer, string or date values.
+     *
+     * \param aggregate aggregate to calculate
+     * \param fieldOrExpression source field or expression to use as basis for aggregated values
+     * \param groupByFields names of the fields of the layer defining the groups
+     * \param context expression context for evaluating expressions
+     * \param ok if specified, will be set to TRUE if aggregate calculation was successful
+     * \param feedback optional feedback argument for early cancellation
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    QHash< QString, QVariant > calculateGrouped( Aggregate aggregate, const QString &fieldOrExpression, const QStringList &groupByFields,
+        QgsExpressionContext *context = nullptr, bool *ok = nullptr, QgsFeedback *feedback = nullptr ) const SIP_SKIP;
+
+    /**
+     * Returns the key identifying the group of features with the specified \a values,
+     * as used by calculateGrouped().
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    static QString groupKey( const QVariantList &values ) SIP_SKIP;
+
     /**
      * Converts a string to a aggregate type.
      * \param string string to convert
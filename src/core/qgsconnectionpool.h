@@ -70,9 +70,15 @@ class QgsConnectionPoolGroup
       QTime lastUsedTime;
     };
 
-    QgsConnectionPoolGroup( const QString &ci )
+    /**
+     * Constructor for a group of connections to \a ci.
+     *
+     * At most \a maxConcurrentConnections connections are acquired at the same time, or
+     * QgsApplication::maxConcurrentConnectionsPerPool() if it is not a positive value.
+     */
+    QgsConnectionPoolGroup( const QString &ci, int maxConcurrentConnections = -1 )
       : connInfo( ci )
-      , sem( QgsApplication::instance()->maxConcurrentConnectionsPerPool() + CONN_POOL_SPARE_CONNECTIONS )
+      , sem( ( maxConcurrentConnections > 0 ? maxConcurrentConnections : QgsApplication::instance()->maxConcurrentConnectionsPerPool() ) + CONN_POOL_SPARE_CONNECTIONS )
     {
     }
 
@@ -116,18 +122,13 @@ class QgsConnectionPoolGroup
       sem.release( requiredFreeConnectionCount - 1 );
 
       // quick (preferred) way - use cached connection
+      T invalidConn = nullptr;
       {
         QMutexLocker locker( &connMutex );
 
         if ( !conns.isEmpty() )
         {
           Item i = conns.pop();
-          if ( !qgsConnectionPool_ConnectionIsValid( i.c ) )
-          {
-            qgsConnectionPool_ConnectionDestroy( i.c );
-            qgsConnectionPool_ConnectionCreate( connInfo, i.c );
-          }
-
 
           // no need to run if nothing can expire
           if ( conns.isEmpty() )
@@ -136,12 +137,20 @@ class QgsConnectionPoolGroup
             QMetaObject::invokeMethod( expirationTimer->parent(), "stopExpirationTimer" );
           }
 
-          acquiredConns.append( i.c );
-
-          return i.c;
+          if ( qgsConnectionPool_ConnectionIsValid( i.c ) )
+          {
+            acquiredConns.append( i.c );
+            return i.c;
+          }
+          invalidConn = i.c;
         }
       }
 
+      // invalidated connections are closed and reopened without holding the lock, so that
+      // other threads can acquire and release connections of the group in the meantime
+      if ( invalidConn )
+        qgsConnectionPool_ConnectionDestroy( invalidConn );
+
       T c;
       qgsConnectionPool_ConnectionCreate( connInfo, c );
       if ( !c )
@@ -43,6 +43,8 @@ QgsExpressionContextScope::QgsExpressionContextScope( const QString &name )
 QgsExpressionContextScope::QgsExpressionContextScope( const QgsExpressionContextScope &other )
   : mName( other.mName )
   , mVariables( other.mVariables )
+  , mKnownVariables( other.mKnownVariables )
+  , mKnownVariablesSet( other.mKnownVariablesSet )
   , mHasFeature( other.mHasFeature )
   , mFeature( other.mFeature )
 {
@@ -57,6 +59,8 @@ QgsExpressionContextScope &QgsExpressionContextScope::operator=( const QgsExpres
 {
   mName = other.mName;
   mVariables = other.mVariables;
+  mKnownVariables = other.mKnownVariables;
+  mKnownVariablesSet = other.mKnownVariablesSet;
   mHasFeature = other.mHasFeature;
   mFeature = other.mFeature;
 
@@ -76,11 +80,112 @@ QgsExpressionContextScope::~QgsExpressionContextScope()
   qDeleteAll( mFunctions );
 }
 
+int QgsExpressionContextScope::knownVariableIndex( const QString &name )
+{
+  // indexed by KnownVariable
+  static const std::array< QString, KNOWN_VARIABLE_COUNT > sNames
+  {
+    QgsExpressionContext::EXPR_SYMBOL_COLOR,
+    QgsExpressionContext::EXPR_SYMBOL_ANGLE,
+    QStringLiteral( "symbol_layer_count" ),
+    QStringLiteral( "symbol_layer_index" ),
+    QStringLiteral( "symbol_marker_row" ),
+    QStringLiteral( "symbol_marker_column" ),
+    QgsExpressionContext::EXPR_GEOMETRY_PART_COUNT,
+    QgsExpressionContext::EXPR_GEOMETRY_PART_NUM,
+    QgsExpressionContext::EXPR_GEOMETRY_RING_NUM,
+    QgsExpressionContext::EXPR_GEOMETRY_POINT_COUNT,
+    QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM,
+    QgsExpressionContext::EXPR_CLUSTER_SIZE,
+    QgsExpressionContext::EXPR_CLUSTER_COLOR,
+    QStringLiteral( "map_scale" ),
+  };
+
+  // indices of the names by length, so that at most a few names of the same length are compared
+  constexpr int MAX_NAME_LENGTH = 20;
+  static const std::array< QVector< int >, MAX_NAME_LENGTH + 1 > sIndicesByLength = []
+  {
+    std::array< QVector< int >, MAX_NAME_LENGTH + 1 > indices;
+    for ( int i = 0; i < KNOWN_VARIABLE_COUNT; ++i )
+    {
+      Q_ASSERT( sNames[i].size() <= MAX_NAME_LENGTH );
+      indices[ sNames[i].size() ] << i;
+    }
+    return indices;
+  }();
+
+  if ( name.size() > MAX_NAME_LENGTH )
+    return -1;
+
+  for ( int i : sIndicesByLength[ name.size() ] )
+  {
+    if ( sNames[i].at( 0 ) == name.at( 0 ) && sNames[i] == name )
+      return i;
+  }
+  return -1;
+}
+
+QString QgsExpressionContextScope::knownVariableName( QgsExpressionContextScope::KnownVariable variable )
+{
+  switch ( variable )
+  {
+    case KnownVariable::SymbolColor:
+      return QgsExpressionContext::EXPR_SYMBOL_COLOR;
+    case KnownVariable::SymbolAngle:
+      return QgsExpressionContext::EXPR_SYMBOL_ANGLE;
+    case KnownVariable::SymbolLayerCount:
+      return QStringLiteral( "symbol_layer_count" );
+    case KnownVariable::SymbolLayerIndex:
+      return QStringLiteral( "symbol_layer_index" );
+    case KnownVariable::SymbolMarkerRow:
+      return QStringLiteral( "symbol_marker_row" );
+    case KnownVariable::SymbolMarkerColumn:
+      return QStringLiteral( "symbol_marker_column" );
+    case KnownVariable::GeometryPartCount:
+      return QgsExpressionContext::EXPR_GEOMETRY_PART_COUNT;
+    case KnownVariable::GeometryPartNum:
+      return QgsExpressionContext::EXPR_GEOMETRY_PART_NUM;
+    case KnownVariable::GeometryRingNum:
+      return QgsExpressionContext::EXPR_GEOMETRY_RING_NUM;
+    case KnownVariable::GeometryPointCount:
+      return QgsExpressionContext::EXPR_GEOMETRY_POINT_COUNT;
+    case KnownVariable::GeometryPointNum:
+      return QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM;
+    case KnownVariable::ClusterSize:
+      return QgsExpressionContext::EXPR_CLUSTER_SIZE;
+    case KnownVariable::ClusterColor:
+      return QgsExpressionContext::EXPR_CLUSTER_COLOR;
+    case KnownVariable::MapScale:
+      return QStringLiteral( "map_scale" );
+  }
+  return QString();
+}
+
+bool QgsExpressionContextScope::isKnownVariable( const QString &name, QgsExpressionContextScope::KnownVariable &variable )
+{
+  const int index = knownVariableIndex( name );
+  if ( index < 0 )
+    return false;
+
+  variable = static_cast< KnownVariable >( index );
+  return true;
+}
+
+const QgsExpressionContextScope::StaticVariable *QgsExpressionContextScope::findVariable( const QString &name ) const
+{
+  const int index = knownVariableIndex( name );
+  if ( index >= 0 )
+    return mKnownVariablesSet & ( 1u << index ) ? &mKnownVariables[ index ] : nullptr;
+
+  const auto it = mVariables.constFind( name );
+  return it != mVariables.constEnd() ? &it.value() : nullptr;
+}
+
 void QgsExpressionContextScope::setVariable( const QString &name, const QVariant &value, bool isStatic )
 {
-  if ( mVariables.contains( name ) )
+  if ( const StaticVariable *existingVariable = findVariable( name ) )
   {
-    StaticVariable existing = mVariables.value( name );
+    StaticVariable existing = *existingVariable;
     existing.value = value;
     existing.isStatic = isStatic;
     addVariable( existing );
@@ -93,30 +198,79 @@ void QgsExpressionContextScope::setVariable( const QString &name, const QVariant
 
 void QgsExpressionContextScope::addVariable( const QgsExpressionContextScope::StaticVariable &variable )
 {
+  const int index = knownVariableIndex( variable.name );
+  if ( index >= 0 )
+  {
+    mKnownVariables[ index ] = variable;
+    mKnownVariablesSet |= 1u << index;
+    return;
+  }
+
   mVariables.insert( variable.name, variable );
 }
 
+void QgsExpressionContextScope::setKnownVariable( QgsExpressionContextScope::KnownVariable variable, const QVariant &value, bool isStatic )
+{
+  const int index = static_cast< int >( variable );
+  StaticVariable &slot = mKnownVariables[ index ];
+  if ( !( mKnownVariablesSet & ( 1u << index ) ) )
+  {
+    slot.name = knownVariableName( variable );
+    slot.description.clear();
+    mKnownVariablesSet |= 1u << index;
+  }
+  slot.value = value;
+  slot.readOnly = true;
+  slot.isStatic = isStatic;
+}
+
 bool QgsExpressionContextScope::removeVariable( const QString &name )
 {
+  const int index = knownVariableIndex( name );
+  if ( index >= 0 )
+  {
+    const bool wasSet = mKnownVariablesSet & ( 1u << index );
+    mKnownVariablesSet &= ~( 1u << index );
+    mKnownVariables[ index ] = StaticVariable();
+    return wasSet;
+  }
+
   return mVariables.remove( name ) > 0;
 }
 
 bool QgsExpressionContextScope::hasVariable( const QString &name ) const
 {
-  return mVariables.contains( name );
+  return findVariable( name ) != nullptr;
 }
 
 QVariant QgsExpressionContextScope::variable( const QString &name ) const
 {
-  return hasVariable( name ) ? mVariables.value( name ).value : QVariant();
+  const StaticVariable *variable = findVariable( name );
+  return variable ? variable->value : QVariant();
 }
 
 QStringList QgsExpressionContextScope::variableNames() const
 {
   QStringList names = mVariables.keys();
+  for ( int i = 0; i < KNOWN_VARIABLE_COUNT; ++i )
+  {
+    if ( mKnownVariablesSet & ( 1u << i ) )
+      names << mKnownVariables[ i ].name;
+  }
   return names;
 }
 
+int QgsExpressionContextScope::variableCount() const
+{
+  int count = mVariables.count();
+  for ( int i = 0; i < KNOWN_VARIABLE_COUNT; ++i )
+  {
+    if ( mKnownVariablesSet & ( 1u << i ) )
+      count++;
+  }
+  return count;
+}
+
 /// @cond PRIVATE
 class QgsExpressionContextVariableCompare
 {
@@ -141,7 +295,7 @@ class QgsExpressionContextVariableCompare
 
 QStringList QgsExpressionContextScope::filteredVariableNames() const
 {
-  QStringList allVariables = mVariables.keys();
+  QStringList allVariables = variableNames();
   QStringList filtered;
   const auto constAllVariables = allVariables;
   for ( const QString &variable : constAllVariables )
@@ -159,17 +313,20 @@ QStringList QgsExpressionContextScope::filteredVariableNames() const
 
 bool QgsExpressionContextScope::isReadOnly( const QString &name ) const
 {
-  return hasVariable( name ) ? mVariables.value( name ).readOnly : false;
+  const StaticVariable *variable = findVariable( name );
+  return variable ? variable->readOnly : false;
 }
 
 bool QgsExpressionContextScope::isStatic( const QString &name ) const
 {
-  return hasVariable( name ) ? mVariables.value( name ).isStatic : false;
+  const StaticVariable *variable = findVariable( name );
+  return variable ? variable->isStatic : false;
 }
 
 QString QgsExpressionContextScope::description( const QString &name ) const
 {
-  return hasVariable( name ) ? mVariables.value( name ).description : QString();
+  const StaticVariable *variable = findVariable( name );
+  return variable ? variable->description : QString();
 }
 
 bool QgsExpressionContextScope::hasFunction( const QString &name ) const
@@ -212,11 +369,12 @@ void QgsExpressionContextScope::readXml( const QDomElement &element, const QgsRe
 
 bool QgsExpressionContextScope::writeXml( QDomElement &element, QDomDocument &document, const QgsReadWriteContext & ) const
 {
-  for ( auto it = mVariables.constBegin(); it != mVariables.constEnd(); ++it )
+  const QStringList names = variableNames();
+  for ( const QString &name : names )
   {
     QDomElement varElem = document.createElement( QStringLiteral( "Variable" ) );
-    varElem.setAttribute( QStringLiteral( "name" ), it.key() );
-    QDomElement valueElem = QgsXmlUtils::writeVariant( it.value().value, document );
+    varElem.setAttribute( QStringLiteral( "name" ), name );
+    QDomElement valueElem = QgsXmlUtils::writeVariant( variable( name ), document );
     varElem.appendChild( valueElem );
     element.appendChild( varElem );
   }
@@ -296,10 +454,25 @@ bool QgsExpressionContext::hasVariable( const QString &name ) const
 
 QVariant QgsExpressionContext::variable( const QString &name ) const
 {
+  // well known variables are looked up in the fixed slots of the scopes
+  QgsExpressionContextScope::KnownVariable known;
+  if ( QgsExpressionContextScope::isKnownVariable( name, known ) )
+    return knownVariable( known );
+
   const QgsExpressionContextScope *scope = activeScopeForVariable( name );
   return scope ? scope->variable( name ) : QVariant();
 }
 
+QVariant QgsExpressionContext::knownVariable( QgsExpressionContextScope::KnownVariable variable ) const
+{
+  for ( auto it = mStack.crbegin(); it != mStack.crend(); ++it )
+  {
+    if ( ( *it )->hasKnownVariable( variable ) )
+      return ( *it )->knownVariable( variable );
+  }
+  return QVariant();
+}
+
 QVariantMap QgsExpressionContext::variablesToMap() const
 {
   QStringList names = variableNames();
@@ -25,6 +25,8 @@
 #include "qgsexpressionfunction.h"
 #include "qgsfeature.h"
 
+#include <array>
+
 /**
  * \ingroup core
  * \class QgsScopedExpressionFunction
@@ -150,6 +152,34 @@ class CORE_EXPORT QgsExpressionContextScope
       QString description;
     };
 
+    /**
+     * Well known variables, which are updated for each rendered symbol, geometry part or marker.
+     *
+     * Scopes store these variables in fixed slots, so that they can be set and retrieved without
+     * looking up their name.
+     *
+     * \see setKnownVariable()
+     * \see knownVariable()
+     * \since QGIS 3.22
+     */
+    enum class KnownVariable : int
+    {
+      SymbolColor, //!< Color of the symbol (``symbol_color``)
+      SymbolAngle, //!< Angle of the symbol (``symbol_angle``)
+      SymbolLayerCount, //!< Number of symbol layers in the symbol (``symbol_layer_count``)
+      SymbolLayerIndex, //!< Index of the symbol layer being rendered (``symbol_layer_index``)
+      SymbolMarkerRow, //!< Row of the marker in a point pattern fill (``symbol_marker_row``)
+      SymbolMarkerColumn, //!< Column of the marker in a point pattern fill (``symbol_marker_column``)
+      GeometryPartCount, //!< Number of parts in the rendered geometry (``geometry_part_count``)
+      GeometryPartNum, //!< Number of the geometry part being rendered (``geometry_part_num``)
+      GeometryRingNum, //!< Number of the polygon ring being rendered (``geometry_ring_num``)
+      GeometryPointCount, //!< Number of points in the geometry part being rendered (``geometry_point_count``)
+      GeometryPointNum, //!< Number of the point being rendered (``geometry_point_num``)
+      ClusterSize, //!< Number of symbols in a cluster (``cluster_size``)
+      ClusterColor, //!< Color of the symbols in a cluster (``cluster_color``)
+      MapScale, //!< Scale of the map (``map_scale``)
+    };
+
     /**
      * Constructor for QgsExpressionContextScope
      * \param name friendly display name for the context scope
@@ -188,6 +218,18 @@ class CORE_EXPORT QgsExpressionContextScope
      */
     void addVariable( const QgsExpressionContextScope::StaticVariable &variable );
 
+    /**
+     * Sets the value of a well known read only \a variable, stored in a fixed slot of the scope.
+     *
+     * This is equivalent to adding a read only variable with the name of the well known variable,
+     * but avoids looking up the name. If the \a isStatic parameter is set to TRUE, this variable can
+     * be cached during the execution of QgsExpression::prepare().
+     *
+     * \see knownVariable()
+     * \since QGIS 3.22
+     */
+    void setKnownVariable( QgsExpressionContextScope::KnownVariable variable, const QVariant &value, bool isStatic = false );
+
     /**
      * Removes a variable from the context scope, if found.
      * \param name name of variable to remove
@@ -214,6 +256,38 @@ class CORE_EXPORT QgsExpressionContextScope
      */
     QVariant variable( const QString &name ) const;
 
+    /**
+     * Returns TRUE if the well known \a variable is set in the scope.
+     *
+     * \see knownVariable()
+     * \since QGIS 3.22
+     */
+    bool hasKnownVariable( QgsExpressionContextScope::KnownVariable variable ) const { return ( mKnownVariablesSet & ( 1u << static_cast< int >( variable ) ) ) != 0; }
+
+    /**
+     * Returns the value of the well known \a variable, or an invalid QVariant if it is not set in the scope.
+     *
+     * \see setKnownVariable()
+     * \see hasKnownVariable()
+     * \since QGIS 3.22
+     */
+    QVariant knownVariable( QgsExpressionContextScope::KnownVariable variable ) const { return hasKnownVariable( variable ) ? mKnownVariables[ static_cast< int >( variable ) ].value : QVariant(); }
+
+    /**
+     * Returns the name of a well known \a variable.
+     *
+     * \since QGIS 3.22
+     */
+    static QString knownVariableName( QgsExpressionContextScope::KnownVariable variable );
+
+    /**
+     * Returns TRUE if the variable \a name is a well known variable, and sets \a variable to it.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    static bool isKnownVariable( const QString &name, QgsExpressionContextScope::KnownVariable &variable ) SIP_SKIP;
+
     /**
      * Returns a list of variable names contained within the scope.
      * \see functionNames()
@@ -256,7 +330,7 @@ class CORE_EXPORT QgsExpressionContextScope
     /**
      * Returns the count of variables contained within the scope.
      */
-    int variableCount() const { return mVariables.count(); }
+    int variableCount() const;
 
     /**
      * Tests whether a function with the specified name exists in the scope.
@@ -346,8 +420,20 @@ class CORE_EXPORT QgsExpressionContextScope
     bool writeXml( QDomElement &element, QDomDocument &document, const QgsReadWriteContext &context ) const;
 
   private:
+    static constexpr int KNOWN_VARIABLE_COUNT = static_cast< int >( KnownVariable::MapScale ) + 1;
+
+    //! Returns the slot of the variable \a name, or -1 if it is not a well known variable
+    static int knownVariableIndex( const QString &name );
+
+    //! Returns the variable \a name, or NULLPTR if it is not set in the scope
+    const StaticVariable *findVariable( const QString &name ) const;
+
     QString mName;
     QHash<QString, StaticVariable> mVariables;
+    //! Well known variables, indexed by KnownVariable
+    std::array< StaticVariable, KNOWN_VARIABLE_COUNT > mKnownVariables;
+    //! Bit set of the well known variables set in the scope
+    quint32 mKnownVariablesSet = 0;
     QHash<QString, QgsScopedExpressionFunction * > mFunctions;
     bool mHasFeature = false;
     QgsFeature mFeature;
@@ -411,6 +497,18 @@ class CORE_EXPORT QgsExpressionContext
      */
     QVariant variable( const QString &name ) const;
 
+    /**
+     * Fetches the value of a well known \a variable from the context. The value will be fetched
+     * from the last scope contained within the context which sets the variable.
+     *
+     * This is equivalent to calling variable() with the name of the well known variable, but avoids
+     * looking up the name in each scope.
+     *
+     * \see QgsExpressionContextScope::setKnownVariable()
+     * \since QGIS 3.22
+     */
+    QVariant knownVariable( QgsExpressionContextScope::KnownVariable variable ) const;
+
     /**
      * Returns a map of variable name to value representing all the expression variables
      * contained by the context.
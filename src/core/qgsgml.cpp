@@ -30,16 +30,61 @@
 #include <QProgressDialog>
 #include <QSet>
 #include <QSettings>
+#include <QThreadPool>
 #include <QUrl>
+#include <QtConcurrentMap>
 
 #include "ogr_api.h"
 
+#include <cstring>
 #include <limits>
 
 static const char NS_SEPARATOR = '?';
 static const char *GML_NAMESPACE = "http://www.opengis.net/gml";
 static const char *GML32_NAMESPACE = "http://www.opengis.net/gml/3.2";
 
+//! Minimum size of a batch of elements parsed by a single parser when parsing in parallel
+static const int PARALLEL_PARSING_CHUNK_SIZE = 1024 * 1024;
+
+///@cond PRIVATE
+
+struct QgsGmlStreamingParser::ParallelParsingState
+{
+  bool enabled = false;
+  //! Set when the document cannot be split safely, all data is then parsed sequentially
+  bool unsupported = false;
+  //! Whether this parser has built a first feature, after which batches of elements are parsed in parallel
+  bool armed = false;
+  //! Data received and not parsed yet
+  QByteArray pending;
+  //! Position in pending up to which markup has been scanned
+  int scanPosition = 0;
+  //! Element depth at scanPosition
+  int depth = 0;
+  //! Whether the root element has been closed
+  bool rootClosed = false;
+  //! Positions in pending following the root start tag or the end of a child of the root element
+  QVector<int> boundaries;
+  //! Start of the document up to the root start tag, repeated before each batch of elements
+  QByteArray prologue;
+  //! End tag of the root element, appended after each batch of elements
+  QByteArray rootEndTag;
+
+  //! Set on parsers of a batch of elements, which record the geometry type updates to replay them in order
+  bool recordWkbTypeUpdates = false;
+  QVector< QPair< QgsWkbTypes::Type, bool > > wkbTypeUpdates;
+};
+
+struct QgsGmlStreamingParser::ChunkParse
+{
+  int begin = 0;
+  int end = 0;
+  std::unique_ptr< QgsGmlStreamingParser > parser;
+  bool ok = false;
+};
+
+///@endcond
+
 QgsGml::QgsGml(
   const QString &typeName,
   const QString &geometryAttribute,
@@ -48,6 +93,8 @@ QgsGml::QgsGml(
   , mTypeName( typeName )
   , mFinished( false )
 {
+  mParser.setParallelParsingEnabled( true );
+
   int index = mTypeName.indexOf( ':' );
   if ( index != -1 && index < mTypeName.length() )
   {
@@ -303,6 +350,8 @@ QgsGmlStreamingParser::QgsGmlStreamingParser( const QString &typeName,
   , mNumberReturned( -1 )
   , mNumberMatched( -1 )
   , mFoundUnhandledGeometryElement( false )
+  , mCreateParser( [ = ] { return new QgsGmlStreamingParser( typeName, geometryAttribute, fields, axisOrientationLogic, invertAxisOrientation ); } )
+  , mParallelParsing( std::make_unique< ParallelParsingState >() )
 {
   mThematicAttributes.clear();
   for ( int i = 0; i < fields.size(); i++ )
@@ -363,6 +412,8 @@ QgsGmlStreamingParser::QgsGmlStreamingParser( const QList<LayerProperties> &laye
   , mNumberReturned( -1 )
   , mNumberMatched( -1 )
   , mFoundUnhandledGeometryElement( false )
+  , mCreateParser( [ = ] { return new QgsGmlStreamingParser( layerProperties, fields, mapFieldNameToSrcLayerNameFieldName, axisOrientationLogic, invertAxisOrientation ); } )
+  , mParallelParsing( std::make_unique< ParallelParsingState >() )
 {
   mThematicAttributes.clear();
   for ( int i = 0; i < fields.size(); i++ )
@@ -444,7 +495,369 @@ bool QgsGmlStreamingParser::processData( const QByteArray &data, bool atEnd )
   return true;
 }
 
+void QgsGmlStreamingParser::setParallelParsingEnabled( bool enabled )
+{
+  mParallelParsing->enabled = enabled;
+}
+
 bool QgsGmlStreamingParser::processData( const QByteArray &data, bool atEnd, QString &errorMsg )
+{
+  ParallelParsingState &state = *mParallelParsing;
+  if ( !state.enabled || state.unsupported )
+    return parseSequentially( data, atEnd, errorMsg );
+
+  state.pending.append( data );
+  if ( !scanPendingData() )
+  {
+    // continue sequentially from the current position
+    state.unsupported = true;
+    const QByteArray pending = state.pending;
+    state.pending.clear();
+    state.boundaries.clear();
+    return parseSequentially( pending, atEnd, errorMsg );
+  }
+
+  if ( !state.boundaries.isEmpty() && !parsePendingElements( errorMsg ) )
+    return false;
+
+  if ( atEnd )
+  {
+    const QByteArray pending = state.pending;
+    state.pending.clear();
+    state.scanPosition = 0;
+    return parseSequentially( pending, true, errorMsg );
+  }
+  return true;
+}
+
+///@cond PRIVATE
+
+enum class GmlMarkupType
+{
+  StartTag,
+  EndTag,
+  EmptyElementTag,
+  Other, // comment, processing instruction or CDATA section
+  Unsupported,
+};
+
+/**
+ * Returns the position following the markup starting with the '<' at \a position,
+ * or -1 if the markup is not complete yet.
+ */
+static int scanGmlMarkup( const QByteArray &data, int position, GmlMarkupType &type )
+{
+  const char *bytes = data.constData();
+  const int size = data.size();
+  type = GmlMarkupType::Other;
+  if ( position + 1 >= size )
+    return -1;
+
+  const char next = bytes[position + 1];
+  if ( next == '?' )
+  {
+    const int end = data.indexOf( "?>", position + 2 );
+    return end < 0 ? -1 : end + 2;
+  }
+  if ( next == '!' )
+  {
+    if ( size - position < 4 )
+      return -1;
+    if ( memcmp( bytes + position, "<!--", 4 ) == 0 )
+    {
+      const int end = data.indexOf( "-->", position + 4 );
+      return end < 0 ? -1 : end + 3;
+    }
+    if ( size - position < 9 )
+      return -1;
+    if ( memcmp( bytes + position, "<![CDATA[", 9 ) == 0 )
+    {
+      const int end = data.indexOf( "]]>", position + 9 );
+      return end < 0 ? -1 : end + 3;
+    }
+    // document type declarations may contain markup declarations, which are not split
+    type = GmlMarkupType::Unsupported;
+    return -1;
+  }
+  if ( next == '/' )
+  {
+    const int end = data.indexOf( '>', position + 2 );
+    type = GmlMarkupType::EndTag;
+    return end < 0 ? -1 : end + 1;
+  }
+
+  // start tag, whose attribute values may contain '>'
+  char quote = 0;
+  for ( int i = position + 1; i < size; ++i )
+  {
+    const char c = bytes[i];
+    if ( quote )
+    {
+      if ( c == quote )
+        quote = 0;
+    }
+    else if ( c == '"' || c == '\'' )
+    {
+      quote = c;
+    }
+    else if ( c == '>' )
+    {
+      type = bytes[i - 1] == '/' ? GmlMarkupType::EmptyElementTag : GmlMarkupType::StartTag;
+      return i + 1;
+    }
+  }
+  type = GmlMarkupType::StartTag;
+  return -1;
+}
+
+///@endcond
+
+bool QgsGmlStreamingParser::scanPendingData()
+{
+  ParallelParsingState &state = *mParallelParsing;
+  const QByteArray &data = state.pending;
+  const int size = data.size();
+
+  if ( state.prologue.isEmpty() && state.scanPosition == 0 )
+  {
+    if ( size < 2 )
+      return true;
+    // the document is split on bytes, which requires an encoding compatible with ASCII
+    const unsigned char first = static_cast< unsigned char >( data.at( 0 ) );
+    if ( first == 0xFE || first == 0xFF || data.at( 0 ) == 0 || data.at( 1 ) == 0 )
+      return false;
+  }
+
+  int position = state.scanPosition;
+  while ( position < size && !state.rootClosed )
+  {
+    const char *lt = static_cast< const char * >( memchr( data.constData() + position, '<', size - position ) );
+    if ( !lt )
+    {
+      position = size;
+      break;
+    }
+    position = static_cast< int >( lt - data.constData() );
+
+    GmlMarkupType type;
+    const int end = scanGmlMarkup( data, position, type );
+    if ( type == GmlMarkupType::Unsupported )
+      return false;
+    if ( end < 0 )
+      break;
+
+    switch ( type )
+    {
+      case GmlMarkupType::StartTag:
+        if ( state.depth == 0 )
+        {
+          // root element
+          int nameEnd = position + 1;
+          while ( nameEnd < end && !strchr( " \t\r\n/>", data.at( nameEnd ) ) )
+            ++nameEnd;
+          state.prologue = data.left( end );
+          state.rootEndTag = "</" + data.mid( position + 1, nameEnd - position - 1 ) + '>';
+          state.boundaries << end;
+        }
+        state.depth++;
+        break;
+
+      case GmlMarkupType::EmptyElementTag:
+        // an empty root element has nothing to split
+        if ( state.depth == 0 )
+          return false;
+        if ( state.depth == 1 )
+          state.boundaries << end;
+        break;
+
+      case GmlMarkupType::EndTag:
+        state.depth--;
+        if ( state.depth < 0 )
+          return false;
+        if ( state.depth == 1 )
+          state.boundaries << end;
+        else if ( state.depth == 0 )
+          state.rootClosed = true;
+        break;
+
+      case GmlMarkupType::Other:
+      case GmlMarkupType::Unsupported:
+        break;
+    }
+    position = end;
+  }
+  state.scanPosition = position;
+  return true;
+}
+
+std::unique_ptr< QgsGmlStreamingParser > QgsGmlStreamingParser::createChunkParser() const
+{
+  std::unique_ptr< QgsGmlStreamingParser > parser( mCreateParser() );
+  // State found in previous elements, which affects the parsing of the next ones
+  parser->mGMLNameSpaceURI = mGMLNameSpaceURI;
+  parser->mGMLNameSpaceURIPtr = mGMLNameSpaceURIPtr;
+  parser->mEpsg = mEpsg;
+  parser->mSrsName = mSrsName;
+  parser->mInvertAxisOrientation = mInvertAxisOrientation;
+  parser->mFeatureCount = mFeatureCount;
+  parser->mParallelParsing->recordWkbTypeUpdates = true;
+  return parser;
+}
+
+bool QgsGmlStreamingParser::mergeChunkParser( QgsGmlStreamingParser &chunkParser )
+{
+  // Feature ids follow the document order
+  for ( const QgsGmlFeaturePtrGmlIdPair &featPair : std::as_const( chunkParser.mFeatureList ) )
+  {
+    featPair.first->setId( mFeatureCount );
+    ++mFeatureCount;
+    mFeatureList.push_back( featPair );
+  }
+  chunkParser.mFeatureList.clear();
+
+  for ( const QPair< QgsWkbTypes::Type, bool > &update : std::as_const( chunkParser.mParallelParsing->wkbTypeUpdates ) )
+  {
+    updateWkbType( update.first, update.second );
+  }
+
+  if ( chunkParser.mTruncatedResponse )
+    mTruncatedResponse = true;
+
+  bool foundState = false;
+  if ( !mGMLNameSpaceURIPtr && chunkParser.mGMLNameSpaceURIPtr )
+  {
+    mGMLNameSpaceURI = chunkParser.mGMLNameSpaceURI;
+    mGMLNameSpaceURIPtr = chunkParser.mGMLNameSpaceURIPtr;
+    foundState = true;
+  }
+  if ( mEpsg == 0 && chunkParser.mEpsg != 0 )
+  {
+    mEpsg = chunkParser.mEpsg;
+    mSrsName = chunkParser.mSrsName;
+    mInvertAxisOrientation = chunkParser.mInvertAxisOrientation;
+    foundState = true;
+  }
+  return foundState;
+}
+
+bool QgsGmlStreamingParser::parsePendingElements( QString &errorMsg )
+{
+  ParallelParsingState &state = *mParallelParsing;
+  const int regionEnd = state.boundaries.last();
+
+  // Removes the data up to the last boundary, which is handed to the parsers
+  const auto consumeRegion = [&state, regionEnd]
+  {
+    state.pending.remove( 0, regionEnd );
+    state.scanPosition -= regionEnd;
+    state.boundaries.clear();
+  };
+
+  int regionBegin = 0;
+  if ( !state.armed )
+  {
+    // The start of the document is parsed by this parser, until a first feature is built
+    for ( const int boundary : std::as_const( state.boundaries ) )
+    {
+      if ( !parseSequentially( state.pending.mid( regionBegin, boundary - regionBegin ), false, errorMsg ) )
+      {
+        consumeRegion();
+        return false;
+      }
+      regionBegin = boundary;
+      state.armed = mFeatureCount > 0 && !mIsException && !state.prologue.isEmpty();
+      if ( state.armed )
+        break;
+    }
+    if ( regionBegin == regionEnd )
+    {
+      consumeRegion();
+      return true;
+    }
+  }
+
+  // Split the remaining complete elements in batches
+  std::vector< ChunkParse > chunks;
+  int chunkBegin = regionBegin;
+  for ( const int boundary : std::as_const( state.boundaries ) )
+  {
+    if ( boundary - chunkBegin >= PARALLEL_PARSING_CHUNK_SIZE )
+    {
+      ChunkParse chunk;
+      chunk.begin = chunkBegin;
+      chunk.end = boundary;
+      chunks.push_back( std::move( chunk ) );
+      chunkBegin = boundary;
+    }
+  }
+  if ( chunkBegin < regionEnd )
+  {
+    ChunkParse chunk;
+    chunk.begin = chunkBegin;
+    chunk.end = regionEnd;
+    chunks.push_back( std::move( chunk ) );
+  }
+
+  if ( chunks.size() < 2 || QThreadPool::globalInstance()->maxThreadCount() < 2 )
+  {
+    const QByteArray region = state.pending.mid( regionBegin, regionEnd - regionBegin );
+    consumeRegion();
+    return parseSequentially( region, false, errorMsg );
+  }
+
+  std::size_t next = 0;
+  while ( next < chunks.size() )
+  {
+    // Parsers start from the state of this parser. If a batch finds state which
+    // later batches depend on, such as the CRS, the following batches are parsed again
+    for ( std::size_t i = next; i < chunks.size(); ++i )
+    {
+      chunks[i].parser = createChunkParser();
+    }
+
+    const QByteArray &pending = state.pending;
+    QtConcurrent::blockingMap( chunks.begin() + static_cast< std::ptrdiff_t >( next ), chunks.end(), [&state, &pending]( ChunkParse & chunk )
+    {
+      QByteArray document;
+      document.reserve( state.prologue.size() + chunk.end - chunk.begin + state.rootEndTag.size() );
+      document.append( state.prologue );
+      document.append( pending.constData() + chunk.begin, chunk.end - chunk.begin );
+      document.append( state.rootEndTag );
+      QString chunkErrorMsg;
+      chunk.ok = chunk.parser->parseSequentially( document, true, chunkErrorMsg );
+    } );
+
+    std::size_t restart = chunks.size();
+    for ( std::size_t i = next; i < chunks.size(); ++i )
+    {
+      ChunkParse &chunk = chunks[i];
+      if ( !chunk.ok )
+      {
+        // Let this parser report the error from the start of the failing batch
+        const QByteArray region = state.pending.mid( chunk.begin, regionEnd - chunk.begin );
+        consumeRegion();
+        return parseSequentially( region, false, errorMsg );
+      }
+      const bool foundState = mergeChunkParser( *chunk.parser );
+      chunk.parser.reset();
+      if ( foundState && i + 1 < chunks.size() )
+      {
+        restart = i + 1;
+        break;
+      }
+    }
+    for ( std::size_t i = restart; i < chunks.size(); ++i )
+    {
+      chunks[i].parser.reset();
+    }
+    next = restart;
+  }
+
+  consumeRegion();
+  return true;
+}
+
+bool QgsGmlStreamingParser::parseSequentially( const QByteArray &data, bool atEnd, QString &errorMsg )
 {
   if ( XML_Parse( mParser, data.data(), data.size(), atEnd ) == 0 )
   {
@@ -460,6 +873,21 @@ bool QgsGmlStreamingParser::processData( const QByteArray &data, bool atEnd, QSt
   return true;
 }
 
+void QgsGmlStreamingParser::updateWkbType( QgsWkbTypes::Type type, bool keepMultiType )
+{
+  ParallelParsingState &state = *mParallelParsing;
+  if ( state.recordWkbTypeUpdates )
+  {
+    // consecutive identical updates have the same effect as a single one
+    const QPair< QgsWkbTypes::Type, bool > update( type, keepMultiType );
+    if ( state.wkbTypeUpdates.isEmpty() || state.wkbTypeUpdates.last() != update )
+      state.wkbTypeUpdates << update;
+  }
+
+  if ( !keepMultiType || mWkbType != QgsWkbTypes::multiType( type ) )
+    mWkbType = type;
+}
+
 QVector<QgsGmlStreamingParser::QgsGmlFeaturePtrGmlIdPair> QgsGmlStreamingParser::getAndStealReadyFeatures()
 {
   QVector<QgsGmlFeaturePtrGmlIdPair> ret = mFeatureList;
@@ -1026,10 +1454,7 @@ void QgsGmlStreamingParser::endElement( const XML_Char *el )
         //error
       }
 
-      if ( mWkbType != QgsWkbTypes::MultiPoint ) //keep multitype in case of geometry type mix
-      {
-        mWkbType = QgsWkbTypes::Point;
-      }
+      updateWkbType( QgsWkbTypes::Point, true ); //keep multitype in case of geometry type mix
     }
     else //multipoint, add WKB as fragment
     {
@@ -1065,10 +1490,7 @@ void QgsGmlStreamingParser::endElement( const XML_Char *el )
         //error
       }
 
-      if ( mWkbType != QgsWkbTypes::MultiLineString )//keep multitype in case of geometry type mix
-      {
-        mWkbType = QgsWkbTypes::LineString;
-      }
+      updateWkbType( QgsWkbTypes::LineString, true ); //keep multitype in case of geometry type mix
     }
     else //multiline, add WKB as fragment
     {
@@ -1116,10 +1538,7 @@ void QgsGmlStreamingParser::endElement( const XML_Char *el )
   else if ( ( parseMode == Geometry || parseMode == MultiPolygon ) && isGMLNS &&
             LOCALNAME_EQUALS( "Polygon" ) )
   {
-    if ( mWkbType != QgsWkbTypes::MultiPolygon )//keep multitype in case of geometry type mix
-    {
-      mWkbType = QgsWkbTypes::Polygon;
-    }
+    updateWkbType( QgsWkbTypes::Polygon, true ); //keep multitype in case of geometry type mix
 
     if ( parseMode == Geometry )
     {
@@ -1129,21 +1548,21 @@ void QgsGmlStreamingParser::endElement( const XML_Char *el )
   else if ( parseMode == MultiPoint &&  isGMLNS &&
             LOCALNAME_EQUALS( "MultiPoint" ) )
   {
-    mWkbType = QgsWkbTypes::MultiPoint;
+    updateWkbType( QgsWkbTypes::MultiPoint );
     mParseModeStack.pop();
     createMultiPointFromFragments();
   }
   else if ( parseMode == MultiLine && isGMLNS &&
             ( LOCALNAME_EQUALS( "MultiLineString" )  || LOCALNAME_EQUALS( "MultiCurve" ) ) )
   {
-    mWkbType = QgsWkbTypes::MultiLineString;
+    updateWkbType( QgsWkbTypes::MultiLineString );
     mParseModeStack.pop();
     createMultiLineFromFragments();
   }
   else if ( parseMode == MultiPolygon && isGMLNS &&
             ( LOCALNAME_EQUALS( "MultiPolygon" )  || LOCALNAME_EQUALS( "MultiSurface" ) ) )
   {
-    mWkbType = QgsWkbTypes::MultiPolygon;
+    updateWkbType( QgsWkbTypes::MultiPolygon );
     mParseModeStack.pop();
     createMultiPolygonFromFragments();
   }
@@ -1466,7 +1885,7 @@ int QgsGmlStreamingParser::createMultiLineFromFragments()
   }
 
   mCurrentWKBFragments.clear();
-  mWkbType = QgsWkbTypes::MultiLineString;
+  updateWkbType( QgsWkbTypes::MultiLineString );
   return 0;
 }
 
@@ -1487,7 +1906,7 @@ int QgsGmlStreamingParser::createMultiPointFromFragments()
   }
 
   mCurrentWKBFragments.clear();
-  mWkbType = QgsWkbTypes::MultiPoint;
+  updateWkbType( QgsWkbTypes::MultiPoint );
   return 0;
 }
 
@@ -1509,7 +1928,7 @@ int QgsGmlStreamingParser::createPolygonFromFragments()
   }
 
   mCurrentWKBFragments.clear();
-  mWkbType = QgsWkbTypes::Polygon;
+  updateWkbType( QgsWkbTypes::Polygon );
   return 0;
 }
 
@@ -1543,7 +1962,7 @@ int QgsGmlStreamingParser::createMultiPolygonFromFragments()
   }
 
   mCurrentWKBFragments.clear();
-  mWkbType = QgsWkbTypes::MultiPolygon;
+  updateWkbType( QgsWkbTypes::MultiPolygon );
   return 0;
 }
 
@@ -30,6 +30,8 @@
 #include <QStack>
 #include <QVector>
 
+#include <functional>
+#include <memory>
 #include <string>
 
 class QgsCoordinateReferenceSystem;
@@ -147,8 +149,28 @@ class CORE_EXPORT QgsGmlStreamingParser
     //! Returns whether a "truncatedResponse" element is found
     bool isTruncatedResponse() const { return mTruncatedResponse; }
 
+    /**
+     * Sets whether large documents can be parsed concurrently.
+     *
+     * When enabled, the data passed to processData() is split after each child
+     * of the root element (e.g. wfs:member or gml:featureMember), and batches of
+     * complete children are parsed by several parsers in parallel. Features are
+     * returned in document order, with the same ids, geometries and attributes as
+     * when the document is parsed sequentially.
+     *
+     * Parallel parsing is disabled by default.
+     *
+     * \since QGIS 3.22
+     */
+    void setParallelParsingEnabled( bool enabled );
+
   private:
 
+    //! State of parallel parsing, defined in the implementation
+    struct ParallelParsingState;
+    //! Parse of a batch of children of the root element by another parser
+    struct ChunkParse;
+
     enum ParseMode
     {
       None,
@@ -247,6 +269,27 @@ class CORE_EXPORT QgsGmlStreamingParser
     //! Adds all the integers contained in mCurrentWKBFragmentSizes
     int totalWKBFragmentSize() const;
 
+    //! Parses \a data with the expat parser of this parser
+    bool parseSequentially( const QByteArray &data, bool atEnd, QString &errorMsg );
+
+    /**
+     * Finds the ends of the children of the root element in the data pending for parallel parsing.
+     * Returns FALSE if the document cannot be split safely.
+     */
+    bool scanPendingData();
+
+    //! Parses the complete children of the root element pending for parallel parsing
+    bool parsePendingElements( QString &errorMsg );
+
+    //! Returns a parser for a batch of children of the root element, starting from the current state of this parser
+    std::unique_ptr< QgsGmlStreamingParser > createChunkParser() const;
+
+    //! Appends the features parsed by a \a chunkParser, returns TRUE if it found state that later batches depend on
+    bool mergeChunkParser( QgsGmlStreamingParser &chunkParser );
+
+    //! Sets the geometry type, keeping a multi type of the same geometry family if \a keepMultiType is TRUE
+    void updateWkbType( QgsWkbTypes::Type type, bool keepMultiType = false );
+
     //! Gets safely (if empty) top from mode stack
     ParseMode modeStackTop() { return mParseModeStack.isEmpty() ? None : mParseModeStack.top(); }
 
@@ -344,6 +387,9 @@ class CORE_EXPORT QgsGmlStreamingParser
     std::string mGeometryString;
     //! Whether we found a unhandled geometry element
     bool mFoundUnhandledGeometryElement;
+    //! Creates a parser with the same configuration as this one
+    std::function< QgsGmlStreamingParser *() > mCreateParser;
+    std::unique_ptr< ParallelParsingState > mParallelParsing;
 };
 
 #endif
@@ -27,6 +27,90 @@
 #include "qgsgeometryengine.h"
 #include "qgsexpressioncontextutils.h"
 #include "qgsmarkersymbol.h"
+#include "qgsreadwritecontext.h"
+
+#include <QCache>
+#include <QCryptographicHash>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QMutex>
+
+#include <cmath>
+
+///@cond PRIVATE
+
+//! Hit test results stored for tiles of layer extents, shared by all hit tests
+class QgsMapHitTestCache
+{
+  public:
+
+    struct Entry
+    {
+      QSet<QString> symbols;
+      QSet<QString> ruleKeys;
+      QElapsedTimer timer;
+    };
+
+    void setMaxAge( int age )
+    {
+      QMutexLocker locker( &mMutex );
+      mMaxAge = age;
+      if ( mMaxAge <= 0 )
+        mEntries.clear();
+    }
+
+    int maxAge()
+    {
+      QMutexLocker locker( &mMutex );
+      return mMaxAge;
+    }
+
+    void clear()
+    {
+      QMutexLocker locker( &mMutex );
+      mEntries.clear();
+    }
+
+    bool lookup( const QString &key, QSet<QString> &symbols, QSet<QString> &ruleKeys )
+    {
+      QMutexLocker locker( &mMutex );
+      const Entry *entry = mEntries.object( key );
+      if ( !entry )
+        return false;
+
+      if ( entry->timer.elapsed() > static_cast< qint64 >( mMaxAge ) * 1000 )
+      {
+        mEntries.remove( key );
+        return false;
+      }
+
+      symbols = entry->symbols;
+      ruleKeys = entry->ruleKeys;
+      return true;
+    }
+
+    void insert( const QString &key, const QSet<QString> &symbols, const QSet<QString> &ruleKeys )
+    {
+      QMutexLocker locker( &mMutex );
+      if ( mMaxAge <= 0 )
+        return;
+
+      Entry *entry = new Entry;
+      entry->symbols = symbols;
+      entry->ruleKeys = ruleKeys;
+      entry->timer.start();
+      mEntries.insert( key, entry );
+    }
+
+  private:
+    QMutex mMutex;
+    int mMaxAge = 0;
+    QCache< QString, Entry > mEntries{ 10000 };
+};
+
+Q_GLOBAL_STATIC( QgsMapHitTestCache, sHitTestCache )
+
+///@endcond
 
 QgsMapHitTest::QgsMapHitTest( const QgsMapSettings &settings, const QgsGeometry &polygon, const LayerFilterExpression &layerFilterExpression )
   : mSettings( settings )
@@ -102,6 +186,36 @@ bool QgsMapHitTest::legendKeyVisible( const QString &ruleKey, QgsVectorLayer *la
   return mHitTestRuleKey.value( layer ).contains( ruleKey );
 }
 
+void QgsMapHitTest::setCacheMaxAge( int age )
+{
+  sHitTestCache()->setMaxAge( age );
+}
+
+int QgsMapHitTest::cacheMaxAge()
+{
+  return sHitTestCache()->maxAge();
+}
+
+void QgsMapHitTest::clearCache()
+{
+  sHitTestCache()->clear();
+}
+
+QString QgsMapHitTest::cacheKey( QgsVectorLayer *vl, QgsFeatureRenderer *r, const QString &expression ) const
+{
+  // the style is identified by the saved renderer, so that changes to the renderer give a new key
+  QDomDocument doc;
+  doc.appendChild( r->save( doc, QgsReadWriteContext() ) );
+  const QByteArray rendererHash = QCryptographicHash::hash( doc.toByteArray(), QCryptographicHash::Md5 ).toHex();
+
+  return QStringLiteral( "%1|%2|%3|%4|%5|%6" ).arg( vl->id(),
+         QString::number( reinterpret_cast< quintptr >( vl ) ),
+         QString::fromLatin1( rendererHash ),
+         QString::number( mSettings.scale(), 'g', 12 ),
+         vl->subsetString(),
+         expression );
+}
+
 void QgsMapHitTest::runHitTestLayer( QgsVectorLayer *vl, SymbolSet &usedSymbols, SymbolSet &usedSymbolsRuleKey, QgsRenderContext &context )
 {
   QgsMapLayerStyleOverride styleOverride( vl );
@@ -110,6 +224,16 @@ void QgsMapHitTest::runHitTestLayer( QgsVectorLayer *vl, SymbolSet &usedSymbols,
 
   std::unique_ptr< QgsFeatureRenderer > r( vl->renderer()->clone() );
   bool moreSymbolsPerFeature = r->capabilities() & QgsFeatureRenderer::MoreSymbolsPerFeature;
+
+  bool hasExpression = mLayerFilterExpression.contains( vl->id() );
+  const QString expressionString = mLayerFilterExpression.value( vl->id() );
+
+  // results are only stored for hit tests filtered by the map extent
+  const QgsRectangle extent = context.extent();
+  const bool useCache = !mOnlyExpressions && mPolygon.isNull() && sHitTestCache()->maxAge() > 0
+                        && extent.width() > 0 && extent.height() > 0;
+  const QString layerCacheKey = useCache ? cacheKey( vl, r.get(), expressionString ) : QString();
+
   r->startRender( context, vl->fields() );
 
   QgsGeometry transformedPolygon = mPolygon;
@@ -122,80 +246,183 @@ void QgsMapHitTest::runHitTestLayer( QgsVectorLayer *vl, SymbolSet &usedSymbols,
     }
   }
 
-  QgsFeature f;
-  QgsFeatureRequest request;
+  std::unique_ptr<QgsExpression> expr;
+  if ( hasExpression )
+  {
+    expr.reset( new QgsExpression( expressionString ) );
+    expr->prepare( &context.expressionContext() );
+  }
+
+  // only fetch the attributes needed by the renderer and the filter expression
+  QgsFeatureRequest baseRequest;
+  QSet<QString> attributes = r->usedAttributes( context );
+  if ( expr )
+    attributes.unite( expr->referencedColumns() );
+  if ( !attributes.contains( QgsFeatureRequest::ALL_ATTRIBUTES ) )
+    baseRequest.setSubsetOfAttributes( attributes, vl->fields() );
+
   std::unique_ptr< QgsGeometryEngine > polygonEngine;
-  if ( !mOnlyExpressions )
+  if ( !mOnlyExpressions && !mPolygon.isNull() )
   {
-    if ( mPolygon.isNull() )
-    {
-      request.setFilterRect( context.extent() );
-      request.setFlags( QgsFeatureRequest::ExactIntersect );
-    }
-    else
-    {
-      request.setFilterRect( transformedPolygon.boundingBox() );
-      polygonEngine.reset( QgsGeometry::createGeometryEngine( transformedPolygon.constGet() ) );
-      polygonEngine->prepareGeometry();
-    }
+    polygonEngine.reset( QgsGeometry::createGeometryEngine( transformedPolygon.constGet() ) );
+    polygonEngine->prepareGeometry();
   }
-  QgsFeatureIterator fi = vl->getFeatures( request );
 
-  SymbolSet lUsedSymbols;
-  SymbolSet lUsedSymbolsRuleKey;
-  bool allExpressionFalse = false;
-  bool hasExpression = mLayerFilterExpression.contains( vl->id() );
-  std::unique_ptr<QgsExpression> expr;
-  if ( hasExpression )
+  // features stop being read once every legend key and legend symbol of the renderer is found,
+  // as the results are only queried for legend items
+  SymbolSet legendSymbols;
+  SymbolSet legendRuleKeys;
+  const QgsLegendSymbolList legendItems = r->legendSymbolItems();
+  for ( const QgsLegendSymbolItem &item : legendItems )
   {
-    expr.reset( new QgsExpression( mLayerFilterExpression[vl->id()] ) );
-    expr->prepare( &context.expressionContext() );
+    if ( !item.ruleKey().isEmpty() )
+      legendRuleKeys.insert( item.ruleKey() );
+    if ( item.symbol() )
+      legendSymbols.insert( QgsSymbolLayerUtils::symbolProperties( item.symbol() ) );
   }
-  while ( fi.nextFeature( f ) )
+
+  // symbols owned by the renderer are described once, other symbols (e.g. embedded in features) for each feature
+  QHash< const QgsSymbol *, QString > rendererSymbols;
+  const QgsSymbolList constRendererSymbols = r->symbols( context );
+  for ( const QgsSymbol *s : constRendererSymbols )
+    rendererSymbols.insert( s, QString() );
+
+  auto symbolProperties = [&rendererSymbols]( QgsSymbol * s ) -> QString
+  {
+    auto it = rendererSymbols.find( s );
+    if ( it == rendererSymbols.end() )
+      return QgsSymbolLayerUtils::symbolProperties( s );
+    if ( it.value().isNull() )
+      it.value() = QgsSymbolLayerUtils::symbolProperties( s );
+    return it.value();
+  };
+
+  auto allFound = [&legendSymbols, &legendRuleKeys]( const SymbolSet & symbols, const SymbolSet & ruleKeys )
+  {
+    return !legendRuleKeys.isEmpty() && symbols.contains( legendSymbols ) && ruleKeys.contains( legendRuleKeys );
+  };
+
+  bool allExpressionFalse = false;
+
+  // reads the features of a request and adds their symbols and legend keys to the sets,
+  // returns TRUE if all the legend items were found
+  auto scan = [&]( const QgsFeatureRequest & request, SymbolSet & lUsedSymbols, SymbolSet & lUsedSymbolsRuleKey ) -> bool
   {
-    context.expressionContext().setFeature( f );
-    // filter out elements outside of the polygon
-    if ( f.hasGeometry() && polygonEngine )
+    QgsFeature f;
+    QgsFeatureIterator fi = vl->getFeatures( request );
+    while ( fi.nextFeature( f ) )
     {
-      if ( !polygonEngine->intersects( f.geometry().constGet() ) )
+      context.expressionContext().setFeature( f );
+      // filter out elements outside of the polygon
+      if ( f.hasGeometry() && polygonEngine )
       {
-        continue;
+        if ( !polygonEngine->intersects( f.geometry().constGet() ) )
+        {
+          continue;
+        }
       }
-    }
 
-    // filter out elements where the expression is false
-    if ( hasExpression )
-    {
-      if ( !expr->evaluate( &context.expressionContext() ).toBool() )
-        continue;
-      else
-        allExpressionFalse = false;
-    }
+      // filter out elements where the expression is false
+      if ( hasExpression )
+      {
+        if ( !expr->evaluate( &context.expressionContext() ).toBool() )
+          continue;
+        else
+          allExpressionFalse = false;
+      }
 
-    //make sure we store string representation of symbol, not pointer
-    //otherwise layer style override changes will delete original symbols and leave hanging pointers
-    const auto constLegendKeysForFeature = r->legendKeysForFeature( f, context );
-    for ( const QString &legendKey : constLegendKeysForFeature )
-    {
-      lUsedSymbolsRuleKey.insert( legendKey );
-    }
+      bool foundNew = false;
 
-    if ( moreSymbolsPerFeature )
-    {
-      const auto constOriginalSymbolsForFeature = r->originalSymbolsForFeature( f, context );
-      for ( QgsSymbol *s : constOriginalSymbolsForFeature )
+      //make sure we store string representation of symbol, not pointer
+      //otherwise layer style override changes will delete original symbols and leave hanging pointers
+      const auto constLegendKeysForFeature = r->legendKeysForFeature( f, context );
+      for ( const QString &legendKey : constLegendKeysForFeature )
+      {
+        if ( !lUsedSymbolsRuleKey.contains( legendKey ) )
+        {
+          lUsedSymbolsRuleKey.insert( legendKey );
+          foundNew = true;
+        }
+      }
+
+      const QgsSymbolList featureSymbols = moreSymbolsPerFeature ? r->originalSymbolsForFeature( f, context )
+                                           : QgsSymbolList() << r->originalSymbolForFeature( f, context );
+      for ( QgsSymbol *s : featureSymbols )
       {
-        if ( s )
-          lUsedSymbols.insert( QgsSymbolLayerUtils::symbolProperties( s ) );
+        if ( !s )
+          continue;
+
+        const QString properties = symbolProperties( s );
+        if ( !lUsedSymbols.contains( properties ) )
+        {
+          lUsedSymbols.insert( properties );
+          foundNew = true;
+        }
       }
+
+      if ( foundNew && allFound( lUsedSymbols, lUsedSymbolsRuleKey ) )
+        return true;
+    }
+    return false;
+  };
+
+  SymbolSet lUsedSymbols;
+  SymbolSet lUsedSymbolsRuleKey;
+
+  if ( mOnlyExpressions )
+  {
+    scan( baseRequest, lUsedSymbols, lUsedSymbolsRuleKey );
+  }
+  else if ( polygonEngine )
+  {
+    scan( QgsFeatureRequest( baseRequest ).setFilterRect( transformedPolygon.boundingBox() ), lUsedSymbols, lUsedSymbolsRuleKey );
+  }
+  else
+  {
+    // Tiles are a quarter to an eighth of the extent size, on a grid which only depends on that size,
+    // so that extents of the same size share the results of the tiles they fully cover.
+    const double tileSize = useCache ? std::pow( 2.0, std::floor( std::log2( std::max( extent.width(), extent.height() ) / 4 ) ) ) : 0;
+    const qint64 firstColumn = useCache ? static_cast< qint64 >( std::floor( extent.xMinimum() / tileSize ) ) : 0;
+    const qint64 lastColumn = useCache ? static_cast< qint64 >( std::ceil( extent.xMaximum() / tileSize ) ) - 1 : 0;
+    const qint64 firstRow = useCache ? static_cast< qint64 >( std::floor( extent.yMinimum() / tileSize ) ) : 0;
+    const qint64 lastRow = useCache ? static_cast< qint64 >( std::ceil( extent.yMaximum() / tileSize ) ) - 1 : 0;
+
+    if ( !useCache || ( lastColumn - firstColumn + 1 ) * ( lastRow - firstRow + 1 ) > 100 )
+    {
+      scan( QgsFeatureRequest( baseRequest ).setFilterRect( extent ).setFlags( QgsFeatureRequest::ExactIntersect ), lUsedSymbols, lUsedSymbolsRuleKey );
     }
     else
     {
-      QgsSymbol *s = r->originalSymbolForFeature( f, context );
-      if ( s )
-        lUsedSymbols.insert( QgsSymbolLayerUtils::symbolProperties( s ) );
+      bool done = false;
+      for ( qint64 row = firstRow; row <= lastRow && !done; ++row )
+      {
+        for ( qint64 column = firstColumn; column <= lastColumn && !done; ++column )
+        {
+          const QgsRectangle tile( column * tileSize, row * tileSize, ( column + 1 ) * tileSize, ( row + 1 ) * tileSize );
+          if ( !extent.contains( tile ) )
+          {
+            // tiles on the border of the extent are only partially tested, their results are not stored
+            const QgsRectangle part = tile.intersect( extent );
+            done = scan( QgsFeatureRequest( baseRequest ).setFilterRect( part ).setFlags( QgsFeatureRequest::ExactIntersect ), lUsedSymbols, lUsedSymbolsRuleKey );
+            continue;
+          }
+
+          const QString tileKey = QStringLiteral( "%1|%2|%3|%4" ).arg( layerCacheKey ).arg( tileSize, 0, 'g', 17 ).arg( column ).arg( row );
+          SymbolSet tileSymbols;
+          SymbolSet tileRuleKeys;
+          if ( !sHitTestCache()->lookup( tileKey, tileSymbols, tileRuleKeys ) )
+          {
+            scan( QgsFeatureRequest( baseRequest ).setFilterRect( tile ).setFlags( QgsFeatureRequest::ExactIntersect ), tileSymbols, tileRuleKeys );
+            sHitTestCache()->insert( tileKey, tileSymbols, tileRuleKeys );
+          }
+          lUsedSymbols.unite( tileSymbols );
+          lUsedSymbolsRuleKey.unite( tileRuleKeys );
+          done = allFound( lUsedSymbols, lUsedSymbolsRuleKey );
+        }
+      }
     }
   }
+
   r->stopRender( context );
 
   if ( !allExpressionFalse )
@@ -205,4 +432,3 @@ void QgsMapHitTest::runHitTestLayer( QgsVectorLayer *vl, SymbolSet &usedSymbols,
     usedSymbolsRuleKey = lUsedSymbolsRuleKey;
   }
 }
-
@@ -23,6 +23,7 @@
 #include <QSet>
 
 class QgsRenderContext;
+class QgsFeatureRenderer;
 class QgsSymbol;
 class QgsVectorLayer;
 class QgsExpression;
@@ -71,6 +72,38 @@ class CORE_EXPORT QgsMapHitTest
      */
     bool legendKeyVisible( const QString &ruleKey, QgsVectorLayer *layer ) const;
 
+    /**
+     * Sets the maximum \a age, in seconds, of the hit test results stored for reuse by later hit tests.
+     *
+     * When \a age is greater than 0, hit tests filtered by the map extent store their results for tiles
+     * of the extent, for each layer, style, subset string, filter expression and map scale. Hit tests of
+     * overlapping or adjacent extents then only read the features of tiles which were not tested yet.
+     * Changes to the data of a layer are only taken into account once the stored results expire.
+     *
+     * The default value of 0 disables storing results.
+     *
+     * \see cacheMaxAge()
+     * \see clearCache()
+     * \since QGIS 3.22
+     */
+    static void setCacheMaxAge( int age );
+
+    /**
+     * Returns the maximum age, in seconds, of the hit test results stored for reuse by later hit tests.
+     *
+     * \see setCacheMaxAge()
+     * \since QGIS 3.22
+     */
+    static int cacheMaxAge();
+
+    /**
+     * Removes all the hit test results stored for reuse by later hit tests.
+     *
+     * \see setCacheMaxAge()
+     * \since QGIS 3.22
+     */
+    static void clearCache();
+
   private:
 
     //! \note not available in Python bindings
@@ -90,6 +123,12 @@ class CORE_EXPORT QgsMapHitTest
      */
     void runHitTestLayer( QgsVectorLayer *vl, SymbolSet &usedSymbols, SymbolSet &usedSymbolsRuleKey, QgsRenderContext &context );
 
+    /**
+     * Returns the key of the results stored for tiles of \a vl, rendered with renderer \a r
+     * and filtered by \a expression.
+     */
+    QString cacheKey( QgsVectorLayer *vl, QgsFeatureRenderer *r, const QString &expression ) const;
+
     //! The initial map settings
     QgsMapSettings mSettings;
 
@@ -676,6 +676,15 @@ QString QgsMapLayer::decodedSource( const QString &source, const QString &dataPr
   return source;
 }
 
+QgsDataProvider *QgsMapLayer::takePreloadedProvider( const QString &providerKey, const QString &dataSource, QgsDataProvider::ReadFlags flags )
+{
+  std::unique_ptr< QgsDataProvider > provider = std::move( mPreloadedProvider );
+  if ( !provider || providerKey != mPreloadedProviderKey || dataSource != mPreloadedProviderSource || flags != mPreloadedProviderFlags )
+    return nullptr;
+
+  return provider.release();
+}
+
 void QgsMapLayer::resolveReferences( QgsProject *project )
 {
   emit beforeResolveReferences( project );
@@ -28,6 +28,8 @@
 #include <QVariant>
 #include <QIcon>
 
+#include <memory>
+
 #include "qgis_sip.h"
 #include "qgserror.h"
 #include "qgsobjectcustomproperties.h"
@@ -1824,6 +1826,17 @@ class CORE_EXPORT QgsMapLayer : public QObject
      */
     virtual QString decodedSource( const QString &source, const QString &dataProvider, const QgsReadWriteContext &context ) const;
 
+    /**
+     * Takes the data provider created ahead of the layer by QgsProject while reading a project.
+     *
+     * The provider is only returned if it was created for the same \a providerKey, \a dataSource and
+     * \a flags, otherwise it is discarded and NULLPTR is returned. The caller takes ownership of the provider.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    QgsDataProvider *takePreloadedProvider( const QString &providerKey, const QString &dataSource, QgsDataProvider::ReadFlags flags ) SIP_SKIP;
+
     /**
      * Read custom properties from project file.
      * \param layerNode note to read from
@@ -2056,7 +2069,14 @@ class CORE_EXPORT QgsMapLayer : public QObject
     //! Path to placeholder image for layer legend. If the string is empty, a generated legend is shown
     QString mLegendPlaceholderImage;
 
+    //! Data provider created ahead by QgsProject, see takePreloadedProvider()
+    std::unique_ptr< QgsDataProvider > mPreloadedProvider;
+    QString mPreloadedProviderKey;
+    QString mPreloadedProviderSource;
+    QgsDataProvider::ReadFlags mPreloadedProviderFlags;
+
     friend class QgsVectorLayer;
+    friend class QgsProject;
 };
 
 Q_DECLARE_METATYPE( QgsMapLayer * )
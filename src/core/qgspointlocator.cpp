@@ -786,6 +786,30 @@ class QgsPointLocator_VisitorMiddlesInRect : public IVisitor
     QgsPointLocator::MatchFilter *mFilter = nullptr;
 };
 
+/**
+ * \ingroup core
+ * \brief Helper class used when traversing the index to collect the ids of the features in a rectangle.
+ * \note not available in Python bindings
+*/
+class QgsPointLocator_VisitorIdsInRect : public IVisitor
+{
+  public:
+    explicit QgsPointLocator_VisitorIdsInRect( QgsFeatureIds &ids )
+      : mIds( ids )
+    {}
+
+    void visitNode( const INode &n ) override { Q_UNUSED( n ) }
+    void visitData( std::vector<const IData *> &v ) override { Q_UNUSED( v ) }
+
+    void visitData( const IData &d ) override
+    {
+      mIds << d.getIdentifier();
+    }
+
+  private:
+    QgsFeatureIds &mIds;
+};
+
 ////////////////////////////////////////////////////////////////////////////
 #include <QStack>
 
@@ -884,6 +908,183 @@ void QgsPointLocator::setExtent( const QgsRectangle *extent )
   mExtent.reset( extent ? new QgsRectangle( *extent ) : nullptr );
 
   destroyIndex();
+
+  mTileSize = 0;
+  mIndexedTiles.clear();
+  mPendingTiles.clear();
+}
+
+void QgsPointLocator::extendExtent( const QgsRectangle &extent, double tileSize )
+{
+  if ( mIsIndexing )
+    // already indexing, return!
+    return;
+
+  if ( tileSize <= 0 || extent.isNull() )
+    return;
+
+  if ( !qgsDoubleNear( tileSize, mTileSize ) )
+  {
+    // tiles of another size (or an index which is not built by tiles) cannot be reused
+    destroyIndex();
+    mIndexedTiles.clear();
+    mPendingTiles.clear();
+    mTileSize = tileSize;
+  }
+
+  mLastTileExtent = extent;
+
+  qint64 firstColumn, firstRow, lastColumn, lastRow;
+  tileRange( extent, firstColumn, firstRow, lastColumn, lastRow );
+  for ( qint64 column = firstColumn; column <= lastColumn; ++column )
+  {
+    for ( qint64 row = firstRow; row <= lastRow; ++row )
+    {
+      const Tile tile( column, row );
+      if ( !mIndexedTiles.contains( tile ) )
+        mPendingTiles.insert( tile );
+    }
+  }
+
+  QgsRectangle tilesExtent;
+  for ( const Tile &tile : std::as_const( mIndexedTiles ) )
+    tilesExtent.combineExtentWith( tileRect( tile ) );
+  for ( const Tile &tile : std::as_const( mPendingTiles ) )
+    tilesExtent.combineExtentWith( tileRect( tile ) );
+  mExtent.reset( new QgsRectangle( tilesExtent ) );
+}
+
+bool QgsPointLocator::coversExtent( const QgsRectangle &rect ) const
+{
+  if ( mTileSize <= 0 )
+    return !mExtent || mExtent->contains( rect );
+
+  qint64 firstColumn, firstRow, lastColumn, lastRow;
+  tileRange( rect, firstColumn, firstRow, lastColumn, lastRow );
+  if ( ( lastColumn - firstColumn + 1 ) * ( lastRow - firstRow + 1 ) > mIndexedTiles.size() )
+    return false;
+
+  for ( qint64 column = firstColumn; column <= lastColumn; ++column )
+  {
+    for ( qint64 row = firstRow; row <= lastRow; ++row )
+    {
+      if ( !mIndexedTiles.contains( Tile( column, row ) ) )
+        return false;
+    }
+  }
+  return true;
+}
+
+void QgsPointLocator::setMaxCachedVertices( int count )
+{
+  mMaxCachedVertices = std::max( 0, count );
+}
+
+void QgsPointLocator::tileRange( const QgsRectangle &rect, qint64 &firstColumn, qint64 &firstRow, qint64 &lastColumn, qint64 &lastRow ) const
+{
+  firstColumn = static_cast< qint64 >( std::floor( rect.xMinimum() / mTileSize ) );
+  firstRow = static_cast< qint64 >( std::floor( rect.yMinimum() / mTileSize ) );
+  lastColumn = static_cast< qint64 >( std::floor( rect.xMaximum() / mTileSize ) );
+  lastRow = static_cast< qint64 >( std::floor( rect.yMaximum() / mTileSize ) );
+}
+
+QgsRectangle QgsPointLocator::tileRect( const Tile &tile ) const
+{
+  return QgsRectangle( tile.first * mTileSize, tile.second * mTileSize,
+                       ( tile.first + 1 ) * mTileSize, ( tile.second + 1 ) * mTileSize );
+}
+
+bool QgsPointLocator::intersectsTiles( const QgsRectangle &rect, const QSet< Tile > &tiles ) const
+{
+  qint64 firstColumn, firstRow, lastColumn, lastRow;
+  tileRange( rect, firstColumn, firstRow, lastColumn, lastRow );
+
+  if ( ( lastColumn - firstColumn + 1 ) * ( lastRow - firstRow + 1 ) > tiles.size() )
+  {
+    // large geometry, cheaper to go through the tiles
+    for ( const Tile &tile : tiles )
+    {
+      if ( tile.first >= firstColumn && tile.first <= lastColumn && tile.second >= firstRow && tile.second <= lastRow )
+        return true;
+    }
+    return false;
+  }
+
+  for ( qint64 column = firstColumn; column <= lastColumn; ++column )
+  {
+    for ( qint64 row = firstRow; row <= lastRow; ++row )
+    {
+      if ( tiles.contains( Tile( column, row ) ) )
+        return true;
+    }
+  }
+  return false;
+}
+
+void QgsPointLocator::evictTiles()
+{
+  if ( !mRTree || mMaxCachedVertices <= 0 || mCachedVertexCount <= mMaxCachedVertices )
+    return;
+
+  qint64 firstColumn, firstRow, lastColumn, lastRow;
+  tileRange( mLastTileExtent, firstColumn, firstRow, lastColumn, lastRow );
+
+  // tiles of the last requested extent are kept, the other ones are dropped furthest first
+  const QgsPointXY center = mLastTileExtent.center();
+  QList< QPair< double, Tile > > candidates;
+  for ( const Tile &tile : std::as_const( mIndexedTiles ) )
+  {
+    if ( tile.first >= firstColumn && tile.first <= lastColumn && tile.second >= firstRow && tile.second <= lastRow )
+      continue;
+    candidates << qMakePair( tileRect( tile ).center().sqrDist( center ), tile );
+  }
+  std::sort( candidates.begin(), candidates.end(), []( const QPair< double, Tile > &a, const QPair< double, Tile > &b )
+  {
+    return a.first > b.first;
+  } );
+
+  for ( const QPair< double, Tile > &candidate : std::as_const( candidates ) )
+  {
+    if ( mCachedVertexCount <= mMaxCachedVertices )
+      break;
+
+    mIndexedTiles.remove( candidate.second );
+
+    QgsFeatureIds ids;
+    QgsPointLocator_VisitorIdsInRect visitor( ids );
+    mRTree->intersectsWithQuery( rect2region( tileRect( candidate.second ) ), visitor );
+    for ( QgsFeatureId fid : std::as_const( ids ) )
+    {
+      const QgsRectangle bbox = mGeoms.value( fid )->boundingBox();
+      if ( intersectsTiles( bbox, mIndexedTiles ) )
+        continue; // still used by another indexed tile
+
+      mRTree->deleteData( rect2region( bbox ), fid );
+      uncacheGeometry( fid );
+    }
+  }
+
+  QgsDebugMsgLevel( QStringLiteral( "Evicted snapping index tiles: %1 tiles and %2 vertices left (%3)" ).arg( mIndexedTiles.size() ).arg( mCachedVertexCount ).arg( mSource->id() ), 2 );
+}
+
+void QgsPointLocator::cacheGeometry( QgsFeatureId fid, const QgsGeometry &geometry )
+{
+  uncacheGeometry( fid );
+
+  QgsGeometry *cached = new QgsGeometry( geometry );
+  if ( cached->constGet() )
+    mCachedVertexCount += cached->constGet()->nCoordinates();
+  mGeoms.insert( fid, cached );
+}
+
+void QgsPointLocator::uncacheGeometry( QgsFeatureId fid )
+{
+  if ( QgsGeometry *geom = mGeoms.take( fid ) )
+  {
+    if ( geom->constGet() )
+      mCachedVertexCount -= geom->constGet()->nCoordinates();
+    delete geom;
+  }
 }
 
 void QgsPointLocator::setRenderContext( const QgsRenderContext *context )
@@ -935,7 +1136,7 @@ bool QgsPointLocator::init( int maxFeaturesToIndex, bool relaxed )
 {
   const QgsWkbTypes::GeometryType geomType = mLayer->geometryType();
   if ( geomType == QgsWkbTypes::NullGeometry // nothing to index
-       || hasIndex()
+       || ( hasIndex() && mPendingTiles.isEmpty() )
        || mIsIndexing ) // already indexing, return!
     return true;
 
@@ -993,7 +1194,7 @@ bool QgsPointLocator::prepare( bool relaxed )
       waitForIndexingFinished();
   }
 
-  if ( !mRTree )
+  if ( !mRTree || !mPendingTiles.isEmpty() )
   {
     init( -1, relaxed );
     if ( ( relaxed && mIsIndexing ) || !mRTree ) // relaxed mode and currently indexing or still invalid?
@@ -1010,7 +1211,10 @@ bool QgsPointLocator::rebuildIndex( int maxFeaturesToIndex )
 
   QgsDebugMsgLevel( QStringLiteral( "RebuildIndex start : %1" ).arg( mSource->id() ), 2 );
 
-  destroyIndex();
+  // when indexing by tiles, only the pending tiles are added to an existing index
+  const bool tiled = mTileSize > 0;
+  if ( !tiled || !mRTree )
+    destroyIndex();
 
   QLinkedList<RTree::Data *> dataList;
   QgsFeature f;
@@ -1018,9 +1222,20 @@ bool QgsPointLocator::rebuildIndex( int maxFeaturesToIndex )
   QgsFeatureRequest request;
   request.setNoAttributes();
 
-  if ( mExtent )
+  QgsRectangle indexExtent;
+  if ( tiled )
   {
-    QgsRectangle rect = *mExtent;
+    for ( const Tile &tile : std::as_const( mPendingTiles ) )
+      indexExtent.combineExtentWith( tileRect( tile ) );
+  }
+  else if ( mExtent )
+  {
+    indexExtent = *mExtent;
+  }
+
+  if ( !indexExtent.isNull() )
+  {
+    QgsRectangle rect = indexExtent;
     if ( mTransform.isValid() )
     {
       try
@@ -1059,6 +1274,9 @@ bool QgsPointLocator::rebuildIndex( int maxFeaturesToIndex )
     if ( !f.hasGeometry() )
       continue;
 
+    if ( tiled && mGeoms.contains( f.id() ) )
+      continue; // already indexed with a neighbor tile
+
     if ( filter && ctx && mRenderer )
     {
       ctx->expressionContext().setFeature( f );
@@ -1086,25 +1304,34 @@ bool QgsPointLocator::rebuildIndex( int maxFeaturesToIndex )
     }
 
     const QgsRectangle bbox = f.geometry().boundingBox();
+    if ( tiled && !intersectsTiles( bbox, mPendingTiles ) )
+      continue; // only in the bounding box of non contiguous pending tiles
+
     if ( bbox.isFinite() )
     {
       SpatialIndex::Region r( rect2region( bbox ) );
       dataList << new RTree::Data( 0, nullptr, r, f.id() );
 
-      if ( mGeoms.contains( f.id() ) )
-        delete mGeoms.take( f.id() );
-      mGeoms[f.id()] = new QgsGeometry( f.geometry() );
+      cacheGeometry( f.id(), f.geometry() );
       ++indexedCount;
     }
 
     if ( maxFeaturesToIndex != -1 && indexedCount > maxFeaturesToIndex )
     {
       qDeleteAll( dataList );
+      mIndexedTiles.clear();
+      mPendingTiles.clear();
       destroyIndex();
       return false;
     }
   }
 
+  if ( tiled )
+  {
+    mIndexedTiles.unite( mPendingTiles );
+    mPendingTiles.clear();
+  }
+
   // R-Tree parameters
   double fillFactor = 0.7;
   unsigned long indexCapacity = 10;
@@ -1115,13 +1342,25 @@ bool QgsPointLocator::rebuildIndex( int maxFeaturesToIndex )
 
   if ( dataList.isEmpty() )
   {
-    mIsEmptyLayer = true;
+    if ( !mRTree )
+      mIsEmptyLayer = true;
     return true; // no features
   }
 
-  QgsPointLocator_Stream stream( dataList );
-  mRTree.reset( RTree::createAndBulkLoadNewRTree( RTree::BLM_STR, stream, *mStorage, fillFactor, indexCapacity,
-                leafCapacity, dimension, variant, indexId ) );
+  if ( mRTree )
+  {
+    for ( RTree::Data *data : std::as_const( dataList ) )
+      mRTree->insertData( 0, nullptr, data->m_region, data->m_id );
+    qDeleteAll( dataList );
+
+    evictTiles();
+  }
+  else
+  {
+    QgsPointLocator_Stream stream( dataList );
+    mRTree.reset( RTree::createAndBulkLoadNewRTree( RTree::BLM_STR, stream, *mStorage, fillFactor, indexCapacity,
+                  leafCapacity, dimension, variant, indexId ) );
+  }
 
   if ( ctx && mRenderer )
   {
@@ -1143,6 +1382,11 @@ void QgsPointLocator::destroyIndex()
   qDeleteAll( mGeoms );
 
   mGeoms.clear();
+  mCachedVertexCount = 0;
+
+  // tiles need to be indexed again
+  mPendingTiles.unite( mIndexedTiles );
+  mIndexedTiles.clear();
 }
 
 void QgsPointLocator::onFeatureAdded( QgsFeatureId fid )
@@ -1218,9 +1462,7 @@ void QgsPointLocator::onFeatureAdded( QgsFeatureId fid )
       SpatialIndex::Region r( rect2region( bbox ) );
       mRTree->insertData( 0, nullptr, r, f.id() );
 
-      if ( mGeoms.contains( f.id() ) )
-        delete mGeoms.take( f.id() );
-      mGeoms[fid] = new QgsGeometry( f.geometry() );
+      cacheGeometry( fid, f.geometry() );
     }
   }
 }
@@ -1247,7 +1489,7 @@ void QgsPointLocator::onFeatureDeleted( QgsFeatureId fid )
   if ( mGeoms.contains( fid ) )
   {
     mRTree->deleteData( rect2region( mGeoms[fid]->boundingBox() ), fid );
-    delete mGeoms.take( fid );
+    uncacheGeometry( fid );
   }
 
 }
@@ -35,6 +35,7 @@ class QgsVectorLayerFeatureSource;
 #include <memory>
 
 #include <QPointer>
+#include <QSet>
 
 /**
  * \ingroup core
@@ -149,6 +150,47 @@ class CORE_EXPORT QgsPointLocator : public QObject
      */
     void setRenderContext( const QgsRenderContext *context );
 
+    /**
+     * Extends the area covered by the index so that it includes \a extent, keeping the data which is already indexed.
+     *
+     * The area is split into square tiles of \a tileSize map units and the next call to init() only fetches
+     * the features of the tiles which are not indexed yet, so that moving around an indexed area does not
+     * rebuild the whole index. Changing the tile size or calling setExtent() discards the indexed tiles.
+     *
+     * \see coversExtent()
+     * \since QGIS 3.22
+     */
+    void extendExtent( const QgsRectangle &extent, double tileSize );
+
+    /**
+     * Returns TRUE if the index is built for the whole \a rect, i.e. the locator indexes the whole layer,
+     * its extent contains \a rect or all the tiles overlapping \a rect are indexed.
+     *
+     * \see extendExtent()
+     * \since QGIS 3.22
+     */
+    bool coversExtent( const QgsRectangle &rect ) const;
+
+    /**
+     * Sets the maximum number of vertices of the geometries cached by the index, or 0 for no limit.
+     *
+     * The limit only applies to indexes extended by tiles: the indexed tiles furthest from the last
+     * extent passed to extendExtent() are dropped once the limit is exceeded. Other indexes always
+     * cache the geometries of all the indexed features.
+     *
+     * \see maxCachedVertices()
+     * \since QGIS 3.22
+     */
+    void setMaxCachedVertices( int count );
+
+    /**
+     * Returns the maximum number of vertices of the geometries cached by the index, or 0 for no limit.
+     *
+     * \see setMaxCachedVertices()
+     * \since QGIS 3.22
+     */
+    int maxCachedVertices() const { return mMaxCachedVertices; }
+
     /**
      * The type of a snap result or the filter type for a snap request.
      */
@@ -414,6 +456,12 @@ class CORE_EXPORT QgsPointLocator : public QObject
      */
     int cachedGeometryCount() const { return mGeoms.count(); }
 
+    /**
+     * Returns how many vertices the geometries cached in the index have
+     * \since QGIS 3.22
+     */
+    int cachedVertexCount() const { return mCachedVertexCount; }
+
     /**
      * Returns TRUE if the point locator is currently indexing the data.
      * This method is useful if constructor parameter \a relaxed is TRUE
@@ -457,6 +505,23 @@ class CORE_EXPORT QgsPointLocator : public QObject
      */
     bool prepare( bool relaxed );
 
+    //! Index of a tile on the grid used by extendExtent(), as column and row
+    typedef QPair< qint64, qint64 > Tile;
+
+    //! Returns the columns and rows of the tiles overlapping \a rect
+    void tileRange( const QgsRectangle &rect, qint64 &firstColumn, qint64 &firstRow, qint64 &lastColumn, qint64 &lastRow ) const;
+    //! Returns the extent of a \a tile in map units
+    QgsRectangle tileRect( const Tile &tile ) const;
+    //! Returns TRUE if \a rect overlaps any of the \a tiles
+    bool intersectsTiles( const QgsRectangle &rect, const QSet< Tile > &tiles ) const;
+    //! Drops the indexed tiles furthest from the last requested extent until the index fits within the vertex limit
+    void evictTiles();
+
+    //! Stores a copy of \a geometry for feature \a fid, replacing any geometry previously cached for it
+    void cacheGeometry( QgsFeatureId fid, const QgsGeometry &geometry );
+    //! Removes the geometry cached for feature \a fid
+    void uncacheGeometry( QgsFeatureId fid );
+
     //! Storage manager
     std::unique_ptr< SpatialIndex::IStorageManager > mStorage;
 
@@ -472,6 +537,16 @@ class CORE_EXPORT QgsPointLocator : public QObject
     QgsVectorLayer *mLayer = nullptr;
     std::unique_ptr< QgsRectangle > mExtent;
 
+    //! Size of the tiles used by extendExtent(), or 0 if the index is not built by tiles
+    double mTileSize = 0;
+    QSet< Tile > mIndexedTiles;
+    //! Tiles which still have to be indexed by the next call to init()
+    QSet< Tile > mPendingTiles;
+    //! Last extent passed to extendExtent(), its tiles are never dropped from the index
+    QgsRectangle mLastTileExtent;
+    int mMaxCachedVertices = 0;
+    int mCachedVertexCount = 0;
+
     std::unique_ptr<QgsRenderContext> mContext;
     std::unique_ptr<QgsFeatureRenderer> mRenderer;
     std::unique_ptr<QgsVectorLayerFeatureSource> mSource;
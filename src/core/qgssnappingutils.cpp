@@ -41,6 +41,7 @@ QgsPointLocator *QgsSnappingUtils::locatorForLayer( QgsVectorLayer *vl )
   if ( !mLocators.contains( vl ) )
   {
     QgsPointLocator *vlpl = new QgsPointLocator( vl, destinationCrs(), mMapSettings.transformContext(), nullptr );
+    vlpl->setMaxCachedVertices( mMaxCachedVerticesPerLayer );
     connect( vlpl, &QgsPointLocator::initFinished, this, &QgsSnappingUtils::onInitFinished );
     mLocators.insert( vl, vlpl );
   }
@@ -98,7 +99,7 @@ bool QgsSnappingUtils::isIndexPrepared( QgsPointLocator *loc, const QgsRectangle
 
   QgsRectangle aoi( areaOfInterest );
   aoi.scale( 0.999 );
-  return mStrategy == IndexHybrid && loc->hasIndex() && ( !loc->extent() || loc->extent()->contains( aoi ) ); // the index - even if it exists - is not suitable
+  return mStrategy == IndexHybrid && loc->hasIndex() && loc->coversExtent( aoi ); // the index - even if it exists - is not suitable
 }
 
 static QgsPointLocator::Match _findClosestSegmentIntersection( const QgsPointXY &pt, const QgsPointLocator::MatchList &segments )
@@ -525,9 +526,10 @@ void QgsSnappingUtils::prepareIndex( const QList<LayerAndAreaOfInterest> &layers
           double halfSide = std::sqrt( indexReasonableArea ) / 2;
           QgsRectangle rect( c.x() - halfSide, c.y() - halfSide,
                              c.x() + halfSide, c.y() + halfSide );
-          loc->setExtent( &rect );
+          // grow the index by tiles around the area, so that the tiles which are already indexed are kept
+          loc->extendExtent( rect, halfSide );
 
-          // see if it's possible build index for this area
+          // see if it's possible build index for the missing tiles
           loc->init( mHybridPerLayerFeatureLimit, relaxed );
         }
 
@@ -556,6 +558,14 @@ void QgsSnappingUtils::setEnableSnappingForInvisibleFeature( bool enable )
   mEnableSnappingForInvisibleFeature = enable;
 }
 
+void QgsSnappingUtils::setMaxCachedVerticesPerLayer( int count )
+{
+  mMaxCachedVerticesPerLayer = std::max( 0, count );
+
+  for ( QgsPointLocator *loc : std::as_const( mLocators ) )
+    loc->setMaxCachedVertices( mMaxCachedVerticesPerLayer );
+}
+
 void QgsSnappingUtils::setConfig( const QgsSnappingConfig &config )
 {
   if ( mSnappingConfig == config )
@@ -663,7 +673,7 @@ QString QgsSnappingUtils::dump()
         else
           extentStr = QStringLiteral( "full extent" );
         if ( loc->hasIndex() )
-          cachedGeoms = QStringLiteral( "%1 feats" ).arg( loc->cachedGeometryCount() );
+          cachedGeoms = QStringLiteral( "%1 feats (%2 vertices)" ).arg( loc->cachedGeometryCount() ).arg( loc->cachedVertexCount() );
         else
           cachedGeoms = QStringLiteral( "not initialized" );
         if ( mStrategy == IndexHybrid )
@@ -189,6 +189,25 @@ class CORE_EXPORT QgsSnappingUtils : public QObject
      */
     void setEnableSnappingForInvisibleFeature( bool enable );
 
+    /**
+     * Sets the maximum number of vertices cached by the index of each layer, or 0 for no limit.
+     *
+     * Indexes of large layers which are built around the snapped area are extended by tiles, and the
+     * tiles furthest from the snapped area are dropped once the index holds more vertices.
+     *
+     * \see maxCachedVerticesPerLayer()
+     * \since QGIS 3.22
+     */
+    void setMaxCachedVerticesPerLayer( int count );
+
+    /**
+     * Returns the maximum number of vertices cached by the index of each layer, or 0 for no limit.
+     *
+     * \see setMaxCachedVerticesPerLayer()
+     * \since QGIS 3.22
+     */
+    int maxCachedVerticesPerLayer() const { return mMaxCachedVerticesPerLayer; }
+
     /**
      * Supply an extra snapping layer (typically a memory layer).
      * This can be used by map tools to provide additional
@@ -315,12 +334,14 @@ class CORE_EXPORT QgsSnappingUtils : public QObject
      * This means that index is built in area around the point with this total area, because
      * for a larger area the number of features will likely exceed the limit. When the limit
      * is exceeded, the maximum area is lowered to prevent that from happening.
-     * When requesting snap in area that is not currently indexed, layer's index is destroyed
-     * and a new one is built in the different area.
+     * When requesting snap in area that is not currently indexed, layer's index is extended
+     * with the tiles of the different area.
      */
     QHash<QString, double> mHybridMaxAreaPerLayer;
     //! if using hybrid strategy, how many features of one layer may be indexed (to limit amount of consumed memory)
     int mHybridPerLayerFeatureLimit = 50000;
+    //! maximum number of vertices cached by the index of each layer (0 = no limit)
+    int mMaxCachedVerticesPerLayer = 0;
 
     //! Disable or not the snapping on all features. By default is always TRUE except for non visible features on map canvas.
     bool mEnableSnappingForInvisibleFeature = true;
@@ -21,59 +21,88 @@
 #include <QImage>
 #include <QUrl>
 
-QCache<QUrl, QImage> QgsTileCache::sTileCache( 256 );
-QMutex QgsTileCache::sTileCacheMutex;
+QgsTileCache::Shard QgsTileCache::sShards[QgsTileCache::SHARD_COUNT];
 
+QgsTileCache::Shard &QgsTileCache::shard( const QUrl &url )
+{
+  return sShards[ qHash( url ) % SHARD_COUNT ];
+}
 
 void QgsTileCache::insertTile( const QUrl &url, const QImage &image )
 {
-  QMutexLocker locker( &sTileCacheMutex );
-  sTileCache.insert( url, new QImage( image ) );
+  Shard &s = shard( url );
+  QMutexLocker locker( &s.mutex );
+  s.tiles.insert( url, new QImage( image ) );
 }
 
 bool QgsTileCache::tile( const QUrl &url, QImage &image )
+{
+  QByteArray imageData;
+  QUrl adjUrl;
+  if ( tileOrEncodedData( url, image, imageData, adjUrl ) )
+    return true;
+
+  if ( imageData.isEmpty() )
+    return false;
+
+  // decode outside of the lock, so that other threads can access the cache meanwhile
+  image = QImage::fromData( imageData );
+
+  // Check for null because it could be a redirect (see: https://github.com/qgis/QGIS/issues/24336 )
+  if ( image.isNull() )
+    return false;
+
+  insertTile( adjUrl, image );
+  return true;
+}
+
+bool QgsTileCache::tileOrEncodedData( const QUrl &url, QImage &image, QByteArray &data, QUrl &cacheUrl )
 {
   QNetworkRequest req( url );
   //Preprocessing might alter the url, so we need to make sure we store/retrieve the url after preprocessing
   QgsNetworkAccessManager::instance()->preprocessRequest( &req );
-  QUrl adjUrl = req.url();
+  cacheUrl = req.url();
 
-  QMutexLocker locker( &sTileCacheMutex );
-  bool success = false;
-  if ( QImage *i = sTileCache.object( adjUrl ) )
   {
-    image = *i;
-    success = true;
+    Shard &s = shard( cacheUrl );
+    QMutexLocker locker( &s.mutex );
+    if ( QImage *i = s.tiles.object( cacheUrl ) )
+    {
+      image = *i;
+      return true;
+    }
   }
-  else if ( QgsNetworkAccessManager::instance()->cache()->metaData( adjUrl ).isValid() )
+
+  data.clear();
+  if ( QgsNetworkAccessManager::instance()->cache()->metaData( cacheUrl ).isValid() )
   {
-    if ( QIODevice *data = QgsNetworkAccessManager::instance()->cache()->data( adjUrl ) )
+    if ( QIODevice *device = QgsNetworkAccessManager::instance()->cache()->data( cacheUrl ) )
     {
-      QByteArray imageData = data->readAll();
-      delete data;
-
-      image = QImage::fromData( imageData );
-
-      // cache it as well (mutex is already locked)
-      // Check for null because it could be a redirect (see: https://github.com/qgis/QGIS/issues/24336 )
-      if ( ! image.isNull( ) )
-      {
-        sTileCache.insert( adjUrl, new QImage( image ) );
-        success = true;
-      }
+      data = device->readAll();
+      delete device;
     }
   }
-  return success;
+  return false;
 }
 
 int QgsTileCache::totalCost()
 {
-  QMutexLocker locker( &sTileCacheMutex );
-  return sTileCache.totalCost();
+  int cost = 0;
+  for ( Shard &s : sShards )
+  {
+    QMutexLocker locker( &s.mutex );
+    cost += s.tiles.totalCost();
+  }
+  return cost;
 }
 
 int QgsTileCache::maxCost()
 {
-  QMutexLocker locker( &sTileCacheMutex );
-  return sTileCache.maxCost();
+  int cost = 0;
+  for ( Shard &s : sShards )
+  {
+    QMutexLocker locker( &s.mutex );
+    cost += s.tiles.maxCost();
+  }
+  return cost;
 }
@@ -18,10 +18,9 @@
 
 #include "qgis_core.h"
 #include <QCache>
+#include <QImage>
 #include <QMutex>
-
-class QImage;
-class QUrl;
+#include <QUrl>
 
 #define SIP_NO_FILE
 
@@ -50,16 +49,42 @@ class CORE_EXPORT QgsTileCache
      */
     static bool tile( const QUrl &url, QImage &image );
 
+    /**
+     * Try to access a tile in the in-memory cache and load it into "image" argument.
+     *
+     * If the tile is not in the in-memory cache, its encoded data are read from the local disk
+     * cache into "data" without being decoded, so that the caller can decode several tiles at once
+     * and then store them with insertTile() using the "cacheUrl" key.
+     *
+     * \returns TRUE if the tile exists in the in-memory cache
+     * \since QGIS 3.22
+     */
+    static bool tileOrEncodedData( const QUrl &url, QImage &image, QByteArray &data, QUrl &cacheUrl );
+
     //! how many tiles are stored in the in-memory cache
     static int totalCost();
     //! how many tiles can be stored in the in-memory cache
     static int maxCost();
 
   private:
-    //! in-memory cache
-    static QCache<QUrl, QImage> sTileCache;
-    //! mutex to protect the in-memory cache
-    static QMutex sTileCacheMutex;
+
+    //! Number of independently locked parts of the in-memory cache
+    static constexpr int SHARD_COUNT = 16;
+
+    //! Number of tiles which can be stored in the whole in-memory cache
+    static constexpr int MAX_TILES = 256;
+
+    //! Part of the in-memory cache holding the tiles whose URL hash to the same shard
+    struct Shard
+    {
+      //! in-memory cache
+      QCache<QUrl, QImage> tiles { MAX_TILES / SHARD_COUNT };
+      //! mutex to protect the in-memory cache
+      QMutex mutex;
+    };
+
+    static Shard &shard( const QUrl &url );
+    static Shard sShards[SHARD_COUNT];
 };
 
 #endif // QGSTILECACHE_H
@@ -26,11 +26,12 @@
 #include "qgsrenderer.h"
 #include "qgssettingsregistrycore.h"
 #include "qgsexpressioncontextutils.h"
+#include "qgsspatialindex.h"
 
 #include <queue>
 #include <vector>
 
-typedef std::pair<int, double> DijkstraQueueItem; // first = vertex index, second = distance
+typedef std::pair<int, double> DijkstraQueueItem; // first = vertex index, second = estimated path length
 
 // utility comparator for queue items based on distance
 struct comp
@@ -101,9 +102,10 @@ struct QgsTracerGraph
     int v1, v2;
     //! coordinates of the edge (including endpoints)
     QVector<QgsPointXY> coords;
+    //! length of the edge
+    double weight = 0;
 
     int otherVertex( int v0 ) const { return v1 == v0 ? v2 : v1; }
-    double weight() const { return distance2D( coords ); }
   };
 
   struct V
@@ -118,6 +120,8 @@ struct QgsTracerGraph
   QVector<V> v;
   //! Edges of the graph
   QVector<E> e;
+  //! Spatial index of the edges (temporarily added edges are not indexed)
+  QgsSpatialIndex edgeIndex;
 
   //! Temporarily removed edges
   QSet<int> inactiveEdges;
@@ -168,12 +172,19 @@ QgsTracerGraph *makeGraph( const QVector<QgsPolylineXY> &edges )
     e.v1 = v1;
     e.v2 = v2;
     e.coords = line;
+    e.weight = distance2D( line );
     g->e.append( e );
 
     // link edge to vertices
     int eIdx = g->e.count() - 1;
     g->v[v1].edges << eIdx;
     g->v[v2].edges << eIdx;
+
+    QgsRectangle bbox;
+    bbox.setMinimal();
+    for ( const QgsPointXY &pt : line )
+      bbox.include( pt );
+    g->edgeIndex.addFeature( eIdx, bbox );
   }
 
   return g;
@@ -185,8 +196,13 @@ QVector<QgsPointXY> shortestPath( const QgsTracerGraph &g, int v1, int v2 )
   if ( v1 == -1 || v2 == -1 )
     return QVector<QgsPointXY>(); // invalid input
 
-  // priority queue to drive Dijkstra:
-  // first of the pair is vertex index, second is distance
+  // A* search: vertices are visited by the length of the path from the start vertex plus the
+  // straight line distance to the end vertex, which is never longer than the rest of the path
+  const QgsPointXY target = g.v[v2].pt;
+  auto estimate = [&g, &target]( int v ) { return std::sqrt( g.v[v].pt.sqrDist( target ) ); };
+
+  // priority queue to drive A*:
+  // first of the pair is vertex index, second is estimated path length
   std::priority_queue< DijkstraQueueItem, std::vector< DijkstraQueueItem >, comp > Q;
 
   // shortest distances to each vertex
@@ -200,7 +216,7 @@ QVector<QgsPointXY> shortestPath( const QgsTracerGraph &g, int v1, int v2 )
   QVector<int> S( g.v.count(), -1 );
 
   int u = -1;
-  Q.push( DijkstraQueueItem( v1, 0 ) );
+  Q.push( DijkstraQueueItem( v1, estimate( v1 ) ) );
 
   while ( !Q.empty() )
   {
@@ -220,13 +236,13 @@ QVector<QgsPointXY> shortestPath( const QgsTracerGraph &g, int v1, int v2 )
     {
       const QgsTracerGraph::E &edge = g.e[ vuEdges[i] ];
       int v = edge.otherVertex( u );
-      double w = edge.weight();
+      double w = edge.weight;
       if ( !F[v] && D[u] + w < D[v] )
       {
         // found a shorter way to the vertex
         D[v] = D[u] + w;
         S[v] = vuEdges[i];
-        Q.push( DijkstraQueueItem( v, D[v] ) );
+        Q.push( DijkstraQueueItem( v, D[v] + estimate( v ) ) );
       }
     }
     F[u] = true; // mark the vertex as processed (we know the fastest path to it)
@@ -258,24 +274,51 @@ QVector<QgsPointXY> shortestPath( const QgsTracerGraph &g, int v1, int v2 )
 }
 
 
+//! Returns the indices of the edges which may be at \a pt, including temporarily added edges, in ascending order
+QList<int> candidateEdges( const QgsTracerGraph &g, const QgsPointXY &pt, double epsilon )
+{
+  QList<int> edges;
+  const QList<QgsFeatureId> indexed = g.edgeIndex.intersects( QgsRectangle( pt.x() - epsilon, pt.y() - epsilon, pt.x() + epsilon, pt.y() + epsilon ) );
+  edges.reserve( indexed.count() + g.joinedVertices * 2 );
+  for ( QgsFeatureId id : indexed )
+    edges << static_cast< int >( id );
+  std::sort( edges.begin(), edges.end() );
+
+  for ( int i = g.e.count() - g.joinedVertices * 2; i < g.e.count(); ++i )
+    edges << i;
+  return edges;
+}
+
+
 int point2vertex( const QgsTracerGraph &g, const QgsPointXY &pt, double epsilon = 1e-6 )
 {
-  // TODO: use spatial index
+  auto isAtPoint = [&pt, epsilon]( const QgsTracerGraph::V & v )
+  {
+    return v.pt == pt || ( std::fabs( v.pt.x() - pt.x() ) < epsilon && std::fabs( v.pt.y() - pt.y() ) < epsilon );
+  };
 
-  for ( int i = 0; i < g.v.count(); ++i )
+  // all vertices are at the ends of edges
+  int vertex = -1;
+  const QList<int> edges = candidateEdges( g, pt, epsilon );
+  for ( int eIdx : edges )
   {
-    const QgsTracerGraph::V &v = g.v.at( i );
-    if ( v.pt == pt || ( std::fabs( v.pt.x() - pt.x() ) < epsilon && std::fabs( v.pt.y() - pt.y() ) < epsilon ) )
-      return i;
+    const QgsTracerGraph::E &e = g.e.at( eIdx );
+    for ( int vIdx : { e.v1, e.v2 } )
+    {
+      if ( ( vertex == -1 || vIdx < vertex ) && isAtPoint( g.v.at( vIdx ) ) )
+        vertex = vIdx;
+    }
   }
 
-  return -1;
+  return vertex;
 }
 
 
 int point2edge( const QgsTracerGraph &g, const QgsPointXY &pt, int &lineVertexAfter, double epsilon = 1e-6 )
 {
-  for ( int i = 0; i < g.e.count(); ++i )
+  // epsilon is compared to the squared distance to segments
+  const QList<int> edges = candidateEdges( g, pt, std::sqrt( epsilon ) );
+  for ( int i : edges )
   {
     if ( g.inactiveEdges.contains( i ) )
       continue;  // ignore temporarily disabled edges
@@ -342,11 +385,13 @@ int joinVertexToGraph( QgsTracerGraph &g, const QgsPointXY &pt )
   e1.v1 = e.v1;
   e1.v2 = vIdx;
   e1.coords = out1;
+  e1.weight = distance2D( out1 );
 
   QgsTracerGraph::E e2;
   e2.v1 = vIdx;
   e2.v2 = e.v2;
   e2.coords = out2;
+  e2.weight = distance2D( out2 );
 
   // update edge connectivity of existing vertices
   v1.edges.replace( v1.edges.indexOf( eIdx ), e1Idx );
@@ -473,7 +518,6 @@ bool QgsTracer::initGraph()
 
   mHasTopologyProblem = false;
 
-  QgsFeature f;
   QgsMultiPolylineXY mpl;
 
   // extract linestrings
@@ -483,60 +527,16 @@ bool QgsTracer::initGraph()
   QElapsedTimer t1, t2, t2a, t3;
 
   t1.start();
-  int featuresCounted = 0;
-  for ( const QgsVectorLayer *vl : std::as_const( mLayers ) )
-  {
-    QgsFeatureRequest request;
-    bool filter = false;
-    std::unique_ptr< QgsFeatureRenderer > renderer;
-    std::unique_ptr<QgsRenderContext> ctx;
-
-    bool enableInvisibleFeature = QgsSettingsRegistryCore::settingsDigitizingSnapInvisibleFeature.value();
-    if ( !enableInvisibleFeature && mRenderContext && vl->renderer() )
-    {
-      renderer.reset( vl->renderer()->clone() );
-      ctx.reset( new QgsRenderContext( *mRenderContext.get() ) );
-      ctx->expressionContext() << QgsExpressionContextUtils::layerScope( vl );
-
-      // setup scale for scale dependent visibility (rule based)
-      renderer->startRender( *ctx.get(), vl->fields() );
-      filter = renderer->capabilities() & QgsFeatureRenderer::Filter;
-      request.setSubsetOfAttributes( renderer->usedAttributes( *ctx.get() ), vl->fields() );
-    }
-    else
-    {
-      request.setNoAttributes();
-    }
-
-    request.setDestinationCrs( mCRS, mTransformContext );
-    if ( !mExtent.isEmpty() )
-      request.setFilterRect( mExtent );
-
-    QgsFeatureIterator fi = vl->getFeatures( request );
-    while ( fi.nextFeature( f ) )
-    {
-      if ( !f.hasGeometry() )
-        continue;
-
-      if ( filter )
-      {
-        ctx->expressionContext().setFeature( f );
-        if ( !renderer->willRenderFeature( f, *ctx.get() ) )
-        {
-          continue;
-        }
-      }
-
-      extractLinework( f.geometry(), mpl );
-
-      ++featuresCounted;
-      if ( mMaxFeatureCount != 0 && featuresCounted >= mMaxFeatureCount )
-        return false;
-    }
+  if ( !updateLinework() )
+    return false;
 
-    if ( renderer )
+  for ( QgsVectorLayer *vl : std::as_const( mLayers ) )
+  {
+    const QMap< QgsFeatureId, FeatureLinework > linework = mLinework.value( vl );
+    for ( const FeatureLinework &featureLinework : linework )
     {
-      renderer->stopRender( *ctx.get() );
+      if ( mExtent.isEmpty() || featureLinework.bbox.intersects( mExtent ) )
+        mpl << featureLinework.linework;
     }
   }
   int timeExtract = t1.elapsed();
@@ -593,6 +593,212 @@ bool QgsTracer::initGraph()
   return true;
 }
 
+bool QgsTracer::updateLinework()
+{
+  int featuresCounted = 0;
+
+  if ( mExtent.isEmpty() )
+  {
+    if ( !mLineworkCoversAll )
+    {
+      clearLinework();
+      for ( QgsVectorLayer *vl : std::as_const( mLayers ) )
+      {
+        QgsFeatureRequest request;
+        if ( !fetchLinework( vl, request, featuresCounted ) )
+        {
+          clearLinework();
+          return false;
+        }
+      }
+      mLineworkCoversAll = true;
+    }
+    else if ( mMaxFeatureCount != 0 )
+    {
+      for ( auto it = mLinework.constBegin(); it != mLinework.constEnd(); ++it )
+        featuresCounted += it->count();
+      if ( featuresCounted >= mMaxFeatureCount )
+        return false;
+    }
+    return true;
+  }
+
+  QgsRectangle fetchRect;
+  QList< Tile > fetchedTiles;
+  if ( !mLineworkCoversAll )
+  {
+    // tiles are sized from the extent, start again when zooming in or out too much
+    const double extentSize = std::max( mExtent.width(), mExtent.height() );
+    if ( mTileSize <= 0 || extentSize > mTileSize * 8 || extentSize < mTileSize / 2 )
+    {
+      clearLinework();
+      mTileSize = extentSize / 2;
+    }
+
+    const qint64 firstColumn = static_cast< qint64 >( std::floor( mExtent.xMinimum() / mTileSize ) );
+    const qint64 firstRow = static_cast< qint64 >( std::floor( mExtent.yMinimum() / mTileSize ) );
+    const qint64 lastColumn = static_cast< qint64 >( std::floor( mExtent.xMaximum() / mTileSize ) );
+    const qint64 lastRow = static_cast< qint64 >( std::floor( mExtent.yMaximum() / mTileSize ) );
+    const QgsRectangle tilesRect( firstColumn * mTileSize, firstRow * mTileSize, ( lastColumn + 1 ) * mTileSize, ( lastRow + 1 ) * mTileSize );
+
+    // drop the tiles and the features which are not around the extent anymore
+    for ( auto it = mLineworkTiles.begin(); it != mLineworkTiles.end(); )
+    {
+      if ( it->first < firstColumn || it->first > lastColumn || it->second < firstRow || it->second > lastRow )
+        it = mLineworkTiles.erase( it );
+      else
+        ++it;
+    }
+    for ( auto layerIt = mLinework.begin(); layerIt != mLinework.end(); ++layerIt )
+    {
+      for ( auto it = layerIt->begin(); it != layerIt->end(); )
+      {
+        if ( !it->bbox.intersects( tilesRect ) )
+          it = layerIt->erase( it );
+        else
+          ++it;
+      }
+    }
+
+    for ( qint64 column = firstColumn; column <= lastColumn; ++column )
+    {
+      for ( qint64 row = firstRow; row <= lastRow; ++row )
+      {
+        const Tile tile( column, row );
+        if ( mLineworkTiles.contains( tile ) )
+          continue;
+
+        fetchRect.combineExtentWith( QgsRectangle( column * mTileSize, row * mTileSize, ( column + 1 ) * mTileSize, ( row + 1 ) * mTileSize ) );
+        fetchedTiles << tile;
+      }
+    }
+  }
+
+  // count the features which are already cached
+  for ( auto layerIt = mLinework.constBegin(); layerIt != mLinework.constEnd(); ++layerIt )
+  {
+    for ( const FeatureLinework &featureLinework : *layerIt )
+    {
+      if ( featureLinework.bbox.intersects( mExtent ) )
+        ++featuresCounted;
+    }
+  }
+  if ( mMaxFeatureCount != 0 && featuresCounted >= mMaxFeatureCount )
+    return false;
+
+  if ( fetchRect.isNull() )
+    return true; // all the tiles are cached
+
+  for ( QgsVectorLayer *vl : std::as_const( mLayers ) )
+  {
+    QgsFeatureRequest request;
+    request.setFilterRect( fetchRect );
+    if ( !fetchLinework( vl, request, featuresCounted ) )
+    {
+      clearLinework();
+      return false;
+    }
+  }
+
+  for ( const Tile &tile : std::as_const( fetchedTiles ) )
+    mLineworkTiles.insert( tile );
+
+  return true;
+}
+
+bool QgsTracer::fetchLinework( QgsVectorLayer *vl, QgsFeatureRequest &request, int &featuresCounted )
+{
+  bool filter = false;
+  std::unique_ptr< QgsFeatureRenderer > renderer;
+  std::unique_ptr<QgsRenderContext> ctx;
+
+  bool enableInvisibleFeature = QgsSettingsRegistryCore::settingsDigitizingSnapInvisibleFeature.value();
+  if ( !enableInvisibleFeature && mRenderContext && vl->renderer() )
+  {
+    renderer.reset( vl->renderer()->clone() );
+    ctx.reset( new QgsRenderContext( *mRenderContext.get() ) );
+    ctx->expressionContext() << QgsExpressionContextUtils::layerScope( vl );
+
+    // setup scale for scale dependent visibility (rule based)
+    renderer->startRender( *ctx.get(), vl->fields() );
+    filter = renderer->capabilities() & QgsFeatureRenderer::Filter;
+    request.setSubsetOfAttributes( renderer->usedAttributes( *ctx.get() ), vl->fields() );
+  }
+  else
+  {
+    request.setNoAttributes();
+  }
+
+  request.setDestinationCrs( mCRS, mTransformContext );
+
+  QMap< QgsFeatureId, FeatureLinework > &layerLinework = mLinework[vl];
+
+  bool ok = true;
+  QgsFeature f;
+  QgsFeatureIterator fi = vl->getFeatures( request );
+  while ( fi.nextFeature( f ) )
+  {
+    if ( !f.hasGeometry() )
+      continue;
+
+    if ( layerLinework.contains( f.id() ) )
+      continue; // already fetched with another tile
+
+    if ( filter )
+    {
+      ctx->expressionContext().setFeature( f );
+      if ( !renderer->willRenderFeature( f, *ctx.get() ) )
+      {
+        continue;
+      }
+    }
+
+    FeatureLinework featureLinework;
+    featureLinework.bbox = f.geometry().boundingBox();
+    extractLinework( f.geometry(), featureLinework.linework );
+    const bool inExtent = mExtent.isEmpty() || featureLinework.bbox.intersects( mExtent );
+    layerLinework.insert( f.id(), featureLinework );
+
+    if ( inExtent )
+    {
+      ++featuresCounted;
+      if ( mMaxFeatureCount != 0 && featuresCounted >= mMaxFeatureCount )
+      {
+        ok = false;
+        break;
+      }
+    }
+  }
+
+  if ( renderer )
+  {
+    renderer->stopRender( *ctx.get() );
+  }
+
+  return ok;
+}
+
+void QgsTracer::updateFeatureLinework( QgsVectorLayer *vl, QgsFeatureId fid )
+{
+  if ( vl && mLinework.contains( vl ) )
+  {
+    mLinework[vl].remove( fid );
+
+    QgsFeatureRequest request( fid );
+    int featuresCounted = 0;
+    fetchLinework( vl, request, featuresCounted );
+  }
+
+  invalidateGraph();
+}
+
+void QgsTracer::clearLinework()
+{
+  mLinework.clear();
+  mLineworkTiles.clear();
+  mLineworkCoversAll = false;
+}
+
 QgsTracer::~QgsTracer()
 {
   invalidateGraph();
@@ -615,6 +821,7 @@ void QgsTracer::setLayers( const QList<QgsVectorLayer *> &layers )
   }
 
   mLayers = layers;
+  clearLinework();
 
   for ( QgsVectorLayer *layer : layers )
   {
@@ -632,6 +839,9 @@ void QgsTracer::setLayers( const QList<QgsVectorLayer *> &layers )
 
 void QgsTracer::setDestinationCrs( const QgsCoordinateReferenceSystem &crs, const QgsCoordinateTransformContext &context )
 {
+  if ( mCRS != crs || !( mTransformContext == context ) )
+    clearLinework();
+
   mCRS = crs;
   mTransformContext = context;
   invalidateGraph();
@@ -639,6 +849,10 @@ void QgsTracer::setDestinationCrs( const QgsCoordinateReferenceSystem &crs, cons
 
 void QgsTracer::setRenderContext( const QgsRenderContext *renderContext )
 {
+  // features visibility may depend on the scale
+  if ( !mRenderContext || !qgsDoubleNear( mRenderContext->rendererScale(), renderContext->rendererScale() ) )
+    clearLinework();
+
   mRenderContext.reset( new QgsRenderContext( *renderContext ) );
   invalidateGraph();
 }
@@ -648,6 +862,7 @@ void QgsTracer::setExtent( const QgsRectangle &extent )
   if ( mExtent == extent )
     return;
 
+  // the cached linework is updated by tiles when the graph is built again
   mExtent = extent;
   invalidateGraph();
 }
@@ -690,38 +905,43 @@ void QgsTracer::invalidateGraph()
 
 void QgsTracer::onFeatureAdded( QgsFeatureId fid )
 {
-  Q_UNUSED( fid )
-  invalidateGraph();
+  updateFeatureLinework( qobject_cast<QgsVectorLayer *>( sender() ), fid );
 }
 
 void QgsTracer::onFeatureDeleted( QgsFeatureId fid )
 {
-  Q_UNUSED( fid )
+  if ( QgsVectorLayer *vl = qobject_cast<QgsVectorLayer *>( sender() ) )
+  {
+    if ( mLinework.contains( vl ) )
+      mLinework[vl].remove( fid );
+  }
   invalidateGraph();
 }
 
 void QgsTracer::onGeometryChanged( QgsFeatureId fid, const QgsGeometry &geom )
 {
-  Q_UNUSED( fid )
   Q_UNUSED( geom )
-  invalidateGraph();
+  updateFeatureLinework( qobject_cast<QgsVectorLayer *>( sender() ), fid );
 }
 
 void QgsTracer::onAttributeValueChanged( QgsFeatureId fid, int idx, const QVariant &value )
 {
-  Q_UNUSED( fid )
   Q_UNUSED( idx )
   Q_UNUSED( value )
-  invalidateGraph();
+  // attributes only matter when invisible features are filtered out
+  if ( mRenderContext )
+    updateFeatureLinework( qobject_cast<QgsVectorLayer *>( sender() ), fid );
 }
 
 void QgsTracer::onDataChanged( )
 {
+  clearLinework();
   invalidateGraph();
 }
 
 void QgsTracer::onStyleChanged( )
 {
+  clearLinework();
   invalidateGraph();
 }
 
@@ -729,6 +949,7 @@ void QgsTracer::onLayerDestroyed( QObject *obj )
 {
   // remove the layer before it is completely invalid (static_cast should be the safest cast)
   mLayers.removeAll( static_cast<QgsVectorLayer *>( obj ) );
+  clearLinework();
   invalidateGraph();
 }
 
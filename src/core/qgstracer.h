@@ -19,6 +19,8 @@
 class QgsVectorLayer;
 
 #include "qgis_core.h"
+#include <QHash>
+#include <QMap>
 #include <QSet>
 #include <QVector>
 #include <memory>
@@ -30,6 +32,7 @@ class QgsVectorLayer;
 
 struct QgsTracerGraph;
 class QgsFeatureRenderer;
+class QgsFeatureRequest;
 class QgsRenderContext;
 
 /**
@@ -76,7 +79,13 @@ class CORE_EXPORT QgsTracer : public QObject
 
     //! Gets extent to which graph's features will be limited (empty extent means no limit)
     QgsRectangle extent() const { return mExtent; }
-    //! Sets extent to which graph's features will be limited (empty extent means no limit)
+
+    /**
+     * Sets extent to which graph's features will be limited (empty extent means no limit)
+     *
+     * The linework of the traced layers is fetched by tiles around the extent and kept when the
+     * extent changes, so that only the features of newly covered tiles have to be fetched again.
+     */
     void setExtent( const QgsRectangle &extent );
 
     /**
@@ -158,12 +167,46 @@ class CORE_EXPORT QgsTracer : public QObject
     virtual void configure() {}
 
   protected slots:
-    //! Destroy the existing graph structure if any (de-initialize)
+
+    /**
+     * Destroy the existing graph structure if any (de-initialize)
+     *
+     * The linework fetched from the layers is kept and reused when the graph is built again.
+     */
     void invalidateGraph();
 
   private:
     bool initGraph();
 
+    //! Linework of a feature in destination CRS
+    struct FeatureLinework
+    {
+      QgsRectangle bbox;
+      QgsMultiPolylineXY linework;
+    };
+
+    //! Index of a tile of the linework cache, as column and row
+    typedef QPair< qint64, qint64 > Tile;
+
+    /**
+     * Fetches the linework of the tiles covering the extent which are not cached yet and drops
+     * the tiles outside of the extent. Returns FALSE if there are too many features in the extent.
+     */
+    bool updateLinework();
+
+    /**
+     * Fetches the linework of the features of \a vl matching \a request into the cache.
+     * \a featuresCounted is increased for each feature in the extent, and FALSE is returned once
+     * it reaches the maximum feature count.
+     */
+    bool fetchLinework( QgsVectorLayer *vl, QgsFeatureRequest &request, int &featuresCounted );
+
+    //! Fetches again the linework of feature \a fid of layer \a vl after it has been edited
+    void updateFeatureLinework( QgsVectorLayer *vl, QgsFeatureId fid );
+
+    //! Drops all the cached linework
+    void clearLinework();
+
   private slots:
     void onFeatureAdded( QgsFeatureId fid );
     void onFeatureDeleted( QgsFeatureId fid );
@@ -176,6 +219,14 @@ class CORE_EXPORT QgsTracer : public QObject
   private:
     //! Graph data structure for path searching
     std::unique_ptr< QgsTracerGraph > mGraph;
+    //! Linework of the features of the traced layers, kept when the graph is invalidated
+    QHash< QgsVectorLayer *, QMap< QgsFeatureId, FeatureLinework > > mLinework;
+    //! Size of the tiles of the linework cache in map units
+    double mTileSize = 0;
+    //! Tiles for which the linework of all the traced layers is cached
+    QSet< Tile > mLineworkTiles;
+    //! Whether the linework of the whole layers is cached
+    bool mLineworkCoversAll = false;
     //! Input layers for the graph building
     QList<QgsVectorLayer *> mLayers;
     //! Destination CRS in which graph is built and tracing done
@@ -47,6 +47,8 @@
 #include <QMetaType>
 #include <QMutex>
 #include <QRegularExpression>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 
 #include <cassert>
 #include <cstdlib> // size_t
@@ -141,11 +143,13 @@ QgsVectorFileWriter *QgsVectorFileWriter::create(
 )
 {
   Q_NOWARN_DEPRECATED_PUSH
-  return new QgsVectorFileWriter( fileName, options.fileEncoding, fields, geometryType, srs,
-                                  options.driverName, options.datasourceOptions, options.layerOptions,
-                                  newFilename, options.symbologyExport, options.fieldValueConverter, options.layerName,
-                                  options.actionOnExistingFile, newLayer, transformContext, sinkFlags, options.fieldNameSource );
+  QgsVectorFileWriter *writer = new QgsVectorFileWriter( fileName, options.fileEncoding, fields, geometryType, srs,
+      options.driverName, options.datasourceOptions, options.layerOptions,
+      newFilename, options.symbologyExport, options.fieldValueConverter, options.layerName,
+      options.actionOnExistingFile, newLayer, transformContext, sinkFlags, options.fieldNameSource );
   Q_NOWARN_DEPRECATED_POP
+  writer->setTransactionSize( options.transactionSize );
+  return writer;
 }
 
 bool QgsVectorFileWriter::supportsFeatureStyles( const QString &driverName )
@@ -451,6 +455,17 @@ void QgsVectorFileWriter::init( QString vectorFileName,
     layerOptions.removeAt( optIndex );
   }
 
+  // Updating a SpatiaLite spatial index for each inserted feature is much slower than building it
+  // once all features are written, so defer its creation unless the caller asked for something else
+  if ( mOgrDriverName == QLatin1String( "SQLite" ) && datasourceOptions.contains( QStringLiteral( "SPATIALITE=YES" ) )
+       && geometryType != QgsWkbTypes::NoGeometry
+       && ( action == CreateOrOverwriteFile || action == CreateOrOverwriteLayer )
+       && layerOptions.filter( QRegularExpression( QStringLiteral( "^SPATIAL_INDEX=" ), QRegularExpression::CaseInsensitiveOption ) ).isEmpty() )
+  {
+    layerOptions.append( QStringLiteral( "SPATIAL_INDEX=NO" ) );
+    mCreateSpatialIndex = true;
+  }
+
   if ( !layerOptions.isEmpty() )
   {
     options = new char *[ layerOptions.size() + 1 ];
@@ -2863,6 +2878,24 @@ bool QgsVectorFileWriter::writeFeature( OGRLayerH layer, OGRFeatureH feature )
     QgsMessageLog::logMessage( mErrorMessage, QObject::tr( "OGR" ) );
     return false;
   }
+
+  // commit features in batches, so that huge exports don't keep all the written data in a single transaction
+  if ( mUsingTransaction && mTransactionSize > 0 && ++mFeaturesInTransaction >= mTransactionSize )
+  {
+    mFeaturesInTransaction = 0;
+    if ( OGRERR_NONE != OGR_L_CommitTransaction( mLayer ) )
+    {
+      mUsingTransaction = false;
+      mErrorMessage = QObject::tr( "Feature transaction commit error (OGR error: %1)" ).arg( QString::fromUtf8( CPLGetLastErrorMsg() ) );
+      mError = ErrFeatureWriteFailed;
+      QgsMessageLog::logMessage( mErrorMessage, QObject::tr( "OGR" ) );
+      return false;
+    }
+    if ( OGRERR_NONE != OGR_L_StartTransaction( mLayer ) )
+    {
+      mUsingTransaction = false;
+    }
+  }
   return true;
 }
 
@@ -2876,6 +2909,20 @@ QgsVectorFileWriter::~QgsVectorFileWriter()
     }
   }
 
+  if ( mCreateSpatialIndex && mDS && mLayer )
+  {
+    const QString sql = QStringLiteral( "SELECT CreateSpatialIndex('%1', '%2')" )
+                        .arg( QString::fromUtf8( OGR_L_GetName( mLayer ) ).replace( '\'', QLatin1String( "''" ) ),
+                              QString::fromUtf8( OGR_L_GetGeometryColumn( mLayer ) ).replace( '\'', QLatin1String( "''" ) ) );
+    CPLErrorReset();
+    if ( OGRLayerH result = GDALDatasetExecuteSQL( mDS.get(), sql.toUtf8().constData(), nullptr, nullptr ) )
+      GDALDatasetReleaseResultSet( mDS.get(), result );
+    if ( CPLGetLastErrorType() == CE_Failure )
+    {
+      QgsMessageLog::logMessage( QObject::tr( "Error while creating spatial index: %1" ).arg( QString::fromUtf8( CPLGetLastErrorMsg() ) ), QObject::tr( "OGR" ) );
+    }
+  }
+
 #if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3,1,0) && GDAL_VERSION_NUM <= GDAL_COMPUTE_VERSION(3,1,3)
   if ( mDS )
   {
@@ -3141,6 +3188,61 @@ QgsVectorFileWriter::WriterError QgsVectorFileWriter::writeAsVectorFormat( Prepa
   return writeAsVectorFormatV2( details, fileName, QgsCoordinateTransformContext(), options, newFilename, newLayer, errorMessage );
 }
 
+///@cond PRIVATE
+
+//! Number of features reprojected together when writing a layer
+constexpr int FEATURE_BLOCK_SIZE = 1000;
+
+struct TransformedFeature
+{
+  TransformedFeature() = default;
+  explicit TransformedFeature( const QgsFeature &feature )
+    : feature( feature )
+  {}
+
+  QgsFeature feature;
+  //! TRUE if the geometry could not be reprojected
+  bool failed = false;
+  //! Reprojection error message
+  QString error;
+};
+
+//! Reprojects the geometries of a block of \a features with \a ct, on the global thread pool
+static void transformFeatures( QVector< TransformedFeature > &features, const QgsCoordinateTransform &ct )
+{
+  auto transform = [&ct]( TransformedFeature & transformed )
+  {
+    if ( !transformed.feature.hasGeometry() )
+      return;
+
+    try
+    {
+      // transforms are not thread safe, every call works on its own copy
+      QgsCoordinateTransform localCt( ct );
+      QgsGeometry g = transformed.feature.geometry();
+      g.transform( localCt );
+      transformed.feature.setGeometry( g );
+    }
+    catch ( QgsCsException &e )
+    {
+      transformed.failed = true;
+      transformed.error = e.what();
+    }
+  };
+
+  if ( features.size() > 1 && QThreadPool::globalInstance()->maxThreadCount() > 1 )
+  {
+    QtConcurrent::blockingMap( features, transform );
+  }
+  else
+  {
+    for ( TransformedFeature &feature : features )
+      transform( feature );
+  }
+}
+
+///@endcond
+
 QgsVectorFileWriter::WriterError QgsVectorFileWriter::writeAsVectorFormatV2( PreparedWriterDetails &details, const QString &fileName, const QgsCoordinateTransformContext &transformContext, const QgsVectorFileWriter::SaveVectorOptions &options, QString *newFilename, QString *newLayer, QString *errorMessage )
 {
   QgsWkbTypes::Type destWkbType = details.destWkbType;
@@ -3265,10 +3367,40 @@ QgsVectorFileWriter::WriterError QgsVectorFileWriter::writeAsVectorFormatV2( Pre
   // Reset mFields to layer fields, and not just exported fields
   writer->mFields = details.sourceFields;
 
+  // Features are fetched in blocks, so that their geometries can be reprojected on the
+  // global thread pool while OGR features are created and written on this thread
+  const int blockSize = details.shallTransform ? FEATURE_BLOCK_SIZE : 1;
+  QVector< TransformedFeature > block;
+  int blockIndex = 0;
+  bool transformFailed = false;
+  QString transformError;
+  auto nextFeature = [&]( QgsFeature & feature ) -> bool
+  {
+    if ( blockIndex >= block.size() )
+    {
+      block.clear();
+      blockIndex = 0;
+      QgsFeature f;
+      while ( block.size() < blockSize && details.sourceFeatureIterator.nextFeature( f ) )
+        block.append( TransformedFeature( f ) );
+      if ( block.isEmpty() )
+        return false;
+
+      if ( details.shallTransform )
+        transformFeatures( block, options.ct );
+    }
+
+    const TransformedFeature &next = block.at( blockIndex++ );
+    feature = next.feature;
+    transformFailed = next.failed;
+    transformError = next.error;
+    return true;
+  };
+
   // write all features
   long saved = 0;
   int initialProgress = lastProgressReport;
-  while ( details.sourceFeatureIterator.nextFeature( fet ) )
+  while ( nextFeature( fet ) )
   {
     if ( options.feedback && options.feedback->isCanceled() )
     {
@@ -3287,27 +3419,15 @@ QgsVectorFileWriter::WriterError QgsVectorFileWriter::writeAsVectorFormatV2( Pre
       }
     }
 
-    if ( details.shallTransform )
+    if ( transformFailed )
     {
-      try
-      {
-        if ( fet.hasGeometry() )
-        {
-          QgsGeometry g = fet.geometry();
-          g.transform( options.ct );
-          fet.setGeometry( g );
-        }
-      }
-      catch ( QgsCsException &e )
-      {
-        QString msg = QObject::tr( "Failed to transform a point while drawing a feature with ID '%1'. Writing stopped. (Exception: %2)" )
-                      .arg( fet.id() ).arg( e.what() );
-        QgsLogger::warning( msg );
-        if ( errorMessage )
-          *errorMessage = msg;
+      QString msg = QObject::tr( "Failed to transform a point while drawing a feature with ID '%1'. Writing stopped. (Exception: %2)" )
+                    .arg( fet.id() ).arg( transformError );
+      QgsLogger::warning( msg );
+      if ( errorMessage )
+        *errorMessage = msg;
 
-        return ErrProjection;
-      }
+      return ErrProjection;
     }
 
     if ( fet.hasGeometry() && details.filterRectEngine && !details.filterRectEngine->intersects( fet.geometry().constGet() ) )
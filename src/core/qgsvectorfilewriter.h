@@ -549,6 +549,16 @@ class CORE_EXPORT QgsVectorFileWriter : public QgsFeatureSink
          * \since QGIS 3.20
          */
         QgsLayerMetadata layerMetadata;
+
+        /**
+         * Maximum number of features written in a single transaction, for drivers supporting transactions.
+         *
+         * Larger batches give a better throughput but keep more uncommitted data. Set to 0 to write
+         * all features in a single transaction.
+         *
+         * \since QGIS 3.22
+         */
+        int transactionSize = 100000;
     };
 
 #ifndef SIP_RUN
@@ -864,6 +874,25 @@ class CORE_EXPORT QgsVectorFileWriter : public QgsFeatureSink
      */
     void setSymbologyScale( double scale );
 
+    /**
+     * Returns the maximum number of features written in a single transaction, or 0 if all
+     * features are written in a single transaction.
+     * \see setTransactionSize()
+     * \since QGIS 3.22
+     */
+    int transactionSize() const { return mTransactionSize; }
+
+    /**
+     * Sets the maximum number of features written in a single transaction, for drivers supporting transactions.
+     *
+     * Once \a size features have been written, the transaction is committed and a new one is started.
+     * Set to 0 to write all features in a single transaction.
+     *
+     * \see transactionSize()
+     * \since QGIS 3.22
+     */
+    void setTransactionSize( int size ) { mTransactionSize = size; }
+
     static bool driverMetadata( const QString &driverName, MetaData &driverMetadata );
 
     /**
@@ -1036,6 +1065,11 @@ class CORE_EXPORT QgsVectorFileWriter : public QgsFeatureSink
     std::unique_ptr< QgsCoordinateTransform > mCoordinateTransform;
 
     bool mUsingTransaction = false;
+    int mTransactionSize = 100000;
+    int mFeaturesInTransaction = 0;
+
+    //! TRUE if the spatial index creation was deferred until all features are written
+    bool mCreateSpatialIndex = false;
     QSet< QVariant::Type > mSupportedListSubTypes;
 
     void createSymbolLayerTable( QgsVectorLayer *vl, const QgsCoordinateTransform &ct, OGRDataSourceH ds );
@@ -21,6 +21,7 @@
 #include "qgsrasterviewport.h"
 #include "qgslayertreemodellegendnode.h"
 #include "qgssymbol.h"
+#include "qgsrasterpixelprocessor_p.h"
 
 #include <QDomDocument>
 #include <QDomElement>
@@ -263,120 +264,134 @@ QgsRasterBlock *QgsMultiBandColorRenderer::block( int bandNo, QgsRectangle  cons
       fastDraw = false;
   }
 
-  qgssize count = ( qgssize )width * height;
-  for ( qgssize i = 0; i < count; i++ )
+  // the contrast enhancements build their lookup tables on first use, make sure this
+  // happens before the block is possibly processed by several threads
+  for ( QgsContrastEnhancement *enhancement : { mRedContrastEnhancement, mGreenContrastEnhancement, mBlueContrastEnhancement } )
   {
-    if ( fastDraw ) //fast rendering if no transparency, stretching, color inversion, etc.
+    if ( enhancement )
+      enhancement->enhanceContrast( enhancement->minimumValue() );
+  }
+
+  const bool byteRgbHasNoData = hasByteRgb && ( redBlock->hasNoData() || greenBlock->hasNoData() || blueBlock->hasNoData() );
+
+  const qgssize count = ( qgssize )width * height;
+  QgsRasterPixelProcessor::processPixels( count, [&]( qgssize start, qgssize end )
+  {
+    for ( qgssize i = start; i < end; i++ )
     {
-      if ( hasByteRgb )
+      if ( fastDraw ) //fast rendering if no transparency, stretching, color inversion, etc.
       {
-        if ( redBlock->isNoData( i ) ||
-             greenBlock->isNoData( i ) ||
-             blueBlock->isNoData( i ) )
+        if ( hasByteRgb )
         {
-          outputBlock->setColor( i, myDefaultColor );
+          if ( byteRgbHasNoData &&
+               ( redBlock->isNoData( i ) ||
+                 greenBlock->isNoData( i ) ||
+                 blueBlock->isNoData( i ) ) )
+          {
+            outputBlockColorData[i] = myDefaultColor;
+          }
+          else
+          {
+            outputBlockColorData[i] = qRgb( redData[i], greenData[i], blueData[i] );
+          }
         }
         else
         {
-          outputBlockColorData[i] = qRgb( redData[i], greenData[i], blueData[i] );
+          bool redIsNoData = false;
+          bool greenIsNoData = false;
+          bool blueIsNoData = false;
+          int redVal = 0;
+          int greenVal = 0;
+          int blueVal = 0;
+
+          redVal = redBlock->valueAndNoData( i, redIsNoData );
+          // as soon as any channel has a no data value, don't do any more work -- the result will
+          // always be the nodata color!
+          if ( !redIsNoData )
+            greenVal = greenBlock->valueAndNoData( i, greenIsNoData );
+          if ( !redIsNoData && !greenIsNoData )
+            blueVal = blueBlock->valueAndNoData( i, blueIsNoData );
+
+          if ( redIsNoData ||
+               greenIsNoData ||
+               blueIsNoData )
+          {
+            outputBlockColorData[i] = myDefaultColor;
+          }
+          else
+          {
+            outputBlockColorData[i] = qRgb( redVal, greenVal, blueVal );
+          }
         }
+        continue;
       }
-      else
+
+      bool isNoData = false;
+      double redVal = 0;
+      double greenVal = 0;
+      double blueVal = 0;
+      if ( mRedBand > 0 )
       {
-        bool redIsNoData = false;
-        bool greenIsNoData = false;
-        bool blueIsNoData = false;
-        int redVal = 0;
-        int greenVal = 0;
-        int blueVal = 0;
-
-        redVal = redBlock->valueAndNoData( i, redIsNoData );
-        // as soon as any channel has a no data value, don't do any more work -- the result will
-        // always be the nodata color!
-        if ( !redIsNoData )
-          greenVal = greenBlock->valueAndNoData( i, greenIsNoData );
-        if ( !redIsNoData && !greenIsNoData )
-          blueVal = blueBlock->valueAndNoData( i, blueIsNoData );
-
-        if ( redIsNoData ||
-             greenIsNoData ||
-             blueIsNoData )
-        {
-          outputBlock->setColor( i, myDefaultColor );
-        }
-        else
-        {
-          outputBlockColorData[i] = qRgb( redVal, greenVal, blueVal );
-        }
+        redVal = redBlock->valueAndNoData( i, isNoData );
+      }
+      if ( !isNoData && mGreenBand > 0 )
+      {
+        greenVal = greenBlock->valueAndNoData( i, isNoData );
+      }
+      if ( !isNoData && mBlueBand > 0 )
+      {
+        blueVal = blueBlock->valueAndNoData( i, isNoData );
+      }
+      if ( isNoData )
+      {
+        outputBlockColorData[i] = myDefaultColor;
+        continue;
       }
-      continue;
-    }
-
-    bool isNoData = false;
-    double redVal = 0;
-    double greenVal = 0;
-    double blueVal = 0;
-    if ( mRedBand > 0 )
-    {
-      redVal = redBlock->valueAndNoData( i, isNoData );
-    }
-    if ( !isNoData && mGreenBand > 0 )
-    {
-      greenVal = greenBlock->valueAndNoData( i, isNoData );
-    }
-    if ( !isNoData && mBlueBand > 0 )
-    {
-      blueVal = blueBlock->valueAndNoData( i, isNoData );
-    }
-    if ( isNoData )
-    {
-      outputBlock->setColor( i, myDefaultColor );
-      continue;
-    }
 
-    //apply default color if red, green or blue not in displayable range
-    if ( ( mRedContrastEnhancement && !mRedContrastEnhancement->isValueInDisplayableRange( redVal ) )
-         || ( mGreenContrastEnhancement && !mGreenContrastEnhancement->isValueInDisplayableRange( redVal ) )
-         || ( mBlueContrastEnhancement && !mBlueContrastEnhancement->isValueInDisplayableRange( redVal ) ) )
-    {
-      outputBlock->setColor( i, myDefaultColor );
-      continue;
-    }
+      //apply default color if red, green or blue not in displayable range
+      if ( ( mRedContrastEnhancement && !mRedContrastEnhancement->isValueInDisplayableRange( redVal ) )
+           || ( mGreenContrastEnhancement && !mGreenContrastEnhancement->isValueInDisplayableRange( redVal ) )
+           || ( mBlueContrastEnhancement && !mBlueContrastEnhancement->isValueInDisplayableRange( redVal ) ) )
+      {
+        outputBlockColorData[i] = myDefaultColor;
+        continue;
+      }
 
-    //stretch color values
-    if ( mRedContrastEnhancement )
-    {
-      redVal = mRedContrastEnhancement->enhanceContrast( redVal );
-    }
-    if ( mGreenContrastEnhancement )
-    {
-      greenVal = mGreenContrastEnhancement->enhanceContrast( greenVal );
-    }
-    if ( mBlueContrastEnhancement )
-    {
-      blueVal = mBlueContrastEnhancement->enhanceContrast( blueVal );
-    }
+      //stretch color values
+      if ( mRedContrastEnhancement )
+      {
+        redVal = mRedContrastEnhancement->enhanceContrast( redVal );
+      }
+      if ( mGreenContrastEnhancement )
+      {
+        greenVal = mGreenContrastEnhancement->enhanceContrast( greenVal );
+      }
+      if ( mBlueContrastEnhancement )
+      {
+        blueVal = mBlueContrastEnhancement->enhanceContrast( blueVal );
+      }
 
-    //opacity
-    double currentOpacity = mOpacity;
-    if ( mRasterTransparency )
-    {
-      currentOpacity = mRasterTransparency->alphaValue( redVal, greenVal, blueVal, mOpacity * 255 ) / 255.0;
-    }
-    if ( mAlphaBand > 0 )
-    {
-      currentOpacity *= alphaBlock->value( i ) / 255.0;
-    }
+      //opacity
+      double currentOpacity = mOpacity;
+      if ( mRasterTransparency )
+      {
+        currentOpacity = mRasterTransparency->alphaValue( redVal, greenVal, blueVal, mOpacity * 255 ) / 255.0;
+      }
+      if ( mAlphaBand > 0 )
+      {
+        currentOpacity *= alphaBlock->value( i ) / 255.0;
+      }
 
-    if ( qgsDoubleNear( currentOpacity, 1.0 ) )
-    {
-      outputBlock->setColor( i, qRgba( redVal, greenVal, blueVal, 255 ) );
-    }
-    else
-    {
-      outputBlock->setColor( i, qRgba( currentOpacity * redVal, currentOpacity * greenVal, currentOpacity * blueVal, currentOpacity * 255 ) );
+      if ( qgsDoubleNear( currentOpacity, 1.0 ) )
+      {
+        outputBlockColorData[i] = qRgba( redVal, greenVal, blueVal, 255 );
+      }
+      else
+      {
+        outputBlockColorData[i] = qRgba( currentOpacity * redVal, currentOpacity * greenVal, currentOpacity * blueVal, currentOpacity * 255 );
+      }
     }
-  }
+  } );
 
   //delete input blocks
   QMap<int, QgsRasterBlock *>::const_iterator bandDelIt = bandBlocks.constBegin();
@@ -23,6 +23,7 @@
 #include "qgsmessagelog.h"
 #include "qgsrasteriterator.h"
 #include "qgslayertreemodellegendnode.h"
+#include "qgsrasterpixelprocessor_p.h"
 
 #include <QColor>
 #include <QDomDocument>
@@ -145,8 +146,6 @@ QgsRasterBlock *QgsPalettedRasterRenderer::block( int, QgsRectangle  const &exte
     return outputBlock.release();
   }
 
-  double currentOpacity = mOpacity;
-
   //rendering is faster without considering user-defined transparency
   bool hasTransparency = usesTransparency();
 
@@ -175,45 +174,66 @@ QgsRasterBlock *QgsPalettedRasterRenderer::block( int, QgsRectangle  const &exte
   //use direct data access instead of QgsRasterBlock::setValue
   //because of performance
   Q_ASSERT( outputBlock ); // to make cppcheck happy
-  unsigned int *outputData = ( unsigned int * )( outputBlock->bits() );
+  QRgb *outputData = outputBlock->colorData();
+
+  const QMap< double, QRgb > colors = mColors;
+  const QgsRasterTransparency *rasterTransparency = mRasterTransparency;
+  const double opacity = mOpacity;
+  const int alphaBand = mAlphaBand;
 
-  qgssize rasterSize = ( qgssize )width * height;
-  bool isNoData = false;
-  for ( qgssize i = 0; i < rasterSize; ++i )
+  auto colorForValue = [ = ]( double value, qgssize i ) -> QRgb
   {
-    const double value = inputBlock->valueAndNoData( i, isNoData );
-    if ( isNoData )
+    const auto colorIt = colors.constFind( value );
+    if ( colorIt == colors.constEnd() )
     {
-      outputData[i] = myDefaultColor;
-      continue;
+      return myDefaultColor;
     }
-    if ( !mColors.contains( value ) )
+
+    if ( !hasTransparency )
     {
-      outputData[i] = myDefaultColor;
-      continue;
+      return colorIt.value();
     }
 
-    if ( !hasTransparency )
+    double currentOpacity = opacity;
+    if ( rasterTransparency )
     {
-      outputData[i] = mColors.value( value );
+      currentOpacity = rasterTransparency->alphaValue( value, opacity * 255 ) / 255.0;
     }
-    else
+    if ( alphaBand > 0 )
     {
-      currentOpacity = mOpacity;
-      if ( mRasterTransparency )
-      {
-        currentOpacity = mRasterTransparency->alphaValue( value, mOpacity * 255 ) / 255.0;
-      }
-      if ( mAlphaBand > 0 )
-      {
-        currentOpacity *= alphaBlock->value( i ) / 255.0;
-      }
-
-      QRgb c = mColors.value( value );
-      outputData[i] = qRgba( currentOpacity * qRed( c ), currentOpacity * qGreen( c ), currentOpacity * qBlue( c ), currentOpacity * qAlpha( c ) );
+      currentOpacity *= alphaBlock->value( i ) / 255.0;
     }
+
+    const QRgb c = colorIt.value();
+    return qRgba( currentOpacity * qRed( c ), currentOpacity * qGreen( c ), currentOpacity * qBlue( c ), currentOpacity * qAlpha( c ) );
+  };
+
+  const qgssize rasterSize = ( qgssize )width * height;
+
+  // without an alpha band the color only depends on the value, so blocks of integer values
+  // are colored through a lookup table holding the color of every value of the data type
+  int lookupTableMinimum = 0;
+  int lookupTableSize = 0;
+  if ( mAlphaBand <= 0 && QgsRasterPixelProcessor::useLookupTable( inputBlock.get(), rasterSize, lookupTableMinimum, lookupTableSize ) )
+  {
+    const std::vector< QRgb > lookupTable = QgsRasterPixelProcessor::buildLookupTable( inputBlock.get(), lookupTableMinimum, lookupTableSize, myDefaultColor, [&colorForValue]( double value )
+    {
+      return colorForValue( value, 0 );
+    } );
+    QgsRasterPixelProcessor::mapThroughLookupTable( inputBlock.get(), rasterSize, lookupTable, lookupTableMinimum, myDefaultColor, outputData );
+    return outputBlock.release();
   }
 
+  QgsRasterPixelProcessor::processPixels( rasterSize, [ = ]( qgssize start, qgssize end )
+  {
+    bool isNoData = false;
+    for ( qgssize i = start; i < end; ++i )
+    {
+      const double value = inputBlock->valueAndNoData( i, isNoData );
+      outputData[i] = isNoData ? myDefaultColor : colorForValue( value, i );
+    }
+  } );
+
   return outputBlock.release();
 }
 
@@ -647,7 +647,10 @@ void QgsRasterLayer::setDataProvider( QString const &provider, const QgsDataProv
   if ( QgsApplication::profiler()->groupIsActive( QStringLiteral( "projectload" ) ) )
     profile = std::make_unique< QgsScopedRuntimeProfile >( tr( "Create %1 provider" ).arg( provider ), QStringLiteral( "projectload" ) );
 
-  mDataProvider = qobject_cast< QgsRasterDataProvider * >( QgsProviderRegistry::instance()->createProvider( mProviderKey, mDataSource, options, flags ) );
+  QgsDataProvider *dataProvider = takePreloadedProvider( mProviderKey, mDataSource, flags );
+  if ( !dataProvider )
+    dataProvider = QgsProviderRegistry::instance()->createProvider( mProviderKey, mDataSource, options, flags );
+  mDataProvider = qobject_cast< QgsRasterDataProvider * >( dataProvider );
   if ( !mDataProvider )
   {
     //QgsMessageLog::logMessage( tr( "Cannot instantiate the data provider" ), tr( "Raster" ) );
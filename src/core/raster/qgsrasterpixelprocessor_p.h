@@ -0,0 +1,194 @@
+/***************************************************************************
+                         qgsrasterpixelprocessor_p.h
+                         ---------------------------
+    begin                : October 2021
+    copyright            : (C) 2021 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSRASTERPIXELPROCESSOR_PRIVATE_H
+#define QGSRASTERPIXELPROCESSOR_PRIVATE_H
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#define SIP_NO_FILE
+
+#include "qgsrasterblock.h"
+
+#include <QPair>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+/**
+ * Helpers shared by the raster renderers to map a block of raster values to colors.
+ *
+ * Blocks of integer values are mapped through a color lookup table built once per block,
+ * large blocks are processed by several threads.
+ */
+class QgsRasterPixelProcessor
+{
+  public:
+
+    //! Minimum number of pixels in a block before it is processed concurrently
+    static constexpr qgssize PARALLEL_PIXEL_THRESHOLD = 256 * 256;
+
+    //! Minimum number of pixels processed by a single task
+    static constexpr qgssize MINIMUM_CHUNK_SIZE = 16 * 1024;
+
+    /**
+     * Calls \a processRange for consecutive ranges [start, end) of pixel indices covering \a count pixels.
+     *
+     * Large blocks are split in ranges which are processed concurrently, so \a processRange must only
+     * write to the pixels of its own range.
+     */
+    static void processPixels( qgssize count, const std::function< void( qgssize start, qgssize end ) > &processRange )
+    {
+      const int threadCount = QThreadPool::globalInstance()->maxThreadCount();
+      if ( count < PARALLEL_PIXEL_THRESHOLD || threadCount < 2 )
+      {
+        processRange( 0, count );
+        return;
+      }
+
+      const qgssize chunkSize = std::max( MINIMUM_CHUNK_SIZE, count / static_cast< qgssize >( threadCount * 4 ) );
+      QVector< QPair< qgssize, qgssize > > ranges;
+      ranges.reserve( static_cast< int >( count / chunkSize + 1 ) );
+      for ( qgssize start = 0; start < count; start += chunkSize )
+      {
+        ranges << qMakePair( start, std::min( start + chunkSize, count ) );
+      }
+
+      QtConcurrent::blockingMap( ranges, [&processRange]( const QPair< qgssize, qgssize > &range )
+      {
+        processRange( range.first, range.second );
+      } );
+    }
+
+    /**
+     * Returns TRUE if values of \a dataType can be mapped through a lookup table, and sets
+     * \a minimum and \a size to the range of values the type can hold.
+     */
+    static bool lookupTableRange( Qgis::DataType dataType, int &minimum, int &size )
+    {
+      switch ( dataType )
+      {
+        case Qgis::DataType::Byte:
+          minimum = 0;
+          size = 256;
+          return true;
+        case Qgis::DataType::UInt16:
+          minimum = 0;
+          size = 65536;
+          return true;
+        case Qgis::DataType::Int16:
+          minimum = -32768;
+          size = 65536;
+          return true;
+        default:
+          return false;
+      }
+    }
+
+    /**
+     * Returns TRUE if \a block of \a count pixels should be mapped through a lookup table,
+     * i.e. if its data type allows it and the block is larger than the table.
+     */
+    static bool useLookupTable( const QgsRasterBlock *block, qgssize count, int &minimum, int &size )
+    {
+      return lookupTableRange( block->dataType(), minimum, size ) && count > static_cast< qgssize >( size );
+    }
+
+    /**
+     * Builds a lookup table of \a size colors for values starting at \a minimum.
+     *
+     * Values matching the no data value of \a block are assigned \a noDataColor, other values
+     * the color returned by \a colorForValue.
+     */
+    static std::vector< QRgb > buildLookupTable( const QgsRasterBlock *block, int minimum, int size, QRgb noDataColor,
+        const std::function< QRgb( double value ) > &colorForValue )
+    {
+      std::vector< QRgb > lookupTable( static_cast< std::size_t >( size ) );
+      const bool hasNoDataValue = block->hasNoDataValue();
+      const double noDataValue = block->noDataValue();
+      for ( int i = 0; i < size; ++i )
+      {
+        const double value = static_cast< double >( minimum + i );
+        lookupTable[i] = hasNoDataValue && qgsDoubleNear( value, noDataValue ) ? noDataColor : colorForValue( value );
+      }
+      return lookupTable;
+    }
+
+    /**
+     * Maps the \a count values of \a block to \a output colors through \a lookupTable, which
+     * starts at value \a minimum.
+     *
+     * Pixels flagged in the no data bitmap of the block are assigned \a noDataColor.
+     */
+    static void mapThroughLookupTable( QgsRasterBlock *block, qgssize count, const std::vector< QRgb > &lookupTable, int minimum, QRgb noDataColor, QRgb *output )
+    {
+      switch ( block->dataType() )
+      {
+        case Qgis::DataType::Byte:
+          mapThroughLookupTable( block, reinterpret_cast< const quint8 * >( block->bits() ), count, lookupTable, minimum, noDataColor, output );
+          break;
+        case Qgis::DataType::UInt16:
+          mapThroughLookupTable( block, reinterpret_cast< const quint16 * >( block->bits() ), count, lookupTable, minimum, noDataColor, output );
+          break;
+        case Qgis::DataType::Int16:
+          mapThroughLookupTable( block, reinterpret_cast< const qint16 * >( block->bits() ), count, lookupTable, minimum, noDataColor, output );
+          break;
+        default:
+          Q_ASSERT( false );
+          break;
+      }
+    }
+
+  private:
+
+    template <typename T>
+    static void mapThroughLookupTable( const QgsRasterBlock *block, const T *data, qgssize count, const std::vector< QRgb > &lookupTable, int minimum, QRgb noDataColor, QRgb *output )
+    {
+      // no data values are part of the lookup table, only the no data bitmap needs a per pixel test
+      const bool useNoDataBitmap = block->hasNoData() && !block->hasNoDataValue();
+      const QRgb *table = lookupTable.data() - minimum;
+      processPixels( count, [ = ]( qgssize start, qgssize end )
+      {
+        if ( useNoDataBitmap )
+        {
+          for ( qgssize i = start; i < end; ++i )
+            output[i] = block->isNoData( i ) ? noDataColor : table[ data[i] ];
+        }
+        else
+        {
+          for ( qgssize i = start; i < end; ++i )
+            output[i] = table[ data[i] ];
+        }
+      } );
+    }
+};
+
+/// @endcond
+
+#endif // QGSRASTERPIXELPROCESSOR_PRIVATE_H
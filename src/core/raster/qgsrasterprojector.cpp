@@ -22,9 +22,104 @@
 #include "qgscoordinatetransform.h"
 #include "qgsexception.h"
 
+#include <QMutex>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+
+/// @cond PRIVATE
+
+/**
+ * Thread safe cache of the most recently used transform grids. A grid depends only on the
+ * destination extent and size, the transform and the source raster limits, so it can be reused
+ * by consecutive requests for the same extent (e.g. the bands of a multiband render or export,
+ * or repeated renders of an unchanged map extent).
+ */
+class QgsRasterProjectorGridCache
+{
+  public:
+
+    struct Key
+    {
+      QgsRectangle destExtent;
+      int width = 0;
+      int height = 0;
+      QgsRasterProjector::Precision precision = QgsRasterProjector::Approximate;
+      QgsCoordinateReferenceSystem srcCrs;
+      QgsCoordinateReferenceSystem destCrs;
+      QgsCoordinateTransformContext transformContext;
+      int srcDatumTransform = -1;
+      int destDatumTransform = -1;
+      QgsRectangle srcLimitExtent;
+      double maxSrcXRes = 0;
+      double maxSrcYRes = 0;
+
+      bool operator==( const Key &other ) const
+      {
+        return destExtent == other.destExtent
+               && width == other.width
+               && height == other.height
+               && precision == other.precision
+               && srcLimitExtent == other.srcLimitExtent
+               && maxSrcXRes == other.maxSrcXRes
+               && maxSrcYRes == other.maxSrcYRes
+               && srcDatumTransform == other.srcDatumTransform
+               && destDatumTransform == other.destDatumTransform
+               && srcCrs == other.srcCrs
+               && destCrs == other.destCrs
+               && transformContext == other.transformContext;
+      }
+    };
+
+    std::shared_ptr< const ProjectorData > find( const Key &key )
+    {
+      QMutexLocker locker( &mMutex );
+      for ( auto it = mEntries.begin(); it != mEntries.end(); ++it )
+      {
+        if ( it->first == key )
+        {
+          // move to front, so that least recently used grids are evicted first
+          std::shared_ptr< const ProjectorData > data = it->second;
+          if ( it != mEntries.begin() )
+          {
+            std::pair< Key, std::shared_ptr< const ProjectorData > > entry = *it;
+            mEntries.erase( it );
+            mEntries.insert( mEntries.begin(), entry );
+          }
+          return data;
+        }
+      }
+      return nullptr;
+    }
+
+    void insert( const Key &key, const std::shared_ptr< const ProjectorData > &data )
+    {
+      QMutexLocker locker( &mMutex );
+      mEntries.insert( mEntries.begin(), std::make_pair( key, data ) );
+      if ( mEntries.size() > MAX_ENTRIES )
+        mEntries.pop_back();
+    }
+
+  private:
+
+    //! Maximum number of grids kept in the cache
+    static constexpr size_t MAX_ENTRIES = 4;
+
+    QMutex mMutex;
+    std::vector< std::pair< Key, std::shared_ptr< const ProjectorData > > > mEntries;
+};
+
+//! Number of destination rows projected by a single task
+constexpr int PARALLEL_BAND_HEIGHT = 64;
+
+//! Minimum number of destination pixels for which the projection is split across threads
+constexpr qgssize PARALLEL_PIXEL_THRESHOLD = 512 * 512;
+
+/// @endcond
+
 Q_NOWARN_DEPRECATED_PUSH // because of deprecated members
 QgsRasterProjector::QgsRasterProjector()
   : QgsRasterInterface( nullptr )
+  , mGridCache( std::make_shared< QgsRasterProjectorGridCache >() )
 {
   QgsDebugMsgLevel( QStringLiteral( "Entered" ), 4 );
 }
@@ -45,6 +140,7 @@ QgsRasterProjector *QgsRasterProjector::clone() const
   Q_NOWARN_DEPRECATED_POP
 
   projector->mPrecision = mPrecision;
+  projector->mGridCache = mGridCache;
   return projector;
 }
 
@@ -90,6 +186,34 @@ void QgsRasterProjector::setCrs( const QgsCoordinateReferenceSystem &srcCRS, con
 }
 
 
+void ProjectorData::sourceLimits( QgsRasterInterface *input, QgsRectangle &extent, double &maxSrcXRes, double &maxSrcYRes )
+{
+  extent = QgsRectangle();
+  maxSrcXRes = 0;
+  maxSrcYRes = 0;
+
+  // Get max source resolution and extent if possible
+  if ( input )
+  {
+    QgsRasterDataProvider *provider = dynamic_cast<QgsRasterDataProvider *>( input->sourceInput() );
+    if ( provider )
+    {
+      // If provider-side resampling is possible, we will get a much better looking
+      // result by not requesting at the maximum resolution and then doing nearest
+      // resampling here. A real fix would be to do resampling during reprojection
+      // however.
+      if ( !( provider->providerCapabilities() & QgsRasterDataProvider::ProviderHintCanPerformProviderResampling ) &&
+           ( provider->capabilities() & QgsRasterDataProvider::Size ) )
+      {
+        maxSrcXRes = provider->extent().width() / provider->xSize();
+        maxSrcYRes = provider->extent().height() / provider->ySize();
+      }
+      // Get source extent
+      extent = provider->extent();
+    }
+  }
+}
+
 ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height, QgsRasterInterface *input, const QgsCoordinateTransform &inverseCt, QgsRasterProjector::Precision precision, QgsRasterBlockFeedback *feedback )
   : mApproximate( false )
   , mInverseCt( inverseCt )
@@ -104,7 +228,6 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   , mSrcYRes( 0.0 )
   , mDestRowsPerMatrixRow( 0.0 )
   , mDestColsPerMatrixCol( 0.0 )
-  , mHelperTopRow( 0 )
   , mCPCols( 0 )
   , mCPRows( 0 )
   , mSqrTolerance( 0.0 )
@@ -113,29 +236,7 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
 {
   QgsDebugMsgLevel( QStringLiteral( "Entered" ), 4 );
 
-  // Get max source resolution and extent if possible
-  if ( input )
-  {
-    QgsRasterDataProvider *provider = dynamic_cast<QgsRasterDataProvider *>( input->sourceInput() );
-    if ( provider )
-    {
-      // If provider-side resampling is possible, we will get a much better looking
-      // result by not requesting at the maximum resolution and then doing nearest
-      // resampling here. A real fix would be to do resampling during reprojection
-      // however.
-      if ( !( provider->providerCapabilities() & QgsRasterDataProvider::ProviderHintCanPerformProviderResampling ) &&
-           ( provider->capabilities() & QgsRasterDataProvider::Size ) )
-      {
-        mMaxSrcXRes = provider->extent().width() / provider->xSize();
-        mMaxSrcYRes = provider->extent().height() / provider->ySize();
-      }
-      // Get source extent
-      if ( mExtent.isEmpty() )
-      {
-        mExtent = provider->extent();
-      }
-    }
-  }
+  sourceLimits( input, mExtent, mMaxSrcXRes, mMaxSrcYRes );
 
   mDestXRes = mDestExtent.width() / ( mDestCols );
   mDestYRes = mDestExtent.height() / ( mDestRows );
@@ -159,20 +260,8 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   // Always try to calculate mCPMatrix, it is used in calcSrcExtent() for both Approximate and Exact
   // Initialize the matrix by corners and middle points
   mCPCols = mCPRows = 3;
-  for ( int i = 0; i < mCPRows; i++ )
-  {
-    QList<QgsPointXY> myRow;
-    myRow.append( QgsPointXY() );
-    myRow.append( QgsPointXY() );
-    myRow.append( QgsPointXY() );
-    mCPMatrix.insert( i, myRow );
-    // And the legal points
-    QList<bool> myLegalRow;
-    myLegalRow.append( bool( false ) );
-    myLegalRow.append( bool( false ) );
-    myLegalRow.append( bool( false ) );
-    mCPLegalMatrix.insert( i, myLegalRow );
-  }
+  mCPMatrix.assign( static_cast< size_t >( mCPRows ) * mCPCols, QgsPointXY() );
+  mCPLegalMatrix.assign( static_cast< size_t >( mCPRows ) * mCPCols, false );
   for ( int i = 0; i < mCPRows; i++ )
   {
     calcRow( i, inverseCt );
@@ -218,12 +307,23 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   QgsDebugMsgLevel( cpToString(), 5 );
 #endif
 
-  // init helper points
-  pHelperTop = new QgsPointXY[mDestCols];
-  pHelperBottom = new QgsPointXY[mDestCols];
-  calcHelper( 0, pHelperTop );
-  calcHelper( 1, pHelperBottom );
-  mHelperTopRow = 0;
+  // precalculate position of destination columns on matrix, it is the same for all rows
+  mHelperMatrixCols.resize( static_cast< size_t >( mDestCols ) );
+  mHelperXFracs.resize( static_cast< size_t >( mDestCols ) );
+  for ( int myDestCol = 0; myDestCol < mDestCols; myDestCol++ )
+  {
+    double myDestX = mDestExtent.xMinimum() + ( myDestCol + 0.5 ) * mDestXRes;
+
+    int myMatrixCol = matrixCol( myDestCol );
+
+    double myDestXMin, myDestYMin, myDestXMax, myDestYMax;
+
+    destPointOnCPMatrix( 0, myMatrixCol, &myDestXMin, &myDestYMin );
+    destPointOnCPMatrix( 0, myMatrixCol + 1, &myDestXMax, &myDestYMax );
+
+    mHelperMatrixCols[myDestCol] = myMatrixCol;
+    mHelperXFracs[myDestCol] = ( myDestX - myDestXMin ) / ( myDestXMax - myDestXMin );
+  }
 
   // Calculate source dimensions
   calcSrcExtent();
@@ -232,13 +332,18 @@ ProjectorData::ProjectorData( const QgsRectangle &extent, int width, int height,
   mSrcXRes = mSrcExtent.width() / mSrcCols;
 }
 
-ProjectorData::~ProjectorData()
+ProjectorData::RowContext ProjectorData::createRowContext() const
 {
-  delete[] pHelperTop;
-  delete[] pHelperBottom;
+  RowContext context;
+  context.inverseCt = mInverseCt;
+  if ( mApproximate )
+  {
+    context.helperTop.resize( static_cast< size_t >( mDestCols ) );
+    context.helperBottom.resize( static_cast< size_t >( mDestCols ) );
+  }
+  return context;
 }
 
-
 void ProjectorData::calcSrcExtent()
 {
   /* Run around the mCPMatrix and find source extent */
@@ -249,14 +354,14 @@ void ProjectorData::calcSrcExtent()
   // For now, we run through all matrix
   // mCPMatrix is used for both Approximate and Exact because QgsCoordinateTransform::transformBoundingBox()
   // is not precise enough, see #13665
-  QgsPointXY myPoint = mCPMatrix[0][0];
+  QgsPointXY myPoint = cp( 0, 0 );
   mSrcExtent = QgsRectangle( myPoint.x(), myPoint.y(), myPoint.x(), myPoint.y() );
   for ( int i = 0; i < mCPRows; i++ )
   {
     for ( int j = 0; j < mCPCols ; j++ )
     {
-      myPoint = mCPMatrix[i][j];
-      if ( mCPLegalMatrix[i][j] )
+      myPoint = cp( i, j );
+      if ( cpLegal( i, j ) )
       {
         mSrcExtent.combineExtentWith( myPoint.x(), myPoint.y() );
       }
@@ -303,7 +408,7 @@ void ProjectorData::calcSrcExtent()
   QgsDebugMsgLevel( "mSrcExtent = " + mSrcExtent.toString(), 4 );
 }
 
-QString ProjectorData::cpToString()
+QString ProjectorData::cpToString() const
 {
   QString myString;
   for ( int i = 0; i < mCPRows; i++ )
@@ -314,8 +419,8 @@ QString ProjectorData::cpToString()
     {
       if ( j > 0 )
         myString += QLatin1String( "  " );
-      QgsPointXY myPoint = mCPMatrix[i][j];
-      if ( mCPLegalMatrix[i][j] )
+      QgsPointXY myPoint = cp( i, j );
+      if ( cpLegal( i, j ) )
       {
         myString += myPoint.toString();
       }
@@ -348,10 +453,10 @@ void ProjectorData::calcSrcRowsCols()
     {
       for ( int j = 0; j < mCPCols - 1; j++ )
       {
-        QgsPointXY myPointA = mCPMatrix[i][j];
-        QgsPointXY myPointB = mCPMatrix[i][j + 1];
-        QgsPointXY myPointC = mCPMatrix[i + 1][j];
-        if ( mCPLegalMatrix[i][j] && mCPLegalMatrix[i][j + 1] && mCPLegalMatrix[i + 1][j] )
+        QgsPointXY myPointA = cp( i, j );
+        QgsPointXY myPointB = cp( i, j + 1 );
+        QgsPointXY myPointC = cp( i + 1, j );
+        if ( cpLegal( i, j ) && cpLegal( i, j + 1 ) && cpLegal( i + 1, j ) )
         {
           double mySize = std::sqrt( myPointA.sqrDist( myPointB ) ) / myDestColsPerMatrixCell;
           if ( mySize < myMinSize )
@@ -402,39 +507,31 @@ void ProjectorData::calcSrcRowsCols()
 }
 
 
-inline void ProjectorData::destPointOnCPMatrix( int row, int col, double *theX, double *theY )
+inline void ProjectorData::destPointOnCPMatrix( int row, int col, double *theX, double *theY ) const
 {
   *theX = mDestExtent.xMinimum() + col * mDestExtent.width() / ( mCPCols - 1 );
   *theY = mDestExtent.yMaximum() - row * mDestExtent.height() / ( mCPRows - 1 );
 }
 
-inline int ProjectorData::matrixRow( int destRow )
+inline int ProjectorData::matrixRow( int destRow ) const
 {
   return static_cast< int >( std::floor( ( destRow + 0.5 ) / mDestRowsPerMatrixRow ) );
 }
-inline int ProjectorData::matrixCol( int destCol )
+inline int ProjectorData::matrixCol( int destCol ) const
 {
   return static_cast< int >( std::floor( ( destCol + 0.5 ) / mDestColsPerMatrixCol ) );
 }
 
-void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points )
+void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points ) const
 {
-  // TODO?: should we also precalc dest cell center coordinates for x and y?
+  const QgsPointXY *myMatrixRow = mCPMatrix.data() + static_cast< size_t >( matrixRow ) * mCPCols;
   for ( int myDestCol = 0; myDestCol < mDestCols; myDestCol++ )
   {
-    double myDestX = mDestExtent.xMinimum() + ( myDestCol + 0.5 ) * mDestXRes;
-
-    int myMatrixCol = matrixCol( myDestCol );
-
-    double myDestXMin, myDestYMin, myDestXMax, myDestYMax;
+    const int myMatrixCol = mHelperMatrixCols[myDestCol];
+    const double xfrac = mHelperXFracs[myDestCol];
 
-    destPointOnCPMatrix( matrixRow, myMatrixCol, &myDestXMin, &myDestYMin );
-    destPointOnCPMatrix( matrixRow, myMatrixCol + 1, &myDestXMax, &myDestYMax );
-
-    double xfrac = ( myDestX - myDestXMin ) / ( myDestXMax - myDestXMin );
-
-    QgsPointXY &mySrcPoint0 = mCPMatrix[matrixRow][myMatrixCol];
-    QgsPointXY &mySrcPoint1 = mCPMatrix[matrixRow][myMatrixCol + 1];
+    const QgsPointXY &mySrcPoint0 = myMatrixRow[myMatrixCol];
+    const QgsPointXY &mySrcPoint1 = myMatrixRow[myMatrixCol + 1];
     double s = mySrcPoint0.x() + ( mySrcPoint1.x() - mySrcPoint0.x() ) * xfrac;
     double t = mySrcPoint0.y() + ( mySrcPoint1.y() - mySrcPoint0.y() ) * xfrac;
 
@@ -443,30 +540,19 @@ void ProjectorData::calcHelper( int matrixRow, QgsPointXY *points )
   }
 }
 
-void ProjectorData::nextHelper()
-{
-  // We just switch pHelperTop and pHelperBottom, memory is not lost
-  QgsPointXY *tmp = nullptr;
-  tmp = pHelperTop;
-  pHelperTop = pHelperBottom;
-  pHelperBottom = tmp;
-  calcHelper( mHelperTopRow + 2, pHelperBottom );
-  mHelperTopRow++;
-}
-
-bool ProjectorData::srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+bool ProjectorData::srcRowCol( RowContext &context, int destRow, int destCol, int *srcRow, int *srcCol ) const
 {
   if ( mApproximate )
   {
-    return approximateSrcRowCol( destRow, destCol, srcRow, srcCol );
+    return approximateSrcRowCol( context, destRow, destCol, srcRow, srcCol );
   }
   else
   {
-    return preciseSrcRowCol( destRow, destCol, srcRow, srcCol );
+    return preciseSrcRowCol( context, destRow, destCol, srcRow, srcCol );
   }
 }
 
-bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+bool ProjectorData::preciseSrcRowCol( RowContext &context, int destRow, int destCol, int *srcRow, int *srcCol ) const
 {
 #if 0 // too slow, even if we only run it on debug builds!
   QgsDebugMsgLevel( QStringLiteral( "theDestRow = %1" ).arg( destRow ), 5 );
@@ -482,11 +568,11 @@ bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int
   QgsDebugMsgLevel( QStringLiteral( "x = %1 y = %2" ).arg( x ).arg( y ), 5 );
 #endif
 
-  if ( mInverseCt.isValid() )
+  if ( context.inverseCt.isValid() )
   {
     try
     {
-      mInverseCt.transformInPlace( x, y, z );
+      context.inverseCt.transformInPlace( x, y, z );
     }
     catch ( QgsCsException & )
     {
@@ -522,15 +608,24 @@ bool ProjectorData::preciseSrcRowCol( int destRow, int destCol, int *srcRow, int
   return true;
 }
 
-bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol )
+bool ProjectorData::approximateSrcRowCol( RowContext &context, int destRow, int destCol, int *srcRow, int *srcCol ) const
 {
   int myMatrixRow = matrixRow( destRow );
-  int myMatrixCol = matrixCol( destCol );
+  int myMatrixCol = mHelperMatrixCols[destCol];
 
-  if ( myMatrixRow > mHelperTopRow )
+  if ( myMatrixRow != context.helperRow )
   {
-    // TODO: make it more robust (for random, not sequential reading)
-    nextHelper();
+    if ( myMatrixRow == context.helperRow + 1 )
+    {
+      // We just switch helper top and bottom, memory is not lost
+      std::swap( context.helperTop, context.helperBottom );
+    }
+    else
+    {
+      calcHelper( myMatrixRow, context.helperTop.data() );
+    }
+    calcHelper( myMatrixRow + 1, context.helperBottom.data() );
+    context.helperRow = myMatrixRow;
   }
 
   double myDestY = mDestExtent.yMaximum() - ( destRow + 0.5 ) * mDestYRes;
@@ -544,8 +639,8 @@ bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow,
 
   double yfrac = ( myDestY - myDestYMin ) / ( myDestYMax - myDestYMin );
 
-  QgsPointXY &myTop = pHelperTop[destCol];
-  QgsPointXY &myBot = pHelperBottom[destCol];
+  const QgsPointXY &myTop = context.helperTop[destCol];
+  const QgsPointXY &myBot = context.helperBottom[destCol];
 
   // Warning: this is very SLOW compared to the following code!:
   //double mySrcX = myBot.x() + (myTop.x() - myBot.x()) * yfrac;
@@ -581,22 +676,19 @@ bool ProjectorData::approximateSrcRowCol( int destRow, int destCol, int *srcRow,
 
 void ProjectorData::insertRows( const QgsCoordinateTransform &ct )
 {
-  for ( int r = 0; r < mCPRows - 1; r++ )
+  // existing rows move to even indexes, new rows are inserted in between
+  const int newRows = mCPRows + mCPRows - 1;
+  std::vector< QgsPointXY > newMatrix( static_cast< size_t >( newRows ) * mCPCols );
+  std::vector< char > newLegalMatrix( static_cast< size_t >( newRows ) * mCPCols, false );
+  for ( int r = 0; r < mCPRows; r++ )
   {
-    QList<QgsPointXY> myRow;
-    QList<bool> myLegalRow;
-    myRow.reserve( mCPCols );
-    myLegalRow.reserve( mCPCols );
-    for ( int c = 0; c < mCPCols; ++c )
-    {
-      myRow.append( QgsPointXY() );
-      myLegalRow.append( false );
-    }
-    QgsDebugMsgLevel( QStringLiteral( "insert new row at %1" ).arg( 1 + r * 2 ), 3 );
-    mCPMatrix.insert( 1 + r * 2, myRow );
-    mCPLegalMatrix.insert( 1 + r * 2, myLegalRow );
+    std::copy_n( mCPMatrix.begin() + static_cast< size_t >( r ) * mCPCols, mCPCols, newMatrix.begin() + static_cast< size_t >( 2 * r ) * mCPCols );
+    std::copy_n( mCPLegalMatrix.begin() + static_cast< size_t >( r ) * mCPCols, mCPCols, newLegalMatrix.begin() + static_cast< size_t >( 2 * r ) * mCPCols );
   }
-  mCPRows += mCPRows - 1;
+  QgsDebugMsgLevel( QStringLiteral( "insert %1 new rows" ).arg( mCPRows - 1 ), 3 );
+  mCPMatrix.swap( newMatrix );
+  mCPLegalMatrix.swap( newLegalMatrix );
+  mCPRows = newRows;
   for ( int r = 1; r < mCPRows - 1; r += 2 )
   {
     calcRow( r, ct );
@@ -605,15 +697,21 @@ void ProjectorData::insertRows( const QgsCoordinateTransform &ct )
 
 void ProjectorData::insertCols( const QgsCoordinateTransform &ct )
 {
+  // existing columns move to even indexes, new columns are inserted in between
+  const int newCols = mCPCols + mCPCols - 1;
+  std::vector< QgsPointXY > newMatrix( static_cast< size_t >( mCPRows ) * newCols );
+  std::vector< char > newLegalMatrix( static_cast< size_t >( mCPRows ) * newCols, false );
   for ( int r = 0; r < mCPRows; r++ )
   {
-    for ( int c = 0; c < mCPCols - 1; c++ )
+    for ( int c = 0; c < mCPCols; c++ )
     {
-      mCPMatrix[r].insert( 1 + c * 2, QgsPointXY() );
-      mCPLegalMatrix[r].insert( 1 + c * 2, false );
+      newMatrix[static_cast< size_t >( r ) * newCols + 2 * c] = cp( r, c );
+      newLegalMatrix[static_cast< size_t >( r ) * newCols + 2 * c] = cpLegal( r, c );
     }
   }
-  mCPCols += mCPCols - 1;
+  mCPMatrix.swap( newMatrix );
+  mCPLegalMatrix.swap( newLegalMatrix );
+  mCPCols = newCols;
   for ( int c = 1; c < mCPCols - 1; c += 2 )
   {
     calcCol( c, ct );
@@ -626,23 +724,24 @@ void ProjectorData::calcCP( int row, int col, const QgsCoordinateTransform &ct )
   double myDestX, myDestY;
   destPointOnCPMatrix( row, col, &myDestX, &myDestY );
   QgsPointXY myDestPoint( myDestX, myDestY );
+  const size_t index = static_cast< size_t >( row ) * mCPCols + col;
   try
   {
     if ( ct.isValid() )
     {
-      mCPMatrix[row][col] = ct.transform( myDestPoint );
-      mCPLegalMatrix[row][col] = true;
+      mCPMatrix[index] = ct.transform( myDestPoint );
+      mCPLegalMatrix[index] = true;
     }
     else
     {
-      mCPLegalMatrix[row][col] = false;
+      mCPLegalMatrix[index] = false;
     }
   }
   catch ( QgsCsException &e )
   {
     Q_UNUSED( e )
     // Caught an error in transform
-    mCPLegalMatrix[row][col] = false;
+    mCPLegalMatrix[index] = false;
   }
 }
 
@@ -683,12 +782,11 @@ bool ProjectorData::checkCols( const QgsCoordinateTransform &ct )
       destPointOnCPMatrix( r, c, &myDestX, &myDestY );
       QgsPointXY myDestPoint( myDestX, myDestY );
 
-      QgsPointXY mySrcPoint1 = mCPMatrix[r - 1][c];
-      QgsPointXY mySrcPoint2 = mCPMatrix[r][c];
-      QgsPointXY mySrcPoint3 = mCPMatrix[r + 1][c];
+      const QgsPointXY &mySrcPoint1 = cp( r - 1, c );
+      const QgsPointXY &mySrcPoint3 = cp( r + 1, c );
 
       QgsPointXY mySrcApprox( ( mySrcPoint1.x() + mySrcPoint3.x() ) / 2, ( mySrcPoint1.y() + mySrcPoint3.y() ) / 2 );
-      if ( !mCPLegalMatrix[r - 1][c] || !mCPLegalMatrix[r][c] || !mCPLegalMatrix[r + 1][c] )
+      if ( !cpLegal( r - 1, c ) || !cpLegal( r, c ) || !cpLegal( r + 1, c ) )
       {
         // There was an error earlier in transform, just abort
         return false;
@@ -728,12 +826,11 @@ bool ProjectorData::checkRows( const QgsCoordinateTransform &ct )
       destPointOnCPMatrix( r, c, &myDestX, &myDestY );
 
       QgsPointXY myDestPoint( myDestX, myDestY );
-      QgsPointXY mySrcPoint1 = mCPMatrix[r][c - 1];
-      QgsPointXY mySrcPoint2 = mCPMatrix[r][c];
-      QgsPointXY mySrcPoint3 = mCPMatrix[r][c + 1];
+      const QgsPointXY &mySrcPoint1 = cp( r, c - 1 );
+      const QgsPointXY &mySrcPoint3 = cp( r, c + 1 );
 
       QgsPointXY mySrcApprox( ( mySrcPoint1.x() + mySrcPoint3.x() ) / 2, ( mySrcPoint1.y() + mySrcPoint3.y() ) / 2 );
-      if ( !mCPLegalMatrix[r][c - 1] || !mCPLegalMatrix[r][c] || !mCPLegalMatrix[r][c + 1] )
+      if ( !cpLegal( r, c - 1 ) || !cpLegal( r, c ) || !cpLegal( r, c + 1 ) )
       {
         // There was an error earlier in transform, just abort
         return false;
@@ -795,12 +892,31 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
   Q_NOWARN_DEPRECATED_PUSH
   const QgsCoordinateTransform inverseCt = mSrcDatumTransform != -1 || mDestDatumTransform != -1 ?
       QgsCoordinateTransform( mDestCRS, mSrcCRS, mDestDatumTransform, mSrcDatumTransform ) : QgsCoordinateTransform( mDestCRS, mSrcCRS, mTransformContext ) ;
+
+  QgsRasterProjectorGridCache::Key gridKey;
+  gridKey.destExtent = extent;
+  gridKey.width = width;
+  gridKey.height = height;
+  gridKey.precision = mPrecision;
+  gridKey.srcCrs = mSrcCRS;
+  gridKey.destCrs = mDestCRS;
+  gridKey.transformContext = mTransformContext;
+  gridKey.srcDatumTransform = mSrcDatumTransform;
+  gridKey.destDatumTransform = mDestDatumTransform;
   Q_NOWARN_DEPRECATED_POP
+  ProjectorData::sourceLimits( mInput, gridKey.srcLimitExtent, gridKey.maxSrcXRes, gridKey.maxSrcYRes );
 
-  ProjectorData pd( extent, width, height, mInput, inverseCt, mPrecision, feedback );
+  std::shared_ptr< const ProjectorData > projectorData = mGridCache->find( gridKey );
+  if ( !projectorData )
+  {
+    projectorData = std::make_shared< ProjectorData >( extent, width, height, mInput, inverseCt, mPrecision, feedback );
 
-  if ( feedback && feedback->isCanceled() )
-    return new QgsRasterBlock();
+    if ( feedback && feedback->isCanceled() )
+      return new QgsRasterBlock();
+
+    mGridCache->insert( gridKey, projectorData );
+  }
+  const ProjectorData &pd = *projectorData;
 
   QgsDebugMsgLevel( QStringLiteral( "srcExtent:\n%1" ).arg( pd.srcExtent().toString() ), 4 );
   QgsDebugMsgLevel( QStringLiteral( "srcCols = %1 srcRows = %2" ).arg( pd.srcCols() ).arg( pd.srcRows() ), 4 );
@@ -849,41 +965,61 @@ QgsRasterBlock *QgsRasterProjector::block( int bandNo, QgsRectangle  const &exte
 
   outputBlock->setIsNoData();
 
-  int srcRow, srcCol;
-  for ( int i = 0; i < height; ++i )
+  // get data pointers once, so that image backed blocks are not detached from concurrent threads
+  const char *srcData = inputBlock->bits();
+  char *destData = outputBlock->bits();
+  if ( !srcData || !destData )
   {
-    if ( feedback && feedback->isCanceled() )
-      break;
-    for ( int j = 0; j < width; ++j )
-    {
-      bool inside = pd.srcRowCol( i, j, &srcRow, &srcCol );
-      if ( !inside ) continue; // we have everything set to no data
+    QgsDebugMsg( QStringLiteral( "Cannot get block data" ) );
+    return outputBlock.release();
+  }
 
-      qgssize srcIndex = static_cast< qgssize >( srcRow * pd.srcCols() + srcCol );
+  const int srcCols = pd.srcCols();
+  QgsRasterBlock *input = inputBlock.get();
+  QgsRasterBlock *output = outputBlock.get();
 
-      // isNoData() may be slow so we check doNoData first
-      if ( doNoData && inputBlock->isNoData( srcRow, srcCol ) )
+  // projects rows [firstRow, lastRow] of the output. Every row band writes only to its own
+  // rows of the output block, so bands can be processed concurrently
+  auto projectRows = [ =, &pd]( const QPair< int, int > &rows )
+  {
+    ProjectorData::RowContext context = pd.createRowContext();
+    int srcRow, srcCol;
+    for ( int i = rows.first; i <= rows.second; ++i )
+    {
+      if ( feedback && feedback->isCanceled() )
+        break;
+      for ( int j = 0; j < width; ++j )
       {
-        outputBlock->setIsNoData( i, j );
-        continue;
-      }
+        bool inside = pd.srcRowCol( context, i, j, &srcRow, &srcCol );
+        if ( !inside ) continue; // we have everything set to no data
 
-      qgssize destIndex = static_cast< qgssize >( i * width + j );
-      char *srcBits = inputBlock->bits( srcIndex );
-      char *destBits = outputBlock->bits( destIndex );
-      if ( !srcBits )
-      {
-        // QgsDebugMsg( QStringLiteral( "Cannot get input block data: row = %1 col = %2" ).arg( i ).arg( j ) );
-        continue;
-      }
-      if ( !destBits )
-      {
-        // QgsDebugMsg( QStringLiteral( "Cannot set output block data: srcRow = %1 srcCol = %2" ).arg( srcRow ).arg( srcCol ) );
-        continue;
+        // isNoData() may be slow so we check doNoData first
+        if ( doNoData && input->isNoData( srcRow, srcCol ) )
+        {
+          output->setIsNoData( i, j );
+          continue;
+        }
+
+        const qgssize srcIndex = static_cast< qgssize >( srcRow ) * srcCols + srcCol;
+        const qgssize destIndex = static_cast< qgssize >( i ) * width + j;
+        memcpy( destData + destIndex * pixelSize, srcData + srcIndex * pixelSize, pixelSize );
+        output->setIsData( i, j );
       }
-      memcpy( destBits, srcBits, pixelSize );
-      outputBlock->setIsData( i, j );
     }
+  };
+
+  QVector< QPair< int, int > > rowBands;
+  for ( int firstRow = 0; firstRow < height; firstRow += PARALLEL_BAND_HEIGHT )
+    rowBands << qMakePair( firstRow, std::min( firstRow + PARALLEL_BAND_HEIGHT, height ) - 1 );
+
+  if ( rowBands.size() > 1 && static_cast< qgssize >( width ) * height >= PARALLEL_PIXEL_THRESHOLD && QThreadPool::globalInstance()->maxThreadCount() > 1 )
+  {
+    QtConcurrent::blockingMap( rowBands, projectRows );
+  }
+  else
+  {
+    for ( const QPair< int, int > &rows : std::as_const( rowBands ) )
+      projectRows( rows );
   }
 
   return outputBlock.release();
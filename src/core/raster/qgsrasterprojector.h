@@ -34,8 +34,11 @@
 #include "qgsrasterinterface.h"
 
 #include <cmath>
+#include <memory>
+#include <vector>
 
 class QgsPointXY;
+class QgsRasterProjectorGridCache;
 
 /**
  * \ingroup core
@@ -124,6 +127,11 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
 
     QgsCoordinateTransformContext mTransformContext;
 
+#ifndef SIP_RUN
+    //! Cache of transform grids, shared with clones of this projector
+    std::shared_ptr< QgsRasterProjectorGridCache > mGridCache;
+#endif
+
 };
 
 
@@ -132,46 +140,79 @@ class CORE_EXPORT QgsRasterProjector : public QgsRasterInterface
 
 /**
  * Internal class for reprojection of rasters - either exact or approximate.
- * QgsRasterProjector creates it and then keeps calling srcRowCol() to get source pixel position
- * for every destination pixel position.
+ * QgsRasterProjector creates it (or reuses a cached one with identical parameters) and then keeps
+ * calling srcRowCol() to get source pixel position for every destination pixel position.
  */
 class ProjectorData
 {
   public:
+
+    /**
+     * Per thread state used to look up source cells of consecutive destination rows.
+     * \see createRowContext()
+     */
+    struct RowContext
+    {
+      //! Matrix row of the helper points, -1 if not yet calculated
+      int helperRow = -1;
+      //! Source points for each destination column on top of current matrix row
+      std::vector< QgsPointXY > helperTop;
+      //! Source points for each destination column on bottom of current matrix row
+      std::vector< QgsPointXY > helperBottom;
+      //! Copy of the transformation from destination CRS to source CRS owned by the thread
+      QgsCoordinateTransform inverseCt;
+    };
+
     //! Initialize reprojector and calculate matrix
     ProjectorData( const QgsRectangle &extent, int width, int height, QgsRasterInterface *input, const QgsCoordinateTransform &inverseCt, QgsRasterProjector::Precision precision, QgsRasterBlockFeedback *feedback = nullptr );
-    ~ProjectorData();
 
     ProjectorData( const ProjectorData &other ) = delete;
     ProjectorData &operator=( const ProjectorData &other ) = delete;
 
+    //! Creates a new row context, each thread looking up source cells needs its own context
+    RowContext createRowContext() const;
+
     /**
-     * Returns the source row and column indexes for current source extent and resolution.
-     * If the source pixel is outside source extent srcRow and srcCol are left unchanged.
-     * \returns TRUE if inside source
+     * Returns source row and column indexes for destination cell.
+     * The object itself is not modified, so it can be shared between threads using distinct \a context.
      */
-    bool srcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    bool srcRowCol( RowContext &context, int destRow, int destCol, int *srcRow, int *srcCol ) const;
 
     QgsRectangle srcExtent() const { return mSrcExtent; }
     int srcRows() const { return mSrcRows; }
     int srcCols() const { return mSrcCols; }
 
+    /**
+     * Retrieves source raster limits used to constrain the projected extent.
+     * \param input raster interface, its source provider is used
+     * \param extent full source raster extent, or empty rectangle if unknown
+     * \param maxSrcXRes maximum source x resolution, or 0 if there is no limit
+     * \param maxSrcYRes maximum source y resolution, or 0 if there is no limit
+     */
+    static void sourceLimits( QgsRasterInterface *input, QgsRectangle &extent, double &maxSrcXRes, double &maxSrcYRes );
+
   private:
 
     //! Returns the destination point for _current_ destination position.
-    void destPointOnCPMatrix( int row, int col, double *theX, double *theY );
+    void destPointOnCPMatrix( int row, int col, double *theX, double *theY ) const;
 
     //! Returns the matrix upper left row index for destination row.
-    int matrixRow( int destRow );
+    int matrixRow( int destRow ) const;
 
     //! Returns the matrix upper left col index for destination col.
-    int matrixCol( int destCol );
+    int matrixCol( int destCol ) const;
+
+    //! Returns source control point at matrix row and column
+    const QgsPointXY &cp( int row, int col ) const { return mCPMatrix[static_cast< size_t >( row ) * mCPCols + col]; }
+
+    //! Returns TRUE if source control point at matrix row and column could be transformed
+    bool cpLegal( int row, int col ) const { return mCPLegalMatrix[static_cast< size_t >( row ) * mCPCols + col]; }
 
     //! Returns precise source row and column indexes for current source extent and resolution.
-    inline bool preciseSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    inline bool preciseSrcRowCol( RowContext &context, int destRow, int destCol, int *srcRow, int *srcCol ) const;
 
     //! Returns approximate source row and column indexes for current source extent and resolution.
-    inline bool approximateSrcRowCol( int destRow, int destCol, int *srcRow, int *srcCol );
+    inline bool approximateSrcRowCol( RowContext &context, int destRow, int destCol, int *srcRow, int *srcCol ) const;
 
     //! \brief insert rows to matrix
     void insertRows( const QgsCoordinateTransform &ct );
@@ -207,13 +248,10 @@ class ProjectorData
     bool checkRows( const QgsCoordinateTransform &ct );
 
     //! Calculate array of src helper points
-    void calcHelper( int matrixRow, QgsPointXY *points );
-
-    //! Calc / switch helper
-    void nextHelper();
+    void calcHelper( int matrixRow, QgsPointXY *points ) const;
 
     //! Gets mCPMatrix as string
-    QString cpToString();
+    QString cpToString() const;
 
     /**
      * Use approximation (requested precision is Approximate and it is possible to calculate
@@ -263,23 +301,18 @@ class ProjectorData
     //! Number of destination cols per matrix col
     double mDestColsPerMatrixCol;
 
-    //! Grid of source control points
-    QList< QList<QgsPointXY> > mCPMatrix;
+    //! Grid of source control points, stored row by row
+    std::vector< QgsPointXY > mCPMatrix;
 
     //! Grid of source control points transformation possible indicator
     /* Same size as mCPMatrix */
-    QList< QList<bool> > mCPLegalMatrix;
-
-    //! Array of source points for each destination column on top of current CPMatrix grid row
-    /* Warning: using QList is slow on access */
-    QgsPointXY *pHelperTop = nullptr;
+    std::vector< char > mCPLegalMatrix;
 
-    //! Array of source points for each destination column on bottom of current CPMatrix grid row
-    /* Warning: using QList is slow on access */
-    QgsPointXY *pHelperBottom = nullptr;
+    //! Matrix column of each destination column
+    std::vector< int > mHelperMatrixCols;
 
-    //! Current mHelperTop matrix row
-    int mHelperTopRow;
+    //! Fraction of each destination column center between its matrix column and the next one
+    std::vector< double > mHelperXFracs;
 
     //! Number of mCPMatrix columns
     int mCPCols;
@@ -23,6 +23,7 @@
 #include "qgsreadwritecontext.h"
 #include "qgscolorramp.h"
 #include "qgssymbol.h"
+#include "qgsrasterpixelprocessor_p.h"
 
 #include <QDomDocument>
 #include <QDomElement>
@@ -130,52 +131,82 @@ QgsRasterBlock *QgsSingleBandGrayRenderer::block( int bandNo, const QgsRectangle
   }
 
   const QRgb myDefaultColor = renderColorForNodataPixel();
-  bool isNoData = false;
-  for ( qgssize i = 0; i < ( qgssize )width * height; i++ )
+  QRgb *outputBlockData = outputBlock->colorData();
+  QgsContrastEnhancement *contrastEnhancement = mContrastEnhancement.get();
+  const QgsRasterTransparency *rasterTransparency = mRasterTransparency;
+  const double opacity = mOpacity;
+  const int alphaBand = mAlphaBand;
+  const Gradient gradient = mGradient;
+
+  // the contrast enhancement builds its lookup table on first use, make sure this
+  // happens before the block is possibly processed by several threads
+  if ( contrastEnhancement )
   {
-    double grayVal = inputBlock->valueAndNoData( i, isNoData );
-
-    if ( isNoData )
-    {
-      outputBlock->setColor( i, myDefaultColor );
-      continue;
-    }
+    contrastEnhancement->enhanceContrast( contrastEnhancement->minimumValue() );
+  }
 
-    double currentAlpha = mOpacity;
-    if ( mRasterTransparency )
+  auto colorForValue = [ = ]( double grayVal, qgssize i ) -> QRgb
+  {
+    double currentAlpha = opacity;
+    if ( rasterTransparency )
     {
-      currentAlpha = mRasterTransparency->alphaValue( grayVal, mOpacity * 255 ) / 255.0;
+      currentAlpha = rasterTransparency->alphaValue( grayVal, opacity * 255 ) / 255.0;
     }
-    if ( mAlphaBand > 0 )
+    if ( alphaBand > 0 )
     {
       currentAlpha *= alphaBlock->value( i ) / 255.0;
     }
 
-    if ( mContrastEnhancement )
+    if ( contrastEnhancement )
     {
-      if ( !mContrastEnhancement->isValueInDisplayableRange( grayVal ) )
+      if ( !contrastEnhancement->isValueInDisplayableRange( grayVal ) )
       {
-        outputBlock->setColor( i, myDefaultColor );
-        continue;
+        return myDefaultColor;
       }
-      grayVal = mContrastEnhancement->enhanceContrast( grayVal );
+      grayVal = contrastEnhancement->enhanceContrast( grayVal );
     }
 
-    if ( mGradient == WhiteToBlack )
+    if ( gradient == WhiteToBlack )
     {
       grayVal = 255 - grayVal;
     }
 
     if ( qgsDoubleNear( currentAlpha, 1.0 ) )
     {
-      outputBlock->setColor( i, qRgba( grayVal, grayVal, grayVal, 255 ) );
+      return qRgba( grayVal, grayVal, grayVal, 255 );
     }
     else
     {
-      outputBlock->setColor( i, qRgba( currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * 255 ) );
+      return qRgba( currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * grayVal, currentAlpha * 255 );
     }
+  };
+
+  const qgssize count = ( qgssize )width * height;
+
+  // without an alpha band the color only depends on the value, so blocks of integer values
+  // are colored through a lookup table holding the color of every value of the data type
+  int lookupTableMinimum = 0;
+  int lookupTableSize = 0;
+  if ( mAlphaBand <= 0 && QgsRasterPixelProcessor::useLookupTable( inputBlock.get(), count, lookupTableMinimum, lookupTableSize ) )
+  {
+    const std::vector< QRgb > lookupTable = QgsRasterPixelProcessor::buildLookupTable( inputBlock.get(), lookupTableMinimum, lookupTableSize, myDefaultColor, [&colorForValue]( double value )
+    {
+      return colorForValue( value, 0 );
+    } );
+    QgsRasterPixelProcessor::mapThroughLookupTable( inputBlock.get(), count, lookupTable, lookupTableMinimum, myDefaultColor, outputBlockData );
+    return outputBlock.release();
   }
 
+  QgsRasterPixelProcessor::processPixels( count, [ = ]( qgssize start, qgssize end )
+  {
+    bool isNoData = false;
+    for ( qgssize i = start; i < end; i++ )
+    {
+      const double grayVal = inputBlock->valueAndNoData( i, isNoData );
+      outputBlockData[i] = isNoData ? myDefaultColor : colorForValue( grayVal, i );
+    }
+  } );
+
   return outputBlock.release();
 }
 
@@ -23,6 +23,7 @@
 #include "qgsrasterviewport.h"
 #include "qgsstyleentityvisitor.h"
 #include "qgscolorramplegendnode.h"
+#include "qgsrasterpixelprocessor_p.h"
 
 #include <QDomDocument>
 #include <QDomElement>
@@ -234,23 +235,16 @@ QgsRasterBlock *QgsSingleBandPseudoColorRenderer::block( int bandNo, QgsRectangl
   const QRgb myDefaultColor = renderColorForNodataPixel();
   QRgb *outputBlockData = outputBlock->colorData();
   const QgsRasterShaderFunction *fcn = mShader->rasterShaderFunction();
+  const QgsRasterTransparency *rasterTransparency = mRasterTransparency;
+  const double opacity = mOpacity;
+  const int alphaBand = mAlphaBand;
 
-  qgssize count = ( qgssize )width * height;
-  bool isNoData = false;
-  for ( qgssize i = 0; i < count; i++ )
+  auto colorForValue = [ = ]( double val, qgssize i ) -> QRgb
   {
-    double val = inputBlock->valueAndNoData( i, isNoData );
-    if ( isNoData )
-    {
-      outputBlockData[i] = myDefaultColor;
-      continue;
-    }
-
     int red, green, blue, alpha;
     if ( !fcn->shade( val, &red, &green, &blue, &alpha ) )
     {
-      outputBlockData[i] = myDefaultColor;
-      continue;
+      return myDefaultColor;
     }
 
     if ( alpha < 255 )
@@ -263,23 +257,60 @@ QgsRasterBlock *QgsSingleBandPseudoColorRenderer::block( int bandNo, QgsRectangl
 
     if ( !hasTransparency )
     {
-      outputBlockData[i] = qRgba( red, green, blue, alpha );
+      return qRgba( red, green, blue, alpha );
     }
-    else
+
+    //opacity
+    double currentOpacity = opacity;
+    if ( rasterTransparency )
     {
-      //opacity
-      double currentOpacity = mOpacity;
-      if ( mRasterTransparency )
-      {
-        currentOpacity = mRasterTransparency->alphaValue( val, mOpacity * 255 ) / 255.0;
-      }
-      if ( mAlphaBand > 0 )
-      {
-        currentOpacity *= alphaBlock->value( i ) / 255.0;
-      }
+      currentOpacity = rasterTransparency->alphaValue( val, opacity * 255 ) / 255.0;
+    }
+    if ( alphaBand > 0 )
+    {
+      currentOpacity *= alphaBlock->value( i ) / 255.0;
+    }
+
+    return qRgba( currentOpacity * red, currentOpacity * green, currentOpacity * blue, currentOpacity * alpha );
+  };
 
-      outputBlockData[i] = qRgba( currentOpacity * red, currentOpacity * green, currentOpacity * blue, currentOpacity * alpha );
+  const qgssize count = ( qgssize )width * height;
+
+  // without an alpha band the color only depends on the value, so blocks of integer values
+  // are colored through a lookup table holding the color of every value of the data type
+  int lookupTableMinimum = 0;
+  int lookupTableSize = 0;
+  if ( mAlphaBand <= 0 && QgsRasterPixelProcessor::useLookupTable( inputBlock.get(), count, lookupTableMinimum, lookupTableSize ) )
+  {
+    const std::vector< QRgb > lookupTable = QgsRasterPixelProcessor::buildLookupTable( inputBlock.get(), lookupTableMinimum, lookupTableSize, myDefaultColor, [&colorForValue]( double value )
+    {
+      return colorForValue( value, 0 );
+    } );
+    QgsRasterPixelProcessor::mapThroughLookupTable( inputBlock.get(), count, lookupTable, lookupTableMinimum, myDefaultColor, outputBlockData );
+    return outputBlock.release();
+  }
+
+  auto processRange = [ = ]( qgssize start, qgssize end )
+  {
+    bool isNoData = false;
+    for ( qgssize i = start; i < end; i++ )
+    {
+      const double val = inputBlock->valueAndNoData( i, isNoData );
+      outputBlockData[i] = isNoData ? myDefaultColor : colorForValue( val, i );
     }
+  };
+
+  // the color ramp shader is safe to use from several threads once its lookup table
+  // is initialized, which the first call to shade() does
+  if ( dynamic_cast< const QgsColorRampShader * >( fcn ) )
+  {
+    int red, green, blue, alpha;
+    fcn->shade( 0, &red, &green, &blue, &alpha );
+    QgsRasterPixelProcessor::processPixels( count, processRange );
+  }
+  else
+  {
+    processRange( 0, count );
   }
 
   return outputBlock.release();
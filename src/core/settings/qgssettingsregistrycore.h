@@ -128,6 +128,9 @@ class CORE_EXPORT QgsSettingsRegistryCore : public QgsSettingsRegistry
     //! Settings entry digitizing snap invisible feature
     static const inline QgsSettingsEntryBool settingsDigitizingSnapInvisibleFeature = QgsSettingsEntryBool( QStringLiteral( "/qgis/digitizing/snap_invisible_feature" ), QgsSettings::NoSection, false );
 
+    //! Settings entry digitizing maximum number of vertices cached by the tiled snapping index of each layer
+    static const inline QgsSettingsEntryInteger settingsDigitizingSnapIndexMaxVertices = QgsSettingsEntryInteger( QStringLiteral( "/qgis/digitizing/snap_index_max_vertices" ), QgsSettings::NoSection, 10000000 );
+
     //! Settings entry digitizing marker only for selected
     static const inline QgsSettingsEntryBool settingsDigitizingMarkerOnlyForSelected = QgsSettingsEntryBool( QStringLiteral( "/qgis/digitizing/marker_only_for_selected" ), QgsSettings::NoSection, true );
 
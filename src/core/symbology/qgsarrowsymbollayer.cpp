@@ -728,8 +728,8 @@ void QgsArrowSymbolLayer::renderPolyline( const QPolygonF &points, QgsSymbolRend
   }
 
   context.renderContext().expressionContext().appendScope( mExpressionScope.get() );
-  mExpressionScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_COUNT, points.size() + 1, true ) );
-  mExpressionScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, 1, true ) );
+  mExpressionScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointCount, points.size() + 1 );
+  mExpressionScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, 1 );
 
   const double prevOpacity = mSymbol->opacity();
   mSymbol->setOpacity( prevOpacity * context.opacity() );
@@ -771,7 +771,7 @@ void QgsArrowSymbolLayer::renderPolyline( const QPolygonF &points, QgsSymbolRend
         if ( context.renderContext().renderingStopped() )
           break;
 
-        mExpressionScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, pIdx + 1, true ) );
+        mExpressionScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, pIdx + 1 );
         _resolveDataDefined( context );
 
         if ( points.size() - pIdx >= 3 )
@@ -825,7 +825,7 @@ void QgsArrowSymbolLayer::renderPolyline( const QPolygonF &points, QgsSymbolRend
         if ( context.renderContext().renderingStopped() )
           break;
 
-        mExpressionScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, pIdx + 1, true ) );
+        mExpressionScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, pIdx + 1 );
         _resolveDataDefined( context );
 
         // origin point
@@ -3562,7 +3562,7 @@ void QgsPointPatternFillSymbolLayer::renderPolygon( const QPolygonF &points, con
   for ( double currentX = ( std::floor( left / width ) - 2 ) * width; currentX <= right + 2 * width; currentX += width, alternateColumn = !alternateColumn )
   {
     if ( needsExpressionContext )
-      scope->addVariable( QgsExpressionContextScope::StaticVariable( QStringLiteral( "symbol_marker_column" ), ++currentCol, true ) );
+      scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolMarkerColumn, ++currentCol );
 
     bool alternateRow = false;
     const double columnX = currentX + widthOffset;
@@ -3579,8 +3579,8 @@ void QgsPointPatternFillSymbolLayer::renderPolygon( const QPolygonF &points, con
 
       if ( needsExpressionContext )
       {
-        scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, ++pointNum, true ) );
-        scope->addVariable( QgsExpressionContextScope::StaticVariable( QStringLiteral( "symbol_marker_row" ), ++currentRow, true ) );
+        scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, ++pointNum );
+        scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolMarkerRow, ++currentRow );
       }
 
       mMarkerSymbol->renderPoint( QPointF( x, y ), context.feature(), context.renderContext() );
@@ -4605,7 +4605,7 @@ void QgsRandomMarkerFillSymbolLayer::render( QgsRenderContext &context, const QV
   for ( const QgsPointXY &p : std::as_const( randomPoints ) )
   {
     if ( needsExpressionContext )
-      scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, ++pointNum, true ) );
+      scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, ++pointNum );
     mMarker->renderPoint( QPointF( p.x(), p.y() ), feature.isValid() ? &feature : nullptr, context, -1, selected );
   }
 
@@ -320,7 +320,7 @@ void QgsSimpleLineSymbolLayer::renderPolygonStroke( const QPolygonF &points, con
       }
 
       if ( scope )
-        scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_RING_NUM, 0, true ) );
+        scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryRingNum, 0 );
 
       renderPolyline( points, context );
     }
@@ -342,7 +342,7 @@ void QgsSimpleLineSymbolLayer::renderPolygonStroke( const QPolygonF &points, con
         for ( const QPolygonF &ring : std::as_const( *rings ) )
         {
           if ( scope )
-            scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_RING_NUM, ringIndex, true ) );
+            scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryRingNum, ringIndex );
 
           renderPolyline( ring, context );
           ringIndex++;
@@ -1348,7 +1348,7 @@ void QgsTemplatedLineSymbolLayerBase::renderPolygonStroke( const QPolygonF &poin
     case ExteriorRingOnly:
     {
       if ( scope )
-        scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_RING_NUM, 0, true ) );
+        scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryRingNum, 0 );
 
       renderPolyline( points, context );
       break;
@@ -1372,7 +1372,7 @@ void QgsTemplatedLineSymbolLayerBase::renderPolygonStroke( const QPolygonF &poin
             context.renderContext().setGeometry( curvePolygon->interiorRing( i ) );
           }
           if ( scope )
-            scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_RING_NUM, i + 1, true ) );
+            scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryRingNum, i + 1 );
 
           renderPolyline( rings->at( i ), context );
         }
@@ -1678,7 +1678,7 @@ void QgsTemplatedLineSymbolLayerBase::renderPolylineInterval( const QPolygonF &p
         setSymbolLineAngle( l.angle() * 180 / M_PI );
       }
 
-      scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, ++pointNum, true ) );
+      scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, ++pointNum );
       renderSymbol( pt, context.feature(), rc, -1, context.selected() );
     }
   }
@@ -1719,7 +1719,7 @@ void QgsTemplatedLineSymbolLayerBase::renderPolylineInterval( const QPolygonF &p
         // "c" is 1 for regular point or in interval (0,1] for begin of line segment
         lastPt += c * diff;
         lengthLeft -= painterUnitInterval;
-        scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, ++pointNum, true ) );
+        scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, ++pointNum );
         renderSymbol( lastPt, context.feature(), rc, -1, context.selected() );
         c = 1; // reset c (if wasn't 1 already)
       }
@@ -1752,7 +1752,7 @@ void QgsTemplatedLineSymbolLayerBase::renderPolylineVertex( const QPolygonF &poi
 
   QgsExpressionContextScope *scope = new QgsExpressionContextScope();
   QgsExpressionContextScopePopper scopePopper( context.renderContext().expressionContext(), scope );
-  scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_COUNT, points.size(), true ) );
+  scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointCount, points.size() );
 
   double offsetAlongLine = mOffsetAlongLine;
   if ( mDataDefinedProperties.isActive( QgsSymbolLayer::PropertyOffsetAlongLine ) )
@@ -1782,7 +1782,7 @@ void QgsTemplatedLineSymbolLayerBase::renderPolylineVertex( const QPolygonF &poi
       if ( context.renderContext().renderingStopped() )
         break;
 
-      scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, ++pointNum, true ) );
+      scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, ++pointNum );
 
       if ( ( placement == QgsTemplatedLineSymbolLayerBase::Vertex && vId.type == QgsVertexId::SegmentVertex )
            || ( placement == QgsTemplatedLineSymbolLayerBase::CurvePoint && vId.type == QgsVertexId::CurveVertex ) )
@@ -1861,7 +1861,7 @@ void QgsTemplatedLineSymbolLayerBase::renderPolylineVertex( const QPolygonF &poi
   QPointF symbolPoint;
   for ( ; i < maxCount; ++i )
   {
-    scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM, ++pointNum, true ) );
+    scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPointNum, ++pointNum );
 
     if ( isRing && placement == QgsTemplatedLineSymbolLayerBase::Vertex && i == points.count() - 1 )
     {
@@ -472,15 +472,15 @@ QgsExpressionContextScope *QgsPointDistanceRenderer::createGroupScope( const Clu
 
     if ( groupColor.isValid() )
     {
-      clusterScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_CLUSTER_COLOR, QgsSymbolLayerUtils::encodeColor( groupColor ), true ) );
+      clusterScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::ClusterColor, QgsSymbolLayerUtils::encodeColor( groupColor ) );
     }
     else
     {
       //mixed colors
-      clusterScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_CLUSTER_COLOR, QVariant(), true ) );
+      clusterScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::ClusterColor, QVariant() );
     }
 
-    clusterScope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_CLUSTER_SIZE, group.size(), true ) );
+    clusterScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::ClusterSize, group.size() );
   }
   if ( !group.empty() )
   {
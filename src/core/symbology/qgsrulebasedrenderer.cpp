@@ -283,11 +283,45 @@ QgsLegendSymbolList QgsRuleBasedRenderer::Rule::legendSymbolItems( int currentLe
 }
 
 
+//! Returns TRUE if \a filter may depend on the symbol or geometry part being rendered, which change between the features of a block
+static bool dependsOnRenderedSymbol( const QgsExpression &filter )
+{
+  const QSet< QString > variables = filter.referencedVariables();
+  // variable names which are only known at evaluation time
+  if ( variables.contains( QString() ) || filter.referencedFunctions().contains( QStringLiteral( "eval" ) ) )
+    return true;
+
+  for ( const QString &name :
+        {
+          QgsExpressionContext::EXPR_SYMBOL_COLOR,
+          QgsExpressionContext::EXPR_SYMBOL_ANGLE,
+          QgsExpressionContext::EXPR_GEOMETRY_PART_COUNT,
+          QgsExpressionContext::EXPR_GEOMETRY_PART_NUM,
+          QgsExpressionContext::EXPR_GEOMETRY_RING_NUM,
+          QgsExpressionContext::EXPR_GEOMETRY_POINT_COUNT,
+          QgsExpressionContext::EXPR_GEOMETRY_POINT_NUM,
+          QgsExpressionContext::EXPR_CLUSTER_SIZE,
+          QgsExpressionContext::EXPR_CLUSTER_COLOR
+        } )
+  {
+    if ( variables.contains( name ) )
+      return true;
+  }
+  return false;
+}
+
 bool QgsRuleBasedRenderer::Rule::isFilterOK( const QgsFeature &f, QgsRenderContext *context ) const
 {
   if ( ! mFilter || mElseRule || ! context )
     return true;
 
+  if ( !mPrefetchedFilterResults.isEmpty() )
+  {
+    const auto it = mPrefetchedFilterResults.constFind( f.id() );
+    if ( it != mPrefetchedFilterResults.constEnd() )
+      return it.value();
+  }
+
   context->expressionContext().setFeature( f );
   QVariant res = mFilter->evaluate( &context->expressionContext() );
   return res.toBool();
@@ -427,8 +461,15 @@ bool QgsRuleBasedRenderer::Rule::startRender( QgsRenderContext &context, const Q
     return false;
 
   // init this rule
+  mPrefetchedFilterResults.clear();
+  mCanPrefetchFilter = false;
   if ( mFilter )
+  {
+    // filters are evaluated over blocks of features, which benefits from compiling them
+    mFilter->setCompilationEnabled( true );
     mFilter->prepare( &context.expressionContext() );
+    mCanPrefetchFilter = !mElseRule && !dependsOnRenderedSymbol( *mFilter );
+  }
   if ( mSymbol )
     mSymbol->startRender( context, fields );
 
@@ -565,6 +606,37 @@ void QgsRuleBasedRenderer::Rule::setNormZLevels( const QMap<int, int> &zLevelsTo
 }
 
 
+void QgsRuleBasedRenderer::Rule::prefetchFilterResults( const QgsFeatureList &features, QgsRenderContext &context )
+{
+  mPrefetchedFilterResults.clear();
+
+  QgsFeatureList matchingFeatures;
+  if ( mCanPrefetchFilter )
+  {
+    const QVariantList results = mFilter->evaluateFeatures( features, &context.expressionContext() );
+    mPrefetchedFilterResults.reserve( features.size() );
+    for ( int i = 0; i < features.size(); ++i )
+    {
+      const bool matches = results.at( i ).toBool();
+      mPrefetchedFilterResults.insert( features.at( i ).id(), matches );
+      if ( matches )
+        matchingFeatures << features.at( i );
+    }
+  }
+  else
+  {
+    matchingFeatures = features;
+  }
+
+  if ( matchingFeatures.isEmpty() )
+    return;
+
+  for ( Rule *rule : std::as_const( mActiveChildren ) )
+  {
+    rule->prefetchFilterResults( matchingFeatures, context );
+  }
+}
+
 QgsRuleBasedRenderer::Rule::RenderResult QgsRuleBasedRenderer::Rule::renderFeature( QgsRuleBasedRenderer::FeatureToRender &featToRender, QgsRenderContext &context, QgsRuleBasedRenderer::RenderQueue &renderQueue )
 {
   if ( !isFilterOK( featToRender.feat, &context ) )
@@ -738,6 +810,7 @@ void QgsRuleBasedRenderer::Rule::stopRender( QgsRenderContext &context )
 
   mActiveChildren.clear();
   mSymbolNormZLevels.clear();
+  mPrefetchedFilterResults.clear();
 }
 
 QgsRuleBasedRenderer::Rule *QgsRuleBasedRenderer::Rule::create( QDomElement &ruleElem, QgsSymbolMap &symbolMap )
@@ -957,6 +1030,24 @@ bool QgsRuleBasedRenderer::renderFeature( const QgsFeature &feature,
 }
 
 
+void QgsRuleBasedRenderer::prefetchFilterResults( const QgsFeatureList &features, QgsRenderContext &context )
+{
+  // results are looked up by feature id, which must be unique within the block
+  QSet< QgsFeatureId > ids;
+  ids.reserve( features.size() );
+  for ( const QgsFeature &feature : features )
+  {
+    if ( ids.contains( feature.id() ) )
+    {
+      mRootRule->prefetchFilterResults( QgsFeatureList(), context );
+      return;
+    }
+    ids.insert( feature.id() );
+  }
+
+  mRootRule->prefetchFilterResults( features, context );
+}
+
 void QgsRuleBasedRenderer::startRender( QgsRenderContext &context, const QgsFields &fields )
 {
   QgsFeatureRenderer::startRender( context, fields );
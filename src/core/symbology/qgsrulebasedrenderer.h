@@ -331,6 +331,18 @@ class CORE_EXPORT QgsRuleBasedRenderer : public QgsFeatureRenderer
          */
         void setNormZLevels( const QMap<int, int> &zLevelsToNormLevels ) SIP_SKIP;
 
+        /**
+         * Evaluates the filter of this rule and of its active children for a block of \a features which
+         * are about to be rendered, so that isFilterOK() does not have to evaluate them one at a time.
+         *
+         * Children filters are only evaluated for the features matching the filter of this rule. Results
+         * are kept until the next block or until the rendering stops.
+         *
+         * \note not available in Python bindings
+         * \since QGIS 3.22
+         */
+        void prefetchFilterResults( const QgsFeatureList &features, QgsRenderContext &context ) SIP_SKIP;
+
         /**
          * Render a given feature, will recursively call subclasses and only render if the constraints apply.
          *
@@ -476,6 +488,10 @@ class CORE_EXPORT QgsRuleBasedRenderer : public QgsFeatureRenderer
         // temporary while rendering
         QSet<int> mSymbolNormZLevels;
         RuleList mActiveChildren;
+        // whether the filter may be evaluated ahead of rendering for blocks of features
+        bool mCanPrefetchFilter = false;
+        // filter results of the current block of features, by feature id
+        QHash< QgsFeatureId, bool > mPrefetchedFilterResults;
 
         /**
          * Check which child rules are else rules and update the internal list of else rules
@@ -505,6 +521,18 @@ class CORE_EXPORT QgsRuleBasedRenderer : public QgsFeatureRenderer
 
     void stopRender( QgsRenderContext &context ) override;
 
+    /**
+     * Evaluates the rule filters for a block of \a features which are about to be rendered,
+     * in the same order, with renderFeature().
+     *
+     * Filters are evaluated over the whole block at once, which is faster than evaluating
+     * them for each feature while rendering.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    void prefetchFilterResults( const QgsFeatureList &features, QgsRenderContext &context ) SIP_SKIP;
+
     QString filter( const QgsFields &fields = QgsFields() ) override;
 
     QSet<QString> usedAttributes( const QgsRenderContext &context ) const override;
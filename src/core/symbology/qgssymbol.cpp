@@ -960,8 +960,8 @@ void QgsSymbol::renderFeature( const QgsFeature &feature, QgsRenderContext &cont
       scopePopper.context = &context.expressionContext();
 
       QgsExpressionContextUtils::updateSymbolScope( this, mSymbolRenderContext->expressionContextScope() );
-      mSymbolRenderContext->expressionContextScope()->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_COUNT, mSymbolRenderContext->geometryPartCount(), true ) );
-      mSymbolRenderContext->expressionContextScope()->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM, 1, true ) );
+      mSymbolRenderContext->expressionContextScope()->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartCount, mSymbolRenderContext->geometryPartCount() );
+      mSymbolRenderContext->expressionContextScope()->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum, 1 );
     }
   }
 
@@ -1222,7 +1222,7 @@ void QgsSymbol::renderFeature( const QgsFeature &feature, QgsRenderContext &cont
   // step 3 - render these geometries using the desired symbol layers.
 
   if ( needsExpressionContext )
-    mSymbolRenderContext->expressionContextScope()->addVariable( QgsExpressionContextScope::StaticVariable( QStringLiteral( "symbol_layer_count" ), mLayers.count(), true ) );
+    mSymbolRenderContext->expressionContextScope()->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolLayerCount, mLayers.count() );
 
   for ( const int symbolLayerIndex : layers )
   {
@@ -1231,7 +1231,7 @@ void QgsSymbol::renderFeature( const QgsFeature &feature, QgsRenderContext &cont
       continue;
 
     if ( needsExpressionContext )
-      mSymbolRenderContext->expressionContextScope()->addVariable( QgsExpressionContextScope::StaticVariable( QStringLiteral( "symbol_layer_index" ), symbolLayerIndex + 1, true ) );
+      mSymbolRenderContext->expressionContextScope()->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolLayerIndex, symbolLayerIndex + 1 );
 
     symbolLayer->startFeatureRender( feature, context );
 
@@ -1247,7 +1247,7 @@ void QgsSymbol::renderFeature( const QgsFeature &feature, QgsRenderContext &cont
 
           mSymbolRenderContext->setGeometryPartNum( geometryPartNumber + 1 );
           if ( needsExpressionContext )
-            mSymbolRenderContext->expressionContextScope()->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM, geometryPartNumber + 1, true ) );
+            mSymbolRenderContext->expressionContextScope()->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum, geometryPartNumber + 1 );
 
           static_cast<QgsMarkerSymbol *>( this )->renderPoint( point.renderPoint, &feature, context, symbolLayerIndex, selected );
           geometryPartNumber++;
@@ -1269,7 +1269,7 @@ void QgsSymbol::renderFeature( const QgsFeature &feature, QgsRenderContext &cont
 
           mSymbolRenderContext->setGeometryPartNum( geometryPartNumber + 1 );
           if ( needsExpressionContext )
-            mSymbolRenderContext->expressionContextScope()->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM, geometryPartNumber + 1, true ) );
+            mSymbolRenderContext->expressionContextScope()->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum, geometryPartNumber + 1 );
 
           context.setGeometry( line.originalGeometry );
           static_cast<QgsLineSymbol *>( this )->renderPolyline( line.renderLine, &feature, context, symbolLayerIndex, selected );
@@ -1287,7 +1287,7 @@ void QgsSymbol::renderFeature( const QgsFeature &feature, QgsRenderContext &cont
 
           mSymbolRenderContext->setGeometryPartNum( info.originalPartIndex + 1 );
           if ( needsExpressionContext )
-            mSymbolRenderContext->expressionContextScope()->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM, info.originalPartIndex + 1, true ) );
+            mSymbolRenderContext->expressionContextScope()->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum, info.originalPartIndex + 1 );
 
           context.setGeometry( info.originalGeometry );
           static_cast<QgsFillSymbol *>( this )->renderPolygon( info.renderExterior, ( !info.renderRings.isEmpty() ? &info.renderRings : nullptr ), &feature, context, symbolLayerIndex, selected );
@@ -721,7 +721,7 @@ void QgsLineSymbolLayer::renderPolygonStroke( const QPolygonF &points, const QVe
     case ExteriorRingOnly:
     {
       if ( scope )
-        scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_RING_NUM, 0, true ) );
+        scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryRingNum, 0 );
       renderPolyline( points, context );
       break;
     }
@@ -740,7 +740,7 @@ void QgsLineSymbolLayer::renderPolygonStroke( const QPolygonF &points, const QVe
         for ( const QPolygonF &ring : std::as_const( *rings ) )
         {
           if ( scope )
-            scope->addVariable( QgsExpressionContextScope::StaticVariable( QgsExpressionContext::EXPR_GEOMETRY_RING_NUM, ringIndex, true ) );
+            scope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryRingNum, ringIndex );
 
           renderPolyline( ring, context );
           ringIndex++;
@@ -87,6 +87,7 @@
 #include "qgsruntimeprofiler.h"
 #include "qgsfeaturerenderergenerator.h"
 #include "qgsvectorlayerutils.h"
+#include "qgsvectorlayeraggregatecache_p.h"
 
 #include "diagram/qgsdiagram.h"
 
@@ -170,6 +171,7 @@ QgsVectorLayer::QgsVectorLayer( const QString &vectorLayerPath,
   setProviderType( providerKey );
 
   mGeometryOptions = std::make_unique<QgsGeometryOptions>();
+  mAggregateCache = std::make_unique<QgsVectorLayerAggregateCache>();
   mActions = new QgsActionManager( this );
   mConditionalStyles = new QgsConditionalLayerStyles( this );
   mStoredExpressionManager = new QgsStoredExpressionManager();
@@ -216,6 +218,18 @@ QgsVectorLayer::QgsVectorLayer( const QString &vectorLayerPath,
   connect( this, &QgsVectorLayer::dataSourceChanged, this, &QgsVectorLayer::supportsEditingChanged );
   connect( this, &QgsVectorLayer::readOnlyChanged, this, &QgsVectorLayer::supportsEditingChanged );
 
+  // any change to the features or fields invalidates the cached aggregates
+  const auto clearAggregateCache = [ = ] { mAggregateCache->clear(); };
+  connect( this, &QgsVectorLayer::featureAdded, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::featureDeleted, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::attributeValueChanged, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::geometryChanged, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::dataChanged, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::subsetStringChanged, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::updatedFields, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::dataSourceChanged, this, clearAggregateCache );
+  connect( this, &QgsVectorLayer::afterRollBack, this, clearAggregateCache );
+
   // Default simplify drawing settings
   QgsSettings settings;
   mSimplifyMethod.setSimplifyHints( settings.flagValue( QStringLiteral( "qgis/simplifyDrawingHints" ), mSimplifyMethod.simplifyHints(), QgsSettings::NoSection ) );
@@ -1773,7 +1787,10 @@ bool QgsVectorLayer::setDataProvider( QString const &provider, const QgsDataProv
   if ( QgsApplication::profiler()->groupIsActive( QStringLiteral( "projectload" ) ) )
     profile = std::make_unique< QgsScopedRuntimeProfile >( tr( "Create %1 provider" ).arg( provider ), QStringLiteral( "projectload" ) );
 
-  mDataProvider = qobject_cast<QgsVectorDataProvider *>( QgsProviderRegistry::instance()->createProvider( provider, mDataSource, options, flags ) );
+  QgsDataProvider *dataProvider = takePreloadedProvider( provider, mDataSource, flags );
+  if ( !dataProvider )
+    dataProvider = QgsProviderRegistry::instance()->createProvider( provider, mDataSource, options, flags );
+  mDataProvider = qobject_cast<QgsVectorDataProvider *>( dataProvider );
   if ( !mDataProvider )
   {
     setValid( false );
@@ -5727,6 +5744,13 @@ QgsGeometryOptions *QgsVectorLayer::geometryOptions() const
   return mGeometryOptions.get();
 }
 
+///@cond PRIVATE
+QgsVectorLayerAggregateCache *QgsVectorLayer::aggregateCache() const
+{
+  return mAggregateCache.get();
+}
+///@endcond
+
 void QgsVectorLayer::setReadExtentFromXml( bool readExtentFromXml )
 {
   mReadExtentFromXml = readExtentFromXml;
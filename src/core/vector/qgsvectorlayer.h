@@ -78,6 +78,7 @@ class QgsFeedback;
 class QgsAuxiliaryStorage;
 class QgsAuxiliaryLayer;
 class QgsGeometryOptions;
+class QgsVectorLayerAggregateCache;
 class QgsStyleEntityVisitorInterface;
 class QgsVectorLayerTemporalProperties;
 class QgsFeatureRendererGenerator;
@@ -2385,6 +2386,18 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
      */
     QgsGeometryOptions *geometryOptions() const;
 
+    ///@cond PRIVATE
+
+    /**
+     * Returns the cache of aggregate values calculated over the layer features, shared
+     * by the aggregate expression functions.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    QgsVectorLayerAggregateCache *aggregateCache() const SIP_SKIP;
+    ///@endcond
+
     /**
      * Controls, if the layer is allowed to commit changes. If this is set to FALSE
      * it will not be possible to commit changes on this layer. This can be used to
@@ -2972,6 +2985,8 @@ class CORE_EXPORT QgsVectorLayer : public QgsMapLayer, public QgsExpressionConte
 
     std::unique_ptr<QgsGeometryOptions> mGeometryOptions;
 
+    std::unique_ptr<QgsVectorLayerAggregateCache> mAggregateCache;
+
     bool mAllowCommit = true;
 
     //! Stored expression used for e.g. filter
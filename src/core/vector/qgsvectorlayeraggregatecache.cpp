@@ -0,0 +1,154 @@
+/***************************************************************************
+                         qgsvectorlayeraggregatecache.cpp
+                         --------------------------------
+    begin                : October 2021
+    copyright            : (C) 2021 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "qgsvectorlayeraggregatecache_p.h"
+#include "qgsexpression.h"
+#include "qgsexpressioncontext.h"
+#include "qgsexpressionfunction.h"
+#include "qgsfeaturerequest.h"
+#include "qgsvectorlayer.h"
+
+#include <QMutexLocker>
+
+///@cond PRIVATE
+
+bool QgsVectorLayerAggregateCache::canCache( const QgsVectorLayer *layer, const QList< const QgsExpression * > &expressions )
+{
+  // built-in functions whose result does not only depend on the layer features and on variables
+  static const QSet< QString > sVolatileFunctions
+  {
+    QStringLiteral( "now" ),
+    QStringLiteral( "rand" ),
+    QStringLiteral( "randf" ),
+    QStringLiteral( "uuid" ),
+    QStringLiteral( "eval" ),
+    QStringLiteral( "eval_template" ),
+    QStringLiteral( "env" ),
+    QStringLiteral( "file_exists" ),
+    QStringLiteral( "file_size" ),
+    QStringLiteral( "is_selected" ),
+    QStringLiteral( "num_selected" ),
+    QStringLiteral( "get_feature" ),
+    QStringLiteral( "get_feature_by_id" ),
+    QStringLiteral( "aggregate" ),
+    QStringLiteral( "relation_aggregate" ),
+    QStringLiteral( "layer_property" ),
+    QStringLiteral( "decode_uri" ),
+    QStringLiteral( "raster_value" ),
+    QStringLiteral( "raster_statistic" ),
+    QStringLiteral( "represent_value" ),
+    QStringLiteral( "sqlite_fetch_and_increment" ),
+    QStringLiteral( "overlay_intersects" ),
+    QStringLiteral( "overlay_contains" ),
+    QStringLiteral( "overlay_crosses" ),
+    QStringLiteral( "overlay_equals" ),
+    QStringLiteral( "overlay_touches" ),
+    QStringLiteral( "overlay_disjoint" ),
+    QStringLiteral( "overlay_within" ),
+    QStringLiteral( "overlay_nearest" ),
+  };
+
+  const QgsFields fields = layer->fields();
+  for ( const QgsExpression *expression : expressions )
+  {
+    const QSet< QString > functions = expression->referencedFunctions();
+    for ( const QString &function : functions )
+    {
+      if ( sVolatileFunctions.contains( function ) )
+        return false;
+
+      // only built-in static functions are known to be pure, scoped functions (e.g. is_layer_visible,
+      // current_value) and Python functions may return anything
+      const int index = QgsExpression::functionIndex( function );
+      if ( index < 0 || !dynamic_cast< const QgsStaticExpressionFunction * >( QgsExpression::Functions().at( index ) ) )
+        return false;
+    }
+
+    // joined and virtual fields may change without the layer being notified
+    const QSet< QString > columns = expression->referencedColumns();
+    for ( const QString &column : columns )
+    {
+      if ( column == QgsFeatureRequest::ALL_ATTRIBUTES )
+      {
+        for ( int i = 0; i < fields.count(); ++i )
+        {
+          if ( fields.fieldOrigin( i ) == QgsFields::OriginJoin || fields.fieldOrigin( i ) == QgsFields::OriginExpression )
+            return false;
+        }
+        continue;
+      }
+
+      const int index = fields.lookupField( column );
+      if ( index >= 0 && ( fields.fieldOrigin( index ) == QgsFields::OriginJoin || fields.fieldOrigin( index ) == QgsFields::OriginExpression ) )
+        return false;
+    }
+  }
+  return true;
+}
+
+QString QgsVectorLayerAggregateCache::variablesKey( const QSet< QString > &variables, const QgsExpressionContext *context )
+{
+  QStringList names = qgis::setToList( variables );
+  std::sort( names.begin(), names.end() );
+
+  QString key;
+  for ( const QString &name : std::as_const( names ) )
+  {
+    const QVariant value = context->variable( name );
+    if ( !value.isNull() && !value.canConvert< QString >() )
+      return QString();
+
+    key += QStringLiteral( "%1=%2:%3;" ).arg( name, QString::number( value.userType() ), value.isNull() ? QStringLiteral( "NULL" ) : value.toString() );
+  }
+  // never return a null string for valid keys
+  return key.isNull() ? QStringLiteral( "" ) : key;
+}
+
+int QgsVectorLayerAggregateCache::generation() const
+{
+  QMutexLocker locker( &mMutex );
+  return mGeneration;
+}
+
+bool QgsVectorLayerAggregateCache::value( const QString &key, QVariant &value ) const
+{
+  QMutexLocker locker( &mMutex );
+  if ( const QVariant *cached = mValues.object( key ) )
+  {
+    value = *cached;
+    return true;
+  }
+  return false;
+}
+
+void QgsVectorLayerAggregateCache::insert( const QString &key, const QVariant &value, int generation )
+{
+  QMutexLocker locker( &mMutex );
+  // the layer changed while the value was calculated
+  if ( generation != mGeneration )
+    return;
+
+  mValues.insert( key, new QVariant( value ) );
+}
+
+void QgsVectorLayerAggregateCache::clear()
+{
+  QMutexLocker locker( &mMutex );
+  mValues.clear();
+  mGeneration++;
+}
+
+///@endcond
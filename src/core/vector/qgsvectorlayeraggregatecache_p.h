@@ -0,0 +1,100 @@
+/***************************************************************************
+                         qgsvectorlayeraggregatecache_p.h
+                         --------------------------------
+    begin                : October 2021
+    copyright            : (C) 2021 by QGIS contributors
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef QGSVECTORLAYERAGGREGATECACHE_PRIVATE_H
+#define QGSVECTORLAYERAGGREGATECACHE_PRIVATE_H
+
+/// @cond PRIVATE
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the QGIS API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+
+#define SIP_NO_FILE
+
+#include "qgis_core.h"
+
+#include <QCache>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QVariant>
+
+class QgsExpression;
+class QgsExpressionContext;
+class QgsVectorLayer;
+
+/**
+ * Aggregate values calculated from the features of a vector layer by expression functions.
+ *
+ * Unlike values cached in an expression context, these values are shared by all the contexts
+ * and threads evaluating aggregates over the layer. The cache is owned by the layer and cleared
+ * whenever the features, fields or data source of the layer change.
+ */
+class CORE_EXPORT QgsVectorLayerAggregateCache
+{
+  public:
+
+    //! Maximum number of aggregate values kept for a layer
+    static constexpr int MAXIMUM_ENTRIES = 1000;
+
+    /**
+     * Returns TRUE if aggregates over \a layer using the \a expressions only depend on the layer
+     * features and on the values of their referenced variables.
+     *
+     * Only expressions using built-in functions known to be pure can be cached: expressions
+     * referencing joined or virtual fields, scoped or Python functions, or functions reading
+     * other layers, files, the selection, the current time or random values cannot be cached.
+     */
+    static bool canCache( const QgsVectorLayer *layer, const QList< const QgsExpression * > &expressions );
+
+    /**
+     * Returns a key identifying the values of the \a variables in a \a context, or a null string
+     * if one of the values cannot be represented in a key.
+     */
+    static QString variablesKey( const QSet< QString > &variables, const QgsExpressionContext *context );
+
+    /**
+     * Returns the generation of the cache, which changes each time the cache is cleared.
+     *
+     * Values are only inserted if the cache was not cleared since they started being calculated.
+     */
+    int generation() const;
+
+    //! Retrieves the \a value stored for a \a key, returns FALSE if no value is stored
+    bool value( const QString &key, QVariant &value ) const;
+
+    //! Stores the \a value for a \a key, calculated while the cache was at the specified \a generation
+    void insert( const QString &key, const QVariant &value, int generation );
+
+    //! Clears all the values
+    void clear();
+
+  private:
+
+    mutable QMutex mMutex;
+    mutable QCache< QString, QVariant > mValues { MAXIMUM_ENTRIES };
+    int mGeneration = 0;
+};
+
+/// @endcond
+
+#endif // QGSVECTORLAYERAGGREGATECACHE_PRIVATE_H
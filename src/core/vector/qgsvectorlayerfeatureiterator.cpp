@@ -31,6 +31,56 @@
 #include <QThreadStorage>
 #include <QStack>
 
+///@cond PRIVATE
+
+//! Number of provider features read ahead to fetch the attributes of joins without memory cache in a single request
+constexpr int JOIN_READ_AHEAD_WINDOW = 256;
+
+//! Number of provider features evaluated at once against a filter expression which the provider could not handle
+constexpr int FILTER_EXPRESSION_BLOCK_SIZE = 1024;
+
+//! Returns \a value formatted as a literal for a filter expression on the join field
+static QString joinValueLiteral( const QVariant &value )
+{
+  QString v = value.toString();
+  switch ( value.type() )
+  {
+    case QVariant::Int:
+    case QVariant::LongLong:
+    case QVariant::Double:
+      break;
+
+    default:
+    case QVariant::String:
+      v.replace( '\'', QLatin1String( "''" ) );
+      v.prepend( '\'' ).append( '\'' );
+      break;
+  }
+  return v;
+}
+
+//! Returns the indices of the join layer attributes to request for \a info
+static QgsAttributeList joinRequestAttributes( const QgsVectorLayerFeatureIterator::FetchJoinInfo &info )
+{
+  QgsAttributeList joinedAttributeIndices;
+
+  // maybe user requested just a subset of layer's attributes
+  // so we do not have to cache everything
+  if ( info.joinInfo->hasSubset() )
+  {
+    const QStringList subsetNames = QgsVectorLayerJoinInfo::joinFieldNamesSubset( *info.joinInfo );
+    QVector<int> subsetIndices = QgsVectorLayerJoinBuffer::joinSubsetIndices( info.joinLayerFields, subsetNames );
+    joinedAttributeIndices = qgis::setToList( qgis::listToSet( info.attributes ).intersect( qgis::listToSet( subsetIndices.toList() ) ) );
+  }
+  else
+  {
+    joinedAttributeIndices = info.attributes;
+  }
+  return joinedAttributeIndices;
+}
+
+///@endcond
+
 QgsVectorLayerFeatureSource::QgsVectorLayerFeatureSource( const QgsVectorLayer *layer )
 {
   QMutexLocker locker( &layer->mFeatureSourceConstructorMutex );
@@ -167,6 +217,8 @@ QgsVectorLayerFeatureIterator::QgsVectorLayerFeatureIterator( QgsVectorLayerFeat
   if ( mRequest.filterType() == QgsFeatureRequest::FilterExpression )
   {
     mRequest.expressionContext()->setFields( mSource->mFields );
+    // the filter is evaluated over blocks of features, which benefits from compiling it
+    mRequest.filterExpression()->setCompilationEnabled( true );
     mRequest.filterExpression()->prepare( mRequest.expressionContext() );
 
     if ( mRequest.flags() & QgsFeatureRequest::SubsetOfAttributes )
@@ -448,32 +500,13 @@ bool QgsVectorLayerFeatureIterator::fetchFeature( QgsFeature &f )
     }
   }
 
-  while ( mProviderIterator.nextFeature( f ) )
+  //filtering by expression, and couldn't do it on the provider side
+  const bool filterLocally = mRequest.filterType() == QgsFeatureRequest::FilterExpression && mProviderRequest.filterType() != QgsFeatureRequest::FilterExpression;
+  while ( filterLocally ? fetchNextFilteredProviderFeature( f ) : fetchNextProviderFeature( f ) )
   {
-    if ( mFetchConsidered.contains( f.id() ) )
-      continue;
-
-    // TODO[MD]: just one resize of attributes
-    f.setFields( mSource->mFields );
-
-    // update attributes
-    if ( mSource->mHasEditBuffer )
-      updateChangedAttributes( f );
-
-    if ( mHasVirtualAttributes )
+    if ( !filterLocally && mHasVirtualAttributes )
       addVirtualAttributes( f );
 
-    if ( mRequest.filterType() == QgsFeatureRequest::FilterExpression && mProviderRequest.filterType() != QgsFeatureRequest::FilterExpression )
-    {
-      //filtering by expression, and couldn't do it on the provider side
-      mRequest.expressionContext()->setFeature( f );
-      if ( !mRequest.filterExpression()->evaluate( mRequest.expressionContext() ).toBool() )
-      {
-        //feature did not match filter
-        continue;
-      }
-    }
-
     // update geometry
     // TODO[MK]: FilterRect check after updating the geometry
     if ( !( mRequest.flags() & QgsFeatureRequest::NoGeometry ) )
@@ -504,6 +537,10 @@ bool QgsVectorLayerFeatureIterator::rewind()
   else
   {
     mProviderIterator.rewind();
+    mReadAheadFeatures.clear();
+    mFilteredFeatures.clear();
+    for ( FetchJoinInfo &info : mOrderedJoinInfoList )
+      info.hasPrefetchedAttributes = false;
     rewindEditBuffer();
   }
 
@@ -516,6 +553,8 @@ bool QgsVectorLayerFeatureIterator::close()
     return false;
 
   mProviderIterator.close();
+  mReadAheadFeatures.clear();
+  mFilteredFeatures.clear();
 
   iteratorClosed();
 
@@ -815,6 +854,20 @@ void QgsVectorLayerFeatureIterator::prepareFields()
   {
     createOrderedJoinList();
   }
+
+  // joins without memory cache driven by a provider field can have the joined attributes
+  // fetched for a whole window of features at once
+  mPrefetchedJoins.clear();
+  for ( int i = 0; i < mOrderedJoinInfoList.size(); ++i )
+  {
+    const FetchJoinInfo &info = mOrderedJoinInfoList.at( i );
+    const QgsFields::FieldOrigin targetOrigin = mSource->mFields.fieldOrigin( info.targetField );
+    if ( info.joinInfo->cachedAttributes.isEmpty() && info.joinField >= 0
+         && ( targetOrigin == QgsFields::OriginProvider || targetOrigin == QgsFields::OriginEdit ) )
+    {
+      mPrefetchedJoins << i;
+    }
+  }
 }
 
 void QgsVectorLayerFeatureIterator::createOrderedJoinList()
@@ -955,10 +1008,111 @@ void QgsVectorLayerFeatureIterator::addJoinedAttributes( QgsFeature &f )
       continue;
 
     const QHash< QString, QgsAttributes> &memoryCache = joinIt->joinInfo->cachedAttributes;
-    if ( memoryCache.isEmpty() )
-      joinIt->addJoinedAttributesDirect( f, targetFieldValue );
-    else
+    if ( !memoryCache.isEmpty() )
       joinIt->addJoinedAttributesCached( f, targetFieldValue );
+    else if ( joinIt->hasPrefetchedAttributes )
+      joinIt->addJoinedAttributesPrefetched( f, targetFieldValue );
+    else
+      joinIt->addJoinedAttributesDirect( f, targetFieldValue );
+  }
+}
+
+bool QgsVectorLayerFeatureIterator::fetchNextProviderFeature( QgsFeature &f )
+{
+  if ( !mPrefetchedJoins.isEmpty() )
+  {
+    if ( mReadAheadFeatures.isEmpty() )
+      readAheadProviderFeatures();
+
+    if ( mReadAheadFeatures.isEmpty() )
+      return false;
+
+    f = mReadAheadFeatures.takeFirst();
+    return true;
+  }
+
+  while ( mProviderIterator.nextFeature( f ) )
+  {
+    if ( mFetchConsidered.contains( f.id() ) )
+      continue;
+
+    // TODO[MD]: just one resize of attributes
+    f.setFields( mSource->mFields );
+
+    // update attributes
+    if ( mSource->mHasEditBuffer )
+      updateChangedAttributes( f );
+
+    return true;
+  }
+  return false;
+}
+
+bool QgsVectorLayerFeatureIterator::fetchNextFilteredProviderFeature( QgsFeature &f )
+{
+  while ( mFilteredFeatures.isEmpty() )
+  {
+    const long long limit = mRequest.limit();
+    const int blockSize = limit >= 0 ? static_cast< int >( std::clamp< long long >( limit, 1, FILTER_EXPRESSION_BLOCK_SIZE ) ) : FILTER_EXPRESSION_BLOCK_SIZE;
+
+    QgsFeatureList block;
+    block.reserve( blockSize );
+    QgsFeature feature;
+    while ( block.size() < blockSize && fetchNextProviderFeature( feature ) )
+    {
+      if ( mHasVirtualAttributes )
+        addVirtualAttributes( feature );
+      block << feature;
+    }
+
+    if ( block.isEmpty() )
+      return false;
+
+    const QVariantList results = mRequest.filterExpression()->evaluateFeatures( block, mRequest.expressionContext() );
+    for ( int i = 0; i < block.size(); ++i )
+    {
+      if ( results.at( i ).toBool() )
+        mFilteredFeatures << block.at( i );
+    }
+  }
+
+  f = mFilteredFeatures.takeFirst();
+  mRequest.expressionContext()->setFeature( f );
+  return true;
+}
+
+void QgsVectorLayerFeatureIterator::readAheadProviderFeatures()
+{
+  // features from the edit buffer are only handled before the provider ones, so from now
+  // on all the features to which joins are added come from the read ahead window
+  const long long limit = mRequest.limit();
+  const int windowSize = limit >= 0 ? static_cast< int >( std::min< long long >( limit, JOIN_READ_AHEAD_WINDOW ) ) : JOIN_READ_AHEAD_WINDOW;
+
+  QgsFeature f;
+  while ( mReadAheadFeatures.size() < windowSize && mProviderIterator.nextFeature( f ) )
+  {
+    if ( mFetchConsidered.contains( f.id() ) )
+      continue;
+
+    f.setFields( mSource->mFields );
+    if ( mSource->mHasEditBuffer )
+      updateChangedAttributes( f );
+
+    mReadAheadFeatures << f;
+  }
+
+  for ( int joinIndex : std::as_const( mPrefetchedJoins ) )
+  {
+    FetchJoinInfo &info = mOrderedJoinInfoList[ joinIndex ];
+    QList< QVariant > joinValues;
+    joinValues.reserve( mReadAheadFeatures.size() );
+    for ( const QgsFeature &feature : std::as_const( mReadAheadFeatures ) )
+    {
+      const QVariant value = feature.attribute( info.targetField );
+      if ( value.isValid() )
+        joinValues << value;
+    }
+    info.prefetchJoinedAttributes( joinValues );
   }
 }
 
@@ -1075,37 +1229,10 @@ void QgsVectorLayerFeatureIterator::FetchJoinInfo::addJoinedAttributesDirect( Qg
   }
   else
   {
-    QString v = joinValue.toString();
-    switch ( joinValue.type() )
-    {
-      case QVariant::Int:
-      case QVariant::LongLong:
-      case QVariant::Double:
-        break;
-
-      default:
-      case QVariant::String:
-        v.replace( '\'', QLatin1String( "''" ) );
-        v.prepend( '\'' ).append( '\'' );
-        break;
-    }
-    subsetString += '=' + v;
+    subsetString += '=' + joinValueLiteral( joinValue );
   }
 
-  QList<int> joinedAttributeIndices;
-
-  // maybe user requested just a subset of layer's attributes
-  // so we do not have to cache everything
-  if ( joinInfo->hasSubset() )
-  {
-    const QStringList subsetNames = QgsVectorLayerJoinInfo::joinFieldNamesSubset( *joinInfo );
-    QVector<int> subsetIndices = QgsVectorLayerJoinBuffer::joinSubsetIndices( joinLayerFields, subsetNames );
-    joinedAttributeIndices = qgis::setToList( qgis::listToSet( attributes ).intersect( qgis::listToSet( subsetIndices.toList() ) ) );
-  }
-  else
-  {
-    joinedAttributeIndices = attributes;
-  }
+  QList<int> joinedAttributeIndices = joinRequestAttributes( *this );
 
   // we don't need the join field, it is already present in the other table
   joinedAttributeIndices.removeAll( joinField );
@@ -1141,6 +1268,87 @@ void QgsVectorLayerFeatureIterator::FetchJoinInfo::addJoinedAttributesDirect( Qg
   }
 }
 
+void QgsVectorLayerFeatureIterator::FetchJoinInfo::prefetchJoinedAttributes( const QList<QVariant> &joinValues )
+{
+  prefetchedAttributes.clear();
+  prefetchedNullAttributes.clear();
+  hasPrefetchedAttributes = true;
+
+  // one request for all the distinct join values, with the same literals as addJoinedAttributesDirect()
+  QSet< QString > literals;
+  bool hasNullValue = false;
+  for ( const QVariant &value : joinValues )
+  {
+    if ( value.isNull() )
+      hasNullValue = true;
+    else
+      literals.insert( joinValueLiteral( value ) );
+  }
+
+  if ( literals.isEmpty() && !hasNullValue )
+    return;
+
+  const QString quotedJoinField = QStringLiteral( "\"%1\"" ).arg( joinInfo->joinFieldName() );
+  QStringList filters;
+  if ( !literals.isEmpty() )
+    filters << QStringLiteral( "%1 IN (%2)" ).arg( quotedJoinField, qgis::setToList( literals ).join( ',' ) );
+  if ( hasNullValue )
+    filters << QStringLiteral( "%1 IS NULL" ).arg( quotedJoinField );
+
+  // the join field is needed to match the joined features back to the target features
+  QgsAttributeList requestAttributes = joinRequestAttributes( *this );
+  if ( !requestAttributes.contains( joinField ) )
+    requestAttributes << joinField;
+
+  QgsFeatureRequest request;
+  request.setFlags( QgsFeatureRequest::NoGeometry );
+  request.setSubsetOfAttributes( requestAttributes );
+  request.setFilterExpression( filters.join( QLatin1String( " OR " ) ) );
+  QgsFeatureIterator fi = joinSource->getFeatures( request );
+
+  QgsFeature fet;
+  while ( fi.nextFeature( fet ) )
+  {
+    // like addJoinedAttributesDirect(), the first matching feature wins
+    const QVariant value = fet.attribute( joinField );
+    if ( value.isNull() )
+    {
+      if ( prefetchedNullAttributes.isEmpty() )
+        prefetchedNullAttributes = fet.attributes();
+    }
+    else
+    {
+      const QString key = value.toString();
+      if ( !prefetchedAttributes.contains( key ) )
+        prefetchedAttributes.insert( key, fet.attributes() );
+    }
+  }
+}
+
+void QgsVectorLayerFeatureIterator::FetchJoinInfo::addJoinedAttributesPrefetched( QgsFeature &f, const QVariant &joinValue ) const
+{
+  QgsAttributes attr;
+  if ( joinValue.isNull() )
+  {
+    attr = prefetchedNullAttributes;
+  }
+  else
+  {
+    attr = prefetchedAttributes.value( joinValue.toString() );
+  }
+
+  if ( attr.isEmpty() )
+    return; // no suitable join feature found, keeping empty (null) attributes
+
+  for ( auto it = attributesSourceToDestLayerMap.constBegin(); it != attributesSourceToDestLayerMap.constEnd(); ++it )
+  {
+    if ( it.key() == joinField )
+      continue;
+
+    f.setAttribute( it.value(), attr.at( it.key() ) );
+  }
+}
+
 
 
 
@@ -182,6 +182,51 @@ class CORE_EXPORT QgsVectorLayerFeatureIterator : public QgsAbstractFeatureItera
 
       void addJoinedAttributesCached( QgsFeature &f, const QVariant &joinValue ) const;
       void addJoinedAttributesDirect( QgsFeature &f, const QVariant &joinValue ) const;
+
+#ifndef SIP_RUN
+
+      /**
+       * Fetches the joined features matching any of \a joinValues with a single request and
+       * keeps their attributes for addJoinedAttributesPrefetched().
+       *
+       * \note Not available in Python bindings
+       * \since QGIS 3.22
+       */
+      void prefetchJoinedAttributes( const QList< QVariant > &joinValues );
+
+      /**
+       * Adds the joined attributes matching \a joinValue, as fetched by the last call to
+       * prefetchJoinedAttributes(), to \a f.
+       *
+       * \note Not available in Python bindings
+       * \since QGIS 3.22
+       */
+      void addJoinedAttributesPrefetched( QgsFeature &f, const QVariant &joinValue ) const;
+
+      /**
+       * TRUE if the join values of the features being processed have been prefetched.
+       *
+       * \note Not available in Python bindings
+       * \since QGIS 3.22
+       */
+      bool hasPrefetchedAttributes = false;
+
+      /**
+       * Attributes of the prefetched joined features, by join value.
+       *
+       * \note Not available in Python bindings
+       * \since QGIS 3.22
+       */
+      QHash< QString, QgsAttributes > prefetchedAttributes;
+
+      /**
+       * Attributes of the prefetched joined feature with a NULL join value, if any.
+       *
+       * \note Not available in Python bindings
+       * \since QGIS 3.22
+       */
+      QgsAttributes prefetchedNullAttributes;
+#endif
     };
 
     bool isValid() const override;
@@ -229,6 +274,29 @@ class CORE_EXPORT QgsVectorLayerFeatureIterator : public QgsAbstractFeatureItera
     //! \note not available in Python bindings
     void addJoinedAttributes( QgsFeature &f ) SIP_SKIP;
 
+    /**
+     * Fetches the next feature from the provider iterator, with edit buffer changes applied.
+     *
+     * When the iterator uses joins without memory cache, features are read ahead in windows and the
+     * joined attributes of each window are fetched with a single request per join.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    bool fetchNextProviderFeature( QgsFeature &f ) SIP_SKIP;
+
+    /**
+     * Fetches the next provider feature matching the request filter expression, for filter expressions
+     * which could not be handled by the provider.
+     *
+     * Provider features are read in blocks, with virtual attributes added, and the filter expression is
+     * evaluated over each block at once.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    bool fetchNextFilteredProviderFeature( QgsFeature &f ) SIP_SKIP;
+
     /**
      * Adds attributes that don't source from the provider but are added inside QGIS
      * Includes
@@ -303,6 +371,18 @@ class CORE_EXPORT QgsVectorLayerFeatureIterator : public QgsAbstractFeatureItera
     //! Join list sorted by dependency
     QList< FetchJoinInfo > mOrderedJoinInfoList;
 
+    //! Indices in mOrderedJoinInfoList of the joins whose attributes are prefetched for read ahead features
+    QList< int > mPrefetchedJoins;
+
+    //! Provider features read ahead, waiting to be returned
+    QList< QgsFeature > mReadAheadFeatures;
+
+    //! Provider features which matched the filter expression, waiting to be returned
+    QList< QgsFeature > mFilteredFeatures;
+
+    //! Fills mReadAheadFeatures with the next window of provider features and prefetches their joined attributes
+    void readAheadProviderFeatures();
+
     /**
      * Will always return TRUE. We assume that ordering has been done on provider level already.
      *
@@ -41,10 +41,14 @@
 #include "qgsvectorlayertemporalproperties.h"
 #include "qgsmapclippingutils.h"
 #include "qgsfeaturerenderergenerator.h"
+#include "qgsrulebasedrenderer.h"
 
 #include <QPicture>
 #include <QTimer>
 
+//! Number of features read ahead so that the filters of a rule based renderer are evaluated over a whole block
+constexpr int RULE_FILTER_BLOCK_SIZE = 1024;
+
 QgsVectorLayerRenderer::QgsVectorLayerRenderer( QgsVectorLayer *layer, QgsRenderContext &context )
   : QgsMapLayerRenderer( layer->id(), &context )
   , mLayer( layer )
@@ -222,9 +226,18 @@ bool QgsVectorLayerRenderer::render()
   }
 
   bool res = true;
-  for ( const std::unique_ptr< QgsFeatureRenderer > &renderer : mRenderers )
+  if ( renderContext()->testFlag( QgsRenderContext::SkipSymbolRendering ) )
   {
-    res = renderInternal( renderer.get() ) && res;
+    // only the main renderer registers features with the labeling engine
+    if ( mLabelProvider || mDiagramProvider )
+      res = renderInternal( mRenderer );
+  }
+  else
+  {
+    for ( const std::unique_ptr< QgsFeatureRenderer > &renderer : mRenderers )
+    {
+      res = renderInternal( renderer.get() ) && res;
+    }
   }
 
   mReadyToCompose = true;
@@ -252,7 +265,7 @@ bool QgsVectorLayerRenderer::renderInternal( QgsFeatureRenderer *renderer )
   // MUST be created in the thread doing the rendering
   mInterruptionChecker = std::make_unique< QgsVectorLayerRendererInterruptionChecker >( context );
   bool usingEffect = false;
-  if ( renderer->paintEffect() && renderer->paintEffect()->enabled() )
+  if ( renderer->paintEffect() && renderer->paintEffect()->enabled() && !context.testFlag( QgsRenderContext::SkipSymbolRendering ) )
   {
     usingEffect = true;
     renderer->paintEffect()->begin( context );
@@ -432,6 +445,7 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureRenderer *renderer, QgsFeat
 
   QgsExpressionContextScope *symbolScope = QgsExpressionContextUtils::updateSymbolScope( nullptr, new QgsExpressionContextScope() );
   QgsRenderContext &context = *renderContext();
+  const bool skipSymbolRendering = context.testFlag( QgsRenderContext::SkipSymbolRendering );
   context.expressionContext().appendScope( symbolScope );
 
   std::unique_ptr< QgsGeometryEngine > clipEngine;
@@ -441,8 +455,35 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureRenderer *renderer, QgsFeat
     clipEngine->prepareGeometry();
   }
 
+  // rule filters are evaluated ahead of rendering for blocks of features
+  QgsRuleBasedRenderer *ruleBasedRenderer = renderer->type() == QLatin1String( "RuleRenderer" ) ? static_cast< QgsRuleBasedRenderer * >( renderer ) : nullptr;
+  QgsFeatureList featureBlock;
+  int featureBlockIndex = 0;
+  const auto nextFeature = [&]( QgsFeature & feature ) -> bool
+  {
+    if ( !ruleBasedRenderer )
+      return fit.nextFeature( feature );
+
+    if ( featureBlockIndex >= featureBlock.size() )
+    {
+      featureBlock.clear();
+      featureBlockIndex = 0;
+      QgsFeature blockFeature;
+      while ( featureBlock.size() < RULE_FILTER_BLOCK_SIZE && !context.renderingStopped() && fit.nextFeature( blockFeature ) )
+        featureBlock << blockFeature;
+
+      if ( featureBlock.isEmpty() )
+        return false;
+
+      ruleBasedRenderer->prefetchFilterResults( featureBlock, context );
+    }
+
+    feature = featureBlock.at( featureBlockIndex++ );
+    return true;
+  };
+
   QgsFeature fet;
-  while ( fit.nextFeature( fet ) )
+  while ( nextFeature( fet ) )
   {
     try
     {
@@ -467,7 +508,8 @@ void QgsVectorLayerRenderer::drawRenderer( QgsFeatureRenderer *renderer, QgsFeat
       bool drawMarker = isMainRenderer && ( mDrawVertexMarkers && context.drawEditingInformation() && ( !mVertexMarkerOnlyForSelection || sel ) );
 
       // render feature
-      bool rendered = renderer->renderFeature( fet, context, -1, sel, drawMarker );
+      bool rendered = skipSymbolRendering ? renderer->willRenderFeature( fet, context )
+                      : renderer->renderFeature( fet, context, -1, sel, drawMarker );
 
       // labeling - register feature
       if ( rendered )
@@ -620,7 +662,7 @@ void QgsVectorLayerRenderer::drawRendererLevels( QgsFeatureRenderer *renderer, Q
 
   scopePopper.reset();
 
-  if ( features.empty() )
+  if ( features.empty() || context.testFlag( QgsRenderContext::SkipSymbolRendering ) )
   {
     // nothing to draw
     stopRenderer( renderer, selRenderer );
@@ -40,6 +40,7 @@ void QgsMapCanvasSnappingUtils::canvasMapSettingsChanged()
 {
   setMapSettings( mCanvas->mapSettings() );
   setEnableSnappingForInvisibleFeature( QgsSettingsRegistryCore::settingsDigitizingSnapInvisibleFeature.value() );
+  setMaxCachedVerticesPerLayer( QgsSettingsRegistryCore::settingsDigitizingSnapIndexMaxVertices.value() );
 }
 
 void QgsMapCanvasSnappingUtils::canvasTransformContextChanged()
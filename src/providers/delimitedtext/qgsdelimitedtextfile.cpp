@@ -362,6 +362,15 @@ void QgsDelimitedTextFile::setTypeCSV( const QString &delim, const QString &quot
   mDelimChars = decodeChars( delim );
   mQuoteChar = decodeChars( quote );
   mEscapeChar = decodeChars( escape );
+  mLatin1SpecialChars.reset();
+  for ( const QString &chars : { mDelimChars, mQuoteChar, mEscapeChar } )
+  {
+    for ( const QChar c : chars )
+    {
+      if ( c.unicode() < 256 )
+        mLatin1SpecialChars.set( c.unicode() );
+    }
+  }
   mParser = &QgsDelimitedTextFile::parseQuoted;
   mDefinitionValid = !mDelimChars.isEmpty();
   if ( ! mDefinitionValid )
@@ -800,6 +809,31 @@ QgsDelimitedTextFile::Status QgsDelimitedTextFile::parseQuoted( QString &buffer,
       break;
     }
 
+    // Copy runs of ordinary characters with a single append. Within quotes
+    // anything but quote, escape and delimiter characters is copied, outside
+    // quotes whitespace is also left to the character by character logic below
+    // as it does not start a field.
+    if ( ! escaped && ( quoted || ! ended ) )
+    {
+      const QChar *data = buffer.constData();
+      int end = cp;
+      if ( quoted )
+      {
+        while ( end < cpmax && isOrdinaryChar( data[end] ) ) end++;
+      }
+      else
+      {
+        while ( end < cpmax && isOrdinaryChar( data[end] ) && ! data[end].isSpace() ) end++;
+      }
+      if ( end > cp )
+      {
+        field.append( data + cp, end - cp );
+        if ( ! quoted ) started = true;
+        cp = end;
+        continue;
+      }
+    }
+
     QChar c = buffer[cp];
     cp++;
 
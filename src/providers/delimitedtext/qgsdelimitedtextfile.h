@@ -23,6 +23,8 @@
 #include <QUrl>
 #include <QObject>
 
+#include <bitset>
+
 class QgsFeature;
 class QgsField;
 class QFile;
@@ -397,6 +399,15 @@ class QgsDelimitedTextFile : public QObject
      */
     void appendField( QStringList &record, QString field, bool quoted = false );
 
+    //! Returns TRUE if \a c is not a delimiter, quote or escape character
+    bool isOrdinaryChar( QChar c ) const
+    {
+      const ushort u = c.unicode();
+      if ( u < 256 )
+        return !mLatin1SpecialChars.test( u );
+      return !mDelimChars.contains( c ) && !mQuoteChar.contains( c ) && !mEscapeChar.contains( c );
+    }
+
     // Pointer to the currently selected parser
     Status( QgsDelimitedTextFile::*mParser )( QString &buffer, QStringList &fields );
 
@@ -423,6 +434,8 @@ class QgsDelimitedTextFile : public QObject
     QString mDelimChars;
     QString mQuoteChar;
     QString mEscapeChar;
+    // Latin1 characters which are delimiter, quote or escape characters
+    std::bitset< 256 > mLatin1SpecialChars;
 
     // Information extracted from file
     QStringList mFieldNames;
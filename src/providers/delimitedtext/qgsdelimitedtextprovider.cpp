@@ -27,6 +27,8 @@
 #include <QRegularExpression>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QThreadPool>
+#include <QtConcurrentMap>
 
 #include "qgsapplication.h"
 #include "qgscoordinateutils.h"
@@ -56,6 +58,263 @@ const QString QgsDelimitedTextProvider::TEXT_PROVIDER_DESCRIPTION = QStringLiter
 
 static const int SUBSET_ID_THRESHOLD_FACTOR = 10;
 
+// Field types are assessed for batches of records, the records of a batch being
+// split in blocks which are tested concurrently.
+
+static const int TYPE_DETECTION_BATCH_SIZE = 16384;
+static const int TYPE_DETECTION_BLOCK_SIZE = 1024;
+
+///@cond PRIVATE
+
+//! Types which the values of a column read so far could be converted to
+struct QgsDelimitedTextColumnTypes
+{
+  bool isEmpty = true;
+  bool couldBeInt = false;
+  bool couldBeLongLong = false;
+  bool couldBeDouble = false;
+  bool couldBeDateTime = false;
+  bool couldBeDate = false;
+  bool couldBeTime = false;
+};
+
+//! Result of testing a single value against the types of its column
+enum QgsDelimitedTextValueType
+{
+  ValueIsInt = 1,
+  ValueIsLongLong = 1 << 1,
+  ValueIsDouble = 1 << 2,
+  ValueIsDateTime = 1 << 3,
+  ValueIsDate = 1 << 4,
+  ValueIsTime = 1 << 5,
+  // Date and time tests of the value once the decimal point is replaced
+  DecimalValueIsDateTime = 1 << 6,
+  DecimalValueIsDate = 1 << 7,
+  DecimalValueIsTime = 1 << 8,
+};
+
+//! Shift from the date and time flags to their decimal counterparts
+static const int DECIMAL_VALUE_TYPE_SHIFT = 3;
+
+static bool valueCouldBeTime( const QString &value )
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  return QTime::fromString( value ).isValid();
+#else
+  // Accept 12:34, 12:34:56 or 12:34:56.789
+  // We do not use QTime::fromString() with Qt < 5.14 as it accepts
+  // strings like 01/03/2004 as valid times
+  bool couldBeTime = value.length() >= 5 &&
+                     value[0] >= '0' && value[0] <= '2' &&
+                     value[1] >= '0' && value[1] <= '9' &&
+                     value[2] == ':' &&
+                     value[3] >= '0' && value[3] <= '5' &&
+                     value[4] >= '0' && value[4] <= '9';
+  if ( couldBeTime && value.length() == 5 )
+  {
+    // ok
+  }
+  else if ( couldBeTime && value.length() >= 8 )
+  {
+    couldBeTime = value[5] == ':' &&
+                  value[6] >= '0' && value[6] <= '6' &&
+                  value[7] >= '0' && value[7] <= '9';
+    if ( couldBeTime && value.length() == 8 )
+    {
+      // ok
+    }
+    else if ( couldBeTime && value.length() >= 9 )
+    {
+      couldBeTime = value[8] == '.';
+    }
+    else
+    {
+      couldBeTime = false;
+    }
+  }
+  else
+  {
+    couldBeTime = false;
+  }
+  return couldBeTime;
+#endif
+}
+
+// Tests the date and time types of a value, returning the DateTime/Date/Time flags
+static int testDateTimeTypes( const QString &value, const QgsDelimitedTextColumnTypes &column )
+{
+  int types = 0;
+  if ( column.isEmpty || column.couldBeDateTime )
+  {
+    if ( value.length() > 10 && QDateTime::fromString( value, Qt::ISODate ).isValid() )
+      types |= ValueIsDateTime;
+  }
+  if ( column.isEmpty || column.couldBeDate )
+  {
+    if ( QDate::fromString( value, Qt::ISODate ).isValid() )
+      types |= ValueIsDate;
+  }
+  if ( column.isEmpty || column.couldBeTime )
+  {
+    if ( valueCouldBeTime( value ) )
+      types |= ValueIsTime;
+  }
+  return types;
+}
+
+// Tests a non empty value against the types its column could still have, independently
+// of the other values of the column. The decimal point replacement which may happen
+// before the date and time tests is tested separately.
+static int testValueTypes( const QString &value, const QgsDelimitedTextColumnTypes &column, const QString &decimalPoint )
+{
+  int types = 0;
+  bool ok = false;
+  if ( column.isEmpty || column.couldBeInt )
+  {
+    ( void )value.toInt( &ok );
+    if ( ok )
+      types |= ValueIsInt | ValueIsLongLong;
+  }
+  if ( !( types & ValueIsLongLong ) && ( column.isEmpty || column.couldBeLongLong ) )
+  {
+    ( void )value.toLongLong( &ok );
+    if ( ok )
+      types |= ValueIsLongLong;
+  }
+
+  bool replaced = false;
+  QString decimalValue;
+  if ( column.isEmpty || column.couldBeDouble )
+  {
+    decimalValue = value;
+    if ( ! decimalPoint.isEmpty() )
+    {
+      decimalValue.replace( decimalPoint, QLatin1String( "." ) );
+      replaced = decimalValue != value;
+    }
+    ( void )decimalValue.toDouble( &ok );
+    if ( ok )
+      types |= ValueIsDouble;
+  }
+
+  const int dateTimeTypes = testDateTimeTypes( value, column );
+  types |= dateTimeTypes;
+  types |= ( replaced ? testDateTimeTypes( decimalValue, column ) : dateTimeTypes ) << DECIMAL_VALUE_TYPE_SHIFT;
+  return types;
+}
+
+// Updates the column types with the result of testing one of its values. This must be
+// called for the values of the column in file order, as types are tested in turn and
+// the value used to test date and time depends on whether it was tested as a double.
+static void updateColumnTypes( QgsDelimitedTextColumnTypes &column, int types )
+{
+  if ( column.couldBeInt )
+    column.couldBeInt = types & ValueIsInt;
+
+  if ( column.couldBeLongLong && !column.couldBeInt )
+    column.couldBeLongLong = types & ValueIsLongLong;
+
+  bool replaced = false;
+  if ( column.couldBeDouble && !column.couldBeLongLong )
+  {
+    column.couldBeDouble = types & ValueIsDouble;
+    replaced = true;
+  }
+
+  const int dateTimeTypes = replaced ? types >> DECIMAL_VALUE_TYPE_SHIFT : types;
+  if ( column.couldBeDateTime )
+    column.couldBeDateTime = dateTimeTypes & ValueIsDateTime;
+
+  if ( column.couldBeDate && !column.couldBeDateTime )
+    column.couldBeDate = dateTimeTypes & ValueIsDate;
+
+  if ( column.couldBeTime && !column.couldBeDateTime )
+    column.couldBeTime = dateTimeTypes & ValueIsTime;
+}
+
+// Assesses the types of the non empty values of a batch of records, in file order
+static void assessFieldTypes( const QVector< QStringList > &records, std::vector< QgsDelimitedTextColumnTypes > &columns, bool detectTypes, const QString &decimalPoint )
+{
+  std::vector< QVector< int > > recordTypes;
+  if ( detectTypes )
+  {
+    // Values are tested against the types their column could have before the batch,
+    // so that blocks of records can be tested independently of each other
+    recordTypes.resize( records.size() );
+    const std::vector< QgsDelimitedTextColumnTypes > batchColumns = columns;
+    const QgsDelimitedTextColumnTypes emptyColumn;
+    auto testRecords = [&records, &recordTypes, &batchColumns, &emptyColumn, &decimalPoint]( const QPair< int, int > &range )
+    {
+      for ( int r = range.first; r < range.second; r++ )
+      {
+        const QStringList &values = records.at( r );
+        QVector< int > &types = recordTypes[r];
+        types.resize( values.size() );
+        for ( int i = 0; i < values.size(); i++ )
+        {
+          const QString &value = values.at( i );
+          if ( value.isEmpty() )
+            continue;
+          const QgsDelimitedTextColumnTypes &column = i < static_cast< int >( batchColumns.size() ) ? batchColumns[i] : emptyColumn;
+          types[i] = testValueTypes( value, column, decimalPoint );
+        }
+      }
+    };
+
+    QVector< QPair< int, int > > ranges;
+    for ( int start = 0; start < records.size(); start += TYPE_DETECTION_BLOCK_SIZE )
+    {
+      ranges << qMakePair( start, std::min( start + TYPE_DETECTION_BLOCK_SIZE, records.size() ) );
+    }
+    if ( ranges.size() > 1 && QThreadPool::globalInstance()->maxThreadCount() > 1 )
+    {
+      QtConcurrent::blockingMap( ranges, testRecords );
+    }
+    else
+    {
+      for ( const QPair< int, int > &range : std::as_const( ranges ) )
+        testRecords( range );
+    }
+  }
+
+  // Now update the possible types of each column, record by record
+  for ( int r = 0; r < records.size(); r++ )
+  {
+    const QStringList &values = records.at( r );
+    for ( int i = 0; i < values.size(); i++ )
+    {
+      // Ignore empty fields - spreadsheet generated CSV files often
+      // have random empty fields at the end of a row
+      if ( values.at( i ).isEmpty() )
+        continue;
+
+      // Expand the columns to include this non empty field if necessary
+      if ( static_cast< int >( columns.size() ) <= i )
+        columns.resize( i + 1 );
+
+      // If this column has been empty so far then initialize it
+      // for possible types
+      QgsDelimitedTextColumnTypes &column = columns[i];
+      if ( column.isEmpty )
+      {
+        column.isEmpty = false;
+        column.couldBeInt = true;
+        column.couldBeLongLong = true;
+        column.couldBeDouble = true;
+        column.couldBeDateTime = true;
+        column.couldBeDate = true;
+        column.couldBeTime = true;
+      }
+
+      // Types are possible until first record which cannot be parsed
+      if ( detectTypes )
+        updateColumnTypes( column, recordTypes[r][i] );
+    }
+  }
+}
+
+///@endcond
+
 QRegularExpression QgsDelimitedTextProvider::sWktPrefixRegexp( QStringLiteral( "^\\s*(?:\\d+\\s+|SRID\\=\\d+\\;)" ), QRegularExpression::CaseInsensitiveOption );
 QRegularExpression QgsDelimitedTextProvider::sCrdDmsRegexp( QStringLiteral( "^\\s*(?:([-+nsew])\\s*)?(\\d{1,3})(?:[^0-9.]+([0-5]?\\d))?[^0-9.]+([0-5]?\\d(?:\\.\\d+)?)[^0-9.]*([-+nsew])?\\s*$" ), QRegularExpression::CaseInsensitiveOption );
 
@@ -403,13 +662,10 @@ void QgsDelimitedTextProvider::scanFile( bool buildIndexes )
   mNumberFeatures = 0;
   mExtent = QgsRectangle();
 
-  QList<bool> isEmpty;
-  QList<bool> couldBeInt;
-  QList<bool> couldBeLongLong;
-  QList<bool> couldBeDouble;
-  QList<bool> couldBeDateTime;
-  QList<bool> couldBeDate;
-  QList<bool> couldBeTime;
+  std::vector< QgsDelimitedTextColumnTypes > columnTypes;
+  // Records whose field types have not been assessed yet
+  QVector< QStringList > typeDetectionBatch;
+  typeDetectionBatch.reserve( TYPE_DETECTION_BATCH_SIZE );
 
   bool foundFirstGeometry = false;
 
@@ -477,10 +733,9 @@ void QgsDelimitedTextProvider::scanFile( bool buildIndexes )
               }
               if ( buildSpatialIndex )
               {
-                QgsFeature f;
-                f.setId( mFile->recordId() );
-                f.setGeometry( geom );
-                mSpatialIndex->addFeature( f );
+                const QgsRectangle bbox = geom.boundingBox();
+                if ( bbox.isFinite() )
+                  mSpatialIndex->addFeature( mFile->recordId(), bbox );
               }
             }
             else
@@ -544,10 +799,7 @@ void QgsDelimitedTextProvider::scanFile( bool buildIndexes )
           mNumberFeatures++;
           if ( buildSpatialIndex && std::isfinite( pt.x() ) && std::isfinite( pt.y() ) )
           {
-            QgsFeature f;
-            f.setId( mFile->recordId() );
-            f.setGeometry( QgsGeometry::fromPointXY( pt ) );
-            mSpatialIndex->addFeature( f );
+            mSpatialIndex->addFeature( mFile->recordId(), QgsRectangle( pt.x(), pt.y(), pt.x(), pt.y() ) );
           }
         }
         else
@@ -571,132 +823,18 @@ void QgsDelimitedTextProvider::scanFile( bool buildIndexes )
       mSubsetIndex.append( mFile->recordId() );
 
 
-    // If we are going to use this record, then assess the potential types of each column
+    // If we are going to use this record, then assess the potential types of each column.
+    // This is done for batches of records, which are tested concurrently.
 
-    for ( int i = 0; i < parts.size(); i++ )
+    typeDetectionBatch.append( parts );
+    if ( typeDetectionBatch.size() >= TYPE_DETECTION_BATCH_SIZE )
     {
-
-      QString &value = parts[i];
-      // Ignore empty fields - spreadsheet generated CSV files often
-      // have random empty fields at the end of a row
-      if ( value.isEmpty() )
-        continue;
-
-      // Expand the columns to include this non empty field if necessary
-
-      while ( couldBeInt.size() <= i )
-      {
-        isEmpty.append( true );
-        couldBeInt.append( false );
-        couldBeLongLong.append( false );
-        couldBeDouble.append( false );
-        couldBeDateTime.append( false );
-        couldBeDate.append( false );
-        couldBeTime.append( false );
-      }
-
-      // If this column has been empty so far then initiallize it
-      // for possible types
-
-      if ( isEmpty[i] )
-      {
-        isEmpty[i] = false;
-        couldBeInt[i] = true;
-        couldBeLongLong[i] = true;
-        couldBeDouble[i] = true;
-        couldBeDateTime[i] = true;
-        couldBeDate[i] = true;
-        couldBeTime[i] = true;
-      }
-
-      if ( ! mDetectTypes )
-      {
-        continue;
-      }
-
-      // Now test for still valid possible types for the field
-      // Types are possible until first record which cannot be parsed
-
-      if ( couldBeInt[i] )
-      {
-        ( void )value.toInt( &couldBeInt[i] );
-      }
-
-      if ( couldBeLongLong[i] && !couldBeInt[i] )
-      {
-        ( void )value.toLongLong( &couldBeLongLong[i] );
-      }
-
-      if ( couldBeDouble[i] && !couldBeLongLong[i] )
-      {
-        if ( ! mDecimalPoint.isEmpty() )
-        {
-          value.replace( mDecimalPoint, QLatin1String( "." ) );
-        }
-        ( void )value.toDouble( &couldBeDouble[i] );
-      }
-
-      if ( couldBeDateTime[i] )
-      {
-        QDateTime dt;
-        if ( value.length() > 10 )
-        {
-          dt = QDateTime::fromString( value, Qt::ISODate );
-        }
-        couldBeDateTime[i] = ( dt.isValid() );
-      }
-
-      if ( couldBeDate[i] && !couldBeDateTime[i] )
-      {
-        QDate d = QDate::fromString( value, Qt::ISODate );
-        couldBeDate[i] = d.isValid();
-      }
-
-      if ( couldBeTime[i] && !couldBeDateTime[i] )
-      {
-#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
-        QTime t = QTime::fromString( value );
-        couldBeTime[i] = t.isValid();
-#else
-        // Accept 12:34, 12:34:56 or 12:34:56.789
-        // We do not use QTime::fromString() with Qt < 5.14 as it accepts
-        // strings like 01/03/2004 as valid times
-        couldBeTime[i] = value.length() >= 5 &&
-                         value[0] >= '0' && value[0] <= '2' &&
-                         value[1] >= '0' && value[1] <= '9' &&
-                         value[2] == ':' &&
-                         value[3] >= '0' && value[3] <= '5' &&
-                         value[4] >= '0' && value[4] <= '9';
-        if ( couldBeTime[i] && value.length() == 5 )
-        {
-          // ok
-        }
-        else if ( couldBeTime[i] && value.length() >= 8 )
-        {
-          couldBeTime[i] = value[5] == ':' &&
-                           value[6] >= '0' && value[6] <= '6' &&
-                           value[7] >= '0' && value[7] <= '9';
-          if ( couldBeTime[i] && value.length() == 8 )
-          {
-            // ok
-          }
-          else if ( couldBeTime[i] && value.length() >= 9 )
-          {
-            couldBeTime[i] = value[8] == '.';
-          }
-          else
-          {
-            couldBeTime[i] = false;
-          }
-        }
-        else
-        {
-          couldBeTime[i] = false;
-        }
-#endif
-      }
+      assessFieldTypes( typeDetectionBatch, columnTypes, mDetectTypes, mDecimalPoint );
+      typeDetectionBatch.clear();
     }
   }
+  assessFieldTypes( typeDetectionBatch, columnTypes, mDetectTypes, mDecimalPoint );
+  typeDetectionBatch.clear();
 
   // Now create the attribute fields.  Field types are determined by prioritizing
   // integer, failing that double, datetime, date, time, and finally text.
@@ -722,29 +860,30 @@ void QgsDelimitedTextProvider::scanFile( bool buildIndexes )
     {
       typeName = csvtTypes[i];
     }
-    else if ( mDetectTypes && i < couldBeInt.size() )
+    else if ( mDetectTypes && i < static_cast< int >( columnTypes.size() ) )
     {
-      if ( couldBeInt[i] )
+      const QgsDelimitedTextColumnTypes &column = columnTypes[i];
+      if ( column.couldBeInt )
       {
         typeName = QStringLiteral( "integer" );
       }
-      else if ( couldBeLongLong[i] )
+      else if ( column.couldBeLongLong )
       {
         typeName = QStringLiteral( "longlong" );
       }
-      else if ( couldBeDouble[i] )
+      else if ( column.couldBeDouble )
       {
         typeName = QStringLiteral( "double" );
       }
-      else if ( couldBeDateTime[i] )
+      else if ( column.couldBeDateTime )
       {
         typeName = QStringLiteral( "datetime" );
       }
-      else if ( couldBeDate[i] )
+      else if ( column.couldBeDate )
       {
         typeName = QStringLiteral( "date" );
       }
-      else if ( couldBeTime[i] )
+      else if ( column.couldBeTime )
       {
         typeName = QStringLiteral( "time" );
       }
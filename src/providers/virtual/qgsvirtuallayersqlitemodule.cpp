@@ -18,6 +18,8 @@ email                : hugo dot mercier at oslandia dot com
 #include <iostream>
 #include <cstdint>
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
 
 #include <QCoreApplication>
 #include <QBuffer>
@@ -159,8 +161,27 @@ struct VTable
 
     QgsFields fields() const { return mFields; }
 
+    /**
+     * Returns the number of features of the table, used to estimate the cost of queries.
+     * The count is only requested once from the layer or provider.
+     */
+    double estimatedFeatureCount()
+    {
+      if ( mFeatureCount < 0 && mValid )
+      {
+        mFeatureCount = mLayer ? mLayer->featureCount() : mProvider->featureCount();
+        // unknown feature count
+        if ( mFeatureCount < 0 )
+          mFeatureCount = UNKNOWN_FEATURE_COUNT;
+      }
+      return static_cast< double >( std::max( mFeatureCount, 1LL ) );
+    }
+
   private:
 
+    //! Number of features assumed when the provider cannot count them
+    static constexpr long long UNKNOWN_FEATURE_COUNT = 100000;
+
     VTable( const VTable &other ) = delete;
     VTable &operator=( const VTable &other ) = delete;
 
@@ -190,6 +211,8 @@ struct VTable
 
     QgsFields mFields;
 
+    long long mFeatureCount = -1;
+
     void init_()
     {
       mFields = mLayer ? mLayer->fields() : mProvider->fields();
@@ -474,9 +497,52 @@ int vtableRename( sqlite3_vtab *vtab, const char *newName )
   return SQLITE_OK;
 }
 
+// Values of idxNum passed from vtableBestIndex to vtableFilter
+enum IndexType
+{
+  NoIndex = 0, // full scan
+  FidIndex = 1, // primary key filter, with the key as single argument
+  ConstraintsIndex = 2, // search frames, comparison operators and limit, with one argument per entry of idxStr
+};
+
+// Fraction of the features expected to be kept by a constraint, used to estimate the cost of filtered queries
+static double constraintSelectivity( unsigned char op )
+{
+  switch ( op )
+  {
+    case SQLITE_INDEX_CONSTRAINT_EQ:
+      return 0.1;
+    case SQLITE_INDEX_CONSTRAINT_GT:
+    case SQLITE_INDEX_CONSTRAINT_LE:
+    case SQLITE_INDEX_CONSTRAINT_LT:
+    case SQLITE_INDEX_CONSTRAINT_GE:
+      return 0.33;
+    default:
+      return 0.5;
+  }
+}
+
+// Sets the estimated cost and number of rows of the plan chosen by vtableBestIndex
+static void setIndexEstimates( sqlite3_index_info *indexInfo, double rows, bool unique )
+{
+  // fetching features through a request has a fixed cost, then a cost per returned feature
+  indexInfo->estimatedCost = 1.0 + rows;
+  // the following members are only allocated by recent SQLite versions
+  if ( sqlite3_libversion_number() >= 3008002 )
+    indexInfo->estimatedRows = static_cast< sqlite3_int64 >( std::ceil( rows ) );
+  if ( unique && sqlite3_libversion_number() >= 3009000 )
+    indexInfo->idxFlags |= SQLITE_INDEX_SCAN_UNIQUE;
+}
+
 int vtableBestIndex( sqlite3_vtab *pvtab, sqlite3_index_info *indexInfo )
 {
   VTable *vtab = reinterpret_cast< VTable * >( pvtab );
+  const double featureCount = vtab->estimatedFeatureCount();
+
+  indexInfo->idxNum = NoIndex;
+  indexInfo->idxStr = nullptr;
+  indexInfo->needToFreeIdxStr = 0;
+
   for ( int i = 0; i < indexInfo->nConstraint; i++ )
   {
     // request for primary key filter with '='
@@ -486,88 +552,107 @@ int vtableBestIndex( sqlite3_vtab *pvtab, sqlite3_index_info *indexInfo )
     {
       indexInfo->aConstraintUsage[i].argvIndex = 1;
       indexInfo->aConstraintUsage[i].omit = 1;
-      indexInfo->idxNum = 1; // PK filter
-      indexInfo->estimatedCost = 1.0;
-      indexInfo->idxStr = nullptr;
-      indexInfo->needToFreeIdxStr = 0;
+      indexInfo->idxNum = FidIndex;
+      setIndexEstimates( indexInfo, 1.0, true );
       return SQLITE_OK;
     }
+  }
 
-    // request for filter with a comparison operator
-    if ( ( indexInfo->aConstraint[i].usable ) &&
-         ( indexInfo->aConstraint[i].iColumn >= 0 ) &&
-         ( indexInfo->aConstraint[i].iColumn < vtab->fields().count() ) &&
-         ( ( indexInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_EQ ) || // if no PK
-           ( indexInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_GT ) ||
-           ( indexInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_LE ) ||
-           ( indexInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_LT ) ||
-           ( indexInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_GE )
-#ifdef SQLITE_INDEX_CONSTRAINT_LIKE
-           || ( indexInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_LIKE )
+  // All the other usable constraints are ANDed in a single feature request:
+  // search frames give the filter rectangle, comparisons an expression which
+  // the provider may compile. Each entry of the idxStr list describes the
+  // argument passed to vtableFilter at the same position.
+  QStringList arguments;
+  double rows = featureCount;
+  bool allConstraintsUsed = true;
+  int limitConstraint = -1;
+  int offsetConstraint = -1;
+  for ( int i = 0; i < indexInfo->nConstraint; i++ )
+  {
+    const auto &constraint = indexInfo->aConstraint[i];
+#ifdef SQLITE_INDEX_CONSTRAINT_LIMIT
+    if ( constraint.op == SQLITE_INDEX_CONSTRAINT_LIMIT )
+    {
+      if ( constraint.usable )
+        limitConstraint = i;
+      continue;
+    }
+    if ( constraint.op == SQLITE_INDEX_CONSTRAINT_OFFSET )
+    {
+      if ( constraint.usable )
+        offsetConstraint = i;
+      continue;
+    }
 #endif
-         ) )
+    if ( !constraint.usable )
     {
-      indexInfo->aConstraintUsage[i].argvIndex = 1;
+      allConstraintsUsed = false;
+      continue;
+    }
+
+    // request for rtree filtering on the _search_frame_ column
+    if ( ( vtab->fields().count() + 1 == constraint.iColumn ) &&
+         ( constraint.op == SQLITE_INDEX_CONSTRAINT_EQ ) )
+    {
+      arguments << QStringLiteral( "r" );
+      indexInfo->aConstraintUsage[i].argvIndex = arguments.size();
+      // do not test for equality, since it is used for filtering, not to return an actual value
       indexInfo->aConstraintUsage[i].omit = 1;
-      indexInfo->idxNum = 3; // expression filter
-      indexInfo->estimatedCost = 2.0; // probably better than no index
+      rows *= 0.1;
+      continue;
+    }
 
-      QString expr = QgsExpression::quotedColumnRef( vtab->fields().at( indexInfo->aConstraint[i].iColumn ).name() );
-      switch ( indexInfo->aConstraint[i].op )
-      {
-        case SQLITE_INDEX_CONSTRAINT_EQ:
-          expr += QLatin1String( " = " );
-          break;
-        case SQLITE_INDEX_CONSTRAINT_GT:
-          expr += QLatin1String( " > " );
-          break;
-        case SQLITE_INDEX_CONSTRAINT_LE:
-          expr += QLatin1String( " <= " );
-          break;
-        case SQLITE_INDEX_CONSTRAINT_LT:
-          expr += QLatin1String( " < " );
-          break;
-        case SQLITE_INDEX_CONSTRAINT_GE:
-          expr += QLatin1String( " >= " );
-          break;
+    // request for filter with a comparison operator
+    if ( ( constraint.iColumn >= 0 ) &&
+         ( constraint.iColumn < vtab->fields().count() ) &&
+         ( ( constraint.op == SQLITE_INDEX_CONSTRAINT_EQ ) ||
+           ( constraint.op == SQLITE_INDEX_CONSTRAINT_GT ) ||
+           ( constraint.op == SQLITE_INDEX_CONSTRAINT_LE ) ||
+           ( constraint.op == SQLITE_INDEX_CONSTRAINT_LT ) ||
+           ( constraint.op == SQLITE_INDEX_CONSTRAINT_GE )
 #ifdef SQLITE_INDEX_CONSTRAINT_LIKE
-        case SQLITE_INDEX_CONSTRAINT_LIKE:
-          expr += QLatin1String( " LIKE " );
-          break;
+           || ( constraint.op == SQLITE_INDEX_CONSTRAINT_LIKE )
 #endif
-        default:
-          break;
-      }
-
-      QByteArray ba = expr.toUtf8();
-      char *cp = ( char * )sqlite3_malloc( ba.size() + 1 );
-      memcpy( cp, ba.constData(), ba.size() + 1 );
-
-      indexInfo->idxStr = cp;
-      indexInfo->needToFreeIdxStr = 1;
-      return SQLITE_OK;
+         ) )
+    {
+      arguments << QStringLiteral( "c%1:%2" ).arg( constraint.iColumn ).arg( constraint.op );
+      indexInfo->aConstraintUsage[i].argvIndex = arguments.size();
+      indexInfo->aConstraintUsage[i].omit = 1;
+      rows *= constraintSelectivity( constraint.op );
+      continue;
     }
 
-    // request for rtree filtering
-    if ( ( indexInfo->aConstraint[i].usable ) &&
-         // request on _search_frame_ column
-         ( vtab->fields().count() + 1 == indexInfo->aConstraint[i].iColumn ) &&
-         ( indexInfo->aConstraint[i].op == SQLITE_INDEX_CONSTRAINT_EQ ) )
+    allConstraintsUsed = false;
+  }
+
+  // SQLite will not filter the returned rows any further if all the constraints
+  // are handled by the request, so that the limit can be passed to the provider.
+  // The offset is not skipped by the provider, SQLite applies both anyway.
+  if ( limitConstraint >= 0 && allConstraintsUsed && indexInfo->nOrderBy == 0 )
+  {
+    arguments << QStringLiteral( "l" );
+    indexInfo->aConstraintUsage[limitConstraint].argvIndex = arguments.size();
+    if ( offsetConstraint >= 0 )
     {
-      indexInfo->aConstraintUsage[i].argvIndex = 1;
-      // do not test for equality, since it is used for filtering, not to return an actual value
-      indexInfo->aConstraintUsage[i].omit = 1;
-      indexInfo->idxNum = 2; // RTree filter
-      indexInfo->estimatedCost = 1.0;
-      indexInfo->idxStr = nullptr;
-      indexInfo->needToFreeIdxStr = 0;
-      return SQLITE_OK;
+      arguments << QStringLiteral( "o" );
+      indexInfo->aConstraintUsage[offsetConstraint].argvIndex = arguments.size();
     }
   }
-  indexInfo->idxNum = 0;
-  indexInfo->estimatedCost = 10.0;
-  indexInfo->idxStr = nullptr;
-  indexInfo->needToFreeIdxStr = 0;
+
+  if ( arguments.isEmpty() )
+  {
+    setIndexEstimates( indexInfo, featureCount, false );
+    return SQLITE_OK;
+  }
+
+  const QByteArray ba = arguments.join( ',' ).toUtf8();
+  char *cp = static_cast< char * >( sqlite3_malloc( ba.size() + 1 ) );
+  memcpy( cp, ba.constData(), ba.size() + 1 );
+
+  indexInfo->idxNum = ConstraintsIndex;
+  indexInfo->idxStr = cp;
+  indexInfo->needToFreeIdxStr = 1;
+  setIndexEstimates( indexInfo, std::max( rows, 1.0 ), false );
   return SQLITE_OK;
 }
 
@@ -587,57 +672,136 @@ int vtableClose( sqlite3_vtab_cursor *cursor )
   return SQLITE_OK;
 }
 
-int vtableFilter( sqlite3_vtab_cursor *cursor, int idxNum, const char *idxStr, int argc, sqlite3_value **argv )
+// Returns the QGIS expression comparing a column to a value passed by SQLite
+static QString comparisonExpression( const QString &column, int op, sqlite3_value *value )
 {
-  Q_UNUSED( argc )
-
-  QgsFeatureRequest request;
-  if ( idxNum == 1 )
+  QString expr = QgsExpression::quotedColumnRef( column );
+  switch ( op )
   {
-    // id filter
-    request.setFilterFid( sqlite3_value_int( argv[0] ) );
+    case SQLITE_INDEX_CONSTRAINT_EQ:
+      expr += QLatin1String( " = " );
+      break;
+    case SQLITE_INDEX_CONSTRAINT_GT:
+      expr += QLatin1String( " > " );
+      break;
+    case SQLITE_INDEX_CONSTRAINT_LE:
+      expr += QLatin1String( " <= " );
+      break;
+    case SQLITE_INDEX_CONSTRAINT_LT:
+      expr += QLatin1String( " < " );
+      break;
+    case SQLITE_INDEX_CONSTRAINT_GE:
+      expr += QLatin1String( " >= " );
+      break;
+#ifdef SQLITE_INDEX_CONSTRAINT_LIKE
+    case SQLITE_INDEX_CONSTRAINT_LIKE:
+      expr += QLatin1String( " LIKE " );
+      break;
+#endif
+    default:
+      break;
   }
-  else if ( idxNum == 2 )
+
+  switch ( sqlite3_value_type( value ) )
   {
-    // rtree filter
-    const char *blob = reinterpret_cast< const char * >( sqlite3_value_blob( argv[0] ) );
-    if ( blob )
+    case SQLITE_INTEGER:
+      expr += QString::number( sqlite3_value_int64( value ) );
+      break;
+    case SQLITE_FLOAT:
+      expr += QString::number( sqlite3_value_double( value ) );
+      break;
+    case SQLITE_TEXT:
     {
-      int bytes = sqlite3_value_bytes( argv[0] );
-      QgsRectangle r( spatialiteBlobBbox( blob, bytes ) );
-      request.setFilterRect( r );
+      int n = sqlite3_value_bytes( value );
+      const char *t = reinterpret_cast<const char *>( sqlite3_value_text( value ) );
+      QString str = QString::fromUtf8( t, n );
+      expr += QgsExpression::quotedString( str );
+      break;
     }
+    case SQLITE_NULL:
+    case SQLITE_BLOB: // comparison to blob ignored
+    default:
+      // as in SQLite, comparing to NULL never matches
+      expr += QLatin1String( "NULL" );
+      break;
+  }
+  return expr;
+}
+
+int vtableFilter( sqlite3_vtab_cursor *cursor, int idxNum, const char *idxStr, int argc, sqlite3_value **argv )
+{
+  VTableCursor *c = reinterpret_cast<VTableCursor *>( cursor );
+
+  QgsFeatureRequest request;
+  if ( idxNum == FidIndex )
+  {
+    // id filter
+    request.setFilterFid( sqlite3_value_int64( argv[0] ) );
   }
-  else if ( idxNum == 3 )
+  else if ( idxNum == ConstraintsIndex )
   {
-    // comparison operator filter
-    // build an expression filter and rely on expression compiler if available
-    QString expr = idxStr;
-    switch ( sqlite3_value_type( argv[0] ) )
+    const QStringList arguments = QString::fromUtf8( idxStr ).split( ',' );
+    QgsRectangle filterRect;
+    bool hasFilterRect = false;
+    bool disjointFilterRects = false;
+    QStringList expressions;
+    long long limit = -1;
+    long long offset = 0;
+    for ( int i = 0; i < arguments.size() && i < argc; i++ )
     {
-      case SQLITE_INTEGER:
-        expr += QString::number( sqlite3_value_int64( argv[0] ) );
-        break;
-      case SQLITE_FLOAT:
-        expr += QString::number( sqlite3_value_double( argv[0] ) );
-        break;
-      case SQLITE_TEXT:
+      const QString &argument = arguments.at( i );
+      if ( argument == QLatin1String( "r" ) )
       {
-        int n = sqlite3_value_bytes( argv[0] );
-        const char *t = reinterpret_cast<const char *>( sqlite3_value_text( argv[0] ) );
-        QString str = QString::fromUtf8( t, n );
-        expr += QgsExpression::quotedString( str );
-        break;
+        // rtree filter, several search frames are intersected
+        const char *blob = reinterpret_cast< const char * >( sqlite3_value_blob( argv[i] ) );
+        if ( blob )
+        {
+          int bytes = sqlite3_value_bytes( argv[i] );
+          const QgsRectangle r( spatialiteBlobBbox( blob, bytes ) );
+          if ( hasFilterRect && !filterRect.intersects( r ) )
+            disjointFilterRects = true;
+          else
+            filterRect = hasFilterRect ? filterRect.intersect( r ) : r;
+          hasFilterRect = true;
+        }
+      }
+      else if ( argument == QLatin1String( "l" ) )
+      {
+        limit = sqlite3_value_int64( argv[i] );
+      }
+      else if ( argument == QLatin1String( "o" ) )
+      {
+        offset = std::max( sqlite3_value_int64( argv[i] ), static_cast< sqlite3_int64 >( 0 ) );
+      }
+      else if ( argument.startsWith( 'c' ) )
+      {
+        // comparison operator filter
+        // build an expression filter and rely on expression compiler if available
+        const int separator = argument.indexOf( ':' );
+        const int column = argument.mid( 1, separator - 1 ).toInt();
+        const int op = argument.mid( separator + 1 ).toInt();
+        expressions << comparisonExpression( c->mVtab->fields().at( column ).name(), op, argv[i] );
       }
-      case SQLITE_NULL:
-      case SQLITE_BLOB: // comparison to blob ignored
-      default:
-        expr += QLatin1String( " is null" );
-        break;
     }
-    request.setFilterExpression( expr );
+
+    if ( disjointFilterRects )
+    {
+      // disjoint search frames do not match any feature, whatever the other constraints are.
+      // The fid filter must not be replaced by an expression filter, as all constraints are omitted by SQLite
+      request.setFilterFids( QgsFeatureIds() );
+    }
+    else
+    {
+      if ( hasFilterRect )
+        request.setFilterRect( filterRect );
+      if ( expressions.size() == 1 )
+        request.setFilterExpression( expressions.at( 0 ) );
+      else if ( expressions.size() > 1 )
+        request.setFilterExpression( QStringLiteral( "(%1)" ).arg( expressions.join( QLatin1String( ") AND (" ) ) ) );
+      if ( limit >= 0 )
+        request.setLimit( limit + offset );
+    }
   }
-  VTableCursor *c = reinterpret_cast<VTableCursor *>( cursor );
   c->filter( request );
   return SQLITE_OK;
 }
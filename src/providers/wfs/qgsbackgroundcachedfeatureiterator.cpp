@@ -165,11 +165,53 @@ void QgsFeatureDownloaderImpl::createProgressDialog( int numberMatched )
     mProgressDialog->show();
 }
 
+// Number of features written to the cache in a single transaction
+static const int FEATURE_BATCH_SIZE = 10000;
+
+// Maximum time in milliseconds a downloaded feature waits before being notified
+static const int FEATURE_BATCH_MAX_DELAY = 1000;
+
+void QgsFeatureDownloaderImpl::queueFeature( const QgsFeatureUniqueIdPair &feature, bool serializeFeatures )
+{
+  if ( mQueuedFeatures.isEmpty() )
+    mQueuedFeaturesTimer.start();
+
+  mQueuedFeatures.push_back( feature );
+  if ( mQueuedFeatures.size() >= FEATURE_BATCH_SIZE )
+    flushQueuedFeatures( serializeFeatures, true );
+}
+
+void QgsFeatureDownloaderImpl::flushQueuedFeatures( bool serializeFeatures, bool force )
+{
+  if ( mQueuedFeatures.isEmpty() )
+    return;
+  if ( !force && mQueuedFeaturesTimer.elapsed() < FEATURE_BATCH_MAX_DELAY )
+    return;
+
+  // We call it directly to avoid asynchronous signal notification, and
+  // as serializeFeatures() can modify the featureList to remove features
+  // that have already been cached, so as to avoid to notify them several
+  // times to subscribers
+  if ( serializeFeatures )
+    mSharedBase->serializeFeatures( mQueuedFeatures );
+
+  if ( !mQueuedFeatures.isEmpty() )
+  {
+    emitFeatureReceived( mQueuedFeatures );
+    emitFeatureReceived( mQueuedFeatures.size() );
+  }
+
+  mQueuedFeatures.clear();
+}
+
 void QgsFeatureDownloaderImpl::endOfRun( bool serializeFeatures,
     bool success, int totalDownloadedFeatureCount,
     bool truncatedResponse, bool interrupted,
     const QString &errorMessage )
 {
+  // Features still queued must be cached before the end of the download is notified
+  flushQueuedFeatures( serializeFeatures, true );
+
   {
     QMutexLocker locker( &mMutexCreateProgressDialog );
     mStop = true;
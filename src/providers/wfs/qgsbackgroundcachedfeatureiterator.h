@@ -24,6 +24,7 @@
 class QDataStream;
 class QFile;
 class QPushButton;
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QThread>
 #include <QWaitCondition>
@@ -151,8 +152,23 @@ class QgsFeatureDownloaderImpl
 
     void connectSignals( QObject *obj, bool requestMadeFromMainThread );
 
+    /**
+     * Queues a downloaded feature. Features are written to the cache and notified
+     * to the iterators in large batches, which may span several responses or pages.
+     */
+    void queueFeature( const QgsFeatureUniqueIdPair &feature, bool serializeFeatures );
+
+    /**
+     * Writes the queued features to the cache and notifies them. Unless \a force
+     * is set, this is only done once the oldest queued feature waited for a second,
+     * so that features still show up progressively on slow connections.
+     */
+    void flushQueuedFeatures( bool serializeFeatures, bool force );
+
   private:
     QgsBackgroundCachedSharedData *mSharedBase;
+    QVector<QgsFeatureUniqueIdPair> mQueuedFeatures;
+    QElapsedTimer mQueuedFeaturesTimer;
     QgsFeatureDownloader *mDownloader;
     QWidget *mMainWindow = nullptr;
     QMutex mMutexCreateProgressDialog;
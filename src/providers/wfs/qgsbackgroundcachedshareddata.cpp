@@ -529,6 +529,14 @@ void QgsBackgroundCachedSharedData::serializeFeatures( QVector<QgsFeatureUniqueI
   Q_ASSERT( hexwkbGeomIdx >= 0 );
   int md5Idx = ( mDistinctSelect ) ? dataProviderFields.indexFromName( QgsBackgroundCachedFeatureIteratorConstants::FIELD_MD5 ) : -1;
 
+  // Index of the cache column of each user visible field
+  QVector<int> cachedFieldIndexes;
+  cachedFieldIndexes.reserve( mFields.size() );
+  for ( int i = 0; i < mFields.size(); i++ )
+  {
+    cachedFieldIndexes.append( dataProviderFields.indexFromName( mMapUserVisibleFieldNameToSpatialiteColumnName[mFields.at( i ).name()] ) );
+  }
+
   QSet<QString> existingUniqueIds;
   QSet<QString> existingMD5s;
   if ( mDistinctSelect )
@@ -601,12 +609,13 @@ void QgsBackgroundCachedSharedData::serializeFeatures( QVector<QgsFeatureUniqueI
     updatedFeatureList.push_back( featPair );
 
     //and the attributes
+    const QgsAttributes srcAttributes = srcFeature.attributes();
     for ( int i = 0; i < mFields.size(); i++ )
     {
-      int idx = dataProviderFields.indexFromName( mMapUserVisibleFieldNameToSpatialiteColumnName[mFields.at( i ).name()] );
+      const int idx = cachedFieldIndexes.at( i );
       if ( idx >= 0 )
       {
-        const QVariant &v = srcFeature.attributes().value( i );
+        const QVariant &v = srcAttributes.value( i );
         const QVariant::Type fieldType = dataProviderFields.at( idx ).type();
         if ( v.type() == QVariant::DateTime && !v.isNull() )
           cachedFeature.setAttribute( idx, QVariant( v.toDateTime().toMSecsSinceEpoch() ) );
@@ -642,9 +651,36 @@ void QgsBackgroundCachedSharedData::serializeFeatures( QVector<QgsFeatureUniqueI
     // That way we will always have a consistent feature id, even in case of
     // paging or BBOX request
     Q_ASSERT( featureListToCache.size() == updatedFeatureList.size() );
+
+    // The id cache is updated in a single transaction, with statements
+    // prepared once for the whole batch of features
+    QString errorMsg;
+    if ( mCacheIdDb.exec( QStringLiteral( "BEGIN" ), errorMsg ) != SQLITE_OK )
+    {
+      QgsMessageLog::logMessage( QObject::tr( "Problem when updating id cache: %1" ).arg( errorMsg ), mComponentTranslated );
+    }
+    int resultCode;
+    sqlite3_statement_unique_ptr selectIdsStmt = mCacheIdDb.prepare( QStringLiteral( "SELECT qgisId, dbId FROM id_cache WHERE uniqueId = ?" ), resultCode );
+    Q_ASSERT( resultCode == SQLITE_OK );
+    sqlite3_statement_unique_ptr clearDbIdStmt = mCacheIdDb.prepare( QStringLiteral( "UPDATE id_cache SET dbId = NULL WHERE dbId = ?" ), resultCode );
+    Q_ASSERT( resultCode == SQLITE_OK );
+    sqlite3_statement_unique_ptr setDbIdStmt = mCacheIdDb.prepare( QStringLiteral( "UPDATE id_cache SET dbId = ? WHERE uniqueId = ?" ), resultCode );
+    Q_ASSERT( resultCode == SQLITE_OK );
+    sqlite3_statement_unique_ptr insertIdStmt = mCacheIdDb.prepare( QStringLiteral( "INSERT INTO id_cache (uniqueId, dbId, qgisId) VALUES (?, ?, ?)" ), resultCode );
+    Q_ASSERT( resultCode == SQLITE_OK );
+
+    // Runs a statement updating the id cache, and resets it for the next feature
+    const auto execUpdate = [this]( sqlite3_statement_unique_ptr & stmt )
+    {
+      if ( stmt.step() != SQLITE_DONE )
+      {
+        QgsMessageLog::logMessage( QObject::tr( "Problem when updating id cache: %1" ).arg( QString::fromUtf8( sqlite3_errmsg( mCacheIdDb.get() ) ) ), mComponentTranslated );
+      }
+      sqlite3_reset( stmt.get() );
+    };
+
     for ( int i = 0; i < updatedFeatureList.size(); i++ )
     {
-      int resultCode;
       QgsFeatureId dbId( cacheOk ? featureListToCache[i].id() : mTotalFeaturesAttemptedToBeCached + i + 1 );
       QgsFeatureId qgisId;
       const auto &uniqueId( updatedFeatureList[i].second );
@@ -656,59 +692,51 @@ void QgsBackgroundCachedSharedData::serializeFeatures( QVector<QgsFeatureUniqueI
       }
       else
       {
-        QString errorMsg;
-
-        QString sql = qgs_sqlite3_mprintf( "SELECT qgisId, dbId FROM id_cache WHERE uniqueId = '%q'",
-                                           uniqueId.toUtf8().constData() );
-        auto stmt = mCacheIdDb.prepare( sql, resultCode );
-        Q_ASSERT( resultCode == SQLITE_OK );
-        if ( stmt.step() == SQLITE_ROW )
+        const QByteArray uniqueIdUtf8 = uniqueId.toUtf8();
+        sqlite3_bind_text( selectIdsStmt.get(), 1, uniqueIdUtf8.constData(), uniqueIdUtf8.size(), SQLITE_TRANSIENT );
+        if ( selectIdsStmt.step() == SQLITE_ROW )
         {
-          qgisId = stmt.columnAsInt64( 0 );
-          QgsFeatureId oldDbId = stmt.columnAsInt64( 1 );
+          qgisId = selectIdsStmt.columnAsInt64( 0 );
+          QgsFeatureId oldDbId = selectIdsStmt.columnAsInt64( 1 );
+          sqlite3_reset( selectIdsStmt.get() );
           if ( dbId != oldDbId )
           {
-            sql = qgs_sqlite3_mprintf( "UPDATE id_cache SET dbId = NULL WHERE dbId = %lld",
-                                       dbId );
-            if ( mCacheIdDb.exec( sql, errorMsg ) != SQLITE_OK )
-            {
-              QgsMessageLog::logMessage( QObject::tr( "Problem when updating id cache: %1 -> %2" ).arg( sql ).arg( errorMsg ), mComponentTranslated );
-            }
-
-            sql = qgs_sqlite3_mprintf( "UPDATE id_cache SET dbId = %lld WHERE uniqueId = '%q'",
-                                       dbId,
-                                       uniqueId.toUtf8().constData() );
-            if ( mCacheIdDb.exec( sql, errorMsg ) != SQLITE_OK )
-            {
-              QgsMessageLog::logMessage( QObject::tr( "Problem when updating id cache: %1 -> %2" ).arg( sql ).arg( errorMsg ), mComponentTranslated );
-            }
+            sqlite3_bind_int64( clearDbIdStmt.get(), 1, dbId );
+            execUpdate( clearDbIdStmt );
+
+            sqlite3_bind_int64( setDbIdStmt.get(), 1, dbId );
+            sqlite3_bind_text( setDbIdStmt.get(), 2, uniqueIdUtf8.constData(), uniqueIdUtf8.size(), SQLITE_TRANSIENT );
+            execUpdate( setDbIdStmt );
           }
         }
         else
         {
-          sql = qgs_sqlite3_mprintf( "UPDATE id_cache SET dbId = NULL WHERE dbId = %lld",
-                                     dbId );
-          if ( mCacheIdDb.exec( sql, errorMsg ) != SQLITE_OK )
-          {
-            QgsMessageLog::logMessage( QObject::tr( "Problem when updating id cache: %1 -> %2" ).arg( sql ).arg( errorMsg ), mComponentTranslated );
-          }
+          sqlite3_reset( selectIdsStmt.get() );
+
+          sqlite3_bind_int64( clearDbIdStmt.get(), 1, dbId );
+          execUpdate( clearDbIdStmt );
 
           qgisId = mNextCachedIdQgisId;
           mNextCachedIdQgisId ++;
-          sql = qgs_sqlite3_mprintf( "INSERT INTO id_cache (uniqueId, dbId, qgisId) VALUES ('%q', %lld, %lld)",
-                                     uniqueId.toUtf8().constData(),
-                                     dbId,
-                                     qgisId );
-          if ( mCacheIdDb.exec( sql, errorMsg ) != SQLITE_OK )
-          {
-            QgsMessageLog::logMessage( QObject::tr( "Problem when updating id cache: %1 -> %2" ).arg( sql ).arg( errorMsg ), mComponentTranslated );
-          }
+          sqlite3_bind_text( insertIdStmt.get(), 1, uniqueIdUtf8.constData(), uniqueIdUtf8.size(), SQLITE_TRANSIENT );
+          sqlite3_bind_int64( insertIdStmt.get(), 2, dbId );
+          sqlite3_bind_int64( insertIdStmt.get(), 3, qgisId );
+          execUpdate( insertIdStmt );
         }
       }
 
       updatedFeatureList[i].first.setId( qgisId );
     }
 
+    selectIdsStmt.reset();
+    clearDbIdStmt.reset();
+    setDbIdStmt.reset();
+    insertIdStmt.reset();
+    if ( mCacheIdDb.exec( QStringLiteral( "COMMIT" ), errorMsg ) != SQLITE_OK )
+    {
+      QgsMessageLog::logMessage( QObject::tr( "Problem when updating id cache: %1" ).arg( errorMsg ), mComponentTranslated );
+    }
+
     {
       QMutexLocker locker( &mMutex );
       if ( mRequestLimit != 1 )
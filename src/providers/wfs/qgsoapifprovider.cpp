@@ -735,8 +735,6 @@ void QgsOapifFeatureDownloaderImpl::run( bool serializeFeatures, long long maxFe
       emit updateProgress( totalDownloadedFeatureCount );
     }
 
-    QVector<QgsFeatureUniqueIdPair> featureList;
-    size_t i = 0;
     const QgsFields srcFields = itemsRequest.fields();
     const QgsFields dstFields = mShared->fields();
     for ( const auto &pair : itemsRequest.features() )
@@ -769,28 +767,11 @@ void QgsOapifFeatureDownloaderImpl::run( bool serializeFeatures, long long maxFe
         uniqueId = QgsBackgroundCachedSharedData::getMD5( f );
       }
 
-      featureList.push_back( QgsFeatureUniqueIdPair( dstFeat, uniqueId ) );
-
-      if ( ( i > 0 && ( i % 1000 ) == 0 ) || i + 1 == itemsRequest.features().size() )
-      {
-        // We call it directly to avoid asynchronous signal notification, and
-        // as serializeFeatures() can modify the featureList to remove features
-        // that have already been cached, so as to avoid to notify them several
-        // times to subscribers
-        if ( serializeFeatures )
-          mShared->serializeFeatures( featureList );
-
-        if ( !featureList.isEmpty() )
-        {
-          emitFeatureReceived( featureList );
-          emitFeatureReceived( featureList.size() );
-        }
-
-        featureList.clear();
-      }
-      i++;
+      queueFeature( QgsFeatureUniqueIdPair( dstFeat, uniqueId ), serializeFeatures );
     }
 
+    flushQueuedFeatures( serializeFeatures, false );
+
     if ( mShared->mPageSize <= 0 )
     {
       break;
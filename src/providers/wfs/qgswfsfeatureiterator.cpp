@@ -589,7 +589,6 @@ void QgsWFSFeatureDownloaderImpl::run( bool serializeFeatures, long long maxFeat
           }
         }
 
-        QVector<QgsFeatureUniqueIdPair> featureList;
         for ( int i = 0; i < featurePtrList.size(); i++ )
         {
           QgsGmlStreamingParser::QgsGmlFeaturePtrGmlIdPair &featPair = featurePtrList[i];
@@ -667,30 +666,15 @@ void QgsWFSFeatureDownloaderImpl::run( bool serializeFeatures, long long maxFeat
             }
           }
 
-          featureList.push_back( QgsFeatureUniqueIdPair( f, gmlId ) );
+          queueFeature( QgsFeatureUniqueIdPair( f, gmlId ), serializeFeatures );
           delete featPair.first;
-          if ( ( i > 0 && ( i % 1000 ) == 0 ) || i + 1 == featurePtrList.size() )
-          {
-            // We call it directly to avoid asynchronous signal notification, and
-            // as serializeFeatures() can modify the featureList to remove features
-            // that have already been cached, so as to avoid to notify them several
-            // times to subscribers
-            if ( serializeFeatures )
-              mShared->serializeFeatures( featureList );
-
-            if ( !featureList.isEmpty() )
-            {
-              emitFeatureReceived( featureList );
-              emitFeatureReceived( featureList.size() );
-            }
-
-            featureList.clear();
-          }
 
           featureCountForThisResponse ++;
         }
       }
 
+      flushQueuedFeatures( serializeFeatures, false );
+
       if ( finished )
       {
         if ( parser->isTruncatedResponse() && mPageSize == 0 )
@@ -196,6 +196,7 @@ QgsGmlStreamingParser *QgsWFSSharedData::createParser() const
     axisOrientationLogic = QgsGmlStreamingParser::Ignore_EPSG;
   }
 
+  QgsGmlStreamingParser *parser = nullptr;
   if ( !mLayerPropertiesList.isEmpty() )
   {
     QList< QgsGmlStreamingParser::LayerProperties > layerPropertiesList;
@@ -208,20 +209,24 @@ QgsGmlStreamingParser *QgsWFSSharedData::createParser() const
       layerPropertiesList << layerPropertiesOut;
     }
 
-    return new QgsGmlStreamingParser( layerPropertiesList,
-                                      mFields,
-                                      mMapFieldNameToSrcLayerNameFieldName,
-                                      axisOrientationLogic,
-                                      mURI.invertAxisOrientation() );
+    parser = new QgsGmlStreamingParser( layerPropertiesList,
+                                        mFields,
+                                        mMapFieldNameToSrcLayerNameFieldName,
+                                        axisOrientationLogic,
+                                        mURI.invertAxisOrientation() );
   }
   else
   {
-    return new QgsGmlStreamingParser( mURI.typeName(),
-                                      mGeometryAttribute,
-                                      mFields,
-                                      axisOrientationLogic,
-                                      mURI.invertAxisOrientation() );
+    parser = new QgsGmlStreamingParser( mURI.typeName(),
+                                        mGeometryAttribute,
+                                        mFields,
+                                        axisOrientationLogic,
+                                        mURI.invertAxisOrientation() );
   }
+
+  // large GetFeature responses are parsed by several threads
+  parser->setParallelParsingEnabled( true );
+  return parser;
 }
 
 
@@ -62,6 +62,7 @@
 #include <QEventLoop>
 #include <QTextCodec>
 #include <QThread>
+#include <QThreadPool>
 #include <QNetworkDiskCache>
 #include <QTimer>
 #include <QStringBuilder>
@@ -69,6 +70,9 @@
 #include <QJsonArray>
 #include <QRegularExpression>
 #include <QRegularExpressionMatch>
+#include <QCoreApplication>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
 
 #include <ogr_api.h>
 
@@ -578,6 +582,36 @@ void QgsWmsProvider::setFormatQueryItem( QUrlQuery &url )
 }
 
 
+//! Maximum number of tiles requested ahead after a view was drawn
+constexpr int MAX_PREFETCH_TILES = 128;
+
+//! Replaces the cache control of a tile in the disk cache by the default tile expiry, unless the server set one
+static void _updateTileCacheExpiry( const QUrl &url )
+{
+  if ( !QgsNetworkAccessManager::instance()->cache() )
+    return;
+
+  QNetworkCacheMetaData cmd = QgsNetworkAccessManager::instance()->cache()->metaData( url );
+
+  QNetworkCacheMetaData::RawHeaderList hl;
+  const auto constRawHeaders = cmd.rawHeaders();
+  for ( const QNetworkCacheMetaData::RawHeader &h : constRawHeaders )
+  {
+    if ( h.first != "Cache-Control" )
+      hl.append( h );
+  }
+  cmd.setRawHeaders( hl );
+
+  QgsDebugMsgLevel( QStringLiteral( "expirationDate:%1" ).arg( cmd.expirationDate().toString() ), 4 );
+  if ( cmd.expirationDate().isNull() )
+  {
+    QgsSettings s;
+    cmd.setExpirationDate( QDateTime::currentDateTime().addSecs( s.value( QStringLiteral( "qgis/defaultTileExpiry" ), "24" ).toInt() * 60 * 60 ) );
+  }
+
+  QgsNetworkAccessManager::instance()->cache()->updateMetaData( cmd );
+}
+
 static bool _fuzzyContainsRect( const QRectF &r1, const QRectF &r2 )
 {
   double significantDigits = std::log10( std::max( r1.width(), r1.height() ) );
@@ -672,6 +706,139 @@ void QgsWmsProvider::fetchOtherResTiles( QgsTileMode tileMode, const QgsRectangl
                     .arg( otherResTiles.count() ), 3 );
 }
 
+const QgsWmtsTileMatrixLimits *QgsWmsProvider::tileMatrixLimits( const QgsWmtsTileMatrix *tm ) const
+{
+  if ( mTileLayer && mTileMatrixSet &&
+       mTileLayer->setLinks.contains( mTileMatrixSet->identifier ) &&
+       mTileLayer->setLinks[ mTileMatrixSet->identifier ].limits.contains( tm->identifier ) )
+  {
+    return &mTileLayer->setLinks[ mTileMatrixSet->identifier ].limits[ tm->identifier ];
+  }
+  return nullptr;
+}
+
+void QgsWmsProvider::prefetchTiles( QgsTileMode tileMode, const QgsWmtsTileMatrix *tm, const QgsRectangle &viewExtent, int col0, int row0, int col1, int row1 )
+{
+  const auto addRequests = [this, tileMode]( const QgsWmtsTileMatrix * matrix, const TilePositions & tiles, TileRequests & requests )
+  {
+    switch ( tileMode )
+    {
+      case WMSC:
+        createTileRequestsWMSC( matrix, tiles, requests );
+        break;
+
+      case WMTS:
+        createTileRequestsWMTS( matrix, tiles, requests );
+        break;
+
+      case XYZ:
+        createTileRequestsXYZ( matrix, tiles, requests );
+        break;
+    }
+  };
+
+  // ring of tiles around the view, within the extent of the matrix
+  int limitCol0 = 0, limitRow0 = 0, limitCol1 = tm->matrixWidth - 1, limitRow1 = tm->matrixHeight - 1;
+  if ( const QgsWmtsTileMatrixLimits *tml = tileMatrixLimits( tm ) )
+  {
+    limitCol0 = tml->minTileCol;
+    limitRow0 = tml->minTileRow;
+    limitCol1 = tml->maxTileCol;
+    limitRow1 = tml->maxTileRow;
+  }
+
+  TilePositions ringTiles;
+  for ( int row = std::max( row0 - 1, limitRow0 ); row <= std::min( row1 + 1, limitRow1 ); row++ )
+  {
+    for ( int col = std::max( col0 - 1, limitCol0 ); col <= std::min( col1 + 1, limitCol1 ); col++ )
+    {
+      if ( row < row0 || row > row1 || col < col0 || col > col1 )
+        ringTiles << TilePosition( row, col );
+    }
+  }
+
+  TileRequests requests;
+  addRequests( tm, ringTiles, requests );
+
+  // tiles of the next zoom level covering the view
+  const QgsWmtsTileMatrix *tmNext = mTileMatrixSet ? mTileMatrixSet->findOtherResolution( tm->tres, -1 ) : nullptr;
+  if ( tmNext )
+  {
+    int c0, r0, c1, r1;
+    tmNext->viewExtentIntersection( viewExtent, tileMatrixLimits( tmNext ), c0, r0, c1, r1 );
+
+    TilePositions nextTiles;
+    for ( int row = r0; row <= r1; row++ )
+    {
+      for ( int col = c0; col <= c1; col++ )
+      {
+        nextTiles << TilePosition( row, col );
+      }
+    }
+    addRequests( tmNext, nextTiles, requests );
+  }
+
+  if ( requests.isEmpty() || !QCoreApplication::instance() )
+    return;
+
+  LessThanTileRequest cmp;
+  cmp.center = viewExtent.center();
+  std::sort( requests.begin(), requests.end(), cmp );
+  if ( requests.size() > MAX_PREFETCH_TILES )
+    requests.erase( requests.begin() + MAX_PREFETCH_TILES, requests.end() );
+
+  // the render thread does not process events once the view is drawn, so let the main thread download the tiles
+  const QgsWmsAuthorization auth = mSettings.authorization();
+  QMetaObject::invokeMethod( QCoreApplication::instance(), [requests, auth]
+  {
+    for ( const TileRequest &r : requests )
+    {
+      if ( QgsNetworkAccessManager::instance()->cache() && QgsNetworkAccessManager::instance()->cache()->metaData( r.url ).isValid() )
+        continue;
+
+      QNetworkRequest request( r.url );
+      QgsSetRequestInitiatorClass( request, QStringLiteral( "QgsWmsProvider" ) );
+      auth.setAuthorization( request );
+      request.setRawHeader( "Accept", "*/*" );
+      request.setAttribute( QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache );
+      request.setAttribute( QNetworkRequest::CacheSaveControlAttribute, true );
+
+      QNetworkReply *reply = QgsNetworkAccessManager::instance()->get( request );
+      QObject::connect( reply, &QNetworkReply::finished, reply, [reply]
+      {
+        if ( reply->error() == QNetworkReply::NoError )
+          _updateTileCacheExpiry( reply->request().url() );
+        reply->deleteLater();
+      } );
+    }
+  }, Qt::QueuedConnection );
+}
+
+void QgsWmsProvider::decodeTiles( QVector<TileLookup> &lookups, const QVector<int> &indices )
+{
+  const auto decode = [&lookups]( int index )
+  {
+    TileLookup &lookup = lookups[index];
+    lookup.image = QImage::fromData( lookup.data );
+    lookup.data.clear();
+
+    // Check for null because it could be a redirect (see: https://github.com/qgis/QGIS/issues/24336 )
+    if ( !lookup.image.isNull() )
+      QgsTileCache::insertTile( lookup.cacheUrl, lookup.image );
+    else if ( lookup.isMBTile )
+      QgsDebugMsg( QStringLiteral( "MBTile data failed to load: %1" ).arg( lookup.cacheUrl.toString() ) );
+  };
+
+  if ( indices.size() < 2 || QThreadPool::globalInstance()->maxThreadCount() < 2 )
+  {
+    for ( int index : indices )
+      decode( index );
+    return;
+  }
+
+  QtConcurrent::blockingMap( indices.constBegin(), indices.constEnd(), [&decode]( const int &index ) { decode( index ); } );
+}
+
 uint qHash( QgsWmsProvider::TilePosition tp )
 {
   return ( uint ) tp.col + ( ( uint ) tp.row << 16 );
@@ -796,14 +963,7 @@ QImage *QgsWmsProvider::draw( QgsRectangle const &viewExtent, int pixelWidth, in
                       .arg( tm->identifier ), 3
                     );
 
-    const QgsWmtsTileMatrixLimits *tml = nullptr;
-
-    if ( mTileLayer &&
-         mTileLayer->setLinks.contains( mTileMatrixSet->identifier ) &&
-         mTileLayer->setLinks[ mTileMatrixSet->identifier ].limits.contains( tm->identifier ) )
-    {
-      tml = &mTileLayer->setLinks[ mTileMatrixSet->identifier ].limits[ tm->identifier ];
-    }
+    const QgsWmtsTileMatrixLimits *tml = tileMatrixLimits( tm );
 
     // calculate tile coordinates
     int col0, col1, row0, row1;
@@ -860,24 +1020,43 @@ QImage *QgsWmsProvider::draw( QgsRectangle const &viewExtent, int pixelWidth, in
 
     QElapsedTimer t;
     t.start();
-    TileRequests requestsFinal;
-    const auto constRequests = requests;
-    for ( const TileRequest &r : constRequests )
+
+    // read the tiles which are not in the in-memory cache, then decode them all at once
+    QVector< TileLookup > lookups( requests.size() );
+    QVector< int > encodedTiles;
+    for ( int i = 0; i < requests.size(); ++i )
     {
-      QImage localImage;
+      const TileRequest &r = requests.at( i );
+      TileLookup &lookup = lookups[i];
+      if ( QgsTileCache::tileOrEncodedData( r.url, lookup.image, lookup.data, lookup.cacheUrl ) )
+        continue;
 
-      if ( mbtilesReader && !QgsTileCache::tile( r.url, localImage ) )
+      if ( mbtilesReader )
       {
         QUrlQuery query( r.url );
-        QImage img = mbtilesReader->tileDataAsImage( query.queryItemValue( "z" ).toInt(),
-                     query.queryItemValue( "x" ).toInt(),
-                     query.queryItemValue( "y" ).toInt() );
-        if ( img.isNull() )
-          continue;
-        QgsTileCache::insertTile( r.url, img );
+        lookup.data = mbtilesReader->tileData( query.queryItemValue( "z" ).toInt(),
+                                               query.queryItemValue( "x" ).toInt(),
+                                               query.queryItemValue( "y" ).toInt() );
+        lookup.cacheUrl = r.url;
+        lookup.isMBTile = true;
       }
 
-      if ( QgsTileCache::tile( r.url, localImage ) )
+      if ( !lookup.data.isEmpty() )
+        encodedTiles << i;
+    }
+    decodeTiles( lookups, encodedTiles );
+
+    TileRequests requestsFinal;
+    for ( int i = 0; i < requests.size(); ++i )
+    {
+      const TileRequest &r = requests.at( i );
+      const QImage &localImage = lookups.at( i ).image;
+
+      // tiles missing from the MBTiles file are not requested
+      if ( localImage.isNull() && lookups.at( i ).isMBTile )
+        continue;
+
+      if ( !localImage.isNull() )
       {
         double cr = viewExtent.width() / image->width();
         QRectF dst( ( r.rect.left() - viewExtent.xMinimum() ) / cr,
@@ -980,6 +1159,13 @@ QImage *QgsWmsProvider::draw( QgsRectangle const &viewExtent, int pixelWidth, in
       handler.downloadBlocking();
     }
 
+    // once the view is complete, get the tiles likely to be needed next
+    if ( !tempTm && !mSettings.mIsMBTiles && !( feedback && ( feedback->isPreviewOnly() || feedback->isCanceled() ) ) &&
+         QgsSettings().value( QStringLiteral( "qgis/defaultTilePrefetch" ), false ).toBool() )
+    {
+      prefetchTiles( tileMode, tm, viewExtent, col0, row0, col1, row1 );
+    }
+
     QgsDebugMsgLevel( QStringLiteral( "TILE CACHE total: %1 / %2" ).arg( QgsTileCache::totalCost() ).arg( QgsTileCache::maxCost() ), 3 );
 
 #if 0
@@ -4236,6 +4422,7 @@ void QgsWmsTiledImageDownloadHandler::downloadBlocking()
   mEventLoop->exec( QEventLoop::ExcludeUserInputEvents );
 
   Q_ASSERT( mReplies.isEmpty() );
+  Q_ASSERT( mDecodes.isEmpty() );
 }
 
 
@@ -4262,28 +4449,7 @@ void QgsWmsTiledImageDownloadHandler::tileReplyFinished()
   }
 #endif
 
-  if ( QgsNetworkAccessManager::instance()->cache() )
-  {
-    QNetworkCacheMetaData cmd = QgsNetworkAccessManager::instance()->cache()->metaData( reply->request().url() );
-
-    QNetworkCacheMetaData::RawHeaderList hl;
-    const auto constRawHeaders = cmd.rawHeaders();
-    for ( const QNetworkCacheMetaData::RawHeader &h : constRawHeaders )
-    {
-      if ( h.first != "Cache-Control" )
-        hl.append( h );
-    }
-    cmd.setRawHeaders( hl );
-
-    QgsDebugMsgLevel( QStringLiteral( "expirationDate:%1" ).arg( cmd.expirationDate().toString() ), 4 );
-    if ( cmd.expirationDate().isNull() )
-    {
-      QgsSettings s;
-      cmd.setExpirationDate( QDateTime::currentDateTime().addSecs( s.value( QStringLiteral( "qgis/defaultTileExpiry" ), "24" ).toInt() * 60 * 60 ) );
-    }
-
-    QgsNetworkAccessManager::instance()->cache()->updateMetaData( cmd );
-  }
+  _updateTileCacheExpiry( reply->request().url() );
 
   int tileReqNo = reply->request().attribute( static_cast<QNetworkRequest::Attribute>( TileReqNo ) ).toInt();
   int tileNo = reply->request().attribute( static_cast<QNetworkRequest::Attribute>( TileIndex ) ).toInt();
@@ -4338,7 +4504,7 @@ void QgsWmsTiledImageDownloadHandler::tileReplyFinished()
       mReplies.removeOne( reply );
       reply->deleteLater();
 
-      if ( mReplies.isEmpty() )
+      if ( mReplies.isEmpty() && mDecodes.isEmpty() )
         finish();
 
       return;
@@ -4377,7 +4543,7 @@ void QgsWmsTiledImageDownloadHandler::tileReplyFinished()
       mReplies.removeOne( reply );
       reply->deleteLater();
 
-      if ( mReplies.isEmpty() )
+      if ( mReplies.isEmpty() && mDecodes.isEmpty() )
         finish();
 
       return;
@@ -4395,37 +4561,22 @@ void QgsWmsTiledImageDownloadHandler::tileReplyFinished()
 
       QgsDebugMsgLevel( QStringLiteral( "tile reply: length %1" ).arg( reply->bytesAvailable() ), 2 );
 
-      QImage myLocalImage = QImage::fromData( reply->readAll() );
-
-      if ( !myLocalImage.isNull() )
+      // decode the tile on the thread pool while other replies arrive, and draw it once decoded
+      const QByteArray data = reply->readAll();
+      const QUrl url = reply->url();
+      QFutureWatcher< QImage > *decode = new QFutureWatcher< QImage >( this );
+      connect( decode, &QFutureWatcher< QImage >::finished, this, [ = ]
       {
-        QPainter p( mImage );
-        // if image size is "close enough" to destination size, don't smooth it out. Instead try for pixel-perfect placement!
-        const bool disableSmoothing = ( qgsDoubleNear( dst.width(), myLocalImage.width(), 2 ) && qgsDoubleNear( dst.height(), myLocalImage.height(), 2 ) );
-        if ( !disableSmoothing && mSmoothPixmapTransform )
-          p.setRenderHint( QPainter::SmoothPixmapTransform, true );
-        p.drawImage( dst, myLocalImage );
-        p.end();
-#if 0
-        myLocalImage.save( QString( "%1/%2-tile-%3.png" ).arg( QDir::tempPath() ).arg( mTileReqNo ).arg( tileNo ) );
-        p.drawRect( dst ); // show tile bounds
-        p.drawText( dst, Qt::AlignCenter, QString( "(%1)\n%2,%3\n%4,%5\n%6x%7" )
-                    .arg( tileNo )
-                    .arg( r.left() ).arg( r.bottom() )
-                    .arg( r.right() ).arg( r.top() )
-                    .arg( r.width() ).arg( r.height() ) );
-#endif
+        mDecodes.removeOne( decode );
+        decode->deleteLater();
 
-        QgsTileCache::insertTile( reply->url(), myLocalImage );
+        drawTile( decode->result(), dst, url, contentType );
 
-        if ( mFeedback )
-          mFeedback->onNewData();
-      }
-      else
-      {
-        QgsMessageLog::logMessage( tr( "Returned image is flawed [Content-Type: %1; URL: %2]" )
-                                   .arg( contentType, reply->url().toString() ), tr( "WMS" ) );
-      }
+        if ( mReplies.isEmpty() && mDecodes.isEmpty() )
+          finish();
+      } );
+      mDecodes << decode;
+      decode->setFuture( QtConcurrent::run( [data] { return QImage::fromData( data ); } ) );
     }
     else
     {
@@ -4435,7 +4586,7 @@ void QgsWmsTiledImageDownloadHandler::tileReplyFinished()
     mReplies.removeOne( reply );
     reply->deleteLater();
 
-    if ( mReplies.isEmpty() )
+    if ( mReplies.isEmpty() && mDecodes.isEmpty() )
       finish();
 
   }
@@ -4458,7 +4609,7 @@ void QgsWmsTiledImageDownloadHandler::tileReplyFinished()
     mReplies.removeOne( reply );
     reply->deleteLater();
 
-    if ( mReplies.isEmpty() )
+    if ( mReplies.isEmpty() && mDecodes.isEmpty() )
       finish();
   }
 
@@ -4472,6 +4623,29 @@ void QgsWmsTiledImageDownloadHandler::tileReplyFinished()
 #endif
 }
 
+void QgsWmsTiledImageDownloadHandler::drawTile( const QImage &image, const QRectF &dst, const QUrl &url, const QString &contentType )
+{
+  if ( image.isNull() )
+  {
+    QgsMessageLog::logMessage( tr( "Returned image is flawed [Content-Type: %1; URL: %2]" )
+                               .arg( contentType, url.toString() ), tr( "WMS" ) );
+    return;
+  }
+
+  QPainter p( mImage );
+  // if image size is "close enough" to destination size, don't smooth it out. Instead try for pixel-perfect placement!
+  const bool disableSmoothing = ( qgsDoubleNear( dst.width(), image.width(), 2 ) && qgsDoubleNear( dst.height(), image.height(), 2 ) );
+  if ( !disableSmoothing && mSmoothPixmapTransform )
+    p.setRenderHint( QPainter::SmoothPixmapTransform, true );
+  p.drawImage( dst, image );
+  p.end();
+
+  QgsTileCache::insertTile( url, image );
+
+  if ( mFeedback )
+    mFeedback->onNewData();
+}
+
 void QgsWmsTiledImageDownloadHandler::canceled()
 {
   QgsDebugMsgLevel( QStringLiteral( "Caught canceled() signal" ), 3 );
@@ -33,6 +33,7 @@
 #include <QMap>
 #include <QVector>
 #include <QUrl>
+#include <QFutureWatcher>
 
 class QgsCoordinateTransform;
 class QgsNetworkAccessManager;
@@ -361,6 +362,33 @@ class QgsWmsProvider final: public QgsRasterDataProvider
       QImage img;  //!< Cached tile to be drawn
       bool smooth; //!< Whether to use antialiasing/smooth transforms when rendering tile
     } TileImage;
+    //! Helper structure to decode tiles which are not in the in-memory tile cache
+    struct TileLookup
+    {
+      QImage image;  //!< Cached or decoded tile
+      QByteArray data;  //!< Encoded tile read from the disk cache or from the MBTiles file
+      QUrl cacheUrl;  //!< Key of the tile in the tile cache
+      bool isMBTile = false;  //!< Whether the data were read from the MBTiles file
+    };
+
+    /**
+     * Decodes the data of the \a lookups at the given \a indices concurrently and
+     * stores the decoded tiles in the tile cache.
+     */
+    static void decodeTiles( QVector<TileLookup> &lookups, const QVector<int> &indices );
+
+    /**
+     * Requests the ring of tiles around the tiles from \a col0, \a row0 to \a col1, \a row1 of
+     * the tile matrix \a tm and the tiles of the next zoom level covering \a viewExtent, so that
+     * they are in the local disk cache when the view is panned or zoomed in.
+     *
+     * The requests run in the background on the main thread.
+     */
+    void prefetchTiles( QgsTileMode tileMode, const QgsWmtsTileMatrix *tm, const QgsRectangle &viewExtent, int col0, int row0, int col1, int row1 );
+
+    //! Returns the limits of the tile matrix \a tm in the current tile layer, if any
+    const QgsWmtsTileMatrixLimits *tileMatrixLimits( const QgsWmtsTileMatrix *tm ) const;
+
     //! Gets tiles from a different resolution to cover the missing areas
     void fetchOtherResTiles( QgsTileMode tileMode, const QgsRectangle &viewExtent, int imageWidth, QList<QRectF> &missing, double tres, int resOffset, QList<TileImage> &otherResTiles );
 
@@ -554,6 +582,9 @@ class QgsWmsTiledImageDownloadHandler : public QObject
 
     void finish() { QMetaObject::invokeMethod( mEventLoop, "quit", Qt::QueuedConnection ); }
 
+    //! Draws a decoded tile \a image to the \a dst rectangle of the image and stores it in the tile cache
+    void drawTile( const QImage &image, const QRectF &dst, const QUrl &url, const QString &contentType );
+
     QString mProviderUri;
 
     QgsWmsAuthorization mAuth;
@@ -569,6 +600,9 @@ class QgsWmsTiledImageDownloadHandler : public QObject
     //! Running tile requests
     QList<QNetworkReply *> mReplies;
 
+    //! Tiles being decoded
+    QList<QFutureWatcher<QImage> *> mDecodes;
+
     QgsRasterBlockFeedback *mFeedback = nullptr;
 };
 
@@ -23,12 +23,19 @@
 #include "qgsfcgiserverrequest.h"
 #include "qgsapplication.h"
 #include "qgscommandlineutils.h"
+#include "qgsconfigcache.h"
+#include "qgsserversettings.h"
+#include "qgsserverplugins.h"
 
 #include <fcgi_stdio.h>
 #include <cstdlib>
+#include <memory>
+#include <vector>
 
 #include <QFontDatabase>
+#include <QMutex>
 #include <QString>
+#include <QThread>
 
 int fcgi_accept()
 {
@@ -42,6 +49,75 @@ int fcgi_accept()
 #endif
 }
 
+/**
+ * Accepts and handles FastCGI requests in its own thread, several workers handle
+ * requests concurrently when QGIS_SERVER_PARALLEL_REQUESTS is greater than 1.
+ */
+class FcgiRequestWorkerThread : public QThread
+{
+  public:
+
+    explicit FcgiRequestWorkerThread( QgsServer &server )
+      : mServer( server )
+    {
+    }
+
+  protected:
+
+    void run() override
+    {
+      // Only one worker waits on the listening socket at a time
+      static QMutex sAcceptMutex;
+
+      FCGX_Request fcgxRequest;
+      FCGX_InitRequest( &fcgxRequest, 0, 0 );
+
+      while ( true )
+      {
+        int accepted = 0;
+        {
+          QMutexLocker acceptLocker( &sAcceptMutex );
+          accepted = FCGX_Accept_r( &fcgxRequest );
+        }
+        if ( accepted < 0 )
+          break;
+
+        handleRequest( &fcgxRequest );
+        FCGX_Finish_r( &fcgxRequest );
+      }
+
+      // The listening socket is closed, stop the server
+      QMetaObject::invokeMethod( qApp, "quit", Qt::QueuedConnection );
+    }
+
+  private:
+
+    void handleRequest( FCGX_Request *fcgxRequest )
+    {
+      QgsFcgiServerRequest request( fcgxRequest );
+      QgsFcgiServerResponse response( fcgxRequest, request.method() );
+      if ( request.hasError() )
+      {
+        response.sendError( 400, "Bad request" );
+        return;
+      }
+
+      // The parameters of the request are not in the process environment, so the project
+      // file set by a rewrite rule is resolved here rather than by the server
+      const QgsServerSettings *settings = mServer.serverInterface()->serverSettings();
+      const QgsProject *project = nullptr;
+      const QString projectFile = request.environmentVariable( QStringLiteral( "QGIS_PROJECT_FILE" ) );
+      if ( !projectFile.isEmpty() && settings->projectFile().isEmpty() && request.serverParameters().map().isEmpty() )
+      {
+        project = QgsConfigCache::instance()->project( projectFile, settings );
+      }
+
+      mServer.handleRequest( request, response, project );
+    }
+
+    QgsServer &mServer;
+};
+
 int main( int argc, char *argv[] )
 {
   if ( argc >= 2 )
@@ -76,6 +152,7 @@ int main( int argc, char *argv[] )
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
   server.initPython();
 #endif
+  server.preloadProjects();
 
 #ifdef Q_OS_WIN
   // Initialize font database before fcgi_accept.
@@ -83,6 +160,33 @@ int main( int argc, char *argv[] )
   QFontDatabase fontDB;
 #endif
 
+  // Requests are accepted by a pool of worker threads, unless Python plugins are loaded,
+  // as they expect the parameters of the request in the process environment
+  const int parallelRequests = server.serverInterface()->serverSettings()->parallelRequests();
+  if ( parallelRequests > 1 && !FCGX_IsCGI() && QgsServerPlugins::serverPlugins().isEmpty() )
+  {
+    QgsMessageLog::logMessage( QStringLiteral( "Handling up to %1 requests concurrently" ).arg( parallelRequests ), QStringLiteral( "Server" ), Qgis::MessageLevel::Info );
+
+    FCGX_Init();
+    std::vector< std::unique_ptr< FcgiRequestWorkerThread > > requestWorkerThreads;
+    for ( int i = 0; i < parallelRequests; ++i )
+    {
+      requestWorkerThreads.emplace_back( std::make_unique< FcgiRequestWorkerThread >( server ) );
+      requestWorkerThreads.back()->start();
+    }
+
+    // The main thread runs the event loop, e.g. for the file watcher of the project cache
+    app.exec();
+
+    FCGX_ShutdownPending();
+    for ( const std::unique_ptr< FcgiRequestWorkerThread > &thread : requestWorkerThreads )
+    {
+      thread->wait();
+    }
+    app.exitQgis();
+    return 0;
+  }
+
   // Starts FCGI loop
   while ( fcgi_accept() >= 0 )
   {
@@ -24,10 +24,13 @@ while QGIS server internal logging is printed to stderr.
  *                                                                         *
  ***************************************************************************/
 
+#include <atomic>
 #include <thread>
 #include <string>
 #include <chrono>
 #include <condition_variable>
+#include <memory>
+#include <vector>
 
 //for CMAKE_INSTALL_PREFIX
 #include "qgscommandlineutils.h"
@@ -498,6 +501,65 @@ class QueueMonitorThread: public QThread
 
 };
 
+/**
+ * Handles the queued requests in its own thread, several workers handle requests
+ * concurrently when QGIS_SERVER_PARALLEL_REQUESTS is greater than 1.
+ */
+class RequestWorkerThread: public QThread
+{
+
+    Q_OBJECT
+
+  public:
+
+    RequestWorkerThread( QgsServer &server, TcpServerThread &tcpServerThread )
+      : mServer( server )
+      , mTcpServerThread( tcpServerThread )
+    {
+    }
+
+    void run( )
+    {
+      while ( mIsRunning )
+      {
+        RequestContext *requestContext = nullptr;
+        {
+          std::unique_lock<std::mutex> requestLocker( REQUEST_QUEUE_MUTEX );
+          REQUEST_WAIT_CONDITION.wait( requestLocker, [ = ] { return ! mIsRunning || ! REQUEST_QUEUE.isEmpty(); } );
+          if ( ! mIsRunning )
+            break;
+          requestContext = REQUEST_QUEUE.dequeue();
+        }
+
+        if ( requestContext->clientConnection && requestContext->clientConnection->isValid() )
+        {
+          mServer.handleRequest( requestContext->request, requestContext->response );
+          if ( requestContext->clientConnection && requestContext->clientConnection->isValid() )
+          {
+            mTcpServerThread.emitResponseReady( requestContext );  //#spellok
+            continue;
+          }
+        }
+        delete requestContext;
+      }
+    }
+
+  public slots:
+
+    void stop()
+    {
+      std::lock_guard<std::mutex> requestLocker( REQUEST_QUEUE_MUTEX );
+      mIsRunning = false;
+    }
+
+  private:
+
+    QgsServer &mServer;
+    TcpServerThread &mTcpServerThread;
+    std::atomic<bool> mIsRunning { true };
+
+};
+
 int main( int argc, char *argv[] )
 {
   // Test if the environ variable DISPLAY is defined
@@ -622,6 +684,7 @@ int main( int argc, char *argv[] )
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
   server.initPython();
 #endif
+  server.preloadProjects();
 
   // TCP thread
   TcpServerThread tcpServerThread{ ipAddress, serverPort.toInt() };
@@ -633,6 +696,18 @@ int main( int argc, char *argv[] )
     qApp->quit();
   }, Qt::QueuedConnection );
 
+  // Requests are handled by the main thread, or by a pool of worker threads
+  const int parallelRequests { server.serverInterface()->serverSettings()->parallelRequests() };
+  std::vector< std::unique_ptr< RequestWorkerThread > > requestWorkerThreads;
+  if ( parallelRequests > 1 )
+  {
+    std::cout << QObject::tr( "Handling up to %1 requests concurrently" ).arg( parallelRequests ).toStdString() << std::endl;
+    for ( int i = 0; i < parallelRequests; ++i )
+    {
+      requestWorkerThreads.emplace_back( std::make_unique< RequestWorkerThread >( server, tcpServerThread ) );
+    }
+  }
+
   // Monitoring thread
   QueueMonitorThread queueMonitorThread;
   queueMonitorThread.connect( &queueMonitorThread, &QueueMonitorThread::requestReady, qApp, [ & ]( RequestContext * requestContext )
@@ -675,15 +750,27 @@ int main( int argc, char *argv[] )
 #endif
 
   tcpServerThread.start();
-  queueMonitorThread.start();
+  if ( requestWorkerThreads.empty() )
+  {
+    queueMonitorThread.start();
+  }
+  else
+  {
+    for ( const auto &requestWorkerThread : requestWorkerThreads )
+      requestWorkerThread->start();
+  }
 
   app.exec();
   // Wait for threads
   tcpServerThread.exit();
   tcpServerThread.wait();
   queueMonitorThread.stop();
+  for ( const auto &requestWorkerThread : requestWorkerThreads )
+    requestWorkerThread->stop();
   REQUEST_WAIT_CONDITION.notify_all();
   queueMonitorThread.wait();
+  for ( const auto &requestWorkerThread : requestWorkerThreads )
+    requestWorkerThread->wait();
   app.exitQgis();
 
   return isTcpError ? 1 : 0;
@@ -19,6 +19,7 @@
 
 #include <QCoreApplication>
 #include <QFileInfo>
+#include <QThread>
 
 #if defined(Q_OS_LINUX)
 #include <sys/vfs.h>
@@ -38,8 +39,10 @@ QgsCapabilitiesCache::QgsCapabilitiesCache()
 
 const QDomDocument *QgsCapabilitiesCache::searchCapabilitiesDocument( const QString &configFilePath, const QString &key )
 {
-  QCoreApplication::processEvents(); //get updates from file system watcher
+  if ( QThread::currentThread() == thread() )
+    QCoreApplication::processEvents(); //get updates from file system watcher
 
+  QMutexLocker locker( &mMutex );
   if ( mCachedCapabilities.contains( configFilePath ) && mCachedCapabilities[ configFilePath ].contains( key ) )
   {
     return &mCachedCapabilities[ configFilePath ][ key ];
@@ -50,8 +53,29 @@ const QDomDocument *QgsCapabilitiesCache::searchCapabilitiesDocument( const QStr
   }
 }
 
+QDomDocument QgsCapabilitiesCache::capabilitiesDocument( const QString &configFilePath, const QString &key )
+{
+  if ( QThread::currentThread() == thread() )
+    QCoreApplication::processEvents(); //get updates from file system watcher
+
+  QMutexLocker locker( &mMutex );
+  return mCachedCapabilities.value( configFilePath ).value( key );
+}
+
 void QgsCapabilitiesCache::insertCapabilitiesDocument( const QString &configFilePath, const QString &key, const QDomDocument *doc )
 {
+  // the file system watcher and the timer belong to the thread of the cache
+  if ( QThread::currentThread() != thread() )
+  {
+    const QDomDocument docCopy = doc->cloneNode().toDocument();
+    QMetaObject::invokeMethod( this, [ = ]
+    {
+      insertCapabilitiesDocument( configFilePath, key, &docCopy );
+    } );
+    return;
+  }
+
+  QMutexLocker locker( &mMutex );
   if ( mCachedCapabilities.size() > 40 )
   {
     //remove another cache entry to avoid memory problems
@@ -85,6 +109,16 @@ void QgsCapabilitiesCache::insertCapabilitiesDocument( const QString &configFile
 
 void QgsCapabilitiesCache::removeCapabilitiesDocument( const QString &path )
 {
+  if ( QThread::currentThread() != thread() )
+  {
+    QMetaObject::invokeMethod( this, [ = ]
+    {
+      removeCapabilitiesDocument( path );
+    } );
+    return;
+  }
+
+  QMutexLocker locker( &mMutex );
   mCachedCapabilities.remove( path );
   mCachedCapabilitiesTimestamps.remove( path );
   mFileSystemWatcher.removePath( path );
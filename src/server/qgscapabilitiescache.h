@@ -21,6 +21,7 @@
 #include <QDomDocument>
 #include <QFileSystemWatcher>
 #include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QDateTime>
 #include <QTimer>
@@ -44,6 +45,19 @@ class SERVER_EXPORT QgsCapabilitiesCache : public QObject
      */
     const QDomDocument *searchCapabilitiesDocument( const QString &configFilePath, const QString &key );
 
+    /**
+     * Returns a copy of the cached capabilities document, or a null document if the document
+     * for the configuration file is not in cache.
+     *
+     * Unlike searchCapabilitiesDocument(), the returned document stays valid if the entry is
+     * removed from the cache, so this method can be used by requests handled concurrently.
+     *
+     * \param configFilePath the project file path
+     * \param key key used to separate different version in different cache
+     * \since QGIS 3.22
+     */
+    QDomDocument capabilitiesDocument( const QString &configFilePath, const QString &key );
+
     /**
      * Inserts new capabilities document (creates a copy of the document, does not take ownership)
      * \param configFilePath the project file path
@@ -64,6 +78,8 @@ class SERVER_EXPORT QgsCapabilitiesCache : public QObject
     QHash< QString, QDateTime> mCachedCapabilitiesTimestamps;
     QFileSystemWatcher mFileSystemWatcher;
     QTimer mTimer;
+    //! Guards the cached documents, which may be used from several request threads
+    QMutex mMutex;
 
   private slots:
     //! Removes changed entry from this cache
@@ -22,6 +22,8 @@
 #include "qgsserverprojectutils.h"
 
 #include <QFile>
+#include <QThread>
+#include <QtConcurrentRun>
 
 QgsConfigCache *QgsConfigCache::instance()
 {
@@ -41,83 +43,187 @@ QgsConfigCache::QgsConfigCache()
 
 const QgsProject *QgsConfigCache::project( const QString &path, const QgsServerSettings *settings )
 {
+  if ( QThread::currentThread() != thread() )
+    return threadProject( path, settings );
+
   if ( ! mProjectCache[ path ] )
   {
+    std::unique_ptr<QgsProject> prj = readProject( path, settings );
+    if ( prj )
+    {
+      mProjectCache.insert( path, prj.release() );
+      mFileSystemWatcher.addPath( path );
+    }
+  }
+  return mProjectCache[ path ];
+}
+
+QStringList QgsConfigCache::preloadProjects( const QStringList &paths, const QgsServerSettings *settings )
+{
+  QStringList preloadedPaths;
+  for ( const QString &path : paths )
+  {
+    const QgsProject *prj = nullptr;
+    try
+    {
+      prj = project( path, settings );
+    }
+    catch ( QgsServerException & )
+    {
+      // bad layers, the error is reported again by the first request for the project
+    }
+
+    if ( !prj )
+      continue;
+
+    const QList< QgsProject * > spareProjects = readSpareProjects( path, settings );
+    {
+      QMutexLocker locker( &mProjectGenerationsMutex );
+      qDeleteAll( mSpareProjects.value( path ) );
+      mSpareProjects.insert( path, spareProjects );
+    }
+
+    mPreloadedProjects.insert( path, settings ? std::make_shared< QgsServerSettings >( *settings ) : nullptr );
+    preloadedPaths << path;
+    QgsMessageLog::logMessage( QStringLiteral( "Preloaded project '%1'" ).arg( path ), QStringLiteral( "Server" ), Qgis::MessageLevel::Info );
+  }
+  return preloadedPaths;
+}
+
+const QgsProject *QgsConfigCache::threadProject( const QString &path, const QgsServerSettings *settings )
+{
+  if ( !mThreadProjects.hasLocalData() )
+    mThreadProjects.setLocalData( new ThreadProjects() );
+  ThreadProjects *threadProjects = mThreadProjects.localData();
+
+  int generation = 0;
+  {
+    QMutexLocker locker( &mProjectGenerationsMutex );
+    generation = mProjectGenerations.value( path );
+  }
+
+  QgsProject *prj = threadProjects->projects.value( path );
+  if ( prj && threadProjects->generations.value( path ) == generation )
+    return prj;
+
+  delete threadProjects->projects.take( path );
+  threadProjects->generations.remove( path );
+
+  // the file changed, a copy of the current version read in advance is taken
+  // if there is one left, otherwise the project is read again in this thread
+  std::unique_ptr<QgsProject> newPrj;
+  {
+    QMutexLocker locker( &mProjectGenerationsMutex );
+    generation = mProjectGenerations.value( path );
+    auto spareProjects = mSpareProjects.find( path );
+    if ( spareProjects != mSpareProjects.end() && !spareProjects->isEmpty() )
+      newPrj.reset( spareProjects->takeLast() );
+  }
 
-    std::unique_ptr<QgsProject> prj( new QgsProject() );
+  if ( newPrj )
+    newPrj->moveToThread( QThread::currentThread() );
+  else
+    newPrj = readProject( path, settings );
 
-    // This is required by virtual layers that call QgsProject::instance() inside the constructor :(
-    QgsProject::setInstance( prj.get() );
+  if ( !newPrj )
+    return nullptr;
+
+  prj = newPrj.release();
+  threadProjects->projects.insert( path, prj );
+  threadProjects->generations.insert( path, generation );
+  watchPath( path );
+  return prj;
+}
 
-    QgsStoreBadLayerInfo *badLayerHandler = new QgsStoreBadLayerInfo();
-    prj->setBadLayerHandler( badLayerHandler );
+std::unique_ptr<QgsProject> QgsConfigCache::readProject( const QString &path, const QgsServerSettings *settings )
+{
+  std::unique_ptr<QgsProject> prj( new QgsProject() );
 
-    // Always skip original styles storage
-    QgsProject::ReadFlags readFlags = QgsProject::ReadFlag() | QgsProject::ReadFlag::FlagDontStoreOriginalStyles ;
-    if ( settings )
+  // This is required by virtual layers that call QgsProject::instance() inside the constructor :(
+  // Only the project instance of the calling thread is changed, as projects may also be read
+  // in the background or while a request is using the project instance
+  QgsProject *previousThreadInstance = QgsProject::threadInstance();
+  QgsProject::setThreadInstance( prj.get() );
+
+  QgsStoreBadLayerInfo *badLayerHandler = new QgsStoreBadLayerInfo();
+  prj->setBadLayerHandler( badLayerHandler );
+
+  // Always skip original styles storage, and create the layer providers concurrently
+  QgsProject::ReadFlags readFlags = QgsProject::ReadFlag() | QgsProject::ReadFlag::FlagDontStoreOriginalStyles | QgsProject::ReadFlag::FlagLoadLayersInParallel;
+  if ( settings )
+  {
+    // Activate trust layer metadata flag
+    if ( settings->trustLayerMetadata() )
     {
-      // Activate trust layer metadata flag
-      if ( settings->trustLayerMetadata() )
-      {
-        readFlags |= QgsProject::ReadFlag::FlagTrustLayerMetadata;
-      }
-      // Activate don't load layouts flag
-      if ( settings->getPrintDisabled() )
-      {
-        readFlags |= QgsProject::ReadFlag::FlagDontLoadLayouts;
-      }
+      readFlags |= QgsProject::ReadFlag::FlagTrustLayerMetadata;
+    }
+    // Activate don't load layouts flag
+    if ( settings->getPrintDisabled() )
+    {
+      readFlags |= QgsProject::ReadFlag::FlagDontLoadLayouts;
     }
+  }
+
+  const bool readOk = prj->read( path, readFlags );
+
+  QgsProject::setThreadInstance( previousThreadInstance );
 
-    if ( prj->read( path, readFlags ) )
+  if ( !readOk )
+  {
+    QgsMessageLog::logMessage(
+      QStringLiteral( "Error when loading project file '%1': %2 " ).arg( path, prj->error() ),
+      QStringLiteral( "Server" ), Qgis::MessageLevel::Critical );
+    return nullptr;
+  }
+
+  if ( !badLayerHandler->badLayers().isEmpty() )
+  {
+    // if bad layers are not restricted layers so service failed
+    QStringList unrestrictedBadLayers;
+    // test bad layers through restrictedlayers
+    const QStringList badLayerIds = badLayerHandler->badLayers();
+    const QMap<QString, QString> badLayerNames = badLayerHandler->badLayerNames();
+    const QStringList resctrictedLayers = QgsServerProjectUtils::wmsRestrictedLayers( *prj );
+    for ( const QString &badLayerId : badLayerIds )
     {
-      if ( !badLayerHandler->badLayers().isEmpty() )
+      // if this bad layer is in restricted layers
+      // it doesn't need to be added to unrestricted bad layers
+      if ( badLayerNames.contains( badLayerId ) &&
+           resctrictedLayers.contains( badLayerNames.value( badLayerId ) ) )
       {
-        // if bad layers are not restricted layers so service failed
-        QStringList unrestrictedBadLayers;
-        // test bad layers through restrictedlayers
-        const QStringList badLayerIds = badLayerHandler->badLayers();
-        const QMap<QString, QString> badLayerNames = badLayerHandler->badLayerNames();
-        const QStringList resctrictedLayers = QgsServerProjectUtils::wmsRestrictedLayers( *prj );
-        for ( const QString &badLayerId : badLayerIds )
-        {
-          // if this bad layer is in restricted layers
-          // it doesn't need to be added to unrestricted bad layers
-          if ( badLayerNames.contains( badLayerId ) &&
-               resctrictedLayers.contains( badLayerNames.value( badLayerId ) ) )
-          {
-            continue;
-          }
-          unrestrictedBadLayers.append( badLayerId );
-        }
-        if ( !unrestrictedBadLayers.isEmpty() )
-        {
-          // This is a critical error unless QGIS_SERVER_IGNORE_BAD_LAYERS is set to TRUE
-          if ( ! settings || ! settings->ignoreBadLayers() )
-          {
-            QgsMessageLog::logMessage(
-              QStringLiteral( "Error, Layer(s) %1 not valid in project %2" ).arg( unrestrictedBadLayers.join( QLatin1String( ", " ) ), path ),
-              QStringLiteral( "Server" ), Qgis::MessageLevel::Critical );
-            throw QgsServerException( QStringLiteral( "Layer(s) not valid" ) );
-          }
-          else
-          {
-            QgsMessageLog::logMessage(
-              QStringLiteral( "Warning, Layer(s) %1 not valid in project %2" ).arg( unrestrictedBadLayers.join( QLatin1String( ", " ) ), path ),
-              QStringLiteral( "Server" ), Qgis::MessageLevel::Warning );
-          }
-        }
+        continue;
       }
-      mProjectCache.insert( path, prj.release() );
-      mFileSystemWatcher.addPath( path );
+      unrestrictedBadLayers.append( badLayerId );
     }
-    else
+    if ( !unrestrictedBadLayers.isEmpty() )
     {
-      QgsMessageLog::logMessage(
-        QStringLiteral( "Error when loading project file '%1': %2 " ).arg( path, prj->error() ),
-        QStringLiteral( "Server" ), Qgis::MessageLevel::Critical );
+      // This is a critical error unless QGIS_SERVER_IGNORE_BAD_LAYERS is set to TRUE
+      if ( ! settings || ! settings->ignoreBadLayers() )
+      {
+        QgsMessageLog::logMessage(
+          QStringLiteral( "Error, Layer(s) %1 not valid in project %2" ).arg( unrestrictedBadLayers.join( QLatin1String( ", " ) ), path ),
+          QStringLiteral( "Server" ), Qgis::MessageLevel::Critical );
+        throw QgsServerException( QStringLiteral( "Layer(s) not valid" ) );
+      }
+      else
+      {
+        QgsMessageLog::logMessage(
+          QStringLiteral( "Warning, Layer(s) %1 not valid in project %2" ).arg( unrestrictedBadLayers.join( QLatin1String( ", " ) ), path ),
+          QStringLiteral( "Server" ), Qgis::MessageLevel::Warning );
+      }
     }
   }
-  return mProjectCache[ path ];
+  return prj;
+}
+
+void QgsConfigCache::watchPath( const QString &path )
+{
+  // the file system watcher belongs to the thread of the cache
+  QMetaObject::invokeMethod( this, [ = ]
+  {
+    if ( !mFileSystemWatcher.files().contains( path ) )
+      mFileSystemWatcher.addPath( path );
+  } );
 }
 
 QDomDocument *QgsConfigCache::xmlDocument( const QString &filePath )
@@ -161,7 +267,23 @@ QDomDocument *QgsConfigCache::xmlDocument( const QString &filePath )
 
 void QgsConfigCache::removeChangedEntry( const QString &path )
 {
-  mProjectCache.remove( path );
+  // preloaded projects keep serving requests until the new version is read
+  if ( mPreloadedProjects.contains( path ) && mProjectCache.contains( path ) )
+  {
+    refreshProject( path );
+    return;
+  }
+
+  removeCachedEntry( path );
+}
+
+void QgsConfigCache::removeCachedEntry( const QString &path )
+{
+  increaseGeneration( path );
+
+  // the project may still be used by the request being handled
+  if ( QgsProject *project = mProjectCache.take( path ) )
+    releaseProject( project );
 
   //xml document must be removed last, as other config cache destructors may require it
   mXmlDocumentCache.remove( path );
@@ -169,8 +291,174 @@ void QgsConfigCache::removeChangedEntry( const QString &path )
   mFileSystemWatcher.removePath( path );
 }
 
+void QgsConfigCache::refreshProject( const QString &path )
+{
+  if ( mRefreshingProjects.contains( path ) )
+  {
+    // read the file again once the current read is done
+    mPendingRefreshes.insert( path );
+    return;
+  }
+  mRefreshingProjects.insert( path );
+
+  const std::shared_ptr< QgsServerSettings > settings = mPreloadedProjects.value( path );
+
+  // Layouts are not thread safe, projects are only read in the background without them
+  if ( !settings || !settings->getPrintDisabled() )
+  {
+    std::unique_ptr< QgsProject > prj;
+    try
+    {
+      prj = readProject( path, settings.get() );
+    }
+    catch ( QgsServerException & )
+    {
+      // bad layers, already logged
+    }
+    const QList< QgsProject * > spareProjects = prj ? readSpareProjects( path, settings.get() ) : QList< QgsProject * >();
+    replaceProject( path, prj.release(), spareProjects );
+    return;
+  }
+
+  QThread *cacheThread = thread();
+  QtConcurrent::run( [ = ]
+  {
+    std::unique_ptr< QgsProject > prj;
+    try
+    {
+      prj = readProject( path, settings.get() );
+    }
+    catch ( QgsServerException & )
+    {
+      // bad layers, already logged
+    }
+
+    // the copies of the worker threads are read here as well, so that they never read the new version themselves
+    const QList< QgsProject * > spareProjects = prj ? readSpareProjects( path, settings.get() ) : QList< QgsProject * >();
+
+    // the project is handed over to the thread of the cache
+    if ( prj )
+      prj->moveToThread( cacheThread );
+    QgsProject *newProject = prj.release();
+    QMetaObject::invokeMethod( this, [ = ]
+    {
+      replaceProject( path, newProject, spareProjects );
+    } );
+  } );
+}
+
+void QgsConfigCache::replaceProject( const QString &path, QgsProject *project, const QList< QgsProject * > &spareProjects )
+{
+  mRefreshingProjects.remove( path );
+
+  if ( project )
+  {
+    increaseGeneration( path, spareProjects );
+
+    // the previous project may still be used by the request being handled
+    if ( QgsProject *previousProject = mProjectCache.take( path ) )
+      releaseProject( previousProject );
+    mProjectCache.insert( path, project );
+    mXmlDocumentCache.remove( path );
+
+    // editors may replace the file, which is then no longer watched
+    if ( !mFileSystemWatcher.files().contains( path ) )
+      mFileSystemWatcher.addPath( path );
+
+    QgsMessageLog::logMessage( QStringLiteral( "Reloaded project '%1'" ).arg( path ), QStringLiteral( "Server" ), Qgis::MessageLevel::Info );
+  }
+  else
+  {
+    // the project cannot be read anymore, the next request reports the error
+    removeCachedEntry( path );
+  }
+
+  if ( mPendingRefreshes.remove( path ) && mProjectCache.contains( path ) )
+    refreshProject( path );
+}
+
+QList< QgsProject * > QgsConfigCache::readSpareProjects( const QString &path, const QgsServerSettings *settings )
+{
+  QList< QgsProject * > spareProjects;
+
+  // requests are only handled by worker threads when several requests are handled concurrently
+  const int workerThreads = settings ? settings->parallelRequests() : 1;
+  if ( workerThreads <= 1 )
+    return spareProjects;
+
+  for ( int i = 0; i < workerThreads; ++i )
+  {
+    std::unique_ptr< QgsProject > prj;
+    try
+    {
+      prj = readProject( path, settings );
+    }
+    catch ( QgsServerException & )
+    {
+      // bad layers, already logged
+    }
+    if ( !prj )
+      break;
+
+    // the worker thread taking the copy pulls it into its own thread
+    prj->moveToThread( nullptr );
+    spareProjects << prj.release();
+  }
+  return spareProjects;
+}
+
+void QgsConfigCache::increaseGeneration( const QString &path, const QList< QgsProject * > &spareProjects )
+{
+  QList< QgsProject * > previousSpareProjects;
+  {
+    QMutexLocker locker( &mProjectGenerationsMutex );
+    mProjectGenerations[ path ]++;
+    previousSpareProjects = mSpareProjects.take( path );
+    if ( !spareProjects.isEmpty() )
+      mSpareProjects.insert( path, spareProjects );
+  }
+  qDeleteAll( previousSpareProjects );
+}
+
+void QgsConfigCache::releaseProject( QgsProject *project )
+{
+  mReplacedProjects.emplace_back( project );
+
+  // deleted from the event loop of the thread of the cache, when the request in progress is done
+  QMetaObject::invokeMethod( this, &QgsConfigCache::deleteReplacedProjects, Qt::QueuedConnection );
+}
+
+void QgsConfigCache::requestStarted()
+{
+  mRequestsInProgress++;
+}
+
+void QgsConfigCache::requestFinished()
+{
+  mRequestsInProgress--;
+  deleteReplacedProjects();
+}
+
+void QgsConfigCache::deleteReplacedProjects()
+{
+  if ( mRequestsInProgress > 0 )
+    return;
+
+  mReplacedProjects.clear();
+}
 
 void QgsConfigCache::removeEntry( const QString &path )
 {
-  removeChangedEntry( path );
+  if ( QThread::currentThread() != thread() )
+  {
+    // the copy of the calling thread is discarded by its next request
+    increaseGeneration( path );
+    QMetaObject::invokeMethod( this, [ = ]
+    {
+      removeCachedEntry( path );
+    } );
+    return;
+  }
+
+  removeCachedEntry( path );
 }
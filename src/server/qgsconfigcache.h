@@ -22,8 +22,15 @@
 
 #include <QCache>
 #include <QFileSystemWatcher>
+#include <QHash>
+#include <QMutex>
 #include <QObject>
 #include <QDomDocument>
+#include <QSet>
+#include <QThreadStorage>
+
+#include <memory>
+#include <vector>
 
 #include "qgis_server.h"
 #include "qgis_sip.h"
@@ -58,6 +65,11 @@ class SERVER_EXPORT QgsConfigCache : public QObject
      * unless the server configuration variable QGIS_SERVER_IGNORE_BAD_LAYERS
      * passed in the optional settings argument is set to TRUE (the default
      * value is FALSE).
+     *
+     * Requests handled by other threads than the thread of the cache get their own
+     * copy of the project. Copies of preloaded projects are read in advance by the
+     * cache, other projects are read again in the requesting thread when the file changes.
+     *
      * \param path the filename of the QGIS project
      * \param settings QGIS server settings
      * \returns the project or NULLPTR if an error happened
@@ -65,9 +77,100 @@ class SERVER_EXPORT QgsConfigCache : public QObject
      */
     const QgsProject *project( const QString &path, const QgsServerSettings *settings = nullptr );
 
+    /**
+     * Reads the projects from \a paths and keeps them in the cache.
+     *
+     * When the file of a preloaded project changes, the cached project is replaced
+     * by the new version once it has been read. If GetPrint is disabled, the new version
+     * is read in the background while the cached one keeps serving requests. Otherwise
+     * it is read in the thread of the cache, as layouts cannot be read in other threads.
+     *
+     * When requests are handled by several worker threads, i.e. when QGIS_SERVER_PARALLEL_REQUESTS
+     * is greater than 1, a copy of each project is also read in advance for every worker thread,
+     * both when preloading and when the file changes.
+     *
+     * This method must be called from the thread of the cache.
+     *
+     * \param paths the filenames of the QGIS projects
+     * \param settings QGIS server settings
+     * \returns the filenames of the projects which could be read
+     * \since QGIS 3.22
+     */
+    QStringList preloadProjects( const QStringList &paths, const QgsServerSettings *settings = nullptr );
+
   private:
     QgsConfigCache() SIP_FORCE;
 
+    friend class QgsServer;
+
+    //! Reads the project from \a path, returns NULLPTR if an error happened
+    std::unique_ptr< QgsProject > readProject( const QString &path, const QgsServerSettings *settings );
+
+    //! Returns the copy of the project owned by the calling thread
+    const QgsProject *threadProject( const QString &path, const QgsServerSettings *settings );
+
+    //! Adds \a path to the file system watcher from the thread of the cache
+    void watchPath( const QString &path );
+
+    //! Removes the project, xml document and watched file for \a path
+    void removeCachedEntry( const QString &path );
+
+    //! Reads the preloaded project at \a path in the background, see replaceProject()
+    void refreshProject( const QString &path );
+
+    /**
+     * Replaces the cached project at \a path with \a project read by refreshProject(), or removes it
+     * if \a project is NULLPTR. The \a spareProjects are the copies of the new version for the worker threads.
+     */
+    void replaceProject( const QString &path, QgsProject *project, const QList< QgsProject * > &spareProjects );
+
+    //! Reads the copies of the project at \a path taken by the worker threads, they belong to no thread
+    QList< QgsProject * > readSpareProjects( const QString &path, const QgsServerSettings *settings );
+
+    //! Discards the copies of the project at \a path read by the threads and uses \a spareProjects for the new version
+    void increaseGeneration( const QString &path, const QList< QgsProject * > &spareProjects = QList< QgsProject * >() );
+
+    //! Moves \a project out of the cache, it is deleted once no request of the thread of the cache uses it
+    void releaseProject( QgsProject *project );
+
+    //! Called by the server when a request starts in the thread of the cache
+    void requestStarted();
+
+    //! Called by the server when a request is done in the thread of the cache
+    void requestFinished();
+
+    //! Deletes the projects which were replaced or removed from the cache, unless a request of the thread of the cache is in progress
+    void deleteReplacedProjects();
+
+    //! Projects replaced or removed from the cache, kept until the requests being handled are done
+    std::vector< std::unique_ptr< QgsProject > > mReplacedProjects;
+    //! Number of requests in progress in the thread of the cache, may be nested by event loops
+    int mRequestsInProgress = 0;
+
+    //! Settings used to read the preloaded projects, NULLPTR if no settings were given
+    QHash< QString, std::shared_ptr< QgsServerSettings > > mPreloadedProjects;
+    //! Preloaded projects being read in the background
+    QSet< QString > mRefreshingProjects;
+    //! Preloaded projects which changed again while being read in the background
+    QSet< QString > mPendingRefreshes;
+
+    //! Projects read by a request thread
+    struct ThreadProjects
+    {
+      ~ThreadProjects() { qDeleteAll( projects ); }
+      QHash< QString, QgsProject * > projects;
+      //! Generation of the file for which each project was read
+      QHash< QString, int > generations;
+    };
+    QThreadStorage< ThreadProjects * > mThreadProjects;
+
+    //! Incremented when a project file changes, so that copies read by request threads are discarded
+    QHash< QString, int > mProjectGenerations;
+    //! Copies of the current version of the preloaded projects, taken by the worker threads
+    QHash< QString, QList< QgsProject * > > mSpareProjects;
+    //! Protects mProjectGenerations and mSpareProjects
+    QMutex mProjectGenerationsMutex;
+
     //! Check for configuration file updates (remove entry from cache if file changes)
     QFileSystemWatcher mFileSystemWatcher;
 
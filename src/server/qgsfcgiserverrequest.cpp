@@ -24,14 +24,33 @@
 #include <fcgi_stdio.h>
 #include <QDebug>
 
+#include <algorithm>
+
 QgsFcgiServerRequest::QgsFcgiServerRequest()
+{
+  init();
+}
+
+QgsFcgiServerRequest::QgsFcgiServerRequest( FCGX_Request *request )
+  : mFcgxRequest( request )
+{
+  init();
+}
+
+QString QgsFcgiServerRequest::environmentVariable( const QString &name ) const
+{
+  const QByteArray variable = name.toLocal8Bit();
+  return QString( mFcgxRequest ? FCGX_GetParam( variable.constData(), mFcgxRequest->envp ) : getenv( variable.constData() ) );
+}
+
+void QgsFcgiServerRequest::init()
 {
   // Get the REQUEST_URI from the environment
-  QString uri = getenv( "REQUEST_URI" );
+  QString uri = environmentVariable( QStringLiteral( "REQUEST_URI" ) );
 
   if ( uri.isEmpty() )
   {
-    uri = getenv( "SCRIPT_NAME" );
+    uri = environmentVariable( QStringLiteral( "SCRIPT_NAME" ) );
   }
 
   QUrl url;
@@ -40,9 +59,9 @@ QgsFcgiServerRequest::QgsFcgiServerRequest()
   // Store the URL before the server rewrite that could have been set in QUERY_STRING
   setOriginalUrl( url );
 
-  const QString qs = getenv( "QUERY_STRING" );
+  const QString qs = environmentVariable( QStringLiteral( "QUERY_STRING" ) );
   const QString questionMark = qs.isEmpty() ? QString() : QChar( '?' );
-  const QString extraPath = QStringLiteral( "%1%2%3" ).arg( getenv( "PATH_INFO" ) ).arg( questionMark ).arg( qs );
+  const QString extraPath = QStringLiteral( "%1%2%3" ).arg( environmentVariable( QStringLiteral( "PATH_INFO" ) ) ).arg( questionMark ).arg( qs );
 
   QUrl baseUrl;
   if ( uri.endsWith( extraPath ) )
@@ -71,27 +90,27 @@ QgsFcgiServerRequest::QgsFcgiServerRequest()
   QgsServerRequest::Method method = GetMethod;
 
   // Get method
-  const char *me = getenv( "REQUEST_METHOD" );
+  const QString me = environmentVariable( QStringLiteral( "REQUEST_METHOD" ) );
 
-  if ( me )
+  if ( !me.isEmpty() )
   {
-    if ( strcmp( me, "POST" ) == 0 )
+    if ( me == QLatin1String( "POST" ) )
     {
       method = PostMethod;
     }
-    else if ( strcmp( me, "PUT" ) == 0 )
+    else if ( me == QLatin1String( "PUT" ) )
     {
       method = PutMethod;
     }
-    else if ( strcmp( me, "DELETE" ) == 0 )
+    else if ( me == QLatin1String( "DELETE" ) )
     {
       method = DeleteMethod;
     }
-    else if ( strcmp( me, "HEAD" ) == 0 )
+    else if ( me == QLatin1String( "HEAD" ) )
     {
       method = HeadMethod;
     }
-    else if ( strcmp( me, "PATCH" ) == 0 )
+    else if ( me == QLatin1String( "PATCH" ) )
     {
       method = PatchMethod;
     }
@@ -107,8 +126,8 @@ QgsFcgiServerRequest::QgsFcgiServerRequest()
   setMethod( method );
 
   // Get accept header for content-type negotiation
-  const char *accept = getenv( "HTTP_ACCEPT" );
-  if ( accept )
+  const QString accept = environmentVariable( QStringLiteral( "HTTP_ACCEPT" ) );
+  if ( !accept.isEmpty() )
   {
     setHeader( QStringLiteral( "Accept" ), accept );
   }
@@ -126,13 +145,13 @@ void QgsFcgiServerRequest::fillUrl( QUrl &url ) const
   // Check if host is defined
   if ( url.host().isEmpty() )
   {
-    url.setHost( getenv( "SERVER_NAME" ) );
+    url.setHost( environmentVariable( QStringLiteral( "SERVER_NAME" ) ) );
   }
 
   // Port ?
   if ( url.port( -1 ) == -1 )
   {
-    const QString portString = getenv( "SERVER_PORT" );
+    const QString portString = environmentVariable( QStringLiteral( "SERVER_PORT" ) );
     if ( !portString.isEmpty() )
     {
       bool portOk;
@@ -147,7 +166,7 @@ void QgsFcgiServerRequest::fillUrl( QUrl &url ) const
   // scheme
   if ( url.scheme().isEmpty() )
   {
-    QString( getenv( "HTTPS" ) ).compare( QLatin1String( "on" ), Qt::CaseInsensitive ) == 0
+    environmentVariable( QStringLiteral( "HTTPS" ) ).compare( QLatin1String( "on" ), Qt::CaseInsensitive ) == 0
     ? url.setScheme( QStringLiteral( "https" ) )
     : url.setScheme( QStringLiteral( "http" ) );
   }
@@ -162,17 +181,17 @@ QByteArray QgsFcgiServerRequest::data() const
 void QgsFcgiServerRequest::readData()
 {
   // Check if we have CONTENT_LENGTH defined
-  const char *lengthstr = getenv( "CONTENT_LENGTH" );
-  if ( lengthstr )
+  const QString lengthstr = environmentVariable( QStringLiteral( "CONTENT_LENGTH" ) );
+  if ( !lengthstr.isEmpty() )
   {
     bool success = false;
-    int length = QString( lengthstr ).toInt( &success );
+    int length = lengthstr.toInt( &success );
     // Note: REQUEST_BODY is not part of CGI standard, and it is not
     // normally passed by any CGI web server and it is implemented only
     // to allow unit tests to inject a request body and simulate a POST
     // request
-    const char *request_body  = getenv( "REQUEST_BODY" );
-    if ( success && request_body )
+    const QString request_body = environmentVariable( QStringLiteral( "REQUEST_BODY" ) );
+    if ( success && !request_body.isNull() )
     {
       QString body( request_body );
       body.truncate( length );
@@ -180,14 +199,24 @@ void QgsFcgiServerRequest::readData()
       length = 0;
     }
 #ifdef QGISDEBUG
-    qDebug() << "fcgi: reading " << lengthstr << " bytes from " << ( request_body ? "REQUEST_BODY" : "stdin" );
+    qDebug() << "fcgi: reading " << lengthstr << " bytes from " << ( !request_body.isNull() ? "REQUEST_BODY" : "stdin" );
 #endif
     if ( success )
     {
-      // XXX This not efficient at all  !!
-      for ( int i = 0; i < length; ++i )
+      if ( mFcgxRequest && length > 0 )
+      {
+        QByteArray data( length, Qt::Uninitialized );
+        const int read = FCGX_GetStr( data.data(), length, mFcgxRequest->in );
+        data.truncate( std::max( read, 0 ) );
+        mData.append( data );
+      }
+      else
       {
-        mData.append( getchar() );
+        // XXX This not efficient at all  !!
+        for ( int i = 0; i < length; ++i )
+        {
+          mData.append( getchar() );
+        }
       }
     }
     else
@@ -253,9 +282,10 @@ void QgsFcgiServerRequest::printRequestInfos( const QUrl &url )
 
   for ( const auto &envVar : envVars )
   {
-    if ( getenv( envVar.toStdString().c_str() ) )
+    const QString value = environmentVariable( envVar );
+    if ( !value.isNull() )
     {
-      QgsMessageLog::logMessage( QStringLiteral( "%1: %2" ).arg( envVar ).arg( QString( getenv( envVar.toStdString().c_str() ) ) ), QStringLiteral( "Server" ), Qgis::MessageLevel::Info );
+      QgsMessageLog::logMessage( QStringLiteral( "%1: %2" ).arg( envVar ).arg( value ), QStringLiteral( "Server" ), Qgis::MessageLevel::Info );
     }
   }
 }
@@ -269,8 +299,8 @@ QString QgsFcgiServerRequest::header( const QString &name ) const
   // https://tools.ietf.org/html/rfc3875#section-4.1.18
   if ( result.isEmpty() )
   {
-    result = qgetenv( QStringLiteral( "HTTP_%1" ).arg(
-                        name.toUpper().replace( QLatin1Char( '-' ), QLatin1Char( '_' ) ) ).toStdString().c_str() );
+    result = environmentVariable( QStringLiteral( "HTTP_%1" ).arg(
+                                    name.toUpper().replace( QLatin1Char( '-' ), QLatin1Char( '_' ) ) ) );
   }
   return result;
 }
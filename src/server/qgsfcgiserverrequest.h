@@ -22,6 +22,10 @@
 
 #include "qgsserverrequest.h"
 
+#ifndef SIP_RUN
+struct FCGX_Request;
+#endif
+
 
 /**
  * \ingroup server
@@ -34,6 +38,16 @@ class SERVER_EXPORT QgsFcgiServerRequest: public QgsServerRequest
   public:
     QgsFcgiServerRequest();
 
+    /**
+     * Constructor for a request accepted with FCGX_Accept_r(). The parameters and the
+     * data of the request are read from \a request instead of the process environment
+     * and the standard input, so that several requests can be accepted concurrently.
+     *
+     * \note not available in Python bindings
+     * \since QGIS 3.22
+     */
+    explicit QgsFcgiServerRequest( FCGX_Request *request ) SIP_SKIP;
+
     QByteArray data() const override;
 
     /**
@@ -49,7 +63,17 @@ class SERVER_EXPORT QgsFcgiServerRequest: public QgsServerRequest
      */
     QString header( const QString &name ) const override;
 
+    /**
+     * Returns the value of the FastCGI parameter \a name of the request, which is
+     * an environment variable of the process unless the request was accepted with FCGX_Accept_r().
+     *
+     * \since QGIS 3.22
+     */
+    QString environmentVariable( const QString &name ) const;
+
   private:
+    void init();
+
     void readData();
 
     // Log request info: print debug infos
@@ -62,6 +86,7 @@ class SERVER_EXPORT QgsFcgiServerRequest: public QgsServerRequest
 
     QByteArray mData;
     bool       mHasError = false;
+    FCGX_Request *mFcgxRequest = nullptr;
 };
 
 #endif
@@ -34,6 +34,26 @@ QgsFcgiServerResponse::QgsFcgiServerResponse( QgsServerRequest::Method method )
   setDefaultHeaders();
 }
 
+QgsFcgiServerResponse::QgsFcgiServerResponse( FCGX_Request *request, QgsServerRequest::Method method )
+  : mMethod( method )
+  , mFcgxRequest( request )
+{
+  mBuffer.open( QIODevice::ReadWrite );
+  setDefaultHeaders();
+}
+
+void QgsFcgiServerResponse::writeData( const QByteArray &data )
+{
+  if ( mFcgxRequest )
+  {
+    FCGX_PutStr( data.constData(), data.size(), mFcgxRequest->out );
+  }
+  else
+  {
+    fwrite( static_cast< const void * >( data.constData() ), data.size(), 1, FCGI_stdout );
+  }
+}
+
 void QgsFcgiServerResponse::removeHeader( const QString &key )
 {
   mHeaders.remove( key );
@@ -109,12 +129,9 @@ void QgsFcgiServerResponse::flush()
     QMap<QString, QString>::const_iterator it;
     for ( it = mHeaders.constBegin(); it != mHeaders.constEnd(); ++it )
     {
-      fputs( it.key().toUtf8(), FCGI_stdout );
-      fputs( ": ", FCGI_stdout );
-      fputs( it.value().toUtf8(), FCGI_stdout );
-      fputs( "\n", FCGI_stdout );
+      writeData( QStringLiteral( "%1: %2\n" ).arg( it.key(), it.value() ).toUtf8() );
     }
-    fputs( "\n", FCGI_stdout );
+    writeData( QByteArrayLiteral( "\n" ) );
     mHeadersSent = true;
   }
 
@@ -128,11 +145,9 @@ void QgsFcgiServerResponse::flush()
   else if ( mBuffer.bytesAvailable() > 0 )
   {
     QByteArray &ba = mBuffer.buffer();
-    size_t count   = fwrite( ( void * )ba.data(), ba.size(), 1, FCGI_stdout );
+    writeData( ba );
 #ifdef QGISDEBUG
-    qDebug() << QStringLiteral( "Sent %1 blocks of %2 bytes" ).arg( count ).arg( ba.size() );
-#else
-    Q_UNUSED( count )
+    qDebug() << QStringLiteral( "Sent %1 bytes" ).arg( ba.size() );
 #endif
     // Reset the internal buffer
     ba.clear();
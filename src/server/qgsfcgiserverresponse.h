@@ -27,6 +27,8 @@
 
 #include <QBuffer>
 
+struct FCGX_Request;
+
 /**
  * \ingroup server
  * \class QgsFcgiServerResponse
@@ -43,6 +45,16 @@ class SERVER_EXPORT QgsFcgiServerResponse: public QgsServerResponse
      */
     QgsFcgiServerResponse( QgsServerRequest::Method method = QgsServerRequest::GetMethod );
 
+    /**
+     * Constructor for QgsFcgiServerResponse writing to the output stream of
+     * an explicitly accepted FastCGI \a request, as done by the workers of a
+     * multithreaded server.
+     * \param request The FastCGI request, it must outlive the response
+     * \param method The HTTP method (Get by default)
+     * \since QGIS 3.22
+     */
+    QgsFcgiServerResponse( FCGX_Request *request, QgsServerRequest::Method method = QgsServerRequest::GetMethod );
+
     void setHeader( const QString &key, const QString &value ) override;
 
     void removeHeader( const QString &key ) override;
@@ -77,12 +89,17 @@ class SERVER_EXPORT QgsFcgiServerResponse: public QgsServerResponse
     void setDefaultHeaders();
 
   private:
+
+    //! Writes \a data to the output stream of the request
+    void writeData( const QByteArray &data );
+
     QMap<QString, QString> mHeaders;
     QBuffer mBuffer;
     bool mFinished    = false;
     bool mHeadersSent = false;
     QgsServerRequest::Method mMethod;
     int mStatusCode = 0;
+    FCGX_Request *mFcgxRequest = nullptr;
 };
 
 #endif
@@ -28,6 +28,7 @@
 #include "qgsproject.h"
 #include "qgsproviderregistry.h"
 #include "qgslogger.h"
+#include "qgsmaphittest.h"
 #include "qgsmapserviceexception.h"
 #include "qgsnetworkaccessmanager.h"
 #include "qgsserverlogger.h"
@@ -39,11 +40,16 @@
 #include "qgsserverparameters.h"
 #include "qgsapplication.h"
 #include "qgsruntimeprofiler.h"
+#include "qgsbufferserverrequest.h"
+#include "qgsbufferserverresponse.h"
 
 #include <QDomDocument>
 #include <QNetworkDiskCache>
 #include <QSettings>
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QUrlQuery>
 
 // TODO: remove, it's only needed by a single debug message
 #include <fcgi_stdio.h>
@@ -309,6 +315,9 @@ bool QgsServer::init()
   // log settings currently used
   sSettings()->logSummary();
 
+  // store the results of content based legends, if enabled
+  QgsMapHitTest::setCacheMaxAge( sSettings()->legendCacheMaxAge() );
+
   setupNetworkAccessManager();
   QDomImplementation::setInvalidDataPolicy( QDomImplementation::DropInvalidChars );
 
@@ -384,11 +393,26 @@ void QgsServer::putenv( const QString &var, const QString &val )
 void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &response, const QgsProject *project )
 {
   const Qgis::MessageLevel logLevel = QgsServerLogger::instance()->logLevel();
+
+  // Requests may be handled concurrently by several threads, except when Python plugins are
+  // loaded or server, access control or cache filters are registered, as they may change the
+  // process environment or rely on the current project and are not thread safe
+  static QMutex sExclusiveRequestMutex;
+  const bool exclusiveRequest = sServerInterface->hasRegisteredFilters() || !QgsServerPlugins::serverPlugins().isEmpty();
+  QMutexLocker exclusiveRequestLocker( exclusiveRequest ? &sExclusiveRequestMutex : nullptr );
+  const bool isMainThread = QThread::currentThread() == qApp->thread();
+
   {
 
     QgsScopedRuntimeProfile profiler { QStringLiteral( "handleRequest" ), QStringLiteral( "server" ) };
 
-    qApp->processEvents();
+    if ( isMainThread )
+    {
+      qApp->processEvents();
+
+      // Projects replaced in the cache are deleted once no request of the main thread uses them
+      mConfigCache->requestStarted();
+    }
 
     response.clear();
 
@@ -460,8 +484,12 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
           }
         }
 
-        // Set the current project instance
-        QgsProject::setInstance( const_cast<QgsProject *>( project ) );
+        // Set the current project instance, requests handled by other threads use their
+        // own copy of the project, which is only the current project of their thread
+        if ( isMainThread )
+          QgsProject::setInstance( const_cast<QgsProject *>( project ) );
+        else
+          QgsProject::setThreadInstance( const_cast<QgsProject *>( project ) );
 
         if ( project )
         {
@@ -542,6 +570,12 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
     // We are done using requestHandler in plugins, make sure we don't access
     // to a deleted request handler from Python bindings
     sServerInterface->clearRequestHandler();
+
+    // The copy of the project may be discarded before the next request of the thread
+    if ( !isMainThread )
+      QgsProject::setThreadInstance( nullptr );
+    else
+      mConfigCache->requestFinished();
   }
 
   if ( logLevel == Qgis::MessageLevel::Info )
@@ -581,6 +615,35 @@ void QgsServer::handleRequest( QgsServerRequest &request, QgsServerResponse &res
 }
 
 
+void QgsServer::preloadProjects()
+{
+#if QT_VERSION < QT_VERSION_CHECK(5, 15, 0)
+  const QStringList paths = sSettings()->preloadProjects().split( QStringLiteral( "||" ), QString::SkipEmptyParts );
+#else
+  const QStringList paths = sSettings()->preloadProjects().split( QStringLiteral( "||" ), Qt::SkipEmptyParts );
+#endif
+  if ( paths.isEmpty() )
+    return;
+
+  const QStringList preloadedPaths = mConfigCache->preloadProjects( paths, sServerInterface->serverSettings() );
+
+  // Provider connections are opened when the projects are read, a first GetCapabilities
+  // request fills the capabilities cache
+  for ( const QString &path : preloadedPaths )
+  {
+    QUrlQuery query;
+    query.addQueryItem( QStringLiteral( "MAP" ), path );
+    query.addQueryItem( QStringLiteral( "SERVICE" ), QStringLiteral( "WMS" ) );
+    query.addQueryItem( QStringLiteral( "REQUEST" ), QStringLiteral( "GetCapabilities" ) );
+    QUrl url( QStringLiteral( "http://localhost/" ) );
+    url.setQuery( query );
+
+    QgsBufferServerRequest request( url );
+    QgsBufferServerResponse response;
+    handleRequest( request, response );
+  }
+}
+
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
 void QgsServer::initPython()
 {
@@ -73,9 +73,26 @@ class SERVER_EXPORT QgsServer
      * \param project a QgsProject or NULLPTR, if it is NULLPTR the project
      *        is created from the MAP param specified in request or from
      *        the QGIS_PROJECT_FILE setting
+     *
+     * Requests can be handled concurrently from several threads, in which case each
+     * thread uses its own copy of the projects read from the configuration cache as its
+     * current project. Requests are handled one at a time when server filters are registered.
      */
     void handleRequest( QgsServerRequest &request, QgsServerResponse &response, const QgsProject *project = nullptr );
 
+    /**
+     * Reads the projects listed by the QGIS_SERVER_PRELOAD_PROJECTS setting into the
+     * configuration cache, and warms them up by handling a WMS GetCapabilities request
+     * for each of them, so that their capabilities documents are cached.
+     *
+     * Preloaded projects are read again in the background when their file changes.
+     *
+     * This method should be called once the plugins are initialized.
+     *
+     * \since QGIS 3.22
+     */
+    void preloadProjects();
+
 
     //! Returns a pointer to the server interface
     QgsServerInterfaceImpl SIP_PYALTERNATIVETYPE( QgsServerInterface ) *serverInterface() { return sServerInterface; }
@@ -26,7 +26,6 @@ QgsServerInterfaceImpl::QgsServerInterfaceImpl( QgsCapabilitiesCache *capCache,
   , mServiceRegistry( srvRegistry )
   , mServerSettings( settings )
 {
-  mRequestHandler = nullptr;
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
   mAccessControls = new QgsAccessControl();
   mCacheManager = new QgsServerCacheManager( *settings );
@@ -50,17 +49,17 @@ QgsServerInterfaceImpl::~QgsServerInterfaceImpl()
 
 void QgsServerInterfaceImpl::clearRequestHandler()
 {
-  mRequestHandler = nullptr;
+  mRequestState.localData().requestHandler = nullptr;
 }
 
 void QgsServerInterfaceImpl::setRequestHandler( QgsRequestHandler *requestHandler )
 {
-  mRequestHandler = requestHandler;
+  mRequestState.localData().requestHandler = requestHandler;
 }
 
 void QgsServerInterfaceImpl::setConfigFilePath( const QString &configFilePath )
 {
-  mConfigFilePath = configFilePath;
+  mRequestState.localData().configFilePath = configFilePath;
 }
 
 void QgsServerInterfaceImpl::registerFilter( QgsServerFilter *filter, int priority )
@@ -78,6 +77,7 @@ void QgsServerInterfaceImpl::registerAccessControl( QgsAccessControlFilter *acce
 {
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
   mAccessControls->registerAccessControl( accessControl, priority );
+  mAccessControlsRegistered = true;
 #else
   Q_UNUSED( accessControl )
   Q_UNUSED( priority )
@@ -89,6 +89,7 @@ void QgsServerInterfaceImpl::registerServerCache( QgsServerCacheFilter *serverCa
 {
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
   mCacheManager->registerServerCache( serverCache, priority );
+  mServerCachesRegistered = true;
 #else
   Q_UNUSED( serverCache )
   Q_UNUSED( priority )
@@ -100,6 +101,11 @@ QgsServerCacheManager *QgsServerInterfaceImpl::cacheManager() const
   return mCacheManager;
 }
 
+bool QgsServerInterfaceImpl::hasRegisteredFilters() const
+{
+  return !mFilters.isEmpty() || mAccessControlsRegistered || mServerCachesRegistered;
+}
+
 void QgsServerInterfaceImpl::removeConfigCacheEntry( const QString &path )
 {
   if ( mCapabilitiesCache )
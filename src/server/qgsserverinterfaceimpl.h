@@ -26,6 +26,8 @@
 #include "qgscapabilitiescache.h"
 #include "qgsservercachemanager.h"
 
+#include <QThreadStorage>
+
 /**
  * \ingroup server
  * \class QgsServerInterfaceImpl
@@ -48,7 +50,7 @@ class SERVER_EXPORT QgsServerInterfaceImpl : public QgsServerInterface
     void clearRequestHandler() override;
     QgsCapabilitiesCache *capabilitiesCache() override { return mCapabilitiesCache; }
     //! Returns the QgsRequestHandler, to be used only in server plugins
-    QgsRequestHandler  *requestHandler() override { return mRequestHandler; }
+    QgsRequestHandler  *requestHandler() override { return mRequestState.localData().requestHandler; }
     void registerFilter( QgsServerFilter *filter, int priority = 0 ) override;
     QgsServerFiltersMap filters() override { return mFilters; }
 
@@ -78,7 +80,7 @@ class SERVER_EXPORT QgsServerInterfaceImpl : public QgsServerInterface
     QgsServerCacheManager *cacheManager() const override;
 
     QString getEnv( const QString &name ) const override;
-    QString configFilePath() override { return mConfigFilePath; }
+    QString configFilePath() override { return mRequestState.localData().configFilePath; }
     void setConfigFilePath( const QString &configFilePath ) override;
     void setFilters( QgsServerFiltersMap *filters ) override;
     void removeConfigCacheEntry( const QString &path ) override;
@@ -87,14 +89,31 @@ class SERVER_EXPORT QgsServerInterfaceImpl : public QgsServerInterface
 
     QgsServerSettings *serverSettings() override;
 
+    /**
+     * Returns TRUE if server filters, access control filters or server cache filters
+     * were registered.
+     *
+     * \since QGIS 3.22
+     */
+    bool hasRegisteredFilters() const;
+
   private:
 
-    QString mConfigFilePath;
+    //! State of the request handled by a thread
+    struct RequestState
+    {
+      QgsRequestHandler *requestHandler = nullptr;
+      QString configFilePath;
+    };
+
+    //! Requests may be handled concurrently, each thread sees the state of its own request
+    QThreadStorage< RequestState > mRequestState;
     QgsServerFiltersMap mFilters;
     QgsAccessControl *mAccessControls = nullptr;
+    bool mAccessControlsRegistered = false;
     QgsServerCacheManager *mCacheManager = nullptr;
+    bool mServerCachesRegistered = false;
     QgsCapabilitiesCache *mCapabilitiesCache = nullptr;
-    QgsRequestHandler *mRequestHandler = nullptr;
     QgsServiceRegistry *mServiceRegistry = nullptr;
     QgsServerSettings *mServerSettings = nullptr;
 };
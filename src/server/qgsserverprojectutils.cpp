@@ -142,6 +142,12 @@ int QgsServerProjectUtils::wmsImageQuality( const QgsProject &project )
   return project.readNumEntry( QStringLiteral( "WMSImageQuality" ), QStringLiteral( "/" ), -1 );
 }
 
+int QgsServerProjectUtils::wmsPngCompression( const QgsProject &project )
+{
+  const int compression = project.readNumEntry( QStringLiteral( "WMSPngCompression" ), QStringLiteral( "/" ), -1 );
+  return compression >= 0 ? std::min( compression, 9 ) : -1;
+}
+
 int QgsServerProjectUtils::wmsTileBuffer( const QgsProject &project )
 {
   return project.readNumEntry( QStringLiteral( "WMSTileBuffer" ), QStringLiteral( "/" ), 0 );
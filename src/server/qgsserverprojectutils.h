@@ -165,6 +165,17 @@ namespace QgsServerProjectUtils
    */
   SERVER_EXPORT int wmsImageQuality( const QgsProject &project );
 
+  /**
+   * Returns the zlib compression level for WMS PNG images defined in a QGIS project.
+   *
+   * Lower levels encode faster, higher levels give smaller images.
+   *
+   * \param project the QGIS project
+   * \returns compression level between 0 and 9 if defined in project, -1 otherwise.
+   * \since QGIS 3.22
+   */
+  SERVER_EXPORT int wmsPngCompression( const QgsProject &project );
+
   /**
    * Returns the tile buffer in pixels for WMS images defined in a QGIS project.
    * \param project the QGIS project
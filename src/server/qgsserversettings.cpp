@@ -22,6 +22,8 @@
 #include <QSettings>
 #include <QDir>
 
+#include <algorithm>
+
 QgsServerSettings::QgsServerSettings()
 {
   load();
@@ -64,6 +66,39 @@ void QgsServerSettings::initSettings()
                               };
   mSettings[ sMaxThreads.envVar ] = sMaxThreads;
 
+  // number of requests handled concurrently
+  const Setting sParallelRequests = { QgsServerSettingsEnv::QGIS_SERVER_PARALLEL_REQUESTS,
+                                      QgsServerSettingsEnv::DEFAULT_VALUE,
+                                      QStringLiteral( "Maximum number of requests handled concurrently" ),
+                                      QStringLiteral( "/qgis/server_parallel_requests" ),
+                                      QVariant::Int,
+                                      QVariant( 1 ),
+                                      QVariant()
+                                    };
+  mSettings[ sParallelRequests.envVar ] = sParallelRequests;
+
+  // projects read at startup
+  const Setting sPreloadProjects = { QgsServerSettingsEnv::QGIS_SERVER_PRELOAD_PROJECTS,
+                                     QgsServerSettingsEnv::DEFAULT_VALUE,
+                                     QStringLiteral( "Projects read when the server starts" ),
+                                     QStringLiteral( "/qgis/server_preload_projects" ),
+                                     QVariant::String,
+                                     QVariant( "" ),
+                                     QVariant()
+                                   };
+  mSettings[ sPreloadProjects.envVar ] = sPreloadProjects;
+
+  // maximum age of the stored results of content based legends
+  const Setting sLegendCacheMaxAge = { QgsServerSettingsEnv::QGIS_SERVER_LEGEND_CACHE_MAX_AGE,
+                                       QgsServerSettingsEnv::DEFAULT_VALUE,
+                                       QStringLiteral( "Maximum age in seconds of the stored results of content based legends" ),
+                                       QStringLiteral( "/qgis/server_legend_cache_max_age" ),
+                                       QVariant::Int,
+                                       QVariant( 0 ),
+                                       QVariant()
+                                     };
+  mSettings[ sLegendCacheMaxAge.envVar ] = sLegendCacheMaxAge;
+
   // log level
   const Setting sLogLevel = { QgsServerSettingsEnv::QGIS_SERVER_LOG_LEVEL,
                               QgsServerSettingsEnv::DEFAULT_VALUE,
@@ -493,6 +528,11 @@ int QgsServerSettings::maxThreads() const
   return value( QgsServerSettingsEnv::QGIS_SERVER_MAX_THREADS ).toInt();
 }
 
+int QgsServerSettings::parallelRequests() const
+{
+  return std::max( 1, value( QgsServerSettingsEnv::QGIS_SERVER_PARALLEL_REQUESTS ).toInt() );
+}
+
 QString QgsServerSettings::logFile() const
 {
   return value( QgsServerSettingsEnv::QGIS_SERVER_LOG_FILE ).toString();
@@ -583,6 +623,16 @@ bool QgsServerSettings::getPrintDisabled() const
   return value( QgsServerSettingsEnv::QGIS_SERVER_DISABLE_GETPRINT ).toBool();
 }
 
+QString QgsServerSettings::preloadProjects() const
+{
+  return value( QgsServerSettingsEnv::QGIS_SERVER_PRELOAD_PROJECTS ).toString();
+}
+
+int QgsServerSettings::legendCacheMaxAge() const
+{
+  return std::max( 0, value( QgsServerSettingsEnv::QGIS_SERVER_LEGEND_CACHE_MAX_AGE ).toInt() );
+}
+
 bool QgsServerSettings::logProfile()
 {
   return value( QgsServerSettingsEnv::QGIS_SERVER_LOG_PROFILE, false ).toBool();
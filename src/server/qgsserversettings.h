@@ -77,6 +77,9 @@ class SERVER_EXPORT QgsServerSettingsEnv : public QObject
       QGIS_SERVER_WCS_SERVICE_URL, //!< To set the WCS service URL if it's not present in the project. (since QGIS 3.20).
       QGIS_SERVER_WMTS_SERVICE_URL, //!< To set the WMTS service URL if it's not present in the project. (since QGIS 3.20).
       QGIS_SERVER_LANDING_PAGE_PREFIX, //! Prefix of the path component of the landing page base URL, default is empty (since QGIS 3.20).
+      QGIS_SERVER_PARALLEL_REQUESTS, //!< Maximum number of requests handled concurrently, defaults to 1 (since QGIS 3.22).
+      QGIS_SERVER_PRELOAD_PROJECTS, //!< Projects read when the server starts, separated by '||' (since QGIS 3.22).
+      QGIS_SERVER_LEGEND_CACHE_MAX_AGE, //!< Maximum age in seconds of the stored results of content based legends, defaults to 0 (since QGIS 3.22).
     };
     Q_ENUM( EnvVar )
 };
@@ -140,6 +143,22 @@ class SERVER_EXPORT QgsServerSettings
      */
     int maxThreads() const;
 
+    /**
+     * Returns the maximum number of requests handled concurrently.
+     *
+     * Both the FastCGI server and the development server accept requests with a pool
+     * of worker threads of this size. Each worker thread uses its own copy of the
+     * projects of the configuration cache. The FastCGI server accepts requests one at
+     * a time when Python plugins are loaded, and requests are always handled one at a
+     * time when server, access control or cache filters are registered.
+     *
+     * The default value is 1, this value can be changed by setting the environment
+     * variable QGIS_SERVER_PARALLEL_REQUESTS.
+     *
+     * \since QGIS 3.22
+     */
+    int parallelRequests() const;
+
     /**
      * Returns the log level.
      * \returns the log level.
@@ -288,6 +307,35 @@ class SERVER_EXPORT QgsServerSettings
      */
     bool getPrintDisabled() const;
 
+    /**
+     * Returns the projects read when the server starts. Multiple projects can be
+     * specified by separating them with '||'.
+     *
+     * Preloaded projects are kept in the configuration cache and are read again
+     * in the background when their file changes.
+     *
+     * The default value is empty, this value can be changed by setting the environment
+     * variable QGIS_SERVER_PRELOAD_PROJECTS.
+     *
+     * \since QGIS 3.22
+     */
+    QString preloadProjects() const;
+
+    /**
+     * Returns the maximum age, in seconds, of the hit test results stored for content based
+     * legends of GetLegendGraphic and GetPrint requests.
+     *
+     * Stored results are reused by legends of overlapping or adjacent extents, but changes to the
+     * layer data are only taken into account once they expire.
+     *
+     * The default value is 0, which disables storing results. This value can be changed by setting
+     * the environment variable QGIS_SERVER_LEGEND_CACHE_MAX_AGE.
+     *
+     * \see QgsMapHitTest::setCacheMaxAge()
+     * \since QGIS 3.22
+     */
+    int legendCacheMaxAge() const;
+
     /**
      * Returns the service URL from the setting.
      * \since QGIS 3.20
@@ -21,6 +21,9 @@
 #include "qgsmaprendererparalleljob.h"
 #include "qgsmaprenderercustompainterjob.h"
 #include "qgsapplication.h"
+#include "qgsruntimeprofiler.h"
+
+#include <QThread>
 
 namespace QgsWms
 {
@@ -37,6 +40,11 @@ namespace QgsWms
 #ifndef HAVE_SERVER_PYTHON_PLUGINS
     Q_UNUSED( mFeatureFilterProvider )
 #endif
+    // Requests handled by other threads than the main thread are rendered in their own
+    // thread, where the project of the request is the current project
+    if ( QThread::currentThread() != QgsApplication::instance()->thread() )
+      mParallelRendering = false;
+
     if ( mParallelRendering )
     {
       QgsApplication::setMaxThreads( maxThreads );
@@ -50,6 +58,8 @@ namespace QgsWms
 
   void QgsMapRendererJobProxy::render( const QgsMapSettings &mapSettings, QImage *image )
   {
+    QgsScopedRuntimeProfile profile( QStringLiteral( "Render map" ), QStringLiteral( "server" ) );
+
     if ( mParallelRendering )
     {
       QgsMapRendererParallelJob renderJob( mapSettings );
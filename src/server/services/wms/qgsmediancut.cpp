@@ -24,6 +24,10 @@
 #include <QList>
 #include <QMultiMap>
 #include <QHash>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <numeric>
 
 namespace QgsWms
 {
@@ -34,17 +38,18 @@ namespace QgsWms
   namespace
   {
 
-    void imageColors( QHash<QRgb, int> &colors, const QImage &image )
+    //! Images with fewer pixels are read on a single thread
+    constexpr int PARALLEL_MIN_PIXELS = 256 * 256;
+
+    void scanLineColors( QHash<QRgb, int> &colors, const QImage &image, int firstLine, int lastLine )
     {
-      colors.clear();
       int width = image.width();
-      int height = image.height();
 
       const QRgb *currentScanLine = nullptr;
       QHash<QRgb, int>::iterator colorIt;
-      for ( int i = 0; i < height; ++i )
+      for ( int i = firstLine; i < lastLine; ++i )
       {
-        currentScanLine = ( const QRgb * )( image.scanLine( i ) );
+        currentScanLine = ( const QRgb * )( image.constScanLine( i ) );
         for ( int j = 0; j < width; ++j )
         {
           colorIt = colors.find( currentScanLine[j] );
@@ -60,6 +65,37 @@ namespace QgsWms
       }
     }
 
+    void imageColors( QHash<QRgb, int> &colors, const QImage &image )
+    {
+      colors.clear();
+      const int height = image.height();
+      const int bands = std::min( QThreadPool::globalInstance()->maxThreadCount(), height );
+      if ( bands < 2 || image.width() * height < PARALLEL_MIN_PIXELS )
+      {
+        scanLineColors( colors, image, 0, height );
+        return;
+      }
+
+      // each band of scan lines gets its own histogram, merged once all the bands are read
+      QVector< QHash<QRgb, int> > bandColors( bands );
+      QVector<int> bandIndexes( bands );
+      std::iota( bandIndexes.begin(), bandIndexes.end(), 0 );
+      QtConcurrent::blockingMap( bandIndexes, [&bandColors, &image, height, bands]( int &band )
+      {
+        scanLineColors( bandColors[band], image, band * height / bands, ( band + 1 ) * height / bands );
+      } );
+
+      colors = bandColors.at( 0 );
+      for ( int band = 1; band < bands; ++band )
+      {
+        const QHash<QRgb, int> &currentColors = bandColors.at( band );
+        for ( auto colorIt = currentColors.constBegin(); colorIt != currentColors.constEnd(); ++colorIt )
+        {
+          colors[colorIt.key()] += colorIt.value();
+        }
+      }
+    }
+
     bool minMaxRange( const QgsColorBox &colorBox, int &redRange, int &greenRange, int &blueRange, int &alphaRange )
     {
       if ( colorBox.size() < 1 )
@@ -126,7 +126,11 @@ namespace QgsWms
 #endif
     if ( !capabilitiesDocument && cache ) //capabilities xml not in cache plugins
     {
-      capabilitiesDocument = capabilitiesCache->searchCapabilitiesDocument( configFilePath, cacheKey );
+      doc = capabilitiesCache->capabilitiesDocument( configFilePath, cacheKey );
+      if ( !doc.isNull() )
+      {
+        capabilitiesDocument = &doc;
+      }
     }
 
     if ( !capabilitiesDocument ) //capabilities xml not in cache. Create a new one
@@ -146,17 +150,11 @@ namespace QgsWms
       // cppcheck-suppress identicalInnerCondition
       if ( !capabilitiesDocument )
       {
+        // the cache keeps its own copy, the document is served from this one
         capabilitiesCache->insertCapabilitiesDocument( configFilePath, cacheKey, &doc );
-        capabilitiesDocument = capabilitiesCache->searchCapabilitiesDocument( configFilePath, cacheKey );
-      }
-      if ( !capabilitiesDocument )
-      {
         capabilitiesDocument = &doc;
       }
-      else
-      {
-        QgsMessageLog::logMessage( QStringLiteral( "Set WMS capabilities document in cache" ), QStringLiteral( "Server" ) );
-      }
+      QgsMessageLog::logMessage( QStringLiteral( "Set WMS capabilities document in cache" ), QStringLiteral( "Server" ) );
     }
     else
     {
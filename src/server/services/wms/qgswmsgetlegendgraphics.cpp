@@ -155,7 +155,7 @@ namespace QgsWms
       tree->clear();
       if ( result )
       {
-        writeImage( response, *result, parameters.formatAsString(), context.imageQuality() );
+        writeImage( response, *result, parameters.formatAsString(), context.imageQuality(), context.pngCompression() );
 #ifdef HAVE_SERVER_PYTHON_PLUGINS
         if ( cacheManager )
         {
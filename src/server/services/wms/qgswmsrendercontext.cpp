@@ -138,6 +138,11 @@ int QgsWmsRenderContext::imageQuality() const
   return imageQuality;
 }
 
+int QgsWmsRenderContext::pngCompression() const
+{
+  return QgsServerProjectUtils::wmsPngCompression( *mProject );
+}
+
 int QgsWmsRenderContext::tileBuffer() const
 {
   int tileBuffer = 0;
@@ -150,6 +150,13 @@ namespace QgsWms
        */
       int imageQuality() const;
 
+      /**
+       * Returns the zlib compression level to use for PNG images according to
+       * the current configuration, or -1 to use the default level.
+       * \since QGIS 3.22
+       */
+      int pngCompression() const;
+
       /**
        * Returns the tile buffer value to use for rendering according to the
        * current configuration.
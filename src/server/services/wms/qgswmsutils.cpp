@@ -20,6 +20,10 @@
  ***************************************************************************/
 
 #include <QRegularExpression>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <numeric>
 
 #include "qgsmodule.h"
 #include "qgswmsutils.h"
@@ -27,9 +31,54 @@
 #include "qgsserverprojectutils.h"
 #include "qgswmsserviceexception.h"
 #include "qgsproject.h"
+#include "qgsruntimeprofiler.h"
 
 namespace QgsWms
 {
+  namespace
+  {
+    //! Images with fewer pixels are converted on a single thread
+    constexpr int PARALLEL_MIN_PIXELS = 256 * 256;
+
+    // Converts an ARGB32 image to an 8 bit image with the colors of colorTable.
+    // Bands of scan lines are converted in parallel, which gives the same image
+    // as a single conversion since threshold dithering does not diffuse errors.
+    QImage convertToIndexed8( const QImage &image, const QVector<QRgb> &colorTable )
+    {
+      const Qt::ImageConversionFlags flags = Qt::ColorOnly | Qt::ThresholdDither |
+                                             Qt::ThresholdAlphaDither | Qt::NoOpaqueDetection;
+      const int width = image.width();
+      const int height = image.height();
+      const int bands = std::min( QThreadPool::globalInstance()->maxThreadCount(), height );
+      if ( bands < 2 || width * height < PARALLEL_MIN_PIXELS )
+      {
+        return image.convertToFormat( QImage::Format_Indexed8, colorTable, flags );
+      }
+
+      QImage result( image.size(), QImage::Format_Indexed8 );
+      result.setColorTable( colorTable );
+      uchar *resultBits = result.bits();
+      const int resultBytesPerLine = result.bytesPerLine();
+
+      QVector<int> bandIndexes( bands );
+      std::iota( bandIndexes.begin(), bandIndexes.end(), 0 );
+      QtConcurrent::blockingMap( bandIndexes, [ & ]( int &band )
+      {
+        const int firstLine = band * height / bands;
+        const int lineCount = ( band + 1 ) * height / bands - firstLine;
+
+        // the band uses the scan lines of the image without copying them
+        const QImage bandImage( image.constScanLine( firstLine ), width, lineCount, image.bytesPerLine(), image.format() );
+        const QImage bandResult = bandImage.convertToFormat( QImage::Format_Indexed8, colorTable, flags );
+        for ( int i = 0; i < lineCount; ++i )
+        {
+          memcpy( resultBits + ( firstLine + i ) * resultBytesPerLine, bandResult.constScanLine( i ), width );
+        }
+      } );
+      return result;
+    }
+  } // namespace
+
   QUrl serviceUrl( const QgsServerRequest &request, const QgsProject *project, const QgsServerSettings &settings )
   {
     QUrl href;
@@ -103,8 +152,10 @@ namespace QgsWms
 
   // Write image response
   void writeImage( QgsServerResponse &response, QImage &img, const QString &formatStr,
-                   int imageQuality )
+                   int imageQuality, int pngCompression )
   {
+    QgsScopedRuntimeProfile profile( QStringLiteral( "Encode image" ), QStringLiteral( "server" ) );
+
     ImageOutputFormat outputFormat = parseImageFormat( formatStr );
     QImage  result;
     QString saveFormat;
@@ -125,9 +176,7 @@ namespace QgsWms
         // the color table.
         QImage img256 = img.convertToFormat( QImage::Format_ARGB32 );
         medianCut( colorTable, 256, img256 );
-        result = img256.convertToFormat( QImage::Format_Indexed8, colorTable,
-                                         Qt::ColorOnly | Qt::ThresholdDither |
-                                         Qt::ThresholdAlphaDither | Qt::NoOpaqueDetection );
+        result = convertToIndexed8( img256, colorTable );
       }
       contentType = "image/png";
       saveFormat = "PNG";
@@ -171,6 +220,12 @@ namespace QgsWms
       {
         result.save( response.io(), qPrintable( saveFormat ), imageQuality );
       }
+      else if ( pngCompression >= 0 )
+      {
+        // Qt maps the PNG quality from [0,100] to the zlib compression level [9,0]
+        const int pngQuality = 100 - ( std::min( pngCompression, 9 ) * 91 + 8 ) / 9;
+        result.save( response.io(), qPrintable( saveFormat ), pngQuality );
+      }
       else
       {
         result.save( response.io(), qPrintable( saveFormat ) );
@@ -61,9 +61,12 @@ namespace QgsWms
 
   /**
    * Write image response
+   *
+   * The \a imageQuality is used for JPEG and WEBP images and the zlib \a pngCompression
+   * level (0 to 9) for PNG images, -1 uses the default of the image writer.
    */
   void writeImage( QgsServerResponse &response, QImage &img, const QString &formatStr,
-                   int imageQuality = -1 );
+                   int imageQuality = -1, int pngCompression = -1 );
 } // namespace QgsWms
 
 #endif
@@ -20,11 +20,13 @@
 #include "qgspoint.h"
 #include "qgslinestring.h"
 #include "qgsvectorlayer.h"
+#include "qgsogrconnpool.h"
 #include <QEventLoop>
 #include <QObject>
 #include <QTemporaryFile>
 #include <QtConcurrentMap>
 #include <QFutureWatcher>
+#include <QThreadPool>
 #include "qgstest.h"
 
 class TestQgsConnectionPool: public QObject
@@ -35,6 +37,7 @@ class TestQgsConnectionPool: public QObject
     void initTestCase();
     void cleanupTestCase();
     void layersFromSameDatasetGPX();
+    void concurrentIteratorsSameDataset();
 
   private:
     struct ReadJob
@@ -141,5 +144,49 @@ void TestQgsConnectionPool::layersFromSameDatasetGPX()
   QFile( testFile.fileName() ).remove();
 }
 
+void TestQgsConnectionPool::concurrentIteratorsSameDataset()
+{
+  // Each thread of the global thread pool must be able to read from its own handle to a local dataset
+  QTemporaryFile testFile( QStringLiteral( "testXXXXXX.gpkg" ) );
+  testFile.open();
+  testFile.close();
+  QFile::remove( testFile.fileName() );
+  QVERIFY( QFile::copy( QStringLiteral( TEST_DATA_DIR ) + QStringLiteral( "/points_gpkg.gpkg" ), testFile.fileName() ) );
+
+  // make sure there are more threads than connections allowed by the default limit, before the pool is created
+  const int defaultLimit = QgsApplication::instance()->maxConcurrentConnectionsPerPool();
+  const int previousMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+  QThreadPool::globalInstance()->setMaxThreadCount( std::max( previousMaxThreadCount, defaultLimit + 4 ) );
+
+  const int iteratorCount = QgsOgrConnPoolGroup::maxConcurrentConnections( testFile.fileName() );
+  QVERIFY( iteratorCount > defaultLimit );
+
+  std::unique_ptr< QgsVectorLayer > layer = std::make_unique< QgsVectorLayer >( testFile.fileName(), QStringLiteral( "points" ), QStringLiteral( "ogr" ) );
+  QVERIFY( layer->isValid() );
+  const long long featureCount = layer->featureCount();
+  QVERIFY( featureCount > 0 );
+
+  // all iterators are open at the same time, a connection which cannot be acquired
+  // within the timeout leaves its iterator closed instead of blocking the test
+  QgsFeatureRequest request;
+  request.setTimeout( 10000 );
+  std::vector< QgsFeatureIterator > iterators;
+  for ( int i = 0; i < iteratorCount; ++i )
+    iterators.emplace_back( layer->getFeatures( request ) );
+
+  for ( QgsFeatureIterator &it : iterators )
+  {
+    long long count = 0;
+    QgsFeature f;
+    while ( it.nextFeature( f ) )
+      count++;
+    QCOMPARE( count, featureCount );
+  }
+  iterators.clear();
+  layer.reset();
+  QThreadPool::globalInstance()->setMaxThreadCount( previousMaxThreadCount );
+  QFile::remove( testFile.fileName() );
+}
+
 QGSTEST_MAIN( TestQgsConnectionPool )
 #include "testqgsconnectionpool.moc"
@@ -48,6 +48,25 @@ static void _parseAndEvalExpr( int arg )
   }
 }
 
+//! Function returning a value which changes without the layers being notified, as Python functions may
+class TestVolatileExpressionFunction : public QgsExpressionFunction
+{
+  public:
+
+    TestVolatileExpressionFunction()
+      : QgsExpressionFunction( QStringLiteral( "test_volatile_value" ), 0, QStringLiteral( "Custom" ) )
+    {}
+
+    QVariant func( const QVariantList &, const QgsExpressionContext *, QgsExpression *, const QgsExpressionNodeFunction * ) override
+    {
+      return sValue;
+    }
+
+    static int sValue;
+};
+
+int TestVolatileExpressionFunction::sValue = 0;
+
 class TestQgsExpression: public QObject
 {
     Q_OBJECT
@@ -2534,6 +2553,114 @@ class TestQgsExpression: public QObject
       QCOMPARE( res, result );
     }
 
+    void aggregateLayerCache()
+    {
+      const QString expression = QStringLiteral( "aggregate('%1','sum',\"col1\")" ).arg( mAggregatesLayer->id() );
+
+      // values are shared between contexts through the layer
+      QgsExpressionContext context1;
+      QgsExpression exp1( expression );
+      QCOMPARE( exp1.evaluate( &context1 ), QVariant( 42.0 ) );
+      QgsExpressionContext context2;
+      QgsExpression exp2( expression );
+      QCOMPARE( exp2.evaluate( &context2 ), QVariant( 42.0 ) );
+
+      // edits invalidate the cached values
+      QVERIFY( mAggregatesLayer->startEditing() );
+      QgsFeature f;
+      mAggregatesLayer->getFeatures( QStringLiteral( "col1 = 4" ) ).nextFeature( f );
+      QVERIFY( mAggregatesLayer->changeAttributeValue( f.id(), 0, 10 ) );
+      QgsExpressionContext context3;
+      QCOMPARE( exp1.evaluate( &context3 ), QVariant( 48.0 ) );
+      QVERIFY( mAggregatesLayer->rollBack() );
+      QgsExpressionContext context4;
+      QCOMPARE( exp1.evaluate( &context4 ), QVariant( 42.0 ) );
+
+      // volatile expressions are never shared, they are evaluated again in each context
+      QgsExpression volatileExp( QStringLiteral( "aggregate('%1','count',\"col1\",filter:=\"col1\">=to_int(env('QGIS_TEST_AGGREGATE_MIN')))" ).arg( mAggregatesLayer->id() ) );
+      qputenv( "QGIS_TEST_AGGREGATE_MIN", "0" );
+      QgsExpressionContext context5;
+      QCOMPARE( volatileExp.evaluate( &context5 ), QVariant( 7 ) );
+
+      // nor are expressions using functions which are not known to be pure
+      QVERIFY( QgsExpression::registerFunction( new TestVolatileExpressionFunction(), true ) );
+      const QString customExpression = QStringLiteral( "aggregate('%1','sum',\"col1\" + test_volatile_value())" ).arg( mAggregatesLayer->id() );
+      TestVolatileExpressionFunction::sValue = 0;
+      QgsExpressionContext context6;
+      QgsExpression customExp1( customExpression );
+      QCOMPARE( customExp1.evaluate( &context6 ), QVariant( 42.0 ) );
+      TestVolatileExpressionFunction::sValue = 1;
+      QgsExpressionContext context7;
+      QgsExpression customExp2( customExpression );
+      QCOMPARE( customExp2.evaluate( &context7 ), QVariant( 49.0 ) );
+      QVERIFY( QgsExpression::unregisterFunction( QStringLiteral( "test_volatile_value" ) ) );
+      qputenv( "QGIS_TEST_AGGREGATE_MIN", "5" );
+      QgsExpressionContext context6;
+      QCOMPARE( volatileExp.evaluate( &context6 ), QVariant( 3 ) );
+      qunsetenv( "QGIS_TEST_AGGREGATE_MIN" );
+
+      // aggregates which only differ by their delimiter are not shared
+      QgsExpression commaExp( QStringLiteral( "aggregate('%1','concatenate',to_string(\"col1\"),delimiter:=',')" ).arg( mAggregatesLayer->id() ) );
+      QgsExpression pipeExp( QStringLiteral( "aggregate('%1','concatenate',to_string(\"col1\"),delimiter:='|')" ).arg( mAggregatesLayer->id() ) );
+      QgsExpressionContext context7;
+      QCOMPARE( commaExp.evaluate( &context7 ), QVariant( QStringLiteral( "4,1,3,2,5,8,19" ) ) );
+      QCOMPARE( pipeExp.evaluate( &context7 ), QVariant( QStringLiteral( "4|1|3|2|5|8|19" ) ) );
+      QgsExpressionContext context8;
+      QCOMPARE( pipeExp.evaluate( &context8 ), QVariant( QStringLiteral( "4|1|3|2|5|8|19" ) ) );
+      QCOMPARE( commaExp.evaluate( &context8 ), QVariant( QStringLiteral( "4,1,3,2,5,8,19" ) ) );
+    }
+
+    void relationAggregateGrouped()
+    {
+      QgsAggregateCalculator calculator( mChildLayer );
+      bool ok = false;
+      const QHash< QString, QVariant > groups = calculator.calculateGrouped( QgsAggregateCalculator::Sum, QStringLiteral( "col3" ), QStringList() << QStringLiteral( "parent" ), nullptr, &ok );
+      QVERIFY( ok );
+      QCOMPARE( groups.size(), 3 );
+      QCOMPARE( groups.value( QgsAggregateCalculator::groupKey( QVariantList() << 4 ) ), QVariant( 5.0 ) );
+      QCOMPARE( groups.value( QgsAggregateCalculator::groupKey( QVariantList() << 3 ) ), QVariant( 9.0 ) );
+      QVERIFY( groups.contains( QString() ) );
+
+      // groups are aggregated as calculate() does for the features of each group
+      QgsAggregateCalculator::AggregateParameters parameters;
+      parameters.delimiter = QStringLiteral( "," );
+      calculator.setParameters( parameters );
+      const QHash< QString, QVariant > concatenated = calculator.calculateGrouped( QgsAggregateCalculator::StringConcatenate, QStringLiteral( "col2" ), QStringList() << QStringLiteral( "parent" ), nullptr, &ok );
+      QVERIFY( ok );
+      QCOMPARE( concatenated.value( QgsAggregateCalculator::groupKey( QVariantList() << 4 ) ), QVariant( QStringLiteral( "test,,test333" ) ) );
+      QCOMPARE( concatenated.value( QgsAggregateCalculator::groupKey( QVariantList() << 3 ) ), QVariant( QStringLiteral( "test4," ) ) );
+      QCOMPARE( concatenated.value( QString() ), QVariant( QStringLiteral( "" ) ) );
+      const QHash< QString, QVariant > maximums = calculator.calculateGrouped( QgsAggregateCalculator::Max, QStringLiteral( "col3 * 2" ), QStringList() << QStringLiteral( "parent" ), nullptr, &ok );
+      QVERIFY( ok );
+      QCOMPARE( maximums.value( QgsAggregateCalculator::groupKey( QVariantList() << 4 ) ), QVariant( 4.0 ) );
+      QCOMPARE( maximums.value( QgsAggregateCalculator::groupKey( QVariantList() << 3 ) ), QVariant( 14.0 ) );
+      QVERIFY( !maximums.value( QString() ).isValid() );
+
+      // several parents aggregated in one context use a single grouped pass over the children
+      const auto checkParents = [ = ]( const QList< QPair< int, QVariant > > &expected )
+      {
+        QgsExpressionContext context;
+        context.appendScope( QgsExpressionContextUtils::layerScope( mAggregatesLayer ) );
+        QgsExpression exp( QStringLiteral( "relation_aggregate('my_rel','sum',\"col3\")" ) );
+        for ( const QPair< int, QVariant > &parent : expected )
+        {
+          QgsFeature f( mAggregatesLayer->fields(), 1 );
+          f.setAttribute( QStringLiteral( "col1" ), parent.first );
+          context.setFeature( f );
+          QCOMPARE( exp.evaluate( &context ), parent.second );
+          QVERIFY( !exp.hasEvalError() );
+        }
+      };
+      checkParents( { qMakePair( 4, QVariant( 5.0 ) ), qMakePair( 3, QVariant( 9.0 ) ), qMakePair( 6, QVariant( 0.0 ) ), qMakePair( 4, QVariant( 5.0 ) ) } );
+
+      // edits of the children invalidate the grouped values
+      QVERIFY( mChildLayer->startEditing() );
+      QVERIFY( mChildLayer->changeAttributeValue( 4, 2, 10 ) );
+      checkParents( { qMakePair( 4, QVariant( 5.0 ) ), qMakePair( 3, QVariant( 17.0 ) ), qMakePair( 6, QVariant( 0.0 ) ) } );
+      QVERIFY( mChildLayer->rollBack() );
+      checkParents( { qMakePair( 4, QVariant( 5.0 ) ), qMakePair( 3, QVariant( 9.0 ) ) } );
+    }
+
     void get_feature_geometry()
     {
       //test that get_feature fetches feature's geometry
@@ -4502,6 +4629,195 @@ class TestQgsExpression: public QObject
       QCOMPARE( exp.evaluate( &context ).toInt(), 20 );
     }
 
+    void testCompilationOptIn()
+    {
+      QgsExpression exp( QStringLiteral( "1 + 2" ) );
+      QVERIFY( !exp.isCompilationEnabled() );
+      QVERIFY( exp.prepare( nullptr ) );
+      QCOMPARE( exp.evaluate( nullptr ).toInt(), 3 );
+
+      exp.setCompilationEnabled( true );
+      QVERIFY( exp.isCompilationEnabled() );
+      QVERIFY( exp.prepare( nullptr ) );
+      QCOMPARE( exp.evaluate( nullptr ).toInt(), 3 );
+
+      // copies keep the setting
+      QgsExpression copy( exp );
+      QVERIFY( copy.isCompilationEnabled() );
+      copy.setCompilationEnabled( false );
+      QVERIFY( !copy.isCompilationEnabled() );
+      QVERIFY( exp.isCompilationEnabled() );
+    }
+
+    void testCompiledProgramMatchesInterpreter_data()
+    {
+      QTest::addColumn<QString>( "expression" );
+
+      QTest::newRow( "field" ) << QStringLiteral( "\"int\"" );
+      QTest::newRow( "int arithmetic" ) << QStringLiteral( "\"int\" * 2 + \"long\" - 7 % 3" );
+      QTest::newRow( "double arithmetic" ) << QStringLiteral( "\"double\" * \"int\" / 4 - 0.5" );
+      QTest::newRow( "modulo by zero" ) << QStringLiteral( "\"int\" % (\"int\" - \"int\")" );
+      QTest::newRow( "division by zero" ) << QStringLiteral( "\"double\" / 0" );
+      QTest::newRow( "integer division" ) << QStringLiteral( "\"double\" // 2" );
+      QTest::newRow( "integer division by null" ) << QStringLiteral( "\"double\" // \"null\"" );
+      QTest::newRow( "power" ) << QStringLiteral( "\"int\" ^ 2 + (-8) ^ (1.0 / 3)" );
+      QTest::newRow( "negate" ) << QStringLiteral( "-\"int\" - -\"double\"" );
+      QTest::newRow( "negate null" ) << QStringLiteral( "-\"null\"" );
+      QTest::newRow( "comparisons" ) << QStringLiteral( "\"int\" > 2 AND \"double\" <= 10 OR \"long\" = \"int\"" );
+      QTest::newRow( "comparison result arithmetic" ) << QStringLiteral( "(\"int\" > 2) + 1" );
+      QTest::newRow( "null comparison" ) << QStringLiteral( "\"null\" = 1" );
+      QTest::newRow( "null logic" ) << QStringLiteral( "\"null\" > 1 OR \"int\" > 100" );
+      QTest::newRow( "not" ) << QStringLiteral( "NOT (\"int\" > 2)" );
+      QTest::newRow( "is" ) << QStringLiteral( "\"double\" IS 2.5 OR \"null\" IS NOT NULL" );
+      QTest::newRow( "string concat" ) << QStringLiteral( "\"string\" || '-' || \"int\"" );
+      QTest::newRow( "string plus" ) << QStringLiteral( "\"string\" + 'x'" );
+      QTest::newRow( "null string plus" ) << QStringLiteral( "\"null_string\" + 'x'" );
+      QTest::newRow( "string comparison" ) << QStringLiteral( "\"string\" > 'b'" );
+      QTest::newRow( "mixed comparison" ) << QStringLiteral( "\"string\" = \"int\"" );
+      QTest::newRow( "numeric string comparison" ) << QStringLiteral( "'5' < \"int\"" );
+      QTest::newRow( "like" ) << QStringLiteral( "\"string\" LIKE 'a%'" );
+      QTest::newRow( "ilike" ) << QStringLiteral( "\"string\" ILIKE '%B_'" );
+      QTest::newRow( "not like" ) << QStringLiteral( "\"string\" NOT LIKE '_b%'" );
+      QTest::newRow( "regexp" ) << QStringLiteral( "\"string\" ~ '^[ab]+$'" );
+      QTest::newRow( "case" ) << QStringLiteral( "CASE WHEN \"int\" > 3 THEN 'big' WHEN \"int\" > 1 THEN \"int\" * 2 ELSE \"double\" END" );
+      QTest::newRow( "case without else" ) << QStringLiteral( "CASE WHEN \"int\" > 3 THEN 'big' END" );
+      QTest::newRow( "invalid boolean" ) << QStringLiteral( "CASE WHEN \"string\" THEN 1 ELSE 2 END" );
+      QTest::newRow( "functions" ) << QStringLiteral( "round( sqrt( abs( \"double\" * \"int\" ) ), 2 ) + length( \"string\" )" );
+      QTest::newRow( "function null argument" ) << QStringLiteral( "abs( \"null\" )" );
+      QTest::newRow( "function handling null" ) << QStringLiteral( "coalesce( \"null\", \"int\" * 3 )" );
+      QTest::newRow( "variables" ) << QStringLiteral( "@var_int * \"int\" || @var_string" );
+      QTest::newRow( "lazy function" ) << QStringLiteral( "if( \"int\" > 2, \"double\", \"string\" )" );
+      QTest::newRow( "in" ) << QStringLiteral( "\"int\" IN (1, 3, 5)" );
+      QTest::newRow( "conversion error" ) << QStringLiteral( "\"string\" * 2" );
+      QTest::newRow( "error short circuit" ) << QStringLiteral( "\"int\" < 0 AND \"string\" * 2 > 1" );
+    }
+
+    void testCompiledProgramMatchesInterpreter()
+    {
+      QFETCH( QString, expression );
+
+      QgsFields fields;
+      fields.append( QgsField( QStringLiteral( "int" ), QVariant::Int ) );
+      fields.append( QgsField( QStringLiteral( "long" ), QVariant::LongLong ) );
+      fields.append( QgsField( QStringLiteral( "double" ), QVariant::Double ) );
+      fields.append( QgsField( QStringLiteral( "string" ), QVariant::String ) );
+      fields.append( QgsField( QStringLiteral( "null" ), QVariant::Int ) );
+      fields.append( QgsField( QStringLiteral( "null_string" ), QVariant::String ) );
+
+      QgsExpressionContext context;
+      QgsExpressionContextScope *scope = new QgsExpressionContextScope();
+      scope->setVariable( QStringLiteral( "var_int" ), 3 );
+      scope->setVariable( QStringLiteral( "var_string" ), QStringLiteral( "s" ) );
+      context.appendScope( scope );
+      context.setFields( fields );
+
+      QgsExpression exp( expression );
+      QVERIFY( !exp.hasParserError() );
+      exp.setCompilationEnabled( true );
+      exp.prepare( &context );
+
+      const QList< QgsAttributes > attributes
+      {
+        QgsAttributes() << 5 << 7LL << 2.5 << QStringLiteral( "abc" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+        QgsAttributes() << 1 << 1LL << 0.0 << QStringLiteral( "b" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+        QgsAttributes() << QVariant( QVariant::Int ) << 3LL << -4.0 << QStringLiteral( "xBz" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+        QgsAttributes() << 3 << 3LL << 12.0 << QStringLiteral( "12" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+      };
+
+      for ( const QgsAttributes &featureAttributes : attributes )
+      {
+        QgsFeature feature( fields );
+        feature.setAttributes( featureAttributes );
+        context.setFeature( feature );
+
+        const QVariant compiled = exp.evaluate( &context );
+        const QString compiledError = exp.evalErrorString();
+
+        // evaluate the same prepared tree through the node interpreter
+        exp.setEvalErrorString( QString() );
+        const QVariant interpreted = const_cast< QgsExpressionNode * >( exp.rootNode() )->eval( &exp, &context );
+        const QString interpretedError = exp.evalErrorString();
+
+        QCOMPARE( compiledError, interpretedError );
+        QCOMPARE( compiled.type(), interpreted.type() );
+        QCOMPARE( compiled.isNull(), interpreted.isNull() );
+        if ( compiled.type() == QVariant::Double && std::isnan( compiled.toDouble() ) )
+          QVERIFY( std::isnan( interpreted.toDouble() ) );
+        else
+          QCOMPARE( compiled, interpreted );
+      }
+    }
+
+    void testEvaluateFeatures_data()
+    {
+      testCompiledProgramMatchesInterpreter_data();
+    }
+
+    void testEvaluateFeatures()
+    {
+      QFETCH( QString, expression );
+
+      QgsFields fields;
+      fields.append( QgsField( QStringLiteral( "int" ), QVariant::Int ) );
+      fields.append( QgsField( QStringLiteral( "long" ), QVariant::LongLong ) );
+      fields.append( QgsField( QStringLiteral( "double" ), QVariant::Double ) );
+      fields.append( QgsField( QStringLiteral( "string" ), QVariant::String ) );
+      fields.append( QgsField( QStringLiteral( "null" ), QVariant::Int ) );
+      fields.append( QgsField( QStringLiteral( "null_string" ), QVariant::String ) );
+
+      QgsExpressionContext context;
+      QgsExpressionContextScope *scope = new QgsExpressionContextScope();
+      scope->setVariable( QStringLiteral( "var_int" ), 3 );
+      scope->setVariable( QStringLiteral( "var_string" ), QStringLiteral( "s" ) );
+      context.appendScope( scope );
+      context.setFields( fields );
+
+      QgsExpression exp( expression );
+      QVERIFY( !exp.hasParserError() );
+      exp.setCompilationEnabled( true );
+      exp.prepare( &context );
+
+      const QList< QgsAttributes > attributes
+      {
+        QgsAttributes() << 5 << 7LL << 2.5 << QStringLiteral( "abc" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+        QgsAttributes() << 1 << 1LL << 0.0 << QStringLiteral( "b" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+        QgsAttributes() << QVariant( QVariant::Int ) << 3LL << -4.0 << QStringLiteral( "xBz" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+        QgsAttributes() << 3 << 3LL << 12.0 << QStringLiteral( "12" ) << QVariant( QVariant::Int ) << QVariant( QVariant::String ),
+      };
+
+      QgsFeatureList features;
+      for ( int i = 0; i < 10; ++i )
+      {
+        QgsFeature feature( fields, i );
+        feature.setAttributes( attributes.at( i % attributes.size() ) );
+        features << feature;
+      }
+
+      QVariantList expected;
+      QString expectedError;
+      for ( const QgsFeature &feature : std::as_const( features ) )
+      {
+        context.setFeature( feature );
+        expected << exp.evaluate( &context );
+        if ( exp.hasEvalError() )
+          expectedError = exp.evalErrorString();
+      }
+
+      const QVariantList results = exp.evaluateFeatures( features, &context );
+      QCOMPARE( exp.evalErrorString(), expectedError );
+      QCOMPARE( results.size(), expected.size() );
+      for ( int i = 0; i < results.size(); ++i )
+      {
+        QCOMPARE( results.at( i ).type(), expected.at( i ).type() );
+        QCOMPARE( results.at( i ).isNull(), expected.at( i ).isNull() );
+        if ( results.at( i ).type() == QVariant::Double && std::isnan( results.at( i ).toDouble() ) )
+          QVERIFY( std::isnan( expected.at( i ).toDouble() ) );
+        else
+          QCOMPARE( results.at( i ), expected.at( i ) );
+      }
+      QCOMPARE( context.feature().id(), features.last().id() );
+    }
+
     void testExpressionUtilsToLocalizedString()
     {
       const QVariant t_int( 12346 );
@@ -22,6 +22,7 @@
 #include "qgsproject.h"
 #include "qgscolorscheme.h"
 #include "qgsexpressioncontextutils.h"
+#include "qgsproperty.h"
 
 #include <QObject>
 #include "qgstest.h"
@@ -37,6 +38,7 @@ class TestQgsExpressionContext : public QObject
     void cleanup();// will be called after every testfunction.
     void contextScope();
     void contextScopeCopy();
+    void contextScopeKnownVariables();
     void contextScopeFunctions();
     void contextStack();
     void scopeByName();
@@ -222,6 +224,75 @@ void TestQgsExpressionContext::contextScopeCopy()
   QVERIFY( copy.function( "get_test_value" ) );
 }
 
+void TestQgsExpressionContext::contextScopeKnownVariables()
+{
+  QgsExpressionContextScope scope;
+  QVERIFY( !scope.hasKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum ) );
+  QVERIFY( !scope.knownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum ).isValid() );
+
+  // well known variables are visible by name
+  scope.setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum, 3 );
+  QVERIFY( scope.hasKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum ) );
+  QCOMPARE( scope.knownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum ).toInt(), 3 );
+  QVERIFY( scope.hasVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM ) );
+  QCOMPARE( scope.variable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM ).toInt(), 3 );
+  QVERIFY( scope.isReadOnly( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM ) );
+  QCOMPARE( scope.variableNames(), QStringList() << QgsExpressionContext::EXPR_GEOMETRY_PART_NUM );
+  QCOMPARE( scope.variableCount(), 1 );
+
+  // and variables set by name use the well known slots
+  scope.addVariable( QgsExpressionContextScope::StaticVariable( QStringLiteral( "map_scale" ), 1000.0, true, true, QStringLiteral( "scale" ) ) );
+  scope.setVariable( QStringLiteral( "test" ), 5 );
+  QCOMPARE( scope.knownVariable( QgsExpressionContextScope::KnownVariable::MapScale ).toDouble(), 1000.0 );
+  QVERIFY( scope.isStatic( QStringLiteral( "map_scale" ) ) );
+  QCOMPARE( scope.description( QStringLiteral( "map_scale" ) ), QStringLiteral( "scale" ) );
+  QCOMPARE( scope.variableCount(), 3 );
+
+  QgsExpressionContextScope copy( scope );
+  QCOMPARE( copy.knownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum ).toInt(), 3 );
+  QCOMPARE( copy.variable( QStringLiteral( "map_scale" ) ).toDouble(), 1000.0 );
+
+  QVERIFY( scope.removeVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM ) );
+  QVERIFY( !scope.removeVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM ) );
+  QVERIFY( !scope.hasKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum ) );
+  QCOMPARE( scope.variableCount(), 2 );
+
+  // the last scope setting a well known variable wins
+  QgsExpressionContext context;
+  QgsExpressionContextScope *lowerScope = new QgsExpressionContextScope();
+  lowerScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolColor, QStringLiteral( "red" ) );
+  lowerScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum, 1 );
+  context.appendScope( lowerScope );
+  QgsExpressionContextScope *upperScope = new QgsExpressionContextScope();
+  upperScope->setVariable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM, 2 );
+  context.appendScope( upperScope );
+  QCOMPARE( context.knownVariable( QgsExpressionContextScope::KnownVariable::SymbolColor ).toString(), QStringLiteral( "red" ) );
+  QCOMPARE( context.knownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum ).toInt(), 2 );
+  QCOMPARE( context.variable( QgsExpressionContext::EXPR_GEOMETRY_PART_NUM ).toInt(), 2 );
+  QVERIFY( !context.knownVariable( QgsExpressionContextScope::KnownVariable::ClusterSize ).isValid() );
+
+  QgsExpression partExp( QStringLiteral( "@geometry_part_num * 10" ) );
+  partExp.prepare( &context );
+  QCOMPARE( partExp.evaluate( &context ).toInt(), 20 );
+  upperScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::GeometryPartNum, 4 );
+  QCOMPARE( partExp.evaluate( &context ).toInt(), 40 );
+
+  // data defined properties read the slots resolved when they are prepared
+  const QgsProperty colorProperty = QgsProperty::fromExpression( QStringLiteral( "var('symbol_color')" ) );
+  QVERIFY( colorProperty.prepare( context ) );
+  QCOMPARE( colorProperty.value( context ).toString(), QStringLiteral( "red" ) );
+  lowerScope->setKnownVariable( QgsExpressionContextScope::KnownVariable::SymbolColor, QStringLiteral( "blue" ) );
+  QCOMPARE( colorProperty.value( context ).toString(), QStringLiteral( "blue" ) );
+
+  // variable names built at evaluation time are still looked up by name
+  QgsExpression dynamicExp( QStringLiteral( "var('geometry_' || 'part_num')" ) );
+  dynamicExp.prepare( &context );
+  QCOMPARE( dynamicExp.evaluate( &context ).toInt(), 4 );
+
+  // as are names which are not well known
+  QCOMPARE( QgsExpression( QStringLiteral( "@symbol_colour" ) ).evaluate( &context ), QVariant() );
+}
+
 void TestQgsExpressionContext::contextScopeFunctions()
 {
   QgsExpressionContextScope scope;
@@ -27,6 +27,9 @@
 #include <QPointF>
 #include <QImage>
 #include <QPainter>
+#include <QtConcurrentMap>
+#include <QThread>
+#include <numeric>
 
 //qgis includes...
 #include <qgsapplication.h>
@@ -183,6 +186,8 @@ class TestQgsGeometry : public QObject
 
     void intersectionCheck1();
     void intersectionCheck2();
+    void predicatesAfterModification();
+    void predicatesAfterPartEdit();
     void translateCheck1();
     void rotateCheck1();
     void unionCheck1();
@@ -17970,6 +17975,101 @@ void TestQgsGeometry::intersectionCheck2()
   QVERIFY( !mpPolygonGeometryA.intersects( mpPolygonGeometryC ) );
 }
 
+void TestQgsGeometry::predicatesAfterPartEdit()
+{
+  // parts edited through the part iterators must not be tested with a stale GEOS representation
+  const QgsGeometry other = QgsGeometry::fromWkt( QStringLiteral( "Point (5 5)" ) );
+
+  QgsGeometry geom = QgsGeometry::fromWkt( QStringLiteral( "MultiPolygon (((0 0, 10 0, 10 10, 0 10, 0 0)),((20 0, 30 0, 30 10, 20 10, 20 0)))" ) );
+  QVERIFY( geom.intersects( other ) );
+  for ( auto it = geom.parts_begin(); it != geom.parts_end(); ++it )
+    ( *it )->transform( QTransform::fromTranslate( 100, 0 ) );
+  QVERIFY( !geom.intersects( other ) );
+  QVERIFY( geom.disjoint( other ) );
+
+  geom = QgsGeometry::fromWkt( QStringLiteral( "MultiPolygon (((0 0, 10 0, 10 10, 0 10, 0 0)),((20 0, 30 0, 30 10, 20 10, 20 0)))" ) );
+  QVERIFY( geom.contains( other ) );
+  QgsGeometryPartIterator parts = geom.parts();
+  while ( parts.hasNext() )
+    parts.next()->transform( QTransform::fromTranslate( 100, 0 ) );
+  QVERIFY( !geom.contains( other ) );
+  QVERIFY( !geom.intersects( other ) );
+}
+
+void TestQgsGeometry::predicatesAfterModification()
+{
+  // predicates reuse the GEOS representation of the geometries, make sure it follows changes
+  QgsGeometry geom = QgsGeometry::fromWkt( QStringLiteral( "Polygon ((0 0, 10 0, 10 10, 0 10, 0 0))" ) );
+  const QgsGeometry other = QgsGeometry::fromWkt( QStringLiteral( "Point (5 5)" ) );
+  QVERIFY( geom.intersects( other ) );
+  QVERIFY( geom.contains( other ) );
+  QVERIFY( other.within( geom ) );
+
+  // shared copy, then modified in place
+  QgsGeometry copy = geom;
+  copy.translate( 100, 0 );
+  QVERIFY( !copy.intersects( other ) );
+  QVERIFY( copy.disjoint( other ) );
+  QVERIFY( geom.intersects( other ) );
+
+  // modified in place through the internal geometry
+  geom.translate( 100, 0 );
+  QVERIFY( !geom.intersects( other ) );
+  geom.get()->transform( QTransform::fromTranslate( -100, 0 ) );
+  QVERIFY( geom.intersects( other ) );
+  geom.get()->transform( QTransform::fromTranslate( -100, 0 ) );
+  QVERIFY( !geom.intersects( other ) );
+
+  // converted and edited
+  geom = QgsGeometry::fromWkt( QStringLiteral( "Point (5 5)" ) );
+  QVERIFY( geom.intersects( other ) );
+  QVERIFY( !geom.touches( other ) );
+  QVERIFY( geom.convertToMultiType() );
+  QVERIFY( geom.intersects( other ) );
+  QVERIFY( geom.moveVertex( 6, 5, 0 ) );
+  QVERIFY( !geom.intersects( other ) );
+
+  // evaluated from other threads
+  geom = QgsGeometry::fromWkt( QStringLiteral( "Polygon ((0 0, 10 0, 10 10, 0 10, 0 0))" ) );
+  QVERIFY( geom.contains( other ) );
+  QVector< int > results( 64 );
+  QtConcurrent::blockingMap( results, [&geom, &other]( int & result )
+  {
+    // shared copies of the same geometry
+    const QgsGeometry threadGeom = geom;
+    const QgsGeometry threadOther = other;
+    result = threadGeom.contains( threadOther ) && !threadGeom.crosses( threadOther ) ? 1 : 0;
+  } );
+  QCOMPARE( std::accumulate( results.constBegin(), results.constEnd(), 0 ), 64 );
+
+  // threads started after others finished never reuse their engines
+  for ( int i = 0; i < 8; ++i )
+  {
+    bool threadResult = false;
+    std::unique_ptr< QThread > thread( QThread::create( [&geom, &other, &threadResult]
+    {
+      threadResult = geom.contains( other ) && !geom.touches( other );
+    } ) );
+    thread->start();
+    QVERIFY( thread->wait() );
+    QVERIFY( threadResult );
+  }
+
+  // the engine of the receiving geometry is prepared once it is reused
+  const QgsGeometry inside = QgsGeometry::fromWkt( QStringLiteral( "Point (1 1)" ) );
+  const QgsGeometry outside = QgsGeometry::fromWkt( QStringLiteral( "Point (20 20)" ) );
+  const QgsGeometry boundary = QgsGeometry::fromWkt( QStringLiteral( "Point (0 5)" ) );
+  for ( int i = 0; i < 3; ++i )
+  {
+    QVERIFY( geom.contains( inside ) );
+    QVERIFY( !geom.contains( outside ) );
+    QVERIFY( geom.disjoint( outside ) );
+    QVERIFY( geom.touches( boundary ) );
+    QVERIFY( !geom.contains( boundary ) );
+    QVERIFY( inside.within( geom ) );
+  }
+}
+
 void TestQgsGeometry::translateCheck1()
 {
   QString wkt = QStringLiteral( "LineString (0 0, 10 0, 10 10)" );
@@ -82,6 +82,7 @@ class TestQgsGML : public QObject
     void testThroughOGRGeometry_urn_EPSG_4326();
     void testAccents();
     void testSameTypeameAsGeomName();
+    void testParallelParsing();
 };
 
 const QString data1( "<myns:FeatureCollection "
@@ -1273,5 +1274,79 @@ void TestQgsGML::testSameTypeameAsGeomName()
   delete features[0].first;
 }
 
+void TestQgsGML::testParallelParsing()
+{
+  // large enough to be split in several batches
+  QByteArray data( "<?xml version='1.0' encoding='UTF-8'?>"
+                   "<myns:FeatureCollection "
+                   "xmlns:myns='http://myns' "
+                   "xmlns:gml='http://www.opengis.net/gml'>"
+                   "<gml:boundedBy><gml:null>unknown</gml:null></gml:boundedBy>" );
+  const int featureCount = 40000;
+  for ( int i = 0; i < featureCount; ++i )
+  {
+    data += QStringLiteral( "<gml:featureMember>"
+                            "<myns:mytypename fid='mytypename.%1'>"
+                            "<myns:intfield>%1</myns:intfield>"
+                            "<!-- comment with <myns:mytypename> -->"
+                            "<myns:strfield><![CDATA[<%1>]]></myns:strfield>"
+                            "<myns:mygeom>" ).arg( i ).toUtf8();
+    if ( i % 1000 == 999 )
+    {
+      data += QStringLiteral( "<gml:MultiPoint>"
+                              "<gml:pointMember><gml:Point><gml:coordinates>%1,2</gml:coordinates></gml:Point></gml:pointMember>"
+                              "</gml:MultiPoint>" ).arg( i ).toUtf8();
+    }
+    else
+    {
+      // the CRS is only known from the first geometry
+      data += QStringLiteral( "<gml:Point%1><gml:coordinates>%2,1</gml:coordinates></gml:Point>" )
+              .arg( i == 0 ? QStringLiteral( " srsName='EPSG:27700'" ) : QString() ).arg( i ).toUtf8();
+    }
+    data += "</myns:mygeom></myns:mytypename></gml:featureMember>";
+  }
+  data += "</myns:FeatureCollection>";
+
+  QgsFields fields;
+  fields.append( QgsField( QStringLiteral( "intfield" ), QVariant::Int, QStringLiteral( "int" ) ) );
+  fields.append( QgsField( QStringLiteral( "strfield" ), QVariant::String, QStringLiteral( "string" ) ) );
+
+  QgsGmlStreamingParser sequentialParser( QStringLiteral( "mytypename" ), QStringLiteral( "mygeom" ), fields );
+  QVERIFY( sequentialParser.processData( data, true ) );
+  QVector<QgsGmlStreamingParser::QgsGmlFeaturePtrGmlIdPair> expected = sequentialParser.getAndStealReadyFeatures();
+  QCOMPARE( expected.size(), featureCount );
+
+  QgsGmlStreamingParser parallelParser( QStringLiteral( "mytypename" ), QStringLiteral( "mygeom" ), fields );
+  parallelParser.setParallelParsingEnabled( true );
+  QVector<QgsGmlStreamingParser::QgsGmlFeaturePtrGmlIdPair> features;
+  // data is received in pieces which are not aligned on elements
+  const int pieceSize = data.size() / 3 + 17;
+  for ( int start = 0; start < data.size(); start += pieceSize )
+  {
+    QVERIFY( parallelParser.processData( data.mid( start, pieceSize ), start + pieceSize >= data.size() ) );
+    features += parallelParser.getAndStealReadyFeatures();
+  }
+
+  QCOMPARE( parallelParser.isException(), false );
+  QCOMPARE( parallelParser.getEPSGCode(), sequentialParser.getEPSGCode() );
+  QCOMPARE( parallelParser.getEPSGCode(), 27700 );
+  QCOMPARE( parallelParser.wkbType(), sequentialParser.wkbType() );
+  QCOMPARE( parallelParser.layerExtent(), sequentialParser.layerExtent() );
+  QCOMPARE( features.size(), expected.size() );
+  for ( int i = 0; i < features.size(); ++i )
+  {
+    QCOMPARE( features[i].first->id(), expected[i].first->id() );
+    QCOMPARE( features[i].second, expected[i].second );
+    QCOMPARE( features[i].first->attributes(), expected[i].first->attributes() );
+    QCOMPARE( features[i].first->geometry().asWkt(), expected[i].first->geometry().asWkt() );
+  }
+  QCOMPARE( features[1].first->attributes().at( 1 ), QVariant( "<1>" ) );
+
+  for ( const QgsGmlStreamingParser::QgsGmlFeaturePtrGmlIdPair &featPair : std::as_const( features ) )
+    delete featPair.first;
+  for ( const QgsGmlStreamingParser::QgsGmlFeaturePtrGmlIdPair &featPair : std::as_const( expected ) )
+    delete featPair.first;
+}
+
 QGSTEST_MAIN( TestQgsGML )
 #include "testqgsgml.moc"
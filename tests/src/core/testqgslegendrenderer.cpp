@@ -30,6 +30,7 @@
 #include "qgslayertreemodel.h"
 #include "qgslayertreemodellegendnode.h"
 #include "qgslinesymbollayer.h"
+#include "qgsmaphittest.h"
 #include "qgsmaplayerlegend.h"
 #include "qgspainteffect.h"
 #include "qgsproject.h"
@@ -189,6 +190,7 @@ class TestQgsLegendRenderer : public QObject
     void testThreeColumns();
     void testFilterByMap();
     void testFilterByMapSameSymbol();
+    void testFilterByMapCache();
     void testColumns_data();
     void testColumns();
     void testColumnBreaks();
@@ -977,6 +979,68 @@ void TestQgsLegendRenderer::testFilterByMapSameSymbol()
   QgsProject::instance()->removeMapLayer( vl4 );
 }
 
+void TestQgsLegendRenderer::testFilterByMapCache()
+{
+  const QgsLegendSymbolList items = mVL3->renderer()->legendSymbolItems();
+  QCOMPARE( items.size(), 3 );
+
+  auto visibleKeys = [ = ]( const QgsRectangle & extent )
+  {
+    QgsMapSettings mapSettings;
+    mapSettings.setExtent( extent );
+    mapSettings.setOutputSize( QSize( 400, 100 ) );
+    mapSettings.setOutputDpi( 96 );
+    mapSettings.setLayers( QList<QgsMapLayer *>() << mVL3 );
+
+    QgsMapHitTest hitTest( mapSettings );
+    hitTest.run();
+    QStringList labels;
+    for ( const QgsLegendSymbolItem &item : items )
+    {
+      if ( hitTest.legendKeyVisible( item.ruleKey(), mVL3 ) )
+        labels << item.label();
+    }
+    return labels;
+  };
+
+  const QList< QgsRectangle > extents
+  {
+    QgsRectangle( 0, 0, 10.0, 4.0 ),
+    QgsRectangle( 0, 0, 10.0, 4.0 ),
+    QgsRectangle( 0.5, 0, 10.5, 4.0 ),
+    QgsRectangle( 2.0, 0, 12.0, 4.0 ),
+    QgsRectangle( 0, 3.0, 10.0, 7.0 ),
+    QgsRectangle( -100, -100, 100, 100 ),
+    QgsRectangle( 4.9, 4.9, 5.1, 5.1 )
+  };
+
+  // results of uncached runs
+  QList< QStringList > expected;
+  for ( const QgsRectangle &extent : extents )
+    expected << visibleKeys( extent );
+  QCOMPARE( expected.at( 0 ), QStringList() << QStringLiteral( "Red" ) << QStringLiteral( "Green" ) );
+  QCOMPARE( expected.at( 3 ), QStringList() << QStringLiteral( "Green" ) );
+  QCOMPARE( expected.at( 5 ), QStringList() << QStringLiteral( "Red" ) << QStringLiteral( "Green" ) << QStringLiteral( "Blue" ) );
+
+  // overlapping extents reuse the stored tiles and must give the same results
+  QgsMapHitTest::setCacheMaxAge( 60 );
+  QCOMPARE( QgsMapHitTest::cacheMaxAge(), 60 );
+  for ( int pass = 0; pass < 2; ++pass )
+  {
+    for ( int i = 0; i < extents.size(); ++i )
+      QCOMPARE( visibleKeys( extents.at( i ) ), expected.at( i ) );
+  }
+
+  // a renderer change must not reuse stored results
+  QgsCategorizedSymbolRenderer *renderer = static_cast<QgsCategorizedSymbolRenderer *>( mVL3->renderer() );
+  renderer->updateCategoryRenderState( 0, false );
+  QCOMPARE( visibleKeys( extents.at( 0 ) ), QStringList() << QStringLiteral( "Green" ) );
+  renderer->updateCategoryRenderState( 0, true );
+
+  QgsMapHitTest::setCacheMaxAge( 0 );
+  QgsMapHitTest::clearCache();
+}
+
 bool TestQgsLegendRenderer::_testLegendColumns( int itemCount, int columnCount, const QString &testName )
 {
   QgsFillSymbol *sym = new QgsFillSymbol();
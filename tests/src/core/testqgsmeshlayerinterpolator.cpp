@@ -39,6 +39,7 @@ class TestQgsMeshLayerInterpolator: public QObject
     void cleanup() {} // will be called after every testfunction.
 
     void testExportRasterBand();
+    void testExportRasterBandMultiThreaded();
   private:
     QString mTestDataDir;
 };
@@ -89,5 +90,50 @@ void TestQgsMeshLayerInterpolator::testExportRasterBand()
   QVERIFY( block->isNoData( 10, 10 ) );
 }
 
+void TestQgsMeshLayerInterpolator::testExportRasterBandMultiThreaded()
+{
+  QgsMeshLayer memoryLayer( mTestDataDir + "/mesh/quad_and_triangle.2dm",
+                            "Triangle and Quad Mdal",
+                            "mdal" );
+  QVERIFY( memoryLayer.isValid() );
+  QgsMeshDatasetIndex index( 0, 0 ); // bed elevation
+  memoryLayer.setCrs( QgsCoordinateReferenceSystem::fromEpsgId( 27700 ) );
+
+  std::unique_ptr< QgsRasterBlock > coarseBlock( QgsMeshUtils::exportRasterBlock(
+        memoryLayer,
+        index,
+        memoryLayer.crs(),
+        QgsProject::instance()->transformContext(),
+        100,
+        memoryLayer.extent() ) );
+
+  // large enough to be split in bands interpolated on several threads
+  std::unique_ptr< QgsRasterBlock > fineBlock( QgsMeshUtils::exportRasterBlock(
+        memoryLayer,
+        index,
+        memoryLayer.crs(),
+        QgsProject::instance()->transformContext(),
+        1,
+        memoryLayer.extent() ) );
+
+  QCOMPARE( fineBlock->width(), 2000 );
+  QCOMPARE( fineBlock->height(), 1000 );
+  QVERIFY( fineBlock->isValid() );
+
+  // pixels sharing the same map position must get the same value
+  for ( int row = 0; row < coarseBlock->height(); ++row )
+  {
+    for ( int col = 0; col < coarseBlock->width(); ++col )
+    {
+      QCOMPARE( fineBlock->isNoData( row * 100, col * 100 ), coarseBlock->isNoData( row, col ) );
+      if ( !coarseBlock->isNoData( row, col ) )
+        QGSCOMPARENEAR( fineBlock->value( row * 100, col * 100 ), coarseBlock->value( row, col ), 1e-6 );
+    }
+  }
+
+  QCOMPARE( fineBlock->value( 0, 0 ), 10.0 );
+  QGSCOMPARENEAR( fineBlock->value( 500, 500 ), 35.0, 1e-6 );
+}
+
 QGSTEST_MAIN( TestQgsMeshLayerInterpolator )
 #include "testqgsmeshlayerinterpolator.moc"
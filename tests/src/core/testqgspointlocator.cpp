@@ -305,6 +305,72 @@ class TestQgsPointLocator : public QObject
       QCOMPARE( m2.point(), QgsPointXY( 1, 1 ) );
     }
 
+    void testExtendExtent()
+    {
+      // points in the middle of unit tiles along the x axis
+      QgsVectorLayer layer( QStringLiteral( "Point" ), QStringLiteral( "x" ), QStringLiteral( "memory" ) );
+      QgsFeatureList flist;
+      for ( int i = 0; i < 10; ++i )
+      {
+        QgsFeature ff;
+        ff.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( i + 0.5, 0.5 ) ) );
+        flist << ff;
+      }
+      layer.dataProvider()->addFeatures( flist );
+
+      QgsPointLocator loc( &layer );
+      loc.extendExtent( QgsRectangle( 0.2, 0.2, 1.8, 0.8 ), 1 );
+      QVERIFY( !loc.coversExtent( QgsRectangle( 0.4, 0.4, 0.6, 0.6 ) ) );
+      QVERIFY( loc.init() );
+      QCOMPARE( loc.cachedGeometryCount(), 2 );
+      QCOMPARE( loc.cachedVertexCount(), 2 );
+      QVERIFY( loc.coversExtent( QgsRectangle( 0.4, 0.4, 1.6, 0.6 ) ) );
+      QVERIFY( !loc.coversExtent( QgsRectangle( 2.4, 0.4, 2.6, 0.6 ) ) );
+
+      // indexed tiles are kept, only the new ones are fetched
+      loc.extendExtent( QgsRectangle( 1.2, 0.2, 3.8, 0.8 ), 1 );
+      QVERIFY( loc.init() );
+      QCOMPARE( loc.cachedGeometryCount(), 4 );
+      QVERIFY( loc.coversExtent( QgsRectangle( 0.4, 0.4, 3.6, 0.6 ) ) );
+      QgsPointLocator::Match m = loc.nearestVertex( QgsPointXY( 3.4, 0.5 ), 0.2 );
+      QVERIFY( m.isValid() );
+      QCOMPARE( m.point(), QgsPointXY( 3.5, 0.5 ) );
+
+      // tiles furthest from the last extent are dropped when exceeding the vertex limit
+      loc.setMaxCachedVertices( 3 );
+      loc.extendExtent( QgsRectangle( 4.2, 0.2, 4.8, 0.8 ), 1 );
+      QVERIFY( loc.init() );
+      QCOMPARE( loc.cachedVertexCount(), 3 );
+      QVERIFY( !loc.coversExtent( QgsRectangle( 0.4, 0.4, 1.6, 0.6 ) ) );
+      QVERIFY( loc.coversExtent( QgsRectangle( 2.4, 0.4, 4.6, 0.6 ) ) );
+      QVERIFY( !loc.nearestVertex( QgsPointXY( 0.5, 0.5 ), 0.2 ).isValid() );
+      QVERIFY( loc.nearestVertex( QgsPointXY( 2.5, 0.5 ), 0.2 ).isValid() );
+
+      // edits update the index incrementally
+      layer.startEditing();
+      QgsFeature ff;
+      ff.setGeometry( QgsGeometry::fromPointXY( QgsPointXY( 4.5, 0.7 ) ) );
+      layer.addFeature( ff );
+      QCOMPARE( loc.cachedGeometryCount(), 4 );
+      m = loc.nearestVertex( QgsPointXY( 4.5, 0.75 ), 0.1 );
+      QVERIFY( m.isValid() );
+      QCOMPARE( m.point(), QgsPointXY( 4.5, 0.7 ) );
+      layer.rollBack();
+
+      // setting an extent discards the tiles
+      QgsRectangle bbox( 0, 0, 2, 1 );
+      loc.setExtent( &bbox );
+      QVERIFY( !loc.hasIndex() );
+      QVERIFY( loc.coversExtent( QgsRectangle( 0.4, 0.4, 1.6, 0.6 ) ) );
+      QVERIFY( !loc.coversExtent( QgsRectangle( 2.4, 0.4, 2.6, 0.6 ) ) );
+
+      // the vertex limit does not apply to indexes which are not extended by tiles
+      loc.setExtent( nullptr );
+      QVERIFY( loc.init() );
+      QCOMPARE( loc.cachedGeometryCount(), 10 );
+      QCOMPARE( loc.cachedVertexCount(), 10 );
+    }
+
     void testNullGeometries()
     {
       QgsVectorLayer *vlNullGeom = new QgsVectorLayer( QStringLiteral( "Polygon" ), QStringLiteral( "x" ), QStringLiteral( "memory" ) );
@@ -16,6 +16,7 @@
 
 #include <QObject>
 #include <QSignalSpy>
+#include <QThread>
 
 #include "qgsapplication.h"
 #include "qgsmarkersymbollayer.h"
@@ -26,9 +27,12 @@
 #include "qgssettings.h"
 #include "qgsunittypes.h"
 #include "qgsvectorlayer.h"
+#include "qgsvectordataprovider.h"
 #include "qgssymbollayerutils.h"
 #include "qgslayoutmanager.h"
 #include "qgsmarkersymbol.h"
+#include "qgsproviderregistry.h"
+#include "qgsprovidermetadata.h"
 
 class TestQgsProject : public QObject
 {
@@ -59,6 +63,7 @@ class TestQgsProject : public QObject
     void testAttachmentsQgs();
     void testAttachmentsQgz();
     void testAttachmentIdentifier();
+    void testThreadInstance();
 };
 
 void TestQgsProject::init()
@@ -476,6 +481,29 @@ void TestQgsProject::testReadFlags()
   layers = p.mapLayers();
   QVERIFY( layers.value( QStringLiteral( "polys20170310142652234" ) )->originalXmlProperties().isEmpty() );
 
+  // create providers concurrently
+  QgsProject pParallel;
+  QVERIFY( pParallel.read( project1Path, QgsProject::ReadFlag::FlagLoadLayersInParallel ) );
+  QCOMPARE( pParallel.mapLayers().count(), 3 );
+  QVERIFY( p.read( project1Path ) );
+  const QMap<QString, QgsMapLayer *> parallelLayers = pParallel.mapLayers();
+  for ( auto it = parallelLayers.constBegin(); it != parallelLayers.constEnd(); ++it )
+  {
+    QgsVectorLayer *parallelLayer = qobject_cast< QgsVectorLayer * >( it.value() );
+    QgsVectorLayer *layer = qobject_cast< QgsVectorLayer * >( p.mapLayer( it.key() ) );
+    QVERIFY( parallelLayer->isValid() );
+    QCOMPARE( parallelLayer->dataProvider()->thread(), pParallel.thread() );
+    QCOMPARE( parallelLayer->dataProvider()->parent(), parallelLayer );
+    QCOMPARE( parallelLayer->source(), layer->source() );
+    QCOMPARE( parallelLayer->featureCount(), layer->featureCount() );
+    QCOMPARE( parallelLayer->renderer()->type(), QStringLiteral( "categorizedSymbol" ) );
+  }
+
+  // postgres connections opened outside of the main thread are not shared, one would be kept per layer
+  QVERIFY( QgsProviderRegistry::instance()->providerMetadata( QStringLiteral( "ogr" ) )->providerCapabilities() & QgsProviderMetadata::ParallelCreateProvider );
+  if ( QgsProviderMetadata *postgresMetadata = QgsProviderRegistry::instance()->providerMetadata( QStringLiteral( "postgres" ) ) )
+    QVERIFY( !( postgresMetadata->providerCapabilities() & QgsProviderMetadata::ParallelCreateProvider ) );
+
   // project with embedded groups
   QString project2Path = QString( TEST_DATA_DIR ) + QStringLiteral( "/embedded_groups/project2.qgs" );
   QgsProject p2;
@@ -904,6 +932,52 @@ void TestQgsProject::testAttachmentIdentifier()
   }
 }
 
+void TestQgsProject::testThreadInstance()
+{
+  QgsProject *instance = QgsProject::instance();
+  QVERIFY( !QgsProject::threadInstance() );
+
+  QgsProject threadProject;
+  QgsProject *otherThreadInstance = nullptr;
+  QgsProject *otherThreadInstanceAfterReset = nullptr;
+  QThread *thread = QThread::create( [&]
+  {
+    QgsProject::setThreadInstance( &threadProject );
+    otherThreadInstance = QgsProject::instance();
+    QgsProject::setThreadInstance( nullptr );
+    otherThreadInstanceAfterReset = QgsProject::instance();
+  } );
+  thread->start();
+  thread->wait();
+  delete thread;
+
+  // the project is only the current project of the thread which set it
+  QCOMPARE( otherThreadInstance, &threadProject );
+  QCOMPARE( otherThreadInstanceAfterReset, instance );
+  QCOMPARE( QgsProject::instance(), instance );
+  QVERIFY( !QgsProject::threadInstance() );
+
+  QgsProject::setThreadInstance( &threadProject );
+  QCOMPARE( QgsProject::instance(), &threadProject );
+
+  // the singleton does not replace the project of the thread
+  QgsProject otherProject;
+  QgsProject::setInstance( &otherProject );
+  QCOMPARE( QgsProject::instance(), &threadProject );
+  QgsProject::setInstance( instance );
+
+  QgsProject::setThreadInstance( nullptr );
+  QCOMPARE( QgsProject::instance(), instance );
+
+  // deleting the project of the thread resets it
+  QgsProject *deletedProject = new QgsProject();
+  QgsProject::setThreadInstance( deletedProject );
+  QCOMPARE( QgsProject::instance(), deletedProject );
+  delete deletedProject;
+  QVERIFY( !QgsProject::threadInstance() );
+  QCOMPARE( QgsProject::instance(), instance );
+}
+
 
 QGSTEST_MAIN( TestQgsProject )
 #include "testqgsproject.moc"
@@ -0,0 +1,148 @@
+/***************************************************************************
+     testqgstilecache.cpp
+     --------------------
+    Date                 : October 2021
+    Copyright            : (C) 2021 by QGIS contributors
+ ***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+#include "qgstest.h"
+#include <QObject>
+#include <QAtomicInt>
+#include <QImage>
+#include <QtConcurrent>
+
+#include <numeric>
+
+#include "qgsapplication.h"
+#include "qgstilecache.h"
+
+/**
+ * \ingroup UnitTests
+ * This is a unit test for QgsTileCache.
+ */
+class TestQgsTileCache : public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    void initTestCase();// will be called before the first testfunction is executed.
+    void cleanupTestCase();// will be called after the last testfunction was executed.
+    void insertAndLookup();
+    void eviction();
+    void concurrentAccess();
+
+  private:
+    static QUrl tileUrl( int index );
+    static QImage tileImage( int index );
+    //! Returns TRUE if the \a image is the tile created for \a index
+    static bool isTile( const QImage &image, int index );
+};
+
+
+void TestQgsTileCache::initTestCase()
+{
+  QgsApplication::init();
+  QgsApplication::initQgis();
+}
+
+void TestQgsTileCache::cleanupTestCase()
+{
+  QgsApplication::exitQgis();
+}
+
+QUrl TestQgsTileCache::tileUrl( int index )
+{
+  return QUrl( QStringLiteral( "http://tiles.example.com/%1.png" ).arg( index ) );
+}
+
+QImage TestQgsTileCache::tileImage( int index )
+{
+  QImage image( 4, 4, QImage::Format_ARGB32 );
+  image.fill( qRgb( index % 256, ( index / 256 ) % 256, 0 ) );
+  return image;
+}
+
+bool TestQgsTileCache::isTile( const QImage &image, int index )
+{
+  return image.size() == QSize( 4, 4 ) && image.pixel( 2, 2 ) == qRgb( index % 256, ( index / 256 ) % 256, 0 );
+}
+
+void TestQgsTileCache::insertAndLookup()
+{
+  QImage image;
+  QVERIFY( !QgsTileCache::tile( tileUrl( -1 ), image ) );
+
+  for ( int i = 0; i < 10; ++i )
+    QgsTileCache::insertTile( tileUrl( i ), tileImage( i ) );
+
+  for ( int i = 0; i < 10; ++i )
+  {
+    QVERIFY( QgsTileCache::tile( tileUrl( i ), image ) );
+    QVERIFY( isTile( image, i ) );
+  }
+
+  // replacing a tile returns the new image
+  QgsTileCache::insertTile( tileUrl( 3 ), tileImage( 300 ) );
+  QVERIFY( QgsTileCache::tile( tileUrl( 3 ), image ) );
+  QVERIFY( isTile( image, 300 ) );
+
+  QVERIFY( QgsTileCache::totalCost() <= QgsTileCache::maxCost() );
+}
+
+void TestQgsTileCache::eviction()
+{
+  // the shards together hold as many tiles as the former single cache
+  QCOMPARE( QgsTileCache::maxCost(), 256 );
+
+  const int count = 4000;
+  for ( int i = 0; i < count; ++i )
+    QgsTileCache::insertTile( tileUrl( 1000 + i ), tileImage( i ) );
+
+  // every shard is full, and none of them grows over its share
+  QCOMPARE( QgsTileCache::totalCost(), QgsTileCache::maxCost() );
+
+  // the most recent tile is kept, the oldest ones are evicted
+  QImage image;
+  QVERIFY( QgsTileCache::tile( tileUrl( 1000 + count - 1 ), image ) );
+  QVERIFY( isTile( image, count - 1 ) );
+  QVERIFY( !QgsTileCache::tile( tileUrl( 1000 ), image ) );
+  QVERIFY( !QgsTileCache::tile( tileUrl( 1001 ), image ) );
+}
+
+void TestQgsTileCache::concurrentAccess()
+{
+  QVector< int > indexes( 20000 );
+  std::iota( indexes.begin(), indexes.end(), 0 );
+
+  QAtomicInt mismatches = 0;
+  QAtomicInt hits = 0;
+  QtConcurrent::blockingMap( indexes, [&mismatches, &hits]( int &index )
+  {
+    QgsTileCache::insertTile( tileUrl( 100000 + index ), tileImage( index ) );
+
+    // tiles may have been evicted by other threads meanwhile, but never mixed up
+    QImage image;
+    if ( QgsTileCache::tile( tileUrl( 100000 + index ), image ) )
+    {
+      hits.ref();
+      if ( !isTile( image, index ) )
+        mismatches.ref();
+    }
+    const int other = ( index * 7919 ) % 20000;
+    if ( QgsTileCache::tile( tileUrl( 100000 + other ), image ) && !isTile( image, other ) )
+      mismatches.ref();
+  } );
+
+  QCOMPARE( mismatches.loadAcquire(), 0 );
+  QVERIFY( hits.loadAcquire() > 0 );
+  QVERIFY( QgsTileCache::totalCost() <= QgsTileCache::maxCost() );
+}
+
+QGSTEST_MAIN( TestQgsTileCache )
+#include "testqgstilecache.moc"
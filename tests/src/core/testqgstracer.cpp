@@ -40,6 +40,7 @@ class TestQgsTracer : public QObject
     void testButterfly();
     void testLayerUpdates();
     void testExtent();
+    void testExtentChange();
     void testReprojection();
     void testCurved();
     void testOffset();
@@ -398,6 +399,51 @@ void TestQgsTracer::testExtent()
   QCOMPARE( points2.count(), 0 );
 }
 
+void TestQgsTracer::testExtentChange()
+{
+  // check that the graph follows the extent when the linework is reused
+
+  // same shape as in testSimple()
+  QStringList wkts;
+  wkts  << QStringLiteral( "LINESTRING(0 0, 0 10)" )
+        << QStringLiteral( "LINESTRING(0 0, 10 0)" )
+        << QStringLiteral( "LINESTRING(0 10, 20 10)" )
+        << QStringLiteral( "LINESTRING(10 0, 20 10)" );
+
+  QgsVectorLayer *vl = make_layer( wkts );
+
+  QgsTracer tracer;
+  tracer.setLayers( QList<QgsVectorLayer *>() << vl );
+  tracer.setExtent( QgsRectangle( 0, 0, 5, 5 ) );
+
+  QgsPolylineXY points1 = tracer.findShortestPath( QgsPointXY( 0, 0 ), QgsPointXY( 20, 10 ) );
+  QCOMPARE( points1.count(), 0 );
+
+  // larger extent, features of the new tiles are added
+  tracer.setExtent( QgsRectangle( 0, 0, 20, 10 ) );
+  QVERIFY( !tracer.isInitialized() );
+
+  QgsPolylineXY points2 = tracer.findShortestPath( QgsPointXY( 0, 0 ), QgsPointXY( 20, 10 ) );
+  QCOMPARE( points2.count(), 3 );
+  QCOMPARE( points2[0], QgsPointXY( 0, 0 ) );
+  QCOMPARE( points2[1], QgsPointXY( 10, 0 ) );
+  QCOMPARE( points2[2], QgsPointXY( 20, 10 ) );
+
+  // smaller extent, features outside of it are not in the graph anymore
+  tracer.setExtent( QgsRectangle( 15, 5, 20, 10 ) );
+
+  QgsPolylineXY points3 = tracer.findShortestPath( QgsPointXY( 10, 0 ), QgsPointXY( 0, 10 ) );
+  QCOMPARE( points3.count(), 3 );
+  QCOMPARE( points3[0], QgsPointXY( 10, 0 ) );
+  QCOMPARE( points3[1], QgsPointXY( 20, 10 ) );
+  QCOMPARE( points3[2], QgsPointXY( 0, 10 ) );
+
+  QVERIFY( !tracer.isPointSnapped( QgsPointXY( 0, 5 ) ) );
+  QVERIFY( tracer.isPointSnapped( QgsPointXY( 15, 5 ) ) );
+
+  delete vl;
+}
+
 void TestQgsTracer::testReprojection()
 {
   QStringList wkts;
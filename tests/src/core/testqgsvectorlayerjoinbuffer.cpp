@@ -69,6 +69,7 @@ class TestVectorLayerJoinBuffer : public QObject
     void testSignals();
     void testChangeAttributeValues();
     void testCollidingNameColumn();
+    void testJoinWithoutCacheReadAhead();
 
   private:
     QgsProject mProject;
@@ -978,5 +979,102 @@ void TestVectorLayerJoinBuffer::testCollidingNameColumn()
   QCOMPARE( fA1.attribute( "value_c" ).toString(), QStringLiteral( "value_c" ) );
 }
 
+void TestVectorLayerJoinBuffer::testJoinWithoutCacheReadAhead()
+{
+  // joins without memory cache fetch the joined features for windows of target features,
+  // results must match the ones of cached joins and keep the target features order
+  mProject.clear();
+  QgsVectorLayer *vlA = new QgsVectorLayer( QStringLiteral( "Point?field=id_a:integer" ), QStringLiteral( "readAheadA" ), QStringLiteral( "memory" ) );
+  QVERIFY( vlA->isValid() );
+  QgsVectorLayer *vlB = new QgsVectorLayer( QStringLiteral( "Point?field=id_b:integer&field=value_b:integer" ), QStringLiteral( "readAheadB" ), QStringLiteral( "memory" ) );
+  QVERIFY( vlB->isValid() );
+  mProject.addMapLayer( vlA );
+  mProject.addMapLayer( vlB );
+
+  QgsFeatureList featuresA;
+  for ( int i = 0; i < 1000; ++i )
+  {
+    QgsFeature f( vlA->dataProvider()->fields() );
+    // every 7th feature has a NULL join value, values >= 40 have no joined feature
+    f.setAttribute( QStringLiteral( "id_a" ), i % 7 == 0 ? QVariant( QVariant::Int ) : QVariant( ( i * 13 ) % 50 ) );
+    featuresA << f;
+  }
+  QVERIFY( vlA->dataProvider()->addFeatures( featuresA ) );
+
+  QgsFeatureList featuresB;
+  for ( int i = 0; i < 40; ++i )
+  {
+    QgsFeature f( vlB->dataProvider()->fields() );
+    f.setAttributes( QgsAttributes() << i << i * 10 );
+    featuresB << f;
+  }
+  QgsFeature nullB( vlB->dataProvider()->fields() );
+  nullB.setAttributes( QgsAttributes() << QVariant( QVariant::Int ) << -1 );
+  featuresB << nullB;
+  QVERIFY( vlB->dataProvider()->addFeatures( featuresB ) );
+
+  auto joinedValues = [vlA, vlB]( bool memoryCache, const QgsFeatureRequest &request )
+  {
+    QgsVectorLayerJoinInfo joinInfo;
+    joinInfo.setTargetFieldName( QStringLiteral( "id_a" ) );
+    joinInfo.setJoinLayer( vlB );
+    joinInfo.setJoinFieldName( QStringLiteral( "id_b" ) );
+    joinInfo.setUsingMemoryCache( memoryCache );
+    joinInfo.setPrefix( QStringLiteral( "B_" ) );
+    vlA->addJoin( joinInfo );
+
+    QList< QPair< QgsFeatureId, QVariant > > values;
+    QgsFeatureIterator it = vlA->getFeatures( request );
+    QgsFeature f;
+    while ( it.nextFeature( f ) )
+      values << qMakePair( f.id(), f.attribute( QStringLiteral( "B_value_b" ) ) );
+
+    vlA->removeJoin( vlB->id() );
+    return values;
+  };
+
+  const QList< QPair< QgsFeatureId, QVariant > > cached = joinedValues( true, QgsFeatureRequest() );
+  QCOMPARE( cached.size(), 1000 );
+  const QList< QPair< QgsFeatureId, QVariant > > direct = joinedValues( false, QgsFeatureRequest() );
+  QCOMPARE( direct.size(), 1000 );
+  for ( int i = 0; i < 1000; ++i )
+  {
+    QCOMPARE( direct.at( i ).first, featuresA.at( i ).id() );
+    const QVariant joinValue = featuresA.at( i ).attribute( 0 );
+    if ( joinValue.isNull() )
+      QCOMPARE( direct.at( i ).second.toInt(), -1 );
+    else if ( joinValue.toInt() >= 40 )
+      QVERIFY( direct.at( i ).second.isNull() );
+    else
+      QCOMPARE( direct.at( i ).second.toInt(), joinValue.toInt() * 10 );
+
+    // the memory cache keys join values by their string representation, only compare non NULL values
+    if ( !joinValue.isNull() )
+      QCOMPARE( direct.at( i ).second.toInt(), cached.at( i ).second.toInt() );
+  }
+
+  // limited request, smaller than the read ahead window
+  const QList< QPair< QgsFeatureId, QVariant > > limited = joinedValues( false, QgsFeatureRequest().setLimit( 10 ) );
+  QCOMPARE( limited.size(), 10 );
+  QCOMPARE( limited, direct.mid( 0, 10 ) );
+
+  // edited target features
+  QVERIFY( vlA->startEditing() );
+  QVERIFY( vlA->changeAttributeValue( featuresA.at( 1 ).id(), 0, 3 ) );
+  QgsFeature added( vlA->fields() );
+  added.setAttribute( 0, 5 );
+  QVERIFY( vlA->addFeature( added ) );
+  const QList< QPair< QgsFeatureId, QVariant > > edited = joinedValues( false, QgsFeatureRequest() );
+  QCOMPARE( edited.size(), 1001 );
+  for ( const auto &value : edited )
+  {
+    if ( value.first == featuresA.at( 1 ).id() )
+      QCOMPARE( value.second.toInt(), 30 );
+    else if ( value.first == added.id() )
+      QCOMPARE( value.second.toInt(), 50 );
+  }
+  vlA->rollBack();
+}
+
 QGSTEST_MAIN( TestVectorLayerJoinBuffer )
 #include "testqgsvectorlayerjoinbuffer.moc"
@@ -14,14 +14,17 @@
  ***************************************************************************/
 #include <QFile>
 #include <QObject>
+#include <QTemporaryDir>
 #include <QUrlQuery>
 
 #include "qgstest.h"
 #include <qgswmsprovider.h>
 #include <qgsapplication.h>
 #include <qgsmultirenderchecker.h>
+#include <qgsrasterblock.h>
 #include <qgsrasterlayer.h>
 #include <qgsproviderregistry.h>
+#include <qgstilecache.h>
 
 /**
  * \ingroup UnitTests
@@ -166,6 +169,71 @@ class TestQgsWmsProvider: public QObject
       QVERIFY( imageCheck( "mbtiles_1", mapSettings ) );
     }
 
+    void testMBTilesDecodedTiles()
+    {
+      // tiles read from the MBTiles file are decoded concurrently and stored in the tile cache
+      QString dataDir( TEST_DATA_DIR );
+      QUrlQuery uq;
+      uq.addQueryItem( "type", "mbtiles" );
+      uq.addQueryItem( "url", QUrl::fromLocalFile( dataDir + "/isle_of_man.mbtiles" ).toString() );
+      QgsRasterLayer layer( uq.toString(), "isle_of_man", "wms" );
+      QVERIFY( layer.isValid() );
+
+      const QgsRectangle extent = layer.extent();
+      std::unique_ptr< QgsRasterBlock > decoded( layer.dataProvider()->block( 1, extent, 1024, 1024 ) );
+      QVERIFY( decoded );
+      const QImage decodedImage = decoded->image();
+      QVERIFY( !decodedImage.isNull() );
+      QVERIFY( QgsTileCache::totalCost() > 0 );
+
+      bool hasData = false;
+      for ( int y = 0; y < decodedImage.height() && !hasData; y += 16 )
+      {
+        for ( int x = 0; x < decodedImage.width() && !hasData; x += 16 )
+          hasData = qAlpha( decodedImage.pixel( x, y ) ) > 0;
+      }
+      QVERIFY( hasData );
+
+      // the same view is now drawn from the decoded tiles stored in the tile cache
+      std::unique_ptr< QgsRasterBlock > cached( layer.dataProvider()->block( 1, extent, 1024, 1024 ) );
+      QVERIFY( cached );
+      QCOMPARE( cached->image(), decodedImage );
+    }
+
+    void testXyzDownloadedTilesDecoded()
+    {
+      // downloaded tiles are decoded on the thread pool, then drawn by the download handler
+      QTemporaryDir dir;
+      QVERIFY( dir.isValid() );
+      const QList< QRgb > colors { qRgb( 255, 0, 0 ), qRgb( 0, 255, 0 ), qRgb( 0, 0, 255 ), qRgb( 255, 255, 0 ) };
+      for ( int x = 0; x < 2; ++x )
+      {
+        QVERIFY( QDir().mkpath( QStringLiteral( "%1/1/%2" ).arg( dir.path() ).arg( x ) ) );
+        for ( int y = 0; y < 2; ++y )
+        {
+          QImage tile( 256, 256, QImage::Format_ARGB32 );
+          tile.fill( colors.at( x * 2 + y ) );
+          QVERIFY( tile.save( QStringLiteral( "%1/1/%2/%3.png" ).arg( dir.path() ).arg( x ).arg( y ) ) );
+        }
+      }
+
+      const QString uri = QStringLiteral( "type=xyz&url=%1/%7Bz%7D/%7Bx%7D/%7By%7D.png&zmax=1&zmin=1" ).arg( QUrl::fromLocalFile( dir.path() ).toString() );
+      QgsRasterLayer layer( uri, QStringLiteral( "xyz" ), QStringLiteral( "wms" ) );
+      QVERIFY( layer.isValid() );
+
+      const QgsRectangle world( -20037508.3427892, -20037508.3427892, 20037508.3427892, 20037508.3427892 );
+      std::unique_ptr< QgsRasterBlock > block( layer.dataProvider()->block( 1, world, 512, 512 ) );
+      QVERIFY( block );
+      const QImage image = block->image();
+      QCOMPARE( image.size(), QSize( 512, 512 ) );
+
+      // tile rows go from north to south
+      QCOMPARE( image.pixel( 128, 128 ), colors.at( 0 ) );
+      QCOMPARE( image.pixel( 128, 384 ), colors.at( 1 ) );
+      QCOMPARE( image.pixel( 384, 128 ), colors.at( 2 ) );
+      QCOMPARE( image.pixel( 384, 384 ), colors.at( 3 ) );
+    }
+
     void testDpiDependentData()
     {
       QString dataDir( TEST_DATA_DIR );
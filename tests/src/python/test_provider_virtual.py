@@ -1353,6 +1353,42 @@ class TestQgsVirtualLayerProvider(unittest.TestCase, ProviderTestCase):
         feat = next(vl.getFeatures())
         self.assertEqual(feat.attribute('fldlonglong'), bigint)
 
+    def test_multiple_constraints(self):
+        """
+        Test queries combining several attribute constraints, search frames and a limit
+        """
+        ml = QgsVectorLayer("Point?srid=EPSG:4326&field=a:int&field=b:string", "mem_constraints", "memory")
+        self.assertEqual(ml.isValid(), True)
+        QgsProject.instance().addMapLayer(ml)
+
+        features = []
+        for i in range(10):
+            f = QgsFeature(ml.fields())
+            f.setAttributes([i, 'even' if i % 2 == 0 else 'odd'])
+            f.setGeometry(QgsGeometry.fromWkt('POINT({0} {0})'.format(i)))
+            features.append(f)
+        ml.dataProvider().addFeatures(features)
+
+        def query_values(sql):
+            df = QgsVirtualLayerDefinition()
+            df.setQuery(sql)
+            vl = QgsVectorLayer(df.toString(), "vl", "virtual")
+            self.assertTrue(vl.isValid())
+            return sorted([f['a'] for f in vl.getFeatures()])
+
+        self.assertEqual(query_values("select * from mem_constraints where a > 2 and a <= 6 and b = 'even'"), [4, 6])
+        self.assertEqual(query_values("select * from mem_constraints where a >= 3 and a < 8 and b = 'odd' limit 1"), [3])
+        self.assertEqual(query_values("select * from mem_constraints where a >= 3 and b = 'odd' limit 2 offset 1"), [5, 7])
+        self.assertEqual(query_values("select * from mem_constraints where a > 100"), [])
+        self.assertEqual(query_values("select * from mem_constraints where a = null"), [])
+        self.assertEqual(query_values("select * from mem_constraints where _search_frame_ = BuildMbr(1.5, 1.5, 5.5, 5.5) and a <> 3"), [2, 4, 5])
+        self.assertEqual(query_values("select * from mem_constraints where _search_frame_ = BuildMbr(0, 0, 4, 4) and _search_frame_ = BuildMbr(3, 3, 9, 9)"), [3, 4])
+        self.assertEqual(query_values("select * from mem_constraints where _search_frame_ = BuildMbr(0, 0, 1, 1) and _search_frame_ = BuildMbr(5, 5, 9, 9)"), [])
+        self.assertEqual(query_values("select * from mem_constraints where _search_frame_ = BuildMbr(0, 0, 1, 1) and _search_frame_ = BuildMbr(5, 5, 9, 9) and a > 1"), [])
+        self.assertEqual(query_values("select * from mem_constraints where _search_frame_ = BuildMbr(0, 0, 1, 1) and _search_frame_ = BuildMbr(5, 5, 9, 9) and b = 'odd' limit 2"), [])
+
+        QgsProject.instance().removeMapLayer(ml.id())
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -4578,6 +4578,99 @@ java.io.IOExceptionCannot do natural order without a primary key, please add it
         errors = vl.dataProvider().errors()
         self.assertEqual(len(errors), 0, errors)
 
+    def testBatchedIdCacheUpdate(self):
+        """Test that the ids and contents of a large download are consistent in the cache"""
+
+        endpoint = self.__class__.basetestpath + '/fake_qgis_http_endpoint_batched_id_cache'
+
+        with open(sanitize(endpoint, '?SERVICE=WFS?REQUEST=GetCapabilities?VERSION=1.0.0'), 'wb') as f:
+            f.write("""
+<WFS_Capabilities version="1.0.0" xmlns="http://www.opengis.net/wfs" xmlns:ogc="http://www.opengis.net/ogc">
+  <FeatureTypeList>
+    <FeatureType>
+      <Name>my:typename</Name>
+      <Title>Title</Title>
+      <Abstract>Abstract</Abstract>
+      <SRS>EPSG:32631</SRS>
+    </FeatureType>
+  </FeatureTypeList>
+</WFS_Capabilities>""".encode('UTF-8'))
+
+        with open(sanitize(endpoint, '?SERVICE=WFS&REQUEST=DescribeFeatureType&VERSION=1.0.0&TYPENAME=my:typename'),
+                  'wb') as f:
+            f.write("""
+<xsd:schema xmlns:my="http://my" xmlns:gml="http://www.opengis.net/gml" xmlns:xsd="http://www.w3.org/2001/XMLSchema" elementFormDefault="qualified" targetNamespace="http://my">
+  <xsd:import namespace="http://www.opengis.net/gml"/>
+  <xsd:complexType name="typenameType">
+    <xsd:complexContent>
+      <xsd:extension base="gml:AbstractFeatureType">
+        <xsd:sequence>
+          <xsd:element maxOccurs="1" minOccurs="0" name="intfield" nillable="true" type="xsd:int"/>
+          <xsd:element maxOccurs="1" minOccurs="0" name="stringfield" nillable="true" type="xsd:string"/>
+          <xsd:element maxOccurs="1" minOccurs="0" name="geometry" nillable="true" type="gml:PointPropertyType"/>
+        </xsd:sequence>
+      </xsd:extension>
+    </xsd:complexContent>
+  </xsd:complexType>
+  <xsd:element name="typename" substitutionGroup="gml:_Feature" type="my:typenameType"/>
+</xsd:schema>
+""".encode('UTF-8'))
+
+        def writeGetFeatureResponse(indexes):
+            members = ''.join("""
+  <gml:featureMember>
+    <my:typename fid="typename.'{0}'">
+      <my:geometry>
+          <gml:Point srsName="http://www.opengis.net/gml/srs/epsg.xml#32631"><gml:coordinates decimal="." cs="," ts=" ">{1},{2}</gml:coordinates></gml:Point>
+      </my:geometry>
+      <my:intfield>{0}</my:intfield>
+      <my:stringfield>feature '{0}'</my:stringfield>
+    </my:typename>
+  </gml:featureMember>""".format(i, 400000 + i, 5400000 + 2 * i) for i in indexes)
+            with open(sanitize(endpoint, '?SERVICE=WFS&REQUEST=GetFeature&VERSION=1.0.0&TYPENAME=my:typename&SRSNAME=EPSG:32631'),
+                      'wb') as f:
+                f.write("""
+<wfs:FeatureCollection
+                       xmlns:wfs="http://www.opengis.net/wfs"
+                       xmlns:gml="http://www.opengis.net/gml"
+                       xmlns:my="http://my">{}
+</wfs:FeatureCollection>""".format(members).encode('UTF-8'))
+
+        def checkFeatures(vl, indexes):
+            self.assertEqual(vl.featureCount(), len(indexes))
+            features = {f['intfield']: f for f in vl.getFeatures()}
+            self.assertEqual(sorted(features.keys()), sorted(indexes))
+            for i, f in features.items():
+                self.assertEqual(f['stringfield'], "feature '{}'".format(i))
+                self.assertEqual(f.geometry().asWkt(), 'Point ({} {})'.format(400000 + i, 5400000 + 2 * i))
+            # every feature has its own id, which gives back the same feature
+            ids = {i: f.id() for i, f in features.items()}
+            self.assertEqual(len(set(ids.values())), len(indexes))
+            for i in indexes[::97]:
+                f = next(vl.getFeatures(QgsFeatureRequest(ids[i])))
+                self.assertEqual(f['intfield'], i)
+                self.assertEqual(f['stringfield'], "feature '{}'".format(i))
+            return ids
+
+        # Enough features to be written to the cache in several batches, with
+        # unique ids which would need quoting in SQL
+        count = 5000
+        writeGetFeatureResponse(range(count))
+
+        vl = QgsVectorLayer("url='http://" + endpoint + "' typename='my:typename' version='1.0.0'", 'test', 'WFS')
+        self.assertTrue(vl.isValid())
+        ids = checkFeatures(vl, list(range(count)))
+        self.assertEqual(sorted(ids.values()), list(range(1, count + 1)))
+
+        # Features downloaded again, in another order and with new ones, keep their id
+        indexes = list(range(count + 500 - 1, 999, -1))
+        writeGetFeatureResponse(indexes)
+        vl.dataProvider().reloadData()
+        newIds = checkFeatures(vl, indexes)
+        for i in range(1000, count):
+            self.assertEqual(newIds[i], ids[i])
+        self.assertEqual(sorted(newIds[i] for i in range(count, count + 500)), list(range(count + 1, count + 501)))
+
     def testWFS20CaseInsensitiveKVP(self):
         """Test an URL with non standard query string arguments where the server exposes
         the same parameters with different case: see https://github.com/qgis/QGIS/issues/34148
@@ -24,6 +24,7 @@ __copyright__ = 'Copyright 2013, The QGIS Project'
 import qgis  # NOQA
 
 import os
+import random
 import re
 import tempfile
 import inspect
@@ -1024,6 +1025,131 @@ class TestQgsDelimitedTextProviderOther(unittest.TestCase):
         finally:
             del os.environ['QGIS_DELIMITED_TEXT_FILE_BUFFER_SIZE']
 
+    def testQuotedAndEscapedFields(self):
+        # Fields are generated with the quoting and escaping rules of the parser,
+        # including long runs of ordinary characters, non Latin1 characters and
+        # special characters which are not Latin1
+        definitions = [
+            ({'delimiter': ',', 'quote': '"', 'escape': '"'}, ',', [
+                ('abc', 'abc'),
+                ('a b  c', 'a b  c'),
+                ('  ab ', '  ab '),
+                ('"a,b"', 'a,b'),
+                ('"a""b"', 'a"b'),
+                ('  "x y"  ', 'x y'),
+                ('"l1\nl2"', 'l1\nl2'),
+                ('ßπ漢字', 'ßπ漢字'),
+                ('"漢,字 ""q"""', '漢,字 "q"'),
+                ('x' * 5000, 'x' * 5000),
+                ('"' + 'y,' * 2000 + '"', 'y,' * 2000),
+            ]),
+            ({'delimiter': ';|', 'quote': "'", 'escape': '\\'}, ';', [
+                ('abc', 'abc'),
+                ("'a\\'b'", "a'b"),
+                ('a\\;b\\|c', 'a;b|c'),
+                ("'x;y|z'", 'x;y|z'),
+                ("'a\"b'", 'a"b'),
+                ('\\\\', '\\'),
+                ('"q"', '"q"'),
+                ("  'p q'  ", 'p q'),
+            ]),
+            ({'delimiter': '→', 'quote': '「', 'escape': '「'}, '→', [
+                ('a,b', 'a,b'),
+                ('「x→y「', 'x→y'),
+                ('「a「「b「', 'a「b'),
+                ('漢字 ok', '漢字 ok'),
+                ('"plain"', '"plain"'),
+                ('「' + 'z→' * 1000 + '「', 'z→' * 1000),
+            ]),
+        ]
+
+        rng = random.Random(37)
+        for params, delimiter, cases in definitions:
+            records = [[rng.choice(cases) for _ in range(6)] for _ in range(3000)]
+            tmpfile = tempfile.NamedTemporaryFile(mode='w', encoding='utf-8', suffix='.csv', delete=False)
+            with tmpfile:
+                for record in records:
+                    tmpfile.write(delimiter.join(raw for raw, _ in record) + '\n')
+
+            url = MyUrl.fromLocalFile(tmpfile.name)
+            url.addQueryItem('type', 'csv')
+            url.addQueryItem('geomType', 'none')
+            url.addQueryItem('useHeader', 'No')
+            url.addQueryItem('detectTypes', 'No')
+            for k, v in params.items():
+                url.addQueryItem(k, v)
+            vl = QgsVectorLayer(url.toString(), 'test', 'delimitedtext')
+            self.assertTrue(vl.isValid(), params)
+            self.assertEqual(len(vl.fields()), 6, params)
+
+            features = [f for f in vl.getFeatures()]
+            self.assertEqual(len(features), len(records), params)
+            for feature, record in zip(features, records):
+                self.assertEqual(feature.attributes(), [expected for _, expected in record], params)
+            del vl
+            os.remove(tmpfile.name)
+
+    def testBatchedTypeDetection(self):
+        # The file spans several batches and blocks of records, with columns
+        # changing type in a later block or batch than their first value
+        rowCount = 40000
+        columns = ['int_col', 'late_long', 'late_double', 'late_text', 'long_then_double',
+                   'date_col', 'datetime_col', 'time_col', 'late_text_date', 'sparse', 'mixed']
+        tmpfile = tempfile.NamedTemporaryFile(mode='w', encoding='utf-8', suffix='.csv', delete=False)
+        with tmpfile:
+            tmpfile.write(';'.join(columns) + '\n')
+            for i in range(rowCount):
+                date = '2021-{:02d}-{:02d}'.format(i % 12 + 1, i % 28 + 1)
+                time = '{:02d}:{:02d}:{:02d}'.format(i % 24, i % 60, (i * 7) % 60)
+                values = [
+                    str(i),
+                    '9000000000' if i == 35000 else str(i),
+                    '2,5' if i == 20000 else str(i),
+                    'x' if i == rowCount - 1 else str(i),
+                    '9000000000' if i == 0 else '1,25' if i == 16383 else str(i),
+                    date,
+                    date + 'T' + time,
+                    time,
+                    'not a date' if i == 16384 else date,
+                    str(i) if i % 1000 == 0 else '',
+                    date if i == 1 else str(i),
+                ]
+                tmpfile.write(';'.join(values) + '\n')
+
+        url = MyUrl.fromLocalFile(tmpfile.name)
+        url.addQueryItem('type', 'csv')
+        url.addQueryItem('geomType', 'none')
+        url.addQueryItem('delimiter', ';')
+        url.addQueryItem('decimalPoint', ',')
+
+        expected = [QVariant.Int, QVariant.LongLong, QVariant.Double, QVariant.String, QVariant.Double,
+                    QVariant.Date, QVariant.DateTime, QVariant.Time, QVariant.String, QVariant.Int, QVariant.String]
+
+        maxThreads = QgsApplication.maxThreads()
+        try:
+            results = []
+            for threads in (1, -1):
+                QgsApplication.setMaxThreads(threads)
+                vl = QgsVectorLayer(url.toString(), 'test', 'delimitedtext')
+                self.assertTrue(vl.isValid())
+                self.assertEqual([f.name() for f in vl.fields()], columns)
+                self.assertEqual([f.type() for f in vl.fields()], expected)
+                self.assertEqual(vl.featureCount(), rowCount)
+
+                features = [f for f in vl.getFeatures()]
+                self.assertEqual(features[35000]['late_long'], 9000000000)
+                self.assertEqual(features[20000]['late_double'], 2.5)
+                self.assertEqual(features[16383]['long_then_double'], 1.25)
+                self.assertEqual(features[16384]['late_text_date'], 'not a date')
+                results.append([f.attributes() for f in features])
+                del vl
+        finally:
+            QgsApplication.setMaxThreads(maxThreads)
+            os.remove(tmpfile.name)
+
+        # testing blocks of records concurrently gives the same result as the sequential scan
+        self.assertEqual(results[0], results[1])
+
 
 if __name__ == '__main__':
     unittest.main()
@@ -46,7 +46,9 @@ from qgis.core import (QgsMultiRenderChecker,
                        QgsFeature,
                        QgsGeometry,
                        QgsPointXY,
-                       QgsVectorLayerSimpleLabeling)
+                       QgsVectorLayerSimpleLabeling,
+                       QgsFeedback,
+                       Qgis)
 from qgis.PyQt.QtCore import QSize, QSizeF, QDir, QRectF, Qt, QDateTime, QDate, QTime, QTimeZone
 from qgis.PyQt.QtGui import QImage, QPainter
 from qgis.PyQt.QtPrintSupport import QPrinter
@@ -950,6 +952,66 @@ class TestQgsLayoutExporter(unittest.TestCase):
         page4_path = os.path.join(self.basetestpath, 'test_exportiteratortoimage_Pays de la Loire.png')
         self.assertTrue(os.path.exists(page4_path))
 
+    def testIteratorToImagesConcurrently(self):
+        project, layout = self.prepareIteratorLayout()
+        atlas = layout.atlas()
+        atlas.setFilenameExpression("'test_exportiteratortoimageconcurrent_' || \"NAME_1\"")
+
+        # setup settings
+        settings = QgsLayoutExporter.ImageExportSettings()
+        settings.dpi = 80
+        settings.workerCount = 2
+
+        result, error = QgsLayoutExporter.exportToImage(atlas, self.basetestpath + '/', 'png', settings)
+        self.assertEqual(result, QgsLayoutExporter.Success, error)
+
+        page1_path = os.path.join(self.basetestpath, 'test_exportiteratortoimageconcurrent_Basse-Normandie.png')
+        self.assertTrue(self.checkImage('iteratortoimageconcurrent1', 'iteratortoimage1', page1_path))
+        page2_path = os.path.join(self.basetestpath, 'test_exportiteratortoimageconcurrent_Bretagne.png')
+        self.assertTrue(self.checkImage('iteratortoimageconcurrent2', 'iteratortoimage2', page2_path))
+        page3_path = os.path.join(self.basetestpath, 'test_exportiteratortoimageconcurrent_Centre.png')
+        self.assertTrue(os.path.exists(page3_path))
+        page4_path = os.path.join(self.basetestpath, 'test_exportiteratortoimageconcurrent_Pays de la Loire.png')
+        self.assertTrue(os.path.exists(page4_path))
+
+    def testIteratorToImagesConcurrentlyError(self):
+        project, layout = self.prepareIteratorLayout()
+        atlas = layout.atlas()
+        atlas.setFilenameExpression("'test_exportiteratortoimageconcurrenterror_' || \"NAME_1\"")
+
+        settings = QgsLayoutExporter.ImageExportSettings()
+        settings.dpi = 80
+        settings.workerCount = 2
+
+        # the files are written by the worker threads, their errors are still reported
+        base_path = os.path.join(self.basetestpath, 'missing_directory') + '/'
+        result, error = QgsLayoutExporter.exportToImage(atlas, base_path, 'png', settings)
+        self.assertEqual(result, QgsLayoutExporter.FileError)
+        self.assertIn('test_exportiteratortoimageconcurrenterror_', error)
+        self.assertFalse(os.path.exists(base_path))
+
+    def testIteratorToImagesConcurrentlyCanceled(self):
+        project, layout = self.prepareIteratorLayout()
+        atlas = layout.atlas()
+        atlas.setFilenameExpression("'test_exportiteratortoimageconcurrentcanceled_' || \"NAME_1\"")
+
+        settings = QgsLayoutExporter.ImageExportSettings()
+        settings.dpi = 80
+        settings.workerCount = 2
+
+        # cancel once the first page is rendered
+        feedback = QgsFeedback()
+        feedback.progressChanged.connect(lambda progress: feedback.cancel() if progress > 0 else None)
+
+        result, error = QgsLayoutExporter.exportToImage(atlas, self.basetestpath + '/', 'png', settings, feedback)
+        self.assertEqual(result, QgsLayoutExporter.Canceled)
+
+        # the pages rendered before the cancellation are completely written
+        page1_path = os.path.join(self.basetestpath, 'test_exportiteratortoimageconcurrentcanceled_Basse-Normandie.png')
+        self.assertTrue(self.checkImage('iteratortoimageconcurrentcanceled1', 'iteratortoimage1', page1_path))
+        page2_path = os.path.join(self.basetestpath, 'test_exportiteratortoimageconcurrentcanceled_Bretagne.png')
+        self.assertFalse(os.path.exists(page2_path))
+
     def testIteratorToSvgs(self):
         project, layout = self.prepareIteratorLayout()
         atlas = layout.atlas()
@@ -1003,6 +1065,83 @@ class TestQgsLayoutExporter(unittest.TestCase):
         page4_path = os.path.join(self.basetestpath, 'test_exportiteratortopdf_Pays de la Loire.pdf')
         self.assertTrue(os.path.exists(page4_path))
 
+    def testIteratorToPdfsConcurrently(self):
+        project, layout = self.prepareIteratorLayout()
+        atlas = layout.atlas()
+        atlas.setFilenameExpression("'test_exportiteratortopdfconcurrent_' || \"NAME_1\"")
+
+        settings = QgsLayoutExporter.PdfExportSettings()
+        settings.dpi = 80
+        settings.rasterizeWholeImage = False
+        settings.forceVectorOutput = False
+        settings.appendGeoreference = True
+        settings.exportMetadata = True
+        settings.workerCount = 2
+
+        result, error = QgsLayoutExporter.exportToPdfs(atlas, self.basetestpath + '/', settings)
+        self.assertEqual(result, QgsLayoutExporter.Success, error)
+
+        page1_path = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrent_Basse-Normandie.pdf')
+        rendered_page_1 = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrent_Basse-Normandie.png')
+        pdfToPng(page1_path, rendered_page_1, dpi=80, page=1)
+        self.assertTrue(self.checkImage('iteratortopdfconcurrent1', 'iteratortoimage1', rendered_page_1, size_tolerance=2))
+        page2_path = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrent_Bretagne.pdf')
+        rendered_page_2 = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrent_Bretagne.png')
+        pdfToPng(page2_path, rendered_page_2, dpi=80, page=1)
+        self.assertTrue(self.checkImage('iteratortopdfconcurrent2', 'iteratortoimage2', rendered_page_2, size_tolerance=2))
+        page3_path = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrent_Centre.pdf')
+        self.assertTrue(os.path.exists(page3_path))
+        page4_path = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrent_Pays de la Loire.pdf')
+        self.assertTrue(os.path.exists(page4_path))
+
+        # the georeferencing and metadata are written by the worker threads
+        for path in (page1_path, page2_path, page3_path, page4_path):
+            ds = gdal.Open(path)
+            self.assertTrue(ds)
+            self.assertNotEqual(ds.GetGeoTransform(), (0.0, 1.0, 0.0, 0.0, 0.0, 1.0))
+            self.assertIn('2154', ds.GetProjectionRef())
+            self.assertEqual(ds.GetMetadataItem('CREATOR'), 'QGIS {}'.format(Qgis.version()))
+            ds = None
+
+    def testIteratorToPdfsConcurrentlyError(self):
+        project, layout = self.prepareIteratorLayout()
+        atlas = layout.atlas()
+        atlas.setFilenameExpression("'test_exportiteratortopdfconcurrenterror_' || \"NAME_1\"")
+
+        settings = QgsLayoutExporter.PdfExportSettings()
+        settings.dpi = 80
+        settings.workerCount = 2
+
+        base_path = os.path.join(self.basetestpath, 'missing_directory') + '/'
+        result, error = QgsLayoutExporter.exportToPdfs(atlas, base_path, settings)
+        self.assertEqual(result, QgsLayoutExporter.FileError)
+        self.assertIn('test_exportiteratortopdfconcurrenterror_', error)
+        self.assertFalse(os.path.exists(base_path))
+
+    def testIteratorToPdfsConcurrentlyCanceled(self):
+        project, layout = self.prepareIteratorLayout()
+        atlas = layout.atlas()
+        atlas.setFilenameExpression("'test_exportiteratortopdfconcurrentcanceled_' || \"NAME_1\"")
+
+        settings = QgsLayoutExporter.PdfExportSettings()
+        settings.dpi = 80
+        settings.workerCount = 2
+
+        # cancel once the first page is rendered
+        feedback = QgsFeedback()
+        feedback.progressChanged.connect(lambda progress: feedback.cancel() if progress > 0 else None)
+
+        result, error = QgsLayoutExporter.exportToPdfs(atlas, self.basetestpath + '/', settings, feedback)
+        self.assertEqual(result, QgsLayoutExporter.Canceled)
+
+        page1_path = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrentcanceled_Basse-Normandie.pdf')
+        ds = gdal.Open(page1_path)
+        self.assertTrue(ds)
+        self.assertEqual(ds.GetMetadataItem('CREATOR'), 'QGIS {}'.format(Qgis.version()))
+        ds = None
+        page2_path = os.path.join(self.basetestpath, 'test_exportiteratortopdfconcurrentcanceled_Bretagne.pdf')
+        self.assertFalse(os.path.exists(page2_path))
+
     def testIteratorToPdf(self):
         project, layout = self.prepareIteratorLayout()
         atlas = layout.atlas()
@@ -157,6 +157,66 @@ class TestQgsMapRenderer(unittest.TestCase):
         self.assertTrue(cache.hasCacheImage('_labels_'))
         self.assertTrue(job.takeLabelingResults())
 
+    def checkRepaintLabeledLayerKeepsOtherLayerImages(self, job_type):
+        """ repainting a labeled layer should not force other labeled layers to be redrawn"""
+        labelSettings = QgsPalLayerSettings()
+        labelSettings.fieldName = "fldtxt"
+
+        layer = QgsVectorLayer("Point?field=fldtxt:string",
+                               "layer1", "memory")
+        f = QgsFeature(layer.fields())
+        f.setAttributes(['a'])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(10, 30)))
+        layer.dataProvider().addFeatures([f])
+        layer.setLabeling(QgsVectorLayerSimpleLabeling(labelSettings))
+        layer.setLabelsEnabled(True)
+
+        layer2 = QgsVectorLayer("Point?field=fldtxt:string",
+                                "layer2", "memory")
+        f = QgsFeature(layer2.fields())
+        f.setAttributes(['b'])
+        f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(20, 40)))
+        layer2.dataProvider().addFeatures([f])
+        layer2.setLabeling(QgsVectorLayerSimpleLabeling(labelSettings))
+        layer2.setLabelsEnabled(True)
+
+        settings = QgsMapSettings()
+        settings.setExtent(QgsRectangle(5, 25, 25, 45))
+        settings.setOutputSize(QSize(600, 400))
+        settings.setLayers([layer, layer2])
+
+        # with cache - first run should populate cache
+        cache = QgsMapRendererCache()
+        job = job_type(settings)
+        job.setCache(cache)
+        job.start()
+        job.waitForFinished()
+        self.assertTrue(cache.hasCacheImage('_labels_'))
+        self.assertTrue(cache.hasCacheImage(layer.id()))
+        self.assertTrue(cache.hasCacheImage(layer2.id()))
+        layer_image = cache.cacheImage(layer.id())
+
+        # trigger repaint on layer2 - should only invalidate its own image and the labels
+        layer2.triggerRepaint()
+        self.assertFalse(cache.hasCacheImage('_labels_'))
+        self.assertTrue(cache.hasCacheImage(layer.id()))
+        self.assertFalse(cache.hasCacheImage(layer2.id()))
+
+        job = job_type(settings)
+        job.setCache(cache)
+        job.start()
+        job.waitForFinished()
+        self.assertFalse(job.usedCachedLabels())
+        self.assertTrue(cache.hasCacheImage('_labels_'))
+        self.assertTrue(cache.hasCacheImage(layer2.id()))
+        self.assertEqual(set(cache.dependentLayers('_labels_')), {layer, layer2})
+        # layer was not redrawn, its cached image is still used
+        self.assertEqual(cache.cacheImage(layer.id()), layer_image)
+
+        # but its labels must still be part of the new labeling solution
+        results = job.takeLabelingResults()
+        self.assertEqual({l.layerID for l in results.allLabels(settings.extent())}, {layer.id(), layer2.id()})
+
     def checkAddingNewLabeledLayerInvalidatesLabelCache(self, job_type):
         """ adding a new labeled layer should invalidate any previous label caches"""
         layer = QgsVectorLayer("Point?field=fldtxt:string",
@@ -435,6 +495,7 @@ class TestQgsMapRenderer(unittest.TestCase):
         self.checkRendererUseCachedLabels(renderer)
         self.checkRepaintNonLabeledLayerDoesNotInvalidateLabelCache(renderer)
         self.checkRepaintLabeledLayerInvalidatesLabelCache(renderer)
+        self.checkRepaintLabeledLayerKeepsOtherLayerImages(renderer)
         self.checkAddingNewLabeledLayerInvalidatesLabelCache(renderer)
         self.checkRemovingLabeledLayerInvalidatesLabelCache(renderer)
         self.checkAddingNewNonLabeledLayerKeepsLabelCache(renderer)
@@ -871,6 +871,64 @@ class TestQgsRasterLayer(unittest.TestCase):
             class_values.append(c.value)
         self.assertEqual(sorted(class_values), list(range(65536)))
 
+    def testRenderersIntegerAndFloatBlocksMatch(self):
+        """
+        Large blocks of integer values are colored through a lookup table,
+        float blocks per pixel: both must give identical colors
+        """
+        tempdir = QTemporaryDir()
+        size = 512
+        npdata = np.array([[(r * size + c) % 500 - 50 for c in range(size)] for r in range(size)])
+
+        layers = {}
+        for data_type, np_type in ((gdal.GDT_Int16, np.int16), (gdal.GDT_Float32, np.float32)):
+            path = os.path.join(tempdir.path(), 'values_{}.tif'.format(data_type))
+            driver = gdal.GetDriverByName('GTiff')
+            outRaster = driver.Create(path, size, size, 1, data_type)
+            outRaster.SetGeoTransform((0, 1, 0, size, 0, -1))
+            outband = outRaster.GetRasterBand(1)
+            outband.SetNoDataValue(-50)
+            outband.WriteArray(npdata.astype(np_type))
+            outband.FlushCache()
+            outRaster.FlushCache()
+            del outRaster
+
+            layers[data_type] = QgsRasterLayer(path, 'values')
+            self.assertTrue(layers[data_type].isValid())
+
+        def render(layer, renderer):
+            renderer.setInput(layer.dataProvider())
+            block = renderer.block(1, layer.extent(), size, size)
+            self.assertTrue(block.isValid())
+            return block.data()
+
+        shader_function = QgsColorRampShader(-50, 450)
+        shader_function.setColorRampType(QgsColorRampShader.Interpolated)
+        shader_function.setColorRampItemList([QgsColorRampShader.ColorRampItem(0, QColor(255, 0, 0, 100)),
+                                              QgsColorRampShader.ColorRampItem(200, QColor(0, 255, 0)),
+                                              QgsColorRampShader.ColorRampItem(400, QColor(0, 0, 255))])
+        classes = [QgsPalettedRasterRenderer.Class(-10, QColor(0, 255, 0), 'class 1'),
+                   QgsPalettedRasterRenderer.Class(3, QColor(255, 0, 0, 120), 'class 2'),
+                   QgsPalettedRasterRenderer.Class(300, QColor(0, 0, 255), 'class 3')]
+
+        for opacity in (1.0, 0.5):
+            blocks = []
+            for data_type in (gdal.GDT_Int16, gdal.GDT_Float32):
+                layer = layers[data_type]
+
+                shader = QgsRasterShader()
+                shader.setRasterShaderFunction(QgsColorRampShader(shader_function))
+                pseudo_color = QgsSingleBandPseudoColorRenderer(None, 1, shader)
+                pseudo_color.setOpacity(opacity)
+
+                paletted = QgsPalettedRasterRenderer(None, 1, classes)
+                paletted.setOpacity(opacity)
+
+                blocks.append((render(layer, pseudo_color), render(layer, paletted)))
+
+            self.assertEqual(blocks[0][0], blocks[1][0])
+            self.assertEqual(blocks[0][1], blocks[1][1])
+
     def testClone(self):
         myPath = os.path.join(unitTestDataPath('raster'),
                               'band1_float32_noct_epsg4326.tif')
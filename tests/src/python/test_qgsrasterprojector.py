@@ -0,0 +1,115 @@
+# -*- coding: utf-8 -*-
+
+"""
+***************************************************************************
+    test_qgsrasterprojector.py
+    --------------------------
+    Date                 : October 2021
+    Copyright            : (C) 2021 by QGIS contributors
+***************************************************************************
+*                                                                         *
+*   This program is free software; you can redistribute it and/or modify  *
+*   it under the terms of the GNU General Public License as published by  *
+*   the Free Software Foundation; either version 2 of the License, or     *
+*   (at your option) any later version.                                   *
+*                                                                         *
+***************************************************************************
+
+From build dir, run: ctest -R PyQgsRasterProjector -V
+
+"""
+
+__author__ = 'QGIS contributors'
+__date__ = 'October 2021'
+__copyright__ = '(C) 2021, QGIS contributors'
+
+import os
+
+import qgis  # NOQA
+from qgis.core import (QgsApplication,
+                       QgsRasterLayer,
+                       QgsRasterProjector,
+                       QgsCoordinateReferenceSystem,
+                       QgsCoordinateTransform,
+                       QgsProject,
+                       )
+from qgis.testing import start_app, unittest
+
+from utilities import unitTestDataPath
+
+start_app()
+TEST_DATA_DIR = unitTestDataPath()
+
+
+class TestQgsRasterProjector(unittest.TestCase):
+
+    def projector(self, layer, precision):
+        projector = QgsRasterProjector()
+        projector.setInput(layer.dataProvider())
+        projector.setCrs(layer.crs(), QgsCoordinateReferenceSystem('EPSG:3857'),
+                         QgsProject.instance().transformContext())
+        projector.setPrecision(precision)
+        return projector
+
+    def test_repeated_and_cloned_blocks_are_identical(self):
+        """
+        Large blocks are projected in concurrent row bands; blocks served
+        from the cached transform grid or from a clone must match a fresh
+        projector
+        """
+        layer = QgsRasterLayer(os.path.join(TEST_DATA_DIR, 'raster', 'band1_float32_noct_epsg4326.tif'), 'layer')
+        self.assertTrue(layer.isValid())
+
+        ct = QgsCoordinateTransform(layer.crs(), QgsCoordinateReferenceSystem('EPSG:3857'), QgsProject.instance())
+        extent = ct.transformBoundingBox(layer.extent())
+
+        for precision in (QgsRasterProjector.Approximate, QgsRasterProjector.Exact):
+            projector = self.projector(layer, precision)
+
+            # large block, projected in parallel row bands
+            first = projector.block(1, extent, 1024, 1024)
+            self.assertTrue(first.isValid())
+            self.assertEqual(first.width(), 1024)
+            self.assertEqual(first.height(), 1024)
+            second = projector.block(1, extent, 1024, 1024)
+            clone = projector.clone()
+            clone.setInput(layer.dataProvider())
+            cloned = clone.block(1, extent, 1024, 1024)
+            fresh = self.projector(layer, precision).block(1, extent, 1024, 1024)
+
+            self.assertEqual(first.data(), second.data())
+            self.assertEqual(first.data(), cloned.data())
+            self.assertEqual(first.data(), fresh.data())
+
+    def test_parallel_blocks_match_sequential_blocks(self):
+        """
+        Projecting a large block in concurrent row bands must give the same
+        result as projecting it on a single thread
+        """
+        layer = QgsRasterLayer(os.path.join(TEST_DATA_DIR, 'raster', 'band1_float32_noct_epsg4326.tif'), 'layer')
+        self.assertTrue(layer.isValid())
+
+        ct = QgsCoordinateTransform(layer.crs(), QgsCoordinateReferenceSystem('EPSG:3857'), QgsProject.instance())
+        extent = ct.transformBoundingBox(layer.extent())
+
+        max_threads = QgsApplication.maxThreads()
+        try:
+            for precision in (QgsRasterProjector.Approximate, QgsRasterProjector.Exact):
+                # a single thread in the pool disables the row bands
+                QgsApplication.setMaxThreads(1)
+                sequential = self.projector(layer, precision).block(1, extent, 1024, 1024)
+                QgsApplication.setMaxThreads(-1)
+                parallel = self.projector(layer, precision).block(1, extent, 1024, 1024)
+
+                self.assertTrue(sequential.isValid())
+                self.assertTrue(parallel.isValid())
+                self.assertEqual(parallel.data(), sequential.data())
+                for row in range(0, 1024, 97):
+                    for col in range(0, 1024, 89):
+                        self.assertEqual(parallel.isNoData(row, col), sequential.isNoData(row, col))
+        finally:
+            QgsApplication.setMaxThreads(max_threads)
+
+
+if __name__ == '__main__':
+    unittest.main()
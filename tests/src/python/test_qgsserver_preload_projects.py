@@ -0,0 +1,128 @@
+# -*- coding: utf-8 -*-
+"""QGIS Unit tests for QgsServer preloaded projects.
+
+From build dir, run: ctest -R PyQgsServerPreloadProjects -V
+
+.. note:: This program is free software; you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation; either version 2 of the License, or
+(at your option) any later version.
+
+"""
+__author__ = 'QGIS contributors'
+__date__ = '19/10/2021'
+__copyright__ = 'Copyright 2021, The QGIS Project'
+
+import os
+import shutil
+import tempfile
+import time
+
+# Needed on Qt 5 so that the serialization of XML is consistent among all executions
+os.environ['QT_HASH_SEED'] = '1'
+
+from qgis.PyQt.QtCore import QCoreApplication
+from qgis.core import QgsProject, QgsPrintLayout
+from qgis.server import QgsConfigCache, QgsServerSettings
+from qgis.testing import unittest
+
+from test_qgsserver import QgsServerTestBase
+
+
+class TestQgsServerPreloadProjects(QgsServerTestBase):
+
+    @classmethod
+    def setUpClass(cls):
+        super().setUpClass()
+        cls.temp_dir = tempfile.mkdtemp()
+
+    @classmethod
+    def tearDownClass(cls):
+        shutil.rmtree(cls.temp_dir, True)
+        super().tearDownClass()
+
+    def _write_project(self, path, title):
+        """Writes a project with a print layout and the given title to path"""
+        project = QgsProject()
+        project.setTitle(title)
+        layout = QgsPrintLayout(project)
+        layout.initializeDefaults()
+        layout.setName('layout1')
+        project.layoutManager().addLayout(layout)
+        self.assertTrue(project.write(path))
+
+    def _get_capabilities(self, path):
+        qs = '?MAP={}&SERVICE=WMS&REQUEST=GetCapabilities&VERSION=1.3.0'.format(path)
+        return self._execute_request(qs)[1].decode('utf-8')
+
+    def test_changed_project_is_served(self):
+        """Test that the new version of a changed preloaded project is served"""
+        path = os.path.join(self.temp_dir, 'preloaded.qgs')
+        self._write_project(path, 'Preloaded version 1')
+
+        self.server.putenv('QGIS_SERVER_PRELOAD_PROJECTS', path)
+        self.server.preloadProjects()
+        self.assertIn('Preloaded version 1', self._get_capabilities(path))
+
+        # the replaced project is deleted from the event loop once no request uses it
+        replaced = []
+        QgsConfigCache.instance().project(path).destroyed.connect(lambda: replaced.append(True))
+
+        # the file watcher needs a distinct modification to report
+        time.sleep(1)
+        self._write_project(path, 'Preloaded version 2')
+
+        body = ''
+        deadline = time.time() + 10
+        while 'Preloaded version 2' not in body and time.time() < deadline:
+            QCoreApplication.processEvents()
+            body = self._get_capabilities(path)
+        self.assertIn('Preloaded version 2', body)
+        self.assertNotIn('Preloaded version 1', body)
+
+        # the project is read again in the thread of the cache, layouts included
+        project = QgsConfigCache.instance().project(path)
+        self.assertEqual(project.title(), 'Preloaded version 2')
+        self.assertIsNotNone(project.layoutManager().layoutByName('layout1'))
+
+        # the instance of the main thread is left untouched by the reads
+        self.assertNotEqual(QgsProject.instance().title(), 'Preloaded version 2')
+
+        QCoreApplication.processEvents()
+        self.assertEqual(replaced, [True])
+        self.assertIn('Preloaded version 2', self._get_capabilities(path))
+
+    def test_changed_project_is_read_in_background(self):
+        """Test that a changed preloaded project is read in the background without layouts"""
+        path = os.path.join(self.temp_dir, 'preloaded_background.qgs')
+        self._write_project(path, 'Background version 1')
+
+        os.environ['QGIS_SERVER_DISABLE_GETPRINT'] = '1'
+        settings = QgsServerSettings()
+        settings.load()
+        del os.environ['QGIS_SERVER_DISABLE_GETPRINT']
+        self.assertTrue(settings.getPrintDisabled())
+
+        self.assertEqual(QgsConfigCache.instance().preloadProjects([path], settings), [path])
+        self.assertEqual(QgsConfigCache.instance().project(path, settings).title(), 'Background version 1')
+
+        time.sleep(1)
+        self._write_project(path, 'Background version 2')
+
+        title = ''
+        deadline = time.time() + 10
+        while title != 'Background version 2' and time.time() < deadline:
+            QCoreApplication.processEvents()
+            title = QgsConfigCache.instance().project(path, settings).title()
+        self.assertEqual(title, 'Background version 2')
+
+        project = QgsConfigCache.instance().project(path, settings)
+        self.assertIsNone(project.layoutManager().layoutByName('layout1'))
+        self.assertNotEqual(QgsProject.instance().title(), 'Background version 2')
+
+        # the project served to requests is the new one
+        self.assertIn('Background version 2', self._get_capabilities(path))
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -41,6 +41,18 @@ class TestQgsServerProjectUtils(unittest.TestCase):
         self.assertEqual(QgsServerProjectUtils.wmsMaxWidth(self.prj), 400)
         self.assertEqual(QgsServerProjectUtils.wmsMaxHeight(self.prj), 500)
 
+    def test_png_compression(self):
+        # default compression level when not set in the project
+        self.assertEqual(QgsServerProjectUtils.wmsPngCompression(self.prj), -1)
+
+        prj = QgsProject()
+        prj.writeEntry("WMSPngCompression", "/", 1)
+        self.assertEqual(QgsServerProjectUtils.wmsPngCompression(prj), 1)
+
+        # levels are clamped to the zlib range
+        prj.writeEntry("WMSPngCompression", "/", 12)
+        self.assertEqual(QgsServerProjectUtils.wmsPngCompression(prj), 9)
+
     def test_url(self):
         self.assertEqual(QgsServerProjectUtils.wmsServiceUrl(self.prj), "my_wms_advertised_url")
         self.assertEqual(QgsServerProjectUtils.wcsServiceUrl(self.prj), "my_wcs_advertised_url")
@@ -101,6 +101,54 @@ class TestQgsServerSettings(unittest.TestCase):
         self.assertEqual(self.settings.maxThreads(), 5)
         os.environ.pop(env)
 
+    def test_env_parallel_requests(self):
+        env = "QGIS_SERVER_PARALLEL_REQUESTS"
+
+        # requests are handled one at a time by default
+        self.settings.load()
+        self.assertEqual(self.settings.parallelRequests(), 1)
+
+        os.environ[env] = "8"
+        self.settings.load()
+        self.assertEqual(self.settings.parallelRequests(), 8)
+        os.environ.pop(env)
+
+        # invalid values fall back to a single request at a time
+        os.environ[env] = "0"
+        self.settings.load()
+        self.assertEqual(self.settings.parallelRequests(), 1)
+        os.environ.pop(env)
+
+    def test_env_preload_projects(self):
+        env = "QGIS_SERVER_PRELOAD_PROJECTS"
+
+        # no project is preloaded by default
+        self.settings.load()
+        self.assertEqual(self.settings.preloadProjects(), "")
+
+        os.environ[env] = "/tmp/project1.qgs||/tmp/project2.qgz"
+        self.settings.load()
+        self.assertEqual(self.settings.preloadProjects(), "/tmp/project1.qgs||/tmp/project2.qgz")
+        os.environ.pop(env)
+
+    def test_env_legend_cache_max_age(self):
+        env = "QGIS_SERVER_LEGEND_CACHE_MAX_AGE"
+
+        # legend hit test results are not stored by default
+        self.settings.load()
+        self.assertEqual(self.settings.legendCacheMaxAge(), 0)
+
+        os.environ[env] = "300"
+        self.settings.load()
+        self.assertEqual(self.settings.legendCacheMaxAge(), 300)
+        os.environ.pop(env)
+
+        # negative values disable storing results
+        os.environ[env] = "-1"
+        self.settings.load()
+        self.assertEqual(self.settings.legendCacheMaxAge(), 0)
+        os.environ.pop(env)
+
     def test_env_cache_size(self):
         env = "QGIS_SERVER_CACHE_SIZE"
 
@@ -1407,6 +1407,57 @@ class TestQgsVectorFileWriter(unittest.TestCase):
         vl = QgsVectorLayer(dest_file_name)
         self.assertTrue(vl.isValid())
 
+    def testTransactionSize(self):
+        """Test writing features in several transactions"""
+        ml = QgsVectorLayer('Point?crs=epsg:4326&field=id:int', 'test', 'memory')
+        self.assertTrue(ml.isValid())
+        features = []
+        for i in range(25):
+            f = QgsFeature(ml.fields())
+            f.setAttributes([i])
+            f.setGeometry(QgsGeometry.fromPointXY(QgsPointXY(i, i)))
+            features.append(f)
+        self.assertTrue(ml.dataProvider().addFeatures(features)[0])
+
+        dest_file_name = os.path.join(str(QDir.tempPath()), 'writer_transaction_size.gpkg')
+        options = QgsVectorFileWriter.SaveVectorOptions()
+        options.driverName = 'GPKG'
+        self.assertEqual(options.transactionSize, 100000)
+        options.transactionSize = 10
+        options.ct = QgsCoordinateTransform(ml.crs(), QgsCoordinateReferenceSystem.fromEpsgId(3857), QgsProject.instance())
+        write_result, error_message, new_file, new_layer = QgsVectorFileWriter.writeAsVectorFormatV3(
+            ml,
+            dest_file_name,
+            QgsProject.instance().transformContext(),
+            options)
+        self.assertEqual(write_result, QgsVectorFileWriter.NoError, error_message)
+
+        created_layer = QgsVectorLayer(dest_file_name, 'test', 'ogr')
+        self.assertTrue(created_layer.isValid())
+        self.assertEqual(created_layer.crs().authid(), 'EPSG:3857')
+        self.assertEqual([f['id'] for f in created_layer.getFeatures()], list(range(25)))
+        f = next(created_layer.getFeatures(QgsFeatureRequest().setFilterExpression('id = 10')))
+        self.assertAlmostEqual(f.geometry().asPoint().x(), 1113194.9, 1)
+
+        # SpatiaLite spatial index is created once all features are written
+        dest_file_name = os.path.join(str(QDir.tempPath()), 'writer_transaction_size.sqlite')
+        options.driverName = 'SpatiaLite'
+        options.layerName = 'points'
+        write_result, error_message, new_file, new_layer = QgsVectorFileWriter.writeAsVectorFormatV3(
+            ml,
+            dest_file_name,
+            QgsProject.instance().transformContext(),
+            options)
+        self.assertEqual(write_result, QgsVectorFileWriter.NoError, error_message)
+
+        ds = ogr.Open(dest_file_name)
+        sql_lyr = ds.ExecuteSQL("SELECT spatial_index_enabled FROM geometry_columns WHERE f_table_name = 'points'")
+        f = sql_lyr.GetNextFeature()
+        self.assertEqual(f.GetField(0), 1)
+        ds.ReleaseResultSet(sql_lyr)
+        self.assertEqual(ds.GetLayer(0).GetFeatureCount(), 25)
+        ds = None
+
     def testPersistMetadata(self):
         """
         Test that metadata from the source layer is saved as default for the destination if the